@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+void initArena(Arena *arena) {
+    arena->head = NULL;
+}
+
+// Reserva memória zerada alinhada a 16 bytes
+void *arenaAlloc(Arena *arena, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    ArenaChunk *chunk = arena->head;
+    if (!chunk || chunk->used + size > chunk->size) {
+        size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+        chunk = (ArenaChunk *)malloc(sizeof(ArenaChunk) + chunk_size);
+        if (!chunk) {
+            fprintf(stderr, "Erro de alocação de memória na arena\n");
+            exit(EXIT_FAILURE);
+        }
+        chunk->used = 0;
+        chunk->size = chunk_size;
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+char *arenaStrdup(Arena *arena, const char *text) {
+    size_t length = strlen(text) + 1;
+    char *copy = (char *)arenaAlloc(arena, length);
+    memcpy(copy, text, length);
+    return copy;
+}
+
+void freeArena(Arena *arena) {
+    ArenaChunk *current = arena->head;
+    while (current) {
+        ArenaChunk *next = current->next;
+        free(current);
+        current = next;
+    }
+    arena->head = NULL;
+}
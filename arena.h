@@ -0,0 +1,24 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bloco de memória de uma arena
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t used;
+    size_t size;
+    _Alignas(16) char data[];
+} ArenaChunk;
+
+// Alocador por região: os nós são liberados todos de uma vez
+typedef struct {
+    ArenaChunk *head;
+} Arena;
+
+void initArena(Arena *arena);
+void *arenaAlloc(Arena *arena, size_t size);
+char *arenaStrdup(Arena *arena, const char *text);
+void freeArena(Arena *arena);
+
+#endif
@@ -0,0 +1,78 @@
+# Benchmark da análise dos corpos dos procedimentos em paralelo (-j) e do lexer numa thread
+# própria (--pipeline, contra --stream na mesma thread): gera um programa com
+# COUNT procedimentos e mede a compilação com cada variante de opções, do início ao fim do processo.
+# Uso: cmake -DCOMPILER=<compilador> -DWORK_DIR=<dir> [-DCOUNT=<n>] [-DRUNS=<n>] -P bench_parallel.cmake
+# Também pelo alvo bench_parallel: cmake --build <build> --target bench_parallel
+#
+# Todas as variantes precisam imprimir o mesmo; o tempo relatado é a mediana das execuções.
+
+foreach(var COMPILER WORK_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "bench_parallel.cmake: ${var} não definido")
+    endif()
+endforeach()
+if(NOT COUNT)
+    set(COUNT 10000)
+endif()
+if(NOT RUNS)
+    set(RUNS 5)
+endif()
+set(variants "--vm" "--vm -j 1" "--vm -j 2" "--vm -j 4" "--vm -j 8" "--vm --stream" "--vm --pipeline")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+set(program "${WORK_DIR}/procedimentos.pas")
+execute_process(COMMAND "${CMAKE_COMMAND}" -DCOUNT=${COUNT} "-DOUTPUT=${program}"
+        -P "${CMAKE_CURRENT_LIST_DIR}/generate_procedures.cmake")
+file(SIZE "${program}" bytes)
+message("bench: ${COUNT} procedures, ${bytes} bytes, ${RUNS} run(s) per variant")
+
+function(microseconds result)
+    string(TIMESTAMP seconds "%s")
+    string(TIMESTAMP fraction "%f")
+    math(EXPR value "${seconds} * 1000000 + ${fraction}")
+    set(${result} ${value} PARENT_SCOPE)
+endfunction()
+
+function(milliseconds result us)
+    math(EXPR whole "${us} / 1000")
+    math(EXPR part "${us} % 1000")
+    string(LENGTH "${part}" digits)
+    if(digits EQUAL 1)
+        set(part "00${part}")
+    elseif(digits EQUAL 2)
+        set(part "0${part}")
+    endif()
+    set(${result} "${whole}.${part} ms" PARENT_SCOPE)
+endfunction()
+
+set(expected "")
+foreach(variant IN LISTS variants)
+    separate_arguments(args UNIX_COMMAND "${variant}")
+    set(times "")
+    foreach(run RANGE 1 ${RUNS})
+        microseconds(start)
+        execute_process(COMMAND "${COMPILER}" ${args} "${program}" WORKING_DIRECTORY "${WORK_DIR}"
+                RESULT_VARIABLE rc OUTPUT_VARIABLE out ERROR_QUIET)
+        microseconds(end)
+        if(NOT rc EQUAL 0)
+            message(FATAL_ERROR "bench: ${variant} falhou (${rc})")
+        endif()
+        if(expected STREQUAL "")
+            set(expected "${out}")
+        elseif(NOT out STREQUAL expected)
+            message(FATAL_ERROR "bench: ${variant} imprimiu algo diferente da primeira variante")
+        endif()
+        math(EXPR elapsed "${end} - ${start}")
+        list(APPEND times ${elapsed})
+    endforeach()
+    list(SORT times COMPARE NATURAL)
+    math(EXPR middle "${RUNS} / 2")
+    list(GET times ${middle} median)
+    list(GET times 0 best)
+    milliseconds(median "${median}")
+    milliseconds(best "${best}")
+    string(LENGTH "${variant}" width)
+    math(EXPR width "20 - ${width}")
+    string(REPEAT " " ${width} padding)
+    message("  ${variant}${padding} median ${median}, min ${best}")
+endforeach()
@@ -0,0 +1,35 @@
+program TabuadaComFor;
+var
+    i: integer;
+    j: integer;
+    soma: integer;
+    produto: integer;
+procedure linha(n: integer);
+var
+    k: integer;
+begin
+    for k := 1 to n do
+        write(n * k, ' ');
+    writeln;
+end;
+begin
+    soma := 0;
+    for i := 1 to 100 do
+        soma := soma + i;
+    writeln('Soma de 1 a 100: ', soma);
+    produto := 1;
+    for i := 10 downto 1 do
+        produto := produto * i;
+    writeln('10! = ', produto);
+    for i := 1 to 5 do
+        linha(i);
+    soma := 0;
+    for i := 1 to 9 do
+        for j := i to 9 do
+            if (i + j) mod 3 = 0 then
+                soma := soma + i * j;
+    writeln('Pares divisíveis por 3: ', soma);
+    { Laço que não executa: o limite final é menor que o inicial }
+    for i := 5 to 1 do
+        writeln('nunca');
+end.
@@ -0,0 +1,47 @@
+program VetoresENotas;
+var
+    notas: array[1..40] of real;
+    pesos: array[1..40] of real;
+    contagem: array[0..9] of integer;
+    deslocado: array[-3..36] of integer;
+    aprovado: array[1..40] of boolean;
+    i: integer;
+    total: integer;
+    media: real;
+    soma_pesos: real;
+begin
+    for i := 1 to 40 do
+    begin
+        notas[i] := (i * 7 mod 11) / 1.0;
+        pesos[i] := 1.0 + i mod 3;
+        deslocado[i - 4] := i * i - 20
+    end;
+    media := 0.0;
+    soma_pesos := 0.0;
+    for i := 1 to 40 do
+    begin
+        media := media + notas[i] * pesos[i];
+        soma_pesos := soma_pesos + pesos[i]
+    end;
+    writeln('Média ponderada: ', media / soma_pesos);
+    for i := 0 to 9 do
+        contagem[i] := 0;
+    for i := 1 to 40 do
+        contagem[i mod 10] := contagem[i mod 10] + 1;
+    for i := 1 to 40 do
+        aprovado[i] := notas[i] >= 5.0;
+    total := 0;
+    for i := 1 to 40 do
+        if aprovado[i] then
+            total := total + 1;
+    writeln('Aprovados: ', total, ' de 40');
+    { Laços elemento a elemento, candidatos à vetorização }
+    for i := -3 to 36 do
+        deslocado[i] := deslocado[i] * 3 - 1;
+    total := 0;
+    for i := -3 to 36 do
+        total := total + deslocado[i];
+    writeln('Soma do vetor deslocado: ', total);
+    writeln('contagem[0] = ', contagem[0], ', contagem[7] = ', contagem[7]);
+    writeln('aprovado[3] = ', aprovado[3], ', aprovado[4] = ', aprovado[4]);
+end.
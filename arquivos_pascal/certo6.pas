@@ -0,0 +1,13 @@
+program UsaGeometria;
+uses geometria;
+var
+    i: integer;
+begin
+    chamadas := 0;
+    for i := 1 to 3 do
+    begin
+        area_retangulo(i, i + 1);
+        perimetro(i, i + 1)
+    end;
+    writeln('Chamadas à unit: ', chamadas);
+end.
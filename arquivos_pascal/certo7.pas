@@ -0,0 +1,19 @@
+program LeituraDeNumeros;
+var
+    n: integer;
+    i: integer;
+    k: integer;
+    x: real;
+    total: real;
+begin
+    read(n);
+    total := 0.0;
+    for i := 1 to n do
+    begin
+        read(x);
+        writeln(x);
+        total := total + x
+    end;
+    read(k);
+    writeln('Total: ', total, ' inteiro: ', k);
+end.
@@ -0,0 +1,18 @@
+program ErrosSemanticos;
+var
+    n: integer;
+    v: array[1..10] of integer;
+    ok: boolean;
+procedure dobra(x: integer);
+begin
+    x := x * 2;
+end;
+begin
+    n := 5;
+    ok := n;
+    v[1] := 3.5;
+    dobra(n, 1);
+    total := n + 1;
+    for n := 1 to 10 do
+        v[n] := n;
+end.
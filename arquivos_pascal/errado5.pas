@@ -0,0 +1,13 @@
+program LiteraisInvalidos;
+var
+    n: integer;
+    x: real;
+    s: integer;
+begin
+    n := 12abc;
+    n := 99999999999999999999;
+    x := 1.5e999;
+    x := 2.5E+;
+    s := 0 ? 1;
+    writeln('texto sem fim);
+end.
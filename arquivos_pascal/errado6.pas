@@ -0,0 +1,8 @@
+program ComentarioAberto;
+var
+    n: integer;
+begin
+    n := 1;
+    { comentário que nunca fecha
+    writeln(n);
+end.
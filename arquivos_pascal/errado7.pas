@@ -0,0 +1,32 @@
+program Diagnosticos;
+var
+    a: integer;
+    r: real;
+    b: boolean;
+    a: real;
+procedure mostra(x: integer);
+begin
+    writeln('x = ', x)
+end;
+procedure calcula(n: integer);
+begin
+    r := n;
+    n := b + 1;
+    if n then writeln('positivo');
+    mostra(1, 2);
+    for r := 1 to 10 do soma := soma + r;
+    b := n / 2;
+    writeln(d)
+end;
+procedure quebrada(y: integer);
+begin
+    y := ;
+    y := (1
+end;
+procedure cabecalho(x integer);
+begin
+    writeln(x)
+end;
+begin
+    calcula(a)
+end.
@@ -0,0 +1,56 @@
+# Gera um programa com COUNT procedimentos encadeados, para os testes e o benchmark do -j.
+# Uso: cmake -DCOUNT=<n> -DOUTPUT=<prog.pas> [-DERRORS=ON] -P generate_procedures.cmake
+#
+# Cada procedimento chama o anterior, então a saída depende de todos os corpos. Com ERRORS,
+# alguns corpos recebem erros de sintaxe e de tipo espalhados pelo arquivo.
+
+foreach(var COUNT OUTPUT)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "generate_procedures.cmake: ${var} não definido")
+    endif()
+endforeach()
+
+# O texto vai para o arquivo em blocos: acumular tudo numa string custa tempo quadrático
+file(WRITE "${OUTPUT}" "program procedimentos;\nvar g: integer;\n    r: real;\n")
+set(text "")
+math(EXPR last "${COUNT} - 1")
+foreach(i RANGE ${last})
+    string(APPEND text
+            "procedure p${i}(a, b: integer; x: real);\n"
+            "var t, k: integer;\n"
+            "    y: real;\n"
+            "begin\n"
+            "  t := a * 3 + b div 2;\n"
+            "  y := x * 1.5 + t;\n"
+            "  for k := 1 to 10 do\n"
+            "  begin\n"
+            "    if k mod 2 = 0 then t := t + k else t := t - 1;\n"
+            "    while t > 100 do t := t div 2\n"
+            "  end;\n")
+    if(i GREATER 0)
+        math(EXPR previous "${i} - 1")
+        string(APPEND text "  p${previous}(t, k, y);\n")
+    endif()
+    if(ERRORS)
+        math(EXPR syntax "${i} % 997")
+        math(EXPR type "${i} % 1499")
+        math(EXPR paren "${i} % 2011")
+        if(syntax EQUAL 5)
+            string(APPEND text "  t := ;\n")
+        endif()
+        if(type EQUAL 7)
+            string(APPEND text "  t := true;\n")
+        endif()
+        if(paren EQUAL 9)
+            string(APPEND text "  t := (1;\n")
+        endif()
+    endif()
+    string(APPEND text "  g := g + t\nend;\n")
+    math(EXPR block "${i} % 200")
+    if(block EQUAL 199)
+        file(APPEND "${OUTPUT}" "${text}")
+        set(text "")
+    endif()
+endforeach()
+string(APPEND text "begin\n  p${last}(1, 2, 0.5);\n  writeln(g)\nend.\n")
+file(APPEND "${OUTPUT}" "${text}")
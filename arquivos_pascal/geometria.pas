@@ -0,0 +1,18 @@
+unit geometria;
+interface
+var
+    chamadas: integer;
+procedure area_retangulo(base: integer; altura: integer);
+procedure perimetro(base: integer; altura: integer);
+implementation
+procedure area_retangulo(base: integer; altura: integer);
+begin
+    chamadas := chamadas + 1;
+    writeln('Área: ', base * altura);
+end;
+procedure perimetro(base: integer; altura: integer);
+begin
+    chamadas := chamadas + 1;
+    writeln('Perímetro: ', 2 * (base + altura));
+end;
+end.
@@ -0,0 +1,179 @@
+# Compila um exemplo de arquivos_pascal/ em um modo e compara a saída com o .out esperado.
+# Uso: cmake -DCOMPILER=<compilador> -DSOURCE=<prog.pas> -DEXPECTED=<prog.out> -DWORK_DIR=<dir>
+#            -DMODE=vm|native|asm|cc|check|rebuild [-DFLAGS=<opções>] [-DUNITS=<unit.pas;...>]
+#            [-DEXPECTED_RC=<código>] [-DEXPECTED_ERR=<prog.err>] [-DINPUT=<prog.in>] -P run_sample.cmake
+#        cmake -DCOMPILER=<compilador> -DWORK_DIR=<dir> -DMODE=compare -DFLAGS=<opções> -DREFERENCE=<opções>
+#            (-DSOURCE=<prog.pas> | -DGENERATE=<procedimentos> [-DGENERATE_ERRORS=ON]) -P run_sample.cmake
+#
+# Os fontes são copiados para WORK_DIR: output.lex, .ppu e executáveis nunca sujam o diretório dos exemplos.
+# Com UNITS o programa é compilado com --build, que gera antes os .ppu das units copiadas.
+# EXPECTED_ERR também confere stderr, onde saem as mensagens do lexer. Com --diagnostics=json
+# a saída do check precisa ser um documento JSON válido, com contagens coerentes. INPUT é a entrada
+# padrão do programa (do compilador com --vm, do executável nos back-ends nativos).
+# MODE=compare não tem .out: compila com REFERENCE e com FLAGS (por exemplo sem e com -j) e exige
+# a mesma saída, os mesmos erros e o mesmo output.lex. GENERATE troca SOURCE por um programa de
+# generate_procedures.cmake, grande o bastante para os caminhos paralelos.
+
+set(required COMPILER WORK_DIR MODE)
+if(NOT GENERATE)
+    list(APPEND required SOURCE)
+endif()
+if(NOT MODE STREQUAL "compare")
+    list(APPEND required EXPECTED)
+endif()
+foreach(var ${required})
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "run_sample.cmake: ${var} não definido")
+    endif()
+endforeach()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+if(GENERATE)
+    set(program procedimentos.pas)
+    execute_process(COMMAND "${CMAKE_COMMAND}" -DCOUNT=${GENERATE} -DERRORS=${GENERATE_ERRORS}
+            "-DOUTPUT=${WORK_DIR}/${program}" -P "${CMAKE_CURRENT_LIST_DIR}/generate_procedures.cmake"
+            RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "generate_procedures.cmake falhou")
+    endif()
+else()
+    file(COPY "${SOURCE}" ${UNITS} DESTINATION "${WORK_DIR}")
+    get_filename_component(program "${SOURCE}" NAME)
+endif()
+separate_arguments(flags UNIX_COMMAND "${FLAGS}")
+set(input "")
+if(INPUT)
+    set(input INPUT_FILE "${INPUT}")
+endif()
+if(UNITS)
+    list(APPEND flags --build)
+endif()
+
+function(compile)
+    execute_process(COMMAND "${COMPILER}" ${ARGN} ${flags} "${program}"
+            WORKING_DIRECTORY "${WORK_DIR}" ${input}
+            RESULT_VARIABLE rc OUTPUT_VARIABLE out ERROR_VARIABLE err)
+    set(rc "${rc}" PARENT_SCOPE)
+    set(out "${out}" PARENT_SCOPE)
+    set(err "${err}" PARENT_SCOPE)
+endfunction()
+
+# Back-ends nativos: compila para um executável e o executa
+function(compile_and_run)
+    compile(${ARGN} -o "${WORK_DIR}/programa")
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "compilação falhou (${rc}):\n${err}")
+    endif()
+    execute_process(COMMAND "${WORK_DIR}/programa" WORKING_DIRECTORY "${WORK_DIR}" ${input}
+            RESULT_VARIABLE rc OUTPUT_VARIABLE out ERROR_VARIABLE err)
+    set(rc "${rc}" PARENT_SCOPE)
+    set(out "${out}" PARENT_SCOPE)
+    set(err "${err}" PARENT_SCOPE)
+endfunction()
+
+function(expect_build_stats compiled up_to_date failed)
+    if(NOT err MATCHES "build: [0-9]+ unit\\(s\\), ${compiled} compiled, ${up_to_date} up to date, ${failed} failed")
+        message(FATAL_ERROR "esperado ${compiled} compiled, ${up_to_date} up to date, ${failed} failed:\n${err}")
+    endif()
+endfunction()
+
+if(NOT EXPECTED_RC)
+    set(EXPECTED_RC 0)
+endif()
+if(MODE STREQUAL "vm")
+    compile(--vm)
+elseif(MODE STREQUAL "native")
+    compile_and_run(--native)
+elseif(MODE STREQUAL "asm")
+    compile_and_run(--native --via-asm)
+elseif(MODE STREQUAL "cc")
+    compile_and_run(--cc)
+elseif(MODE STREQUAL "check")
+    compile(--check)
+elseif(MODE STREQUAL "rebuild")
+    # Primeira compilação gera tudo; a segunda reaproveita os .ppu; editar uma unit a recompila.
+    # Uma unit com erro conta como falha, não como compilada, e a compilação termina com erro
+    if(NOT UNITS)
+        message(FATAL_ERROR "run_sample.cmake: MODE=rebuild exige UNITS")
+    endif()
+    compile(--vm --stats)
+    expect_build_stats("[1-9][0-9]*" 0 0)
+    compile(--vm --stats)
+    expect_build_stats(0 "[1-9][0-9]*" 0)
+    list(GET UNITS 0 unit)
+    get_filename_component(unit "${unit}" NAME)
+    file(READ "${WORK_DIR}/${unit}" text)
+    file(WRITE "${WORK_DIR}/${unit}" "{ editado pelo teste }\n${text}")
+    compile(--vm --stats)
+    expect_build_stats(1 "[0-9]+" 0)
+    file(WRITE "${WORK_DIR}/${unit}" "{ editado pelo teste }\n;\n${text}")
+    compile(--vm --stats)
+    if(rc EQUAL 0)
+        message(FATAL_ERROR "rebuild: unit com erro compilou sem falhar")
+    endif()
+    expect_build_stats(0 "[0-9]+" "[1-9][0-9]*")
+    file(WRITE "${WORK_DIR}/${unit}" "${text}")
+    compile(--vm --stats)
+    expect_build_stats(1 "[0-9]+" 0)
+elseif(MODE STREQUAL "compare")
+    set(variant ${flags})
+    separate_arguments(flags UNIX_COMMAND "${REFERENCE}")
+    foreach(run reference result)
+        file(REMOVE "${WORK_DIR}/output.lex")
+        compile()
+        set(lex "")
+        if(EXISTS "${WORK_DIR}/output.lex")
+            file(READ "${WORK_DIR}/output.lex" lex)
+        endif()
+        set(${run} "código de saída ${rc}\n--- stdout\n${out}--- stderr\n${err}--- output.lex\n${lex}")
+        set(flags ${variant})
+    endforeach()
+    if(NOT result STREQUAL reference)
+        message(FATAL_ERROR "${FLAGS} diverge de ${REFERENCE}\n=== ${REFERENCE}\n${reference}=== ${FLAGS}\n${result}")
+    endif()
+    return()
+else()
+    message(FATAL_ERROR "run_sample.cmake: modo desconhecido ${MODE}")
+endif()
+
+if(NOT rc EQUAL EXPECTED_RC)
+    message(FATAL_ERROR "${MODE}: código de saída ${rc}, esperado ${EXPECTED_RC}:\n${err}")
+endif()
+file(READ "${EXPECTED}" expected)
+if(NOT out STREQUAL expected)
+    message(FATAL_ERROR "${MODE}: saída diferente de ${EXPECTED}\n--- esperado\n${expected}--- obtido\n${out}")
+endif()
+list(FIND flags --diagnostics=json json)
+if(MODE STREQUAL "check" AND json GREATER -1)
+    string(JSON shown ERROR_VARIABLE problem LENGTH "${out}" diagnostics)
+    if(problem)
+        message(FATAL_ERROR "check: JSON inválido (${problem})\n${out}")
+    endif()
+    string(JSON errors GET "${out}" errors)
+    string(JSON omitted GET "${out}" omitted)
+    set(shown_errors 0)
+    if(shown GREATER 0)
+        math(EXPR last "${shown} - 1")
+        foreach(i RANGE ${last})
+            string(JSON severity GET "${out}" diagnostics ${i} severity)
+            string(JSON text GET "${out}" diagnostics ${i} message)
+            if(text STREQUAL "")
+                message(FATAL_ERROR "check: diagnóstico ${i} sem mensagem")
+            endif()
+            if(severity STREQUAL "error")
+                math(EXPR shown_errors "${shown_errors} + 1")
+            endif()
+        endforeach()
+    endif()
+    math(EXPR counted "${shown_errors} + ${omitted}")
+    if(NOT counted EQUAL errors)
+        message(FATAL_ERROR "check: ${shown_errors} erro(s) mostrados + ${omitted} omitidos != ${errors}")
+    endif()
+endif()
+if(EXPECTED_ERR)
+    file(READ "${EXPECTED_ERR}" expected)
+    if(NOT err STREQUAL expected)
+        message(FATAL_ERROR "${MODE}: stderr diferente de ${EXPECTED_ERR}\n--- esperado\n${expected}--- obtido\n${err}")
+    endif()
+endif()
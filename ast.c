@@ -0,0 +1,33 @@
+#include <stdlib.h>
+#include "ast.h"
+
+AstNode *createNode(Arena *arena, NodeKind kind, int line, int column) {
+    AstNode *node = (AstNode *)arenaAlloc(arena, sizeof(AstNode));
+    node->kind = kind;
+    node->line = line;
+    node->column = column;
+    node->type = TYPE_UNKNOWN;
+    return node;
+}
+
+// Libera o escopo e a arena de um procedimento, onde o próprio nó foi alocado
+void freeProcedure(AstNode *proc) {
+    SymbolTable *locals = proc->as.procedure.locals;
+    Arena *arena = proc->as.procedure.arena;
+    freeSymbolTable(locals);
+    free(locals);
+    freeArena(arena);
+    free(arena);
+}
+
+// Libera os escopos e arenas de cada procedimento; o nó do programa
+// vive na arena do próprio parser
+void freeProgram(AstNode *program) {
+    if (!program) return;
+    AstNode *proc = program->as.program.procedures;
+    while (proc) {
+        AstNode *next = proc->next;
+        freeProcedure(proc);
+        proc = next;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef AST_H
+#define AST_H
+
+#include <stdbool.h>
+#include "tokens.h"
+#include "symbol_table.h"
+#include "arena.h"
+
+typedef enum {
+    NODE_PROGRAM,
+    NODE_PROCEDURE,
+    NODE_BLOCK,
+    NODE_ASSIGN,
+    NODE_IF,
+    NODE_WHILE,
+    NODE_FOR,
+    NODE_CALL,
+    NODE_WRITE,
+    NODE_READ,
+    NODE_BINARY,
+    NODE_UNARY,
+    NODE_WIDEN,          // Conversão implícita de integer para real
+    NODE_VARIABLE,
+    NODE_INDEX,          // Elemento de array: array[índice]
+    NODE_INT_LITERAL,
+    NODE_REAL_LITERAL,
+    NODE_BOOL_LITERAL,
+    NODE_STRING_LITERAL
+} NodeKind;
+
+typedef struct AstNode AstNode;
+
+// Nó da árvore sintática; listas (statements, argumentos, parâmetros)
+// são encadeadas pelo campo next
+struct AstNode {
+    NodeKind kind;
+    int line;
+    int column;
+    DataType type;   // Tipo declarado ou inferido
+    AstNode *next;
+    union {
+        struct { char *name; AstNode *procedures; AstNode *body; bool unit; } program;  // Units não têm body
+        struct {
+            char *name;
+            Symbol *symbol;
+            AstNode *params;      // Lista de NODE_VARIABLE
+            AstNode *body;
+            SymbolTable *locals;  // Parâmetros e variáveis locais
+            Arena *arena;         // Arena com os nós deste procedimento
+            int token_count;      // Tokens do corpo analisado em paralelo, para o --trace (0: desconhecido)
+        } procedure;
+        struct { AstNode *statements; } block;
+        struct { AstNode *target; AstNode *value; } assign;
+        struct { AstNode *cond; AstNode *then_branch; AstNode *else_branch; } if_stmt;
+        struct { AstNode *cond; AstNode *body; } while_stmt;
+        struct { AstNode *var; AstNode *start; AstNode *end; AstNode *body; bool downto; } for_stmt;
+        struct { char *name; Symbol *symbol; AstNode *args; } call;
+        struct { bool newline; AstNode *args; } write;
+        struct { AstNode *targets; } read;
+        struct { TokenType op; AstNode *left; AstNode *right; } binary;
+        struct { TokenType op; AstNode *operand; } unary;    // Também NODE_WIDEN
+        struct { char *name; Symbol *symbol; } variable;     // symbol é resolvido na análise semântica
+        struct { AstNode *array; AstNode *index; } element;  // array é um NODE_VARIABLE
+        long long int_value;
+        double real_value;
+        bool bool_value;
+        char *string_value;
+    } as;
+};
+
+AstNode *createNode(Arena *arena, NodeKind kind, int line, int column);
+void freeProcedure(AstNode *proc);
+void freeProgram(AstNode *program);
+
+#endif
@@ -0,0 +1,396 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include "build.h"
+#include "lexer.h"
+#include "unit.h"
+#include "trace.h"
+#include "parallel.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sys/stat.h>
+#define HAVE_PTHREADS 1
+#endif
+
+// Nó do grafo: o programa (nó 0) ou uma unit
+typedef struct {
+    char *name;
+    char *directory;          // Onde o fonte e o .ppu estão
+    char *path;               // Fonte; NULL quando só existe o .ppu
+    uint64_t build_key;
+    int *uses;                // Nós das units do uses
+    int use_count;
+    int *dependents;
+    int dependent_count;
+    int pending;              // Dependências ainda não prontas
+    uint64_t interface_hash;  // Interface atual, depois que o nó fica pronto
+    bool failed;
+} BuildNode;
+
+typedef struct {
+    BuildNode *nodes;
+    int count;
+    int capacity;
+    int *slots;               // Tabela de nomes: 1 + nó, 0 se vazio
+    int slot_count;
+    const BuildOptions *options;
+    int *ready;               // Fila de nós prontos para compilar; cada nó entra uma vez
+    int ready_head;
+    int ready_tail;
+    int remaining;
+    int compiled;
+    int up_to_date;
+    int failed;               // Compilação falhou ou uma dependência falhou
+#ifdef HAVE_PTHREADS
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+#endif
+} Build;
+
+static void *checkedRealloc(void *memory, size_t size) {
+    void *grown = realloc(memory, size ? size : 1);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória no build\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static char *checkedStrdup(const char *text) {
+    char *copy = checkedRealloc(NULL, strlen(text) + 1);
+    strcpy(copy, text);
+    return copy;
+}
+
+// Como o readSourceFile do main.c: só arquivos regulares, com o motivo da recusa em reason
+static char *readSource(const char *path, const char **reason) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        *reason = strerror(errno);
+        return NULL;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat info;
+    if (fstat(fileno(file), &info) != 0 || !S_ISREG(info.st_mode)) {
+        fclose(file);
+        *reason = "not a regular file";
+        return NULL;
+    }
+#endif
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length < 0 || length == LONG_MAX || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        *reason = "not a regular file";
+        return NULL;
+    }
+    char *source = checkedRealloc(NULL, (size_t)length + 1);
+    size_t read = fread(source, 1, (size_t)length, file);
+    source[read] = '\0';
+    fclose(file);
+    return source;
+}
+
+static char *directoryOf(const char *path) {
+    const char *slash = strrchr(path, '/');
+    if (!slash) return checkedStrdup(".");
+    if (slash == path) return checkedStrdup("/");
+    char *directory = checkedRealloc(NULL, (size_t)(slash - path) + 1);
+    memcpy(directory, path, (size_t)(slash - path));
+    directory[slash - path] = '\0';
+    return directory;
+}
+
+static uint32_t slotOf(const Build *b, const char *name) {
+    uint32_t hash = unitSymbolHash(name), mask = (uint32_t)b->slot_count - 1;
+    uint32_t slot = hash & mask;
+    while (b->slots[slot] && strcmp(b->nodes[b->slots[slot] - 1].name, name) != 0) slot = (slot + 1) & mask;
+    return slot;
+}
+
+static int findNode(const Build *b, const char *name) {
+    return b->slot_count ? b->slots[slotOf(b, name)] - 1 : -1;
+}
+
+static int addNode(Build *b, const char *name, const char *directory) {
+    if (2 * (b->count + 1) > b->slot_count) {
+        free(b->slots);
+        b->slot_count = b->slot_count ? b->slot_count * 2 : 64;
+        b->slots = checkedRealloc(NULL, sizeof(int) * b->slot_count);
+        memset(b->slots, 0, sizeof(int) * b->slot_count);
+        for (int i = 0; i < b->count; i++) b->slots[slotOf(b, b->nodes[i].name)] = i + 1;
+    }
+    if (b->count == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 64;
+        b->nodes = checkedRealloc(b->nodes, sizeof(BuildNode) * b->capacity);
+    }
+    BuildNode *node = &b->nodes[b->count];
+    memset(node, 0, sizeof(*node));
+    node->name = checkedStrdup(name);
+    node->directory = checkedStrdup(directory);
+    b->slots[slotOf(b, name)] = b->count + 1;
+    return b->count++;
+}
+
+// Próximo token do cabeçalho; NULL no fim do fonte
+static const Token *nextToken(Lexer *lexer, TokenList *tokens) {
+    return lexBatch(lexer, tokens, 1) ? &tokens->tail->token : NULL;
+}
+
+// Lê só o cabeçalho e o uses; erros de sintaxe ficam para o parser
+static int scanUses(const char *source, char ***names) {
+    Lexer lexer;
+    TokenList tokens;
+    initLexer(&lexer, source);
+    initTokenList(&tokens);
+    int count = 0;
+    const Token *t = nextToken(&lexer, &tokens);
+    bool unit = t && t->type == TOKEN_UNIT;
+    if (t && (unit || t->type == TOKEN_PROGRAM) &&
+        (t = nextToken(&lexer, &tokens)) && t->type == TOKEN_IDENTIFIER &&
+        (t = nextToken(&lexer, &tokens)) && t->type == TOKEN_SEMICOLON &&
+        (!unit || ((t = nextToken(&lexer, &tokens)) && t->type == TOKEN_INTERFACE)) &&
+        (t = nextToken(&lexer, &tokens)) && t->type == TOKEN_USES) {
+        while ((t = nextToken(&lexer, &tokens)) && t->type == TOKEN_IDENTIFIER) {
+            *names = checkedRealloc(*names, sizeof(char *) * (count + 1));
+            (*names)[count++] = checkedStrdup(t->lexeme);
+            if (!(t = nextToken(&lexer, &tokens)) || t->type != TOKEN_COMMA) break;
+        }
+    }
+    freeTokenList(&tokens);
+    return count;
+}
+
+static void addDependent(BuildNode *node, int dependent) {
+    node->dependents = checkedRealloc(node->dependents, sizeof(int) * (node->dependent_count + 1));
+    node->dependents[node->dependent_count++] = dependent;
+}
+
+// Busca em largura a partir do programa: cada unit é procurada no diretório de quem a usa
+static bool discover(Build *b, const char *source_path) {
+    char *directory = directoryOf(source_path);
+    addNode(b, "", directory);
+    free(directory);
+    b->nodes[0].path = checkedStrdup(source_path);
+    for (int i = 0; i < b->count; i++) {
+        // Sem fonte: o .ppu existente é usado como está
+        if (!b->nodes[i].path) continue;
+        const char *reason;
+        char *source = readSource(b->nodes[i].path, &reason);
+        if (!source) {
+            fprintf(stderr, "Erro: não foi possível ler %s: %s\n", b->nodes[i].path, reason);
+            return false;
+        }
+        b->nodes[i].build_key = unitBuildKey(source, b->options->opt_level);
+        char **names = NULL;
+        int count = scanUses(source, &names);
+        free(source);
+        b->nodes[i].uses = checkedRealloc(NULL, sizeof(int) * (count + 1));
+        for (int u = 0; u < count; u++) {
+            int used = findNode(b, names[u]);
+            if (used < 0) {
+                used = addNode(b, names[u], b->nodes[i].directory);
+                char path[1024];
+                snprintf(path, sizeof(path), "%s/%s.pas", b->nodes[i].directory, names[u]);
+                FILE *probe = fopen(path, "rb");
+                if (probe) {
+                    fclose(probe);
+                    b->nodes[used].path = checkedStrdup(path);
+                }
+            }
+            // Um uses repetido é erro do parser; aqui basta uma aresta
+            bool repeated = false;
+            for (int k = 0; k < b->nodes[i].use_count; k++) repeated |= b->nodes[i].uses[k] == used;
+            if (!repeated && used != i) {
+                b->nodes[i].uses[b->nodes[i].use_count++] = used;
+                addDependent(&b->nodes[used], i);
+            }
+            free(names[u]);
+        }
+        free(names);
+    }
+    return true;
+}
+
+// Busca em profundidade: 0 não visitado, 1 na pilha, 2 concluído
+static bool findCycle(const Build *b, int node, char *state, int *stack, int depth) {
+    state[node] = 1;
+    stack[depth] = node;
+    for (int u = 0; u < b->nodes[node].use_count; u++) {
+        int used = b->nodes[node].uses[u];
+        if (state[used] == 1) {
+            fprintf(stderr, "Erro: dependência circular entre units:");
+            int start = depth;
+            while (stack[start] != used) start--;
+            for (int k = start; k <= depth; k++) fprintf(stderr, " %s ->", b->nodes[stack[k]].name);
+            fprintf(stderr, " %s\n", b->nodes[used].name);
+            return true;
+        }
+        if (state[used] == 0 && findCycle(b, used, state, stack, depth + 1)) return true;
+    }
+    state[node] = 2;
+    return false;
+}
+
+// Desatualizada se o fonte mudou ou se a interface de alguma dependência não é mais a
+// que a unit viu ao ser compilada
+static bool isStale(const Build *b, const BuildNode *node, const Unit *unit) {
+    if (unitRecordedKey(unit) != node->build_key) return true;
+    int count = unitDependencyCount(unit);
+    if (count != node->use_count) return true;
+    for (int i = 0; i < count; i++) {
+        uint64_t interface_hash;
+        int used = findNode(b, unitDependency(unit, i, &interface_hash));
+        if (used < 0 || b->nodes[used].interface_hash != interface_hash) return true;
+    }
+    return false;
+}
+
+// Compila a unit se preciso e registra a interface resultante; roda sem a trava
+static bool processNode(Build *b, BuildNode *node) {
+    uint64_t span = traceBegin();
+    bool compiled = false;
+    for (int u = 0; u < node->use_count; u++) {
+        if (b->nodes[node->uses[u]].failed) {
+            node->failed = true;
+            return false;
+        }
+    }
+    const char *reason;
+    Unit *unit = openUnit(node->directory, node->name, &reason);
+    if (node->path && (!unit || isStale(b, node, unit))) {
+        closeUnit(unit);
+        unit = NULL;
+        compiled = true;
+        if (b->options->compile(node->path, node->name, b->options->context)) {
+            unit = openUnit(node->directory, node->name, &reason);
+        } else {
+            reason = NULL;
+        }
+    }
+    if (unit) {
+        node->interface_hash = unitInterfaceHash(unit);
+        closeUnit(unit);
+    } else {
+        if (reason) fprintf(stderr, "Erro: unit %s: %s\n", node->name, reason);
+        node->failed = true;
+    }
+    traceSpan(span, "build", node->name, "compiled", compiled);
+    return compiled;
+}
+
+static void lockBuild(Build *b) {
+#ifdef HAVE_PTHREADS
+    pthread_mutex_lock(&b->lock);
+#else
+    (void)b;
+#endif
+}
+
+static void unlockBuild(Build *b) {
+#ifdef HAVE_PTHREADS
+    pthread_mutex_unlock(&b->lock);
+#else
+    (void)b;
+#endif
+}
+
+// Laço de cada thread: pega o próximo nó pronto e, ao terminar, libera os dependentes
+static void *worker(void *argument) {
+    Build *b = argument;
+    uint64_t span = traceBegin();
+    int processed = 0;
+    lockBuild(b);
+    for (;;) {
+#ifdef HAVE_PTHREADS
+        while (b->ready_head == b->ready_tail && b->remaining > 0) pthread_cond_wait(&b->wake, &b->lock);
+#endif
+        if (b->ready_head == b->ready_tail) break;
+        BuildNode *node = &b->nodes[b->ready[b->ready_head++]];
+        unlockBuild(b);
+        bool compiled = processNode(b, node);
+        processed++;
+        lockBuild(b);
+        b->remaining--;
+        if (node->failed) b->failed++;
+        else if (compiled) b->compiled++;
+        else b->up_to_date++;
+        for (int d = 0; d < node->dependent_count; d++) {
+            int dependent = node->dependents[d];
+            if (dependent != 0 && --b->nodes[dependent].pending == 0) b->ready[b->ready_tail++] = dependent;
+        }
+#ifdef HAVE_PTHREADS
+        pthread_cond_broadcast(&b->wake);
+#endif
+    }
+    unlockBuild(b);
+    traceSpan(span, "build", "worker", "units", processed);
+    return NULL;
+}
+
+static void schedule(Build *b, int jobs) {
+    b->ready = checkedRealloc(NULL, sizeof(int) * b->count);
+    b->remaining = b->count - 1;
+    for (int i = 1; i < b->count; i++) {
+        b->nodes[i].pending = b->nodes[i].use_count;
+        if (b->nodes[i].pending == 0) b->ready[b->ready_tail++] = i;
+    }
+#ifdef HAVE_PTHREADS
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->wake, NULL);
+    pthread_t *threads = checkedRealloc(NULL, sizeof(pthread_t) * jobs);
+    int started = 0;
+    for (int i = 1; i < jobs; i++) {
+        if (pthread_create(&threads[started], NULL, worker, b) == 0) started++;
+    }
+    worker(b);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_cond_destroy(&b->wake);
+    pthread_mutex_destroy(&b->lock);
+#else
+    (void)jobs;
+    worker(b);
+#endif
+}
+
+bool buildUnits(const char *source_path, const BuildOptions *options, BuildStats *stats) {
+    Build b;
+    memset(&b, 0, sizeof(b));
+    b.options = options;
+    memset(stats, 0, sizeof(*stats));
+    bool ok = discover(&b, source_path);
+    if (ok) {
+        char *state = checkedRealloc(NULL, (size_t)b.count);
+        int *stack = checkedRealloc(NULL, sizeof(int) * b.count);
+        memset(state, 0, (size_t)b.count);
+        ok = !findCycle(&b, 0, state, stack, 0);
+        free(state);
+        free(stack);
+    }
+    if (ok && b.count > 1) {
+        int jobs = options->jobs > 0 ? options->jobs : defaultJobs();
+        if (jobs > b.count - 1) jobs = b.count - 1;
+        schedule(&b, jobs);
+        stats->jobs = jobs;
+        for (int i = 1; i < b.count; i++) ok &= !b.nodes[i].failed;
+    }
+    stats->units = b.count > 0 ? b.count - 1 : 0;
+    stats->compiled = b.compiled;
+    stats->up_to_date = b.up_to_date;
+    stats->failed = b.failed;
+    for (int i = 0; i < b.count; i++) {
+        free(b.nodes[i].name);
+        free(b.nodes[i].directory);
+        free(b.nodes[i].path);
+        free(b.nodes[i].uses);
+        free(b.nodes[i].dependents);
+    }
+    free(b.nodes);
+    free(b.slots);
+    free(b.ready);
+    return ok;
+}
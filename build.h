@@ -0,0 +1,34 @@
+#ifndef BUILD_H
+#define BUILD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// --build: a partir dos uses do programa descobre o grafo de units (<diretório>/<Nome>.pas)
+// e compila as desatualizadas em ordem topológica num grupo de threads; cada unit entra na
+// fila assim que as suas dependências ficam prontas. Uma unit é recompilada quando o fonte
+// ou o nível de otimização mudou, ou quando a interface de alguma unit que ela usa mudou;
+// mudanças só na implementação de uma dependência não a afetam, porque o código das
+// dependências só entra na ligação do programa.
+
+// Compila o fonte de uma unit e grava <diretório>/<name>.ppu; chamada em paralelo
+typedef bool (*BuildCompileFn)(const char *path, const char *name, void *context);
+
+typedef struct {
+    int jobs;                 // Threads de compilação (0: uma por processador)
+    int opt_level;            // Entra na chave de compilação dos .ppu
+    BuildCompileFn compile;
+    void *context;
+} BuildOptions;
+
+typedef struct {
+    int units;                // Units alcançáveis a partir do programa
+    int compiled;             // Só as compilações que deram certo
+    int up_to_date;
+    int failed;
+    int jobs;
+} BuildStats;
+
+bool buildUnits(const char *source_path, const BuildOptions *options, BuildStats *stats);
+
+#endif
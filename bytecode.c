@@ -0,0 +1,557 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bytecode.h"
+
+// Estado da geração de código de uma função
+typedef struct {
+    BytecodeProgram *program;
+    Function *function;
+    int *int_temps;       // Temporários inteiros/booleanos já criados
+    int int_temp_count;
+    int int_temps_used;   // Quantos estão em uso no statement atual
+    int *real_temps;
+    int real_temp_count;
+    int real_temps_used;
+    int line;
+    int column;
+    bool failed;
+} Compiler;
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *grown = realloc(array, size);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar bytecode\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static int emit(Compiler *c, OpCode op, int a, int b, int k) {
+    Function *f = c->function;
+    if (f->count == f->capacity) {
+        f->capacity = f->capacity ? f->capacity * 2 : 64;
+        f->code = checkedRealloc(f->code, sizeof(Instruction) * f->capacity);
+        f->lines = checkedRealloc(f->lines, sizeof(int) * f->capacity);
+        f->columns = checkedRealloc(f->columns, sizeof(int) * f->capacity);
+    }
+    Instruction *ins = &f->code[f->count];
+    memset(ins, 0, sizeof(*ins));
+    ins->op = (uint8_t)op;
+    ins->a = (uint16_t)a;
+    ins->k = k;
+    if (b >= 0) ins->b = (uint16_t)b;
+    f->lines[f->count] = c->line;
+    f->columns[f->count] = c->column;
+    return f->count++;
+}
+
+static int emitABC(Compiler *c, OpCode op, int a, int b, int reg_c) {
+    int index = emit(c, op, a, 0, 0);
+    c->function->code[index].b = (uint16_t)b;
+    c->function->code[index].c = (uint16_t)reg_c;
+    return index;
+}
+
+static void patchJump(Compiler *c, int index, int target) {
+    c->function->code[index].k = target;
+}
+
+static int newRegister(Compiler *c, DataType type) {
+    Function *f = c->function;
+    if (f->register_count >= MAX_REGISTERS) {
+        if (!c->failed) {
+            fprintf(stderr, "Erro: procedimento %s excede %d registradores\n", f->name, MAX_REGISTERS);
+        }
+        c->failed = true;
+        return 0;
+    }
+    f->register_types = checkedRealloc(f->register_types, f->register_count + 1);
+    f->register_types[f->register_count] = (uint8_t)type;
+    return f->register_count++;
+}
+
+// Temporários são reaproveitados entre statements, sempre com o mesmo tipo,
+// para que cada registrador tenha um único tipo durante toda a função
+static int allocTemp(Compiler *c, DataType type) {
+    if (type == TYPE_REAL) {
+        if (c->real_temps_used == c->real_temp_count) {
+            c->real_temps = checkedRealloc(c->real_temps, sizeof(int) * (c->real_temp_count + 1));
+            c->real_temps[c->real_temp_count++] = newRegister(c, TYPE_REAL);
+        }
+        return c->real_temps[c->real_temps_used++];
+    }
+    if (c->int_temps_used == c->int_temp_count) {
+        c->int_temps = checkedRealloc(c->int_temps, sizeof(int) * (c->int_temp_count + 1));
+        c->int_temps[c->int_temp_count++] = newRegister(c, TYPE_INTEGER);
+    }
+    return c->int_temps[c->int_temps_used++];
+}
+
+static void resetTemps(Compiler *c) {
+    c->int_temps_used = 0;
+    c->real_temps_used = 0;
+}
+
+static int addConstant(Compiler *c, Value value) {
+    BytecodeProgram *p = c->program;
+    p->constants = checkedRealloc(p->constants, sizeof(Value) * (p->constant_count + 1));
+    p->constants[p->constant_count] = value;
+    return p->constant_count++;
+}
+
+static int addString(Compiler *c, const char *text) {
+    BytecodeProgram *p = c->program;
+    for (int i = 0; i < p->string_count; i++) {
+        if (strcmp(p->strings[i], text) == 0) return i;
+    }
+    p->strings = checkedRealloc(p->strings, sizeof(char *) * (p->string_count + 1));
+    p->strings[p->string_count] = strdup(text);
+    return p->string_count++;
+}
+
+static bool isGlobal(const Symbol *symbol) {
+    return symbol->scope == 0;
+}
+
+static void emitLoadInteger(Compiler *c, int dst, long long value) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+        emit(c, OP_LOADI, dst, -1, (int32_t)value);
+    } else {
+        Value constant = {.i = value};
+        emit(c, OP_LOADK, dst, -1, addConstant(c, constant));
+    }
+}
+
+static OpCode binaryOpcode(TokenType op, DataType operand_type) {
+    bool real = operand_type == TYPE_REAL;
+    switch (op) {
+        case TOKEN_PLUS: return real ? OP_ADD_R : OP_ADD_I;
+        case TOKEN_MINUS: return real ? OP_SUB_R : OP_SUB_I;
+        case TOKEN_MULTIPLY: return real ? OP_MUL_R : OP_MUL_I;
+        case TOKEN_DIVIDE: return OP_DIV_R;
+        case TOKEN_DIV: return OP_DIV_I;
+        case TOKEN_MOD: return OP_MOD_I;
+        case TOKEN_AND: return OP_AND;
+        case TOKEN_OR: return OP_OR;
+        case TOKEN_EQ: return real ? OP_EQ_R : OP_EQ_I;
+        case TOKEN_NEQ: return real ? OP_NE_R : OP_NE_I;
+        case TOKEN_LT: return real ? OP_LT_R : OP_LT_I;
+        case TOKEN_LTE: return real ? OP_LE_R : OP_LE_I;
+        case TOKEN_GT: return real ? OP_GT_R : OP_GT_I;
+        case TOKEN_GTE: return real ? OP_GE_R : OP_GE_I;
+        default: return OP_NOP;
+    }
+}
+
+// Gera o código da expressão e devolve o registrador com o resultado;
+// se dst >= 0 o resultado é produzido diretamente nele
+static int compileExpression(Compiler *c, AstNode *node, int dst);
+
+// Elementos de array: numa atribuição o índice é avaliado depois do valor, e o limite
+// é conferido pela própria instrução
+static int loadElement(Compiler *c, AstNode *node, int dst) {
+    int index = compileExpression(c, node->as.element.index, -1);
+    int reg = dst >= 0 ? dst : allocTemp(c, node->type);
+    emitABC(c, OP_LOADX, reg, index, node->as.element.array->as.variable.symbol->index);
+    return reg;
+}
+
+static void storeElement(Compiler *c, AstNode *target, int reg) {
+    int index = compileExpression(c, target->as.element.index, -1);
+    emitABC(c, OP_STOREX, reg, index, target->as.element.array->as.variable.symbol->index);
+}
+
+static int compileExpression(Compiler *c, AstNode *node, int dst) {
+    switch (node->kind) {
+        case NODE_INT_LITERAL:
+        case NODE_BOOL_LITERAL: {
+            int reg = dst >= 0 ? dst : allocTemp(c, node->type);
+            emitLoadInteger(c, reg, node->kind == NODE_BOOL_LITERAL ? node->as.bool_value : node->as.int_value);
+            return reg;
+        }
+        case NODE_REAL_LITERAL: {
+            int reg = dst >= 0 ? dst : allocTemp(c, TYPE_REAL);
+            Value constant = {.r = node->as.real_value};
+            emit(c, OP_LOADK, reg, -1, addConstant(c, constant));
+            return reg;
+        }
+        case NODE_VARIABLE: {
+            Symbol *symbol = node->as.variable.symbol;
+            if (isGlobal(symbol)) {
+                int reg = dst >= 0 ? dst : allocTemp(c, symbol->type);
+                emit(c, OP_LOADG, reg, -1, symbol->index);
+                return reg;
+            }
+            if (dst >= 0 && dst != symbol->index) {
+                emit(c, OP_MOV, dst, symbol->index, 0);
+                return dst;
+            }
+            return symbol->index;
+        }
+        case NODE_INDEX:
+            return loadElement(c, node, dst);
+        case NODE_WIDEN: {
+            int operand = compileExpression(c, node->as.unary.operand, -1);
+            int reg = dst >= 0 ? dst : allocTemp(c, TYPE_REAL);
+            emit(c, OP_I2R, reg, operand, 0);
+            return reg;
+        }
+        case NODE_UNARY: {
+            AstNode *operand_node = node->as.unary.operand;
+            if (node->as.unary.op == TOKEN_PLUS) {
+                return compileExpression(c, operand_node, dst);
+            }
+            int operand = compileExpression(c, operand_node, -1);
+            int reg = dst >= 0 ? dst : allocTemp(c, node->type);
+            OpCode op = node->as.unary.op == TOKEN_NOT ? OP_NOT
+                      : node->type == TYPE_REAL ? OP_NEG_R : OP_NEG_I;
+            emit(c, op, reg, operand, 0);
+            return reg;
+        }
+        case NODE_BINARY: {
+            int left = compileExpression(c, node->as.binary.left, -1);
+            int right = compileExpression(c, node->as.binary.right, -1);
+            int reg = dst >= 0 ? dst : allocTemp(c, node->type);
+            emitABC(c, binaryOpcode(node->as.binary.op, node->as.binary.left->type), reg, left, right);
+            return reg;
+        }
+        default:
+            c->failed = true;
+            return 0;
+    }
+}
+
+// Atribui o resultado de value à variável representada por symbol
+static void compileStore(Compiler *c, const Symbol *symbol, AstNode *value) {
+    if (isGlobal(symbol)) {
+        int reg = compileExpression(c, value, -1);
+        emit(c, OP_STOREG, reg, -1, symbol->index);
+    } else {
+        compileExpression(c, value, symbol->index);
+    }
+}
+
+static void compileStatement(Compiler *c, AstNode *node);
+
+static void compileFor(Compiler *c, AstNode *node) {
+    const Symbol *var = node->as.for_stmt.var->as.variable.symbol;
+    bool downto = node->as.for_stmt.downto;
+
+    // O limite é avaliado uma única vez e precisa sobreviver ao corpo
+    int limit = newRegister(c, TYPE_INTEGER);
+    compileExpression(c, node->as.for_stmt.end, limit);
+    compileStore(c, var, node->as.for_stmt.start);
+
+    int counter = isGlobal(var) ? allocTemp(c, TYPE_INTEGER) : var->index;
+    if (isGlobal(var)) emit(c, OP_LOADG, counter, -1, var->index);
+    int test = allocTemp(c, TYPE_BOOLEAN);
+    emitABC(c, downto ? OP_LT_I : OP_GT_I, test, counter, limit);
+    int skip = emit(c, OP_JMPT, test, -1, 0);
+
+    int loop = c->function->count;
+    compileStatement(c, node->as.for_stmt.body);
+
+    c->line = node->line;
+    c->column = node->column;
+    resetTemps(c);
+    counter = isGlobal(var) ? allocTemp(c, TYPE_INTEGER) : var->index;
+    if (isGlobal(var)) emit(c, OP_LOADG, counter, -1, var->index);
+    test = allocTemp(c, TYPE_BOOLEAN);
+    emitABC(c, OP_EQ_I, test, counter, limit);
+    int done = emit(c, OP_JMPT, test, -1, 0);
+    int one = allocTemp(c, TYPE_INTEGER);
+    emit(c, OP_LOADI, one, -1, 1);
+    emitABC(c, downto ? OP_SUB_I : OP_ADD_I, counter, counter, one);
+    if (isGlobal(var)) emit(c, OP_STOREG, counter, -1, var->index);
+    emit(c, OP_JMP, 0, -1, loop);
+
+    patchJump(c, skip, c->function->count);
+    patchJump(c, done, c->function->count);
+}
+
+static void compileStatement(Compiler *c, AstNode *node) {
+    c->line = node->line;
+    c->column = node->column;
+    resetTemps(c);
+
+    switch (node->kind) {
+        case NODE_BLOCK:
+            for (AstNode *stmt = node->as.block.statements; stmt; stmt = stmt->next) {
+                compileStatement(c, stmt);
+            }
+            break;
+        case NODE_ASSIGN:
+            if (node->as.assign.target->kind == NODE_INDEX) {
+                storeElement(c, node->as.assign.target, compileExpression(c, node->as.assign.value, -1));
+            } else {
+                compileStore(c, node->as.assign.target->as.variable.symbol, node->as.assign.value);
+            }
+            break;
+        case NODE_IF: {
+            int cond = compileExpression(c, node->as.if_stmt.cond, -1);
+            int jump_else = emit(c, OP_JMPF, cond, -1, 0);
+            compileStatement(c, node->as.if_stmt.then_branch);
+            if (node->as.if_stmt.else_branch) {
+                int jump_end = emit(c, OP_JMP, 0, -1, 0);
+                patchJump(c, jump_else, c->function->count);
+                compileStatement(c, node->as.if_stmt.else_branch);
+                patchJump(c, jump_end, c->function->count);
+            } else {
+                patchJump(c, jump_else, c->function->count);
+            }
+            break;
+        }
+        case NODE_WHILE: {
+            int loop = c->function->count;
+            int cond = compileExpression(c, node->as.while_stmt.cond, -1);
+            int exit_jump = emit(c, OP_JMPF, cond, -1, 0);
+            compileStatement(c, node->as.while_stmt.body);
+            emit(c, OP_JMP, 0, -1, loop);
+            patchJump(c, exit_jump, c->function->count);
+            break;
+        }
+        case NODE_FOR:
+            compileFor(c, node);
+            break;
+        case NODE_CALL: {
+            int count = 0;
+            for (AstNode *arg = node->as.call.args; arg; arg = arg->next) count++;
+            if (count > MAX_ARGS) {
+                fprintf(stderr, "Erro: chamada de %s com %d argumentos excede o limite de %d\n",
+                        node->as.call.name, count, MAX_ARGS);
+                c->failed = true;
+                break;
+            }
+            for (AstNode *arg = node->as.call.args; arg; arg = arg->next) {
+                emit(c, OP_ARG, compileExpression(c, arg, -1), -1, 0);
+            }
+            emit(c, OP_CALL, 0, -1, node->as.call.symbol->index);
+            break;
+        }
+        case NODE_WRITE:
+            for (AstNode *arg = node->as.write.args; arg; arg = arg->next) {
+                if (arg->kind == NODE_STRING_LITERAL) {
+                    emit(c, OP_WRITE_S, 0, -1, addString(c, arg->as.string_value));
+                    continue;
+                }
+                int reg = compileExpression(c, arg, -1);
+                OpCode op = arg->type == TYPE_REAL ? OP_WRITE_R
+                          : arg->type == TYPE_BOOLEAN ? OP_WRITE_B : OP_WRITE_I;
+                emit(c, op, reg, -1, 0);
+            }
+            if (node->as.write.newline) emit(c, OP_WRITELN, 0, -1, 0);
+            break;
+        case NODE_READ:
+            for (AstNode *target = node->as.read.targets; target; target = target->next) {
+                if (target->kind == NODE_INDEX) {
+                    int reg = allocTemp(c, target->type);
+                    emit(c, target->type == TYPE_REAL ? OP_READ_R : OP_READ_I, reg, -1, 0);
+                    storeElement(c, target, reg);
+                    continue;
+                }
+                const Symbol *symbol = target->as.variable.symbol;
+                int reg = isGlobal(symbol) ? allocTemp(c, symbol->type) : symbol->index;
+                emit(c, symbol->type == TYPE_REAL ? OP_READ_R : OP_READ_I, reg, -1, 0);
+                if (isGlobal(symbol)) emit(c, OP_STOREG, reg, -1, symbol->index);
+            }
+            break;
+        default:
+            c->failed = true;
+            break;
+    }
+}
+
+static void initFunction(Function *f, const char *name) {
+    memset(f, 0, sizeof(*f));
+    f->name = strdup(name ? name : "main");
+}
+
+static bool compileFunction(Compiler *c, Function *f, AstNode *body, SymbolTable *locals, int param_count) {
+    c->function = f;
+    c->int_temp_count = c->real_temp_count = 0;
+    resetTemps(c);
+    f->param_count = param_count;
+
+    // Parâmetros e variáveis locais ocupam os primeiros registradores
+    if (locals) {
+        f->register_count = locals->variable_count;
+        f->register_types = calloc(locals->variable_count + 1, 1);
+        for (Symbol *s = locals->head; s; s = s->next) {
+            f->register_types[s->index] = (uint8_t)s->type;
+        }
+    }
+
+    if (body) compileStatement(c, body);
+    c->line = 0;
+    c->column = 0;
+    emit(c, locals ? OP_RET : OP_HALT, 0, -1, 0);
+    return !c->failed;
+}
+
+int arrayLayout(const SymbolTable *globals, ArrayInfo *arrays) {
+    for (const Symbol *s = globals->head; s; s = s->next) {
+        if (s->type != TYPE_ARRAY) continue;
+        arrays[s->index].type = (uint8_t)s->element_type;
+        arrays[s->index].low = s->low;
+        arrays[s->index].length = (int32_t)((int64_t)s->high - s->low + 1);
+    }
+    int slots = 0;
+    for (int i = 0; i < globals->array_count; i++) {
+        arrays[i].offset = slots;
+        slots += arrays[i].length;
+    }
+    return slots;
+}
+
+bool compileProgram(AstNode *program, SymbolTable *globals, BytecodeProgram *out) {
+    memset(out, 0, sizeof(*out));
+    Compiler c;
+    memset(&c, 0, sizeof(c));
+    c.program = out;
+
+    out->global_count = globals->variable_count;
+    out->global_types = calloc(globals->variable_count + 1, 1);
+    globalTypes(globals, out->global_types);
+    out->array_count = globals->array_count;
+    out->arrays = calloc(globals->array_count + 1, sizeof(ArrayInfo));
+    out->array_slots = arrayLayout(globals, out->arrays);
+
+    out->function_count = globals->procedure_count + 1;
+    out->main_function = globals->procedure_count;
+    out->functions = calloc(out->function_count, sizeof(Function));
+
+    for (AstNode *proc = program->as.program.procedures; proc; proc = proc->next) {
+        Symbol *symbol = proc->as.procedure.symbol;
+        Function *f = &out->functions[symbol->index];
+        initFunction(f, proc->as.procedure.name);
+        compileFunction(&c, f, proc->as.procedure.body, proc->as.procedure.locals, symbol->param_count);
+    }
+
+    Function *main_function = &out->functions[out->main_function];
+    initFunction(main_function, program->as.program.name);
+    compileFunction(&c, main_function, program->as.program.body, NULL, 0);
+
+    free(c.int_temps);
+    free(c.real_temps);
+    return !c.failed;
+}
+
+void freeBytecode(BytecodeProgram *program) {
+    for (int i = 0; i < program->function_count; i++) {
+        Function *f = &program->functions[i];
+        free(f->name);
+        free(f->code);
+        free(f->lines);
+        free(f->columns);
+        free(f->register_types);
+    }
+    for (int i = 0; i < program->string_count; i++) {
+        free(program->strings[i]);
+    }
+    free(program->functions);
+    free(program->constants);
+    free(program->strings);
+    free(program->global_types);
+    free(program->arrays);
+    for (int i = 0; i < program->kernel_count; i++) {
+        free(program->kernels[i].ops);
+    }
+    free(program->kernels);
+    memset(program, 0, sizeof(*program));
+}
+
+const char *opcodeName(OpCode op) {
+    static const char *names[] = {
+#define X(name) #name,
+        OPCODES(X)
+#undef X
+    };
+    return op < OP_COUNT ? names[op] : "?";
+}
+
+int opcodeOperands(OpCode op) {
+    switch (op) {
+        case OP_MOV: case OP_NEG_I: case OP_NEG_R: case OP_NOT: case OP_I2R:
+            return OPERAND_DEF_A | OPERAND_USE_B;
+        case OP_ADD_I: case OP_SUB_I: case OP_MUL_I: case OP_DIV_I: case OP_MOD_I:
+        case OP_ADD_R: case OP_SUB_R: case OP_MUL_R: case OP_DIV_R:
+        case OP_EQ_I: case OP_NE_I: case OP_LT_I: case OP_LE_I: case OP_GT_I: case OP_GE_I:
+        case OP_EQ_R: case OP_NE_R: case OP_LT_R: case OP_LE_R: case OP_GT_R: case OP_GE_R:
+        case OP_AND: case OP_OR:
+            return OPERAND_DEF_A | OPERAND_USE_B | OPERAND_USE_C;
+        case OP_LOADX:
+            return OPERAND_DEF_A | OPERAND_USE_B | OPERAND_ARRAY_C;
+        case OP_STOREX:
+            return OPERAND_USE_A | OPERAND_USE_B | OPERAND_ARRAY_C;
+        case OP_LOADI: case OP_LOADK: case OP_LOADG: case OP_READ_I: case OP_READ_R: case OP_VLOOP:
+            return OPERAND_DEF_A;
+        case OP_STOREG: case OP_ARG: case OP_WRITE_I: case OP_WRITE_R: case OP_WRITE_B:
+            return OPERAND_USE_A;
+        case OP_JMPF: case OP_JMPT:
+            return OPERAND_USE_A | OPERAND_JUMP;
+        case OP_JMP:
+            return OPERAND_JUMP;
+        default:
+            return 0;
+    }
+}
+
+void disassembleProgram(const BytecodeProgram *program, FILE *out) {
+    for (int i = 0; i < program->function_count; i++) {
+        const Function *f = &program->functions[i];
+        fprintf(out, "function %d %s (params %d, registers %d)\n", i, f->name, f->param_count, f->register_count);
+        for (int pc = 0; pc < f->count; pc++) {
+            const Instruction *ins = &f->code[pc];
+            fprintf(out, "  %4d  [line %3d]  %-8s", pc, f->lines[pc], opcodeName(ins->op));
+            switch (ins->op) {
+                case OP_LOADI: case OP_LOADG: case OP_STOREG: case OP_JMPF: case OP_JMPT:
+                    fprintf(out, " r%d, %d", ins->a, ins->k);
+                    break;
+                case OP_LOADK:
+                    fprintf(out, " r%d, k%d", ins->a, ins->k);
+                    break;
+                case OP_LOADX: case OP_STOREX:
+                    fprintf(out, " r%d, r%d, a%d", ins->a, ins->b, ins->c);
+                    break;
+                case OP_VLOOP:
+                    fprintf(out, " r%d, v%d", ins->a, ins->k);
+                    break;
+                case OP_JMP: case OP_CALL: case OP_WRITE_S: case OP_PROFILE:
+                    fprintf(out, " %d", ins->k);
+                    break;
+                case OP_MOV: case OP_NEG_I: case OP_NEG_R: case OP_NOT: case OP_I2R:
+                    fprintf(out, " r%d, r%d", ins->a, ins->b);
+                    break;
+                case OP_ARG: case OP_WRITE_I: case OP_WRITE_R: case OP_WRITE_B:
+                case OP_READ_I: case OP_READ_R:
+                    fprintf(out, " r%d", ins->a);
+                    break;
+                case OP_NOP: case OP_RET: case OP_WRITELN: case OP_HALT:
+                    break;
+                default:
+                    fprintf(out, " r%d, r%d, r%d", ins->a, ins->b, ins->c);
+                    break;
+            }
+            fputc('\n', out);
+        }
+    }
+    for (int i = 0; i < program->kernel_count; i++) {
+        const Kernel *kernel = &program->kernels[i];
+        fprintf(out, "kernel v%d (inputs %d", i, kernel->input_count);
+        if (kernel->reduction >= 0) fprintf(out, ", %s e%d", opcodeName(kernel->reduction_op), kernel->reduction);
+        fprintf(out, ")\n");
+        for (int n = 0; n < kernel->op_count; n++) {
+            const KernelOp *op = &kernel->ops[n];
+            fprintf(out, "  e%-3d %-8s", n, opcodeName(op->op));
+            switch (op->op) {
+                case OP_LOADX: fprintf(out, " [%d]", op->k); break;
+                case OP_STOREX: fprintf(out, " [%d], e%d", op->k, op->a); break;
+                case OP_ARG: fprintf(out, " %d", op->k); break;
+                case OP_NEG_I: fprintf(out, " e%d", op->a); break;
+                default: fprintf(out, " e%d, e%d", op->a, op->b); break;
+            }
+            fputc('\n', out);
+        }
+    }
+}
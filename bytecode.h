@@ -0,0 +1,148 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ast.h"
+#include "symbol_table.h"
+
+// Conjunto de instruções da máquina virtual de registradores.
+// Convenções de operandos (R = registrador do quadro atual, k = imediato):
+//   MOV a b           R[a] = R[b]
+//   LOADI a k         R[a] = k (inteiro de 32 bits)
+//   LOADK a k         R[a] = constants[k]
+//   LOADG a k         R[a] = globals[k]
+//   STOREG a k        globals[k] = R[a]
+//   LOADX a b c       R[a] = elemento R[b] do array c (erro fora dos limites)
+//   STOREX a b c      elemento R[b] do array c = R[a]
+//   VLOOP a k         executa kernels[k] sobre os argumentos empilhados; R[a] = redução
+//   ADD_I..GE_R a b c R[a] = R[b] op R[c]
+//   NEG_I, NEG_R, NOT, I2R a b   R[a] = op R[b]
+//   JMP k             desvia para a instrução k
+//   JMPF/JMPT a k     desvia para k se R[a] for falso/verdadeiro
+//   ARG a             empilha R[a] como argumento da próxima chamada
+//   CALL k            chama a função k com os argumentos empilhados
+//   WRITE_I/R/B a     escreve R[a]; WRITE_S k escreve strings[k]
+//   READ_I/R a        lê um valor para R[a]
+//   PROFILE k         soma 1 ao contador de perfil k (-fprofile-generate)
+#define OPCODES(X) \
+    X(NOP) X(MOV) X(LOADI) X(LOADK) X(LOADG) X(STOREG) \
+    X(LOADX) X(STOREX) \
+    X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(MOD_I) X(NEG_I) \
+    X(ADD_R) X(SUB_R) X(MUL_R) X(DIV_R) X(NEG_R) X(I2R) \
+    X(EQ_I) X(NE_I) X(LT_I) X(LE_I) X(GT_I) X(GE_I) \
+    X(EQ_R) X(NE_R) X(LT_R) X(LE_R) X(GT_R) X(GE_R) \
+    X(AND) X(OR) X(NOT) \
+    X(JMP) X(JMPF) X(JMPT) X(ARG) X(CALL) X(RET) \
+    X(WRITE_I) X(WRITE_R) X(WRITE_B) X(WRITE_S) X(WRITELN) \
+    X(READ_I) X(READ_R) X(PROFILE) X(VLOOP) X(HALT)
+
+typedef enum {
+#define X(name) OP_##name,
+    OPCODES(X)
+#undef X
+    OP_COUNT
+} OpCode;
+
+#define MAX_REGISTERS 65535
+// Argumentos de uma chamada: a VM os junta num vetor de tamanho fixo antes do CALL
+#define MAX_ARGS MAX_PARAMS
+
+// Instrução de 8 bytes: três registradores ou um registrador e um imediato
+typedef struct {
+    uint8_t op;
+    uint16_t a;
+    union {
+        struct { uint16_t b; uint16_t c; };
+        int32_t k;
+    };
+} Instruction;
+
+// Registradores tipados: inteiros e booleanos usam i, reais usam r
+typedef union {
+    int64_t i;
+    double r;
+} Value;
+
+typedef struct {
+    char *name;
+    Instruction *code;
+    int *lines;               // Linha do código-fonte de cada instrução
+    int *columns;             // Coluna do statement de origem (0 se desconhecida)
+    int count;
+    int capacity;
+    int register_count;
+    int param_count;
+    uint8_t *register_types;  // DataType de cada registrador
+} Function;
+
+// Array do programa: length elementos a partir de offset na área dos arrays, que fica
+// separada das globais; o elemento low ocupa a primeira posição
+typedef struct {
+    uint8_t type;             // DataType dos elementos
+    int32_t low;
+    int32_t length;
+    int32_t offset;
+} ArrayInfo;
+
+// Laço elemento a elemento (VLOOP), gerado pela vetorização (ir_loop.c). Os argumentos
+// são start, count, o valor inicial da redução (se houver) e as entradas invariantes;
+// para j de 0 a count - 1 as operações são avaliadas em ordem e a operação n produz o
+// valor n. LOADX e STOREX acessam a posição k + start + j da área dos arrays, então os
+// back-ends podem processar vários j de uma vez
+#define KERNEL_MAX_OPS 12
+
+typedef struct {
+    uint8_t op;               // OP_LOADX, OP_STOREX, OP_ARG (entrada k) ou aritmética
+    uint8_t type;             // DataType do valor produzido
+    uint16_t a;               // Operandos: posições de operações anteriores
+    uint16_t b;
+    int32_t k;
+} KernelOp;
+
+typedef struct {
+    KernelOp *ops;
+    int op_count;
+    int input_count;
+    int reduction;            // Operação somada ao acumulador a cada j, -1 se nenhuma
+    uint8_t reduction_op;     // OP_ADD_I, OP_SUB_I, OP_ADD_R ou OP_SUB_R
+} Kernel;
+
+typedef struct {
+    Function *functions;      // Procedimentos na ordem de declaração e, por último, o bloco principal
+    int function_count;
+    int main_function;
+    Value *constants;
+    int constant_count;
+    char **strings;
+    int string_count;
+    int global_count;
+    uint8_t *global_types;
+    int counter_count;        // Contadores usados por PROFILE
+    ArrayInfo *arrays;
+    int array_count;
+    int array_slots;          // Tamanho da área dos arrays, em Values
+    Kernel *kernels;
+    int kernel_count;
+} BytecodeProgram;
+
+// Papel dos campos de cada opcode, usado pelas análises sobre o bytecode
+enum {
+    OPERAND_DEF_A = 1,    // Escreve R[a]
+    OPERAND_USE_A = 2,    // Lê R[a]
+    OPERAND_USE_B = 4,    // Lê R[b]
+    OPERAND_USE_C = 8,    // Lê R[c]
+    OPERAND_JUMP = 16,    // k é o destino de um desvio
+    OPERAND_ARRAY_C = 32  // c é o número de um array
+};
+
+// Distribui os arrays de globals na área dos arrays; devolve o tamanho da área
+int arrayLayout(const SymbolTable *globals, ArrayInfo *arrays);
+bool compileProgram(AstNode *program, SymbolTable *globals, BytecodeProgram *out);
+void freeBytecode(BytecodeProgram *program);
+const char *opcodeName(OpCode op);
+int opcodeOperands(OpCode op);
+void disassembleProgram(const BytecodeProgram *program, FILE *out);
+
+#endif
@@ -0,0 +1,447 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "codegen_c.h"
+
+// Tradução direta da árvore para C: cada procedimento vira uma função static, as
+// globais viram variáveis static e as expressões mantêm a forma do fonte. Nomes
+// recebem prefixo (v_ para variáveis, p_ para procedimentos) para não colidir com
+// palavras reservadas de C nem com a biblioteca de execução.
+
+typedef struct {
+    FILE *out;
+    int depth;        // Nível de indentação
+    int limit_count;  // Limites de laços for já declarados na função
+    bool failed;
+} CGen;
+
+static const char *cType(DataType type) {
+    switch (type) {
+        case TYPE_REAL: return "double";
+        case TYPE_BOOLEAN: return "bool";
+        default: return "int64_t";
+    }
+}
+
+static void indent(CGen *g) {
+    for (int i = 0; i < g->depth; i++) fputs("    ", g->out);
+}
+
+static void writeInteger(FILE *out, long long value) {
+    // -9223372036854775808 seria a negação de uma constante que não cabe em int64_t
+    if (value == INT64_MIN) fputs("INT64_MIN", out);
+    else if (value >= INT32_MIN && value <= INT32_MAX) fprintf(out, "%lld", value);
+    else fprintf(out, "INT64_C(%lld)", value);
+}
+
+// Menor representação decimal que volta exatamente ao mesmo double
+static void writeReal(FILE *out, double value) {
+    if (isinf(value)) {
+        fputs(value > 0 ? "HUGE_VAL" : "-HUGE_VAL", out);
+        return;
+    }
+    char text[64];
+    for (int precision = 15; precision <= 17; precision++) {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, NULL) == value) break;
+    }
+    fputs(text, out);
+    if (!strpbrk(text, ".eE")) fputs(".0", out);
+}
+
+static void writeString(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\' || *c == '?') fprintf(out, "\\%c", *c);
+        else if (*c == '\n') fputs("\\n", out);
+        else if (*c < 0x20 || *c == 0x7f) fprintf(out, "\\%03o", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+static const char *integerHelper(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "pas_add";
+        case TOKEN_MINUS: return "pas_sub";
+        case TOKEN_MULTIPLY: return "pas_mul";
+        case TOKEN_DIV: return "pas_div";
+        case TOKEN_MOD: return "pas_mod";
+        default: return NULL;
+    }
+}
+
+static const char *infixOperator(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "+";
+        case TOKEN_MINUS: return "-";
+        case TOKEN_MULTIPLY: return "*";
+        case TOKEN_DIVIDE: return "/";
+        // Sem curto-circuito: os dois lados são avaliados, como no bytecode
+        case TOKEN_AND: return "&";
+        case TOKEN_OR: return "|";
+        case TOKEN_EQ: return "==";
+        case TOKEN_NEQ: return "!=";
+        case TOKEN_LT: return "<";
+        case TOKEN_LTE: return "<=";
+        case TOKEN_GT: return ">";
+        case TOKEN_GTE: return ">=";
+        default: return NULL;
+    }
+}
+
+static void generateExpression(CGen *g, const AstNode *node, bool nested);
+
+// Elemento de array; pas_index confere os limites e devolve a posição a partir de zero
+static void generateElement(CGen *g, const AstNode *node) {
+    const Symbol *array = node->as.element.array->as.variable.symbol;
+    fprintf(g->out, "v_%s[pas_index(", array->name);
+    generateExpression(g, node->as.element.index, false);
+    fprintf(g->out, ", %d, %lld)]", array->low, (long long)array->high - array->low + 1);
+}
+
+// nested: a expressão é operando de outra e operadores infixos ganham parênteses
+static void generateExpression(CGen *g, const AstNode *node, bool nested) {
+    FILE *out = g->out;
+    switch (node->kind) {
+        case NODE_INT_LITERAL:
+            writeInteger(out, node->as.int_value);
+            break;
+        case NODE_BOOL_LITERAL:
+            fputs(node->as.bool_value ? "true" : "false", out);
+            break;
+        case NODE_REAL_LITERAL:
+            writeReal(out, node->as.real_value);
+            break;
+        case NODE_VARIABLE:
+            fprintf(out, "v_%s", node->as.variable.symbol->name);
+            break;
+        case NODE_INDEX:
+            generateElement(g, node);
+            break;
+        case NODE_WIDEN:
+            fputs("(double)", out);
+            generateExpression(g, node->as.unary.operand, true);
+            break;
+        case NODE_UNARY: {
+            const AstNode *operand = node->as.unary.operand;
+            if (node->as.unary.op == TOKEN_PLUS) {
+                generateExpression(g, operand, nested);
+            } else if (node->as.unary.op == TOKEN_NOT) {
+                fputc('!', out);
+                generateExpression(g, operand, true);
+            } else if (node->type == TYPE_REAL) {
+                // Parênteses em volta de outro unário: "--x" seria um decremento em C
+                bool wrap = operand->kind == NODE_UNARY;
+                fputs(wrap ? "-(" : "-", out);
+                generateExpression(g, operand, !wrap);
+                if (wrap) fputc(')', out);
+            } else {
+                fputs("pas_neg(", out);
+                generateExpression(g, operand, false);
+                fputc(')', out);
+            }
+            break;
+        }
+        case NODE_BINARY: {
+            TokenType op = node->as.binary.op;
+            const char *helper = node->as.binary.left->type == TYPE_REAL ? NULL : integerHelper(op);
+            if (helper) {
+                fprintf(out, "%s(", helper);
+                generateExpression(g, node->as.binary.left, false);
+                fputs(", ", out);
+                generateExpression(g, node->as.binary.right, false);
+                fputc(')', out);
+                break;
+            }
+            const char *symbol = infixOperator(op);
+            if (!symbol) {
+                g->failed = true;
+                break;
+            }
+            if (nested) fputc('(', out);
+            generateExpression(g, node->as.binary.left, true);
+            fprintf(out, " %s ", symbol);
+            generateExpression(g, node->as.binary.right, true);
+            if (nested) fputc(')', out);
+            break;
+        }
+        default:
+            g->failed = true;
+            break;
+    }
+}
+
+static void generateStatement(CGen *g, const AstNode *node);
+
+// Corpo de if, while e for: um bloco é aberto em vez de ganhar chaves próprias
+static void generateBody(CGen *g, const AstNode *node) {
+    g->depth++;
+    generateStatement(g, node);
+    g->depth--;
+}
+
+static void generateIf(CGen *g, const AstNode *node) {
+    fputs("if (", g->out);
+    generateExpression(g, node->as.if_stmt.cond, false);
+    fputs(") {\n", g->out);
+    generateBody(g, node->as.if_stmt.then_branch);
+    const AstNode *else_branch = node->as.if_stmt.else_branch;
+    indent(g);
+    if (!else_branch) {
+        fputs("}\n", g->out);
+    } else if (else_branch->kind == NODE_IF) {
+        fputs("} else ", g->out);
+        generateIf(g, else_branch);
+    } else {
+        fputs("} else {\n", g->out);
+        generateBody(g, else_branch);
+        indent(g);
+        fputs("}\n", g->out);
+    }
+}
+
+// Mesma semântica do bytecode: o limite é avaliado uma vez, antes da atribuição
+// inicial, e o laço termina quando o contador chega ao limite depois do corpo
+static void generateFor(CGen *g, const AstNode *node) {
+    const char *name = node->as.for_stmt.var->as.variable.symbol->name;
+    bool downto = node->as.for_stmt.downto;
+    int limit = ++g->limit_count;
+    fputs("{\n", g->out);
+    g->depth++;
+    indent(g);
+    fprintf(g->out, "const int64_t limit%d = ", limit);
+    generateExpression(g, node->as.for_stmt.end, false);
+    fputs(";\n", g->out);
+    indent(g);
+    fprintf(g->out, "v_%s = ", name);
+    generateExpression(g, node->as.for_stmt.start, false);
+    fputs(";\n", g->out);
+    indent(g);
+    fprintf(g->out, "if (v_%s %s limit%d) {\n", name, downto ? ">=" : "<=", limit);
+    g->depth++;
+    indent(g);
+    fputs("for (;;) {\n", g->out);
+    generateBody(g, node->as.for_stmt.body);
+    g->depth++;
+    indent(g);
+    fprintf(g->out, "if (v_%s == limit%d) break;\n", name, limit);
+    indent(g);
+    fprintf(g->out, "v_%s = %s(v_%s, 1);\n", name, downto ? "pas_sub" : "pas_add", name);
+    g->depth--;
+    indent(g);
+    fputs("}\n", g->out);
+    g->depth--;
+    indent(g);
+    fputs("}\n", g->out);
+    g->depth--;
+    indent(g);
+    fputs("}\n", g->out);
+}
+
+static void generateStatement(CGen *g, const AstNode *node) {
+    FILE *out = g->out;
+    if (node->kind == NODE_BLOCK) {
+        for (const AstNode *stmt = node->as.block.statements; stmt; stmt = stmt->next) {
+            generateStatement(g, stmt);
+        }
+        return;
+    }
+    if (node->kind != NODE_WRITE && node->kind != NODE_READ) indent(g);
+    switch (node->kind) {
+        case NODE_ASSIGN:
+            if (node->as.assign.target->kind == NODE_INDEX) {
+                // Como no bytecode, o valor é calculado antes do índice
+                fprintf(out, "{ const %s value = ", cType(node->as.assign.target->type));
+                generateExpression(g, node->as.assign.value, false);
+                fputs("; ", out);
+                generateElement(g, node->as.assign.target);
+                fputs(" = value; }\n", out);
+                break;
+            }
+            fprintf(out, "v_%s = ", node->as.assign.target->as.variable.symbol->name);
+            generateExpression(g, node->as.assign.value, false);
+            fputs(";\n", out);
+            break;
+        case NODE_IF:
+            generateIf(g, node);
+            break;
+        case NODE_WHILE:
+            fputs("while (", out);
+            generateExpression(g, node->as.while_stmt.cond, false);
+            fputs(") {\n", out);
+            generateBody(g, node->as.while_stmt.body);
+            indent(g);
+            fputs("}\n", out);
+            break;
+        case NODE_FOR:
+            generateFor(g, node);
+            break;
+        case NODE_CALL:
+            fprintf(out, "p_%s(", node->as.call.name);
+            for (const AstNode *arg = node->as.call.args; arg; arg = arg->next) {
+                generateExpression(g, arg, false);
+                if (arg->next) fputs(", ", out);
+            }
+            fputs(");\n", out);
+            break;
+        case NODE_WRITE:
+            for (const AstNode *arg = node->as.write.args; arg; arg = arg->next) {
+                indent(g);
+                if (arg->kind == NODE_STRING_LITERAL) {
+                    fputs("pas_write_string(", out);
+                    writeString(out, arg->as.string_value);
+                } else {
+                    fprintf(out, "pas_write_%s(", arg->type == TYPE_REAL ? "real"
+                                                : arg->type == TYPE_BOOLEAN ? "boolean" : "integer");
+                    generateExpression(g, arg, false);
+                }
+                fputs(");\n", out);
+            }
+            if (node->as.write.newline) {
+                indent(g);
+                fputs("pas_writeln();\n", out);
+            }
+            break;
+        case NODE_READ:
+            for (const AstNode *target = node->as.read.targets; target; target = target->next) {
+                indent(g);
+                if (target->kind == NODE_INDEX) {
+                    fprintf(out, "{ const %s value = pas_read_%s(); ", cType(target->type),
+                            target->type == TYPE_REAL ? "real" : "integer");
+                    generateElement(g, target);
+                    fputs(" = value; }\n", out);
+                    continue;
+                }
+                const Symbol *symbol = target->as.variable.symbol;
+                fprintf(out, "v_%s = pas_read_%s();\n", symbol->name, symbol->type == TYPE_REAL ? "real" : "integer");
+            }
+            break;
+        default:
+            g->failed = true;
+            break;
+    }
+}
+
+static void generateSignature(CGen *g, const AstNode *proc) {
+    fprintf(g->out, "static void p_%s(", proc->as.procedure.name);
+    const AstNode *param = proc->as.procedure.params;
+    if (!param) fputs("void", g->out);
+    for (; param; param = param->next) {
+        fprintf(g->out, "%s v_%s%s", cType(param->type), param->as.variable.name, param->next ? ", " : "");
+    }
+    fputc(')', g->out);
+}
+
+// Variáveis do escopo indexadas pela posição, que segue a ordem de declaração
+static const Symbol **variablesByIndex(const SymbolTable *table) {
+    const Symbol **order = calloc(table->variable_count + 1, sizeof(Symbol *));
+    if (!order) {
+        fprintf(stderr, "Erro de alocação de memória no back-end C\n");
+        exit(EXIT_FAILURE);
+    }
+    for (const Symbol *s = table->head; s; s = s->next) {
+        if (s->type != TYPE_PROCEDURE && s->type != TYPE_ARRAY && s->index >= 0 && s->index < table->variable_count) order[s->index] = s;
+    }
+    return order;
+}
+
+// Os parâmetros ocupam os primeiros índices; as demais variáveis começam zeradas
+static void generateLocals(CGen *g, const SymbolTable *locals, int param_count) {
+    const Symbol **order = variablesByIndex(locals);
+    for (int index = param_count; index < locals->variable_count; index++) {
+        const Symbol *s = order[index];
+        if (!s) continue;
+        indent(g);
+        fprintf(g->out, "%s v_%s = %s;\n", cType(s->type), s->name,
+                s->type == TYPE_REAL ? "0.0" : s->type == TYPE_BOOLEAN ? "false" : "0");
+    }
+    free(order);
+}
+
+static const char *preamble =
+    "#include <stdint.h>\n"
+    "#include <stdbool.h>\n"
+    "#include <math.h>\n"
+    "\n"
+    "// Biblioteca de execução (libpasrt)\n"
+    "void pas_write_integer(int64_t value);\n"
+    "void pas_write_real(double value);\n"
+    "void pas_write_boolean(int64_t value);\n"
+    "void pas_write_string(const char *text);\n"
+    "void pas_writeln(void);\n"
+    "int64_t pas_read_integer(void);\n"
+    "double pas_read_real(void);\n"
+    "_Noreturn void pas_runtime_error(const char *message);\n"
+    "\n"
+    "// Aritmética de integer com volta em caso de estouro, como na VM\n"
+    "static inline int64_t pas_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }\n"
+    "static inline int64_t pas_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }\n"
+    "static inline int64_t pas_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }\n"
+    "static inline int64_t pas_neg(int64_t a) { return (int64_t)(0 - (uint64_t)a); }\n"
+    "\n"
+    "static inline int64_t pas_div(int64_t a, int64_t b) {\n"
+    "    if (b == 0) pas_runtime_error(\"division by zero\");\n"
+    "    return b == -1 ? pas_neg(a) : a / b;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t pas_index(int64_t index, int64_t low, int64_t length) {\n"
+    "    if ((uint64_t)index - (uint64_t)low >= (uint64_t)length) pas_runtime_error(\"index out of range\");\n"
+    "    return index - low;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t pas_mod(int64_t a, int64_t b) {\n"
+    "    if (b == 0) pas_runtime_error(\"division by zero\");\n"
+    "    return b == -1 ? 0 : a % b;\n"
+    "}\n";
+
+bool generateC(const AstNode *program, const SymbolTable *globals, FILE *out) {
+    CGen g;
+    memset(&g, 0, sizeof(g));
+    g.out = out;
+
+    fprintf(out, "// Gerado a partir do programa Pascal %s\n", program->as.program.name);
+    fputs(preamble, out);
+
+    if (globals->variable_count > 0 || globals->array_count > 0) fputc('\n', out);
+    const Symbol **order = variablesByIndex(globals);
+    for (int index = 0; index < globals->variable_count; index++) {
+        if (order[index]) fprintf(out, "static %s v_%s;\n", cType(order[index]->type), order[index]->name);
+    }
+    free(order);
+    // Arrays só existem entre as globais do programa e começam zerados, como as demais
+    for (int index = 0; index < globals->array_count; index++) {
+        for (const Symbol *s = globals->head; s; s = s->next) {
+            if (s->type != TYPE_ARRAY || s->index != index) continue;
+            fprintf(out, "static %s v_%s[%lld];\n", cType(s->element_type), s->name, (long long)s->high - s->low + 1);
+        }
+    }
+
+    const AstNode *procedures = program->as.program.procedures;
+    if (procedures) fputc('\n', out);
+    for (const AstNode *proc = procedures; proc; proc = proc->next) {
+        generateSignature(&g, proc);
+        fputs(";\n", out);
+    }
+    for (const AstNode *proc = procedures; proc; proc = proc->next) {
+        fputc('\n', out);
+        generateSignature(&g, proc);
+        fputs(" {\n", out);
+        g.depth = 1;
+        g.limit_count = 0;
+        generateLocals(&g, proc->as.procedure.locals, proc->as.procedure.symbol->param_count);
+        if (proc->as.procedure.body) generateStatement(&g, proc->as.procedure.body);
+        fputs("}\n", out);
+    }
+
+    fputs("\nint main(void) {\n", out);
+    g.depth = 1;
+    g.limit_count = 0;
+    if (program->as.program.body) generateStatement(&g, program->as.program.body);
+    fputs("    return 0;\n}\n", out);
+
+    if (g.failed) fprintf(stderr, "Erro: construção sem tradução para C no programa %s\n", program->as.program.name);
+    return !g.failed;
+}
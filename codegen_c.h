@@ -0,0 +1,16 @@
+#ifndef CODEGEN_C_H
+#define CODEGEN_C_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "ast.h"
+#include "symbol_table.h"
+
+// Back-end que traduz a árvore verificada para C11 (--emit=c). integer vira int64_t,
+// real vira double e boolean vira bool; writeln e read chamam a biblioteca de
+// execução (libpasrt). A aritmética inteira volta em caso de estouro e div/mod por
+// zero geram o mesmo erro de execução da VM, então a saída não depende do
+// compilador C nem do nível de otimização.
+bool generateC(const AstNode *program, const SymbolTable *globals, FILE *out);
+
+#endif
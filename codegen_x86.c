@@ -0,0 +1,1211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "x86.h"
+#include "trace.h"
+
+const char *const x86RuntimeNames[RT_COUNT] = {
+    "pas_write_integer", "pas_write_real", "pas_write_boolean", "pas_write_string", "pas_writeln",
+    "pas_read_integer", "pas_read_real", "pas_runtime_error"
+};
+
+// Registradores alocáveis. Os preservados pelo chamado podem atravessar chamadas;
+// rax, rdx, r10, r11, xmm0 e xmm1 ficam reservados como rascunho.
+static const int callee_saved[] = {RBX, R12, R13, R14, R15};
+static const int caller_saved[] = {RCX, RSI, RDI, R8, R9};
+static const int int_arg_registers[] = {RDI, RSI, RDX, RCX, R8, R9};
+#define CALLEE_SAVED_COUNT 5
+#define CALLER_SAVED_COUNT 5
+#define FIRST_XMM 2
+#define XMM_COUNT 16
+#define MAX_INT_ARGS 6
+#define MAX_REAL_ARGS 8
+
+// Intervalo de vida de um registrador virtual, em posições de instrução do bytecode
+typedef struct {
+    int start;
+    int end;
+    bool crosses_call;
+} Interval;
+
+// Estado da geração de código de uma função
+typedef struct {
+    const BytecodeProgram *program;
+    const Function *function;
+    X86Program *x86;
+    X86Function *out;
+    Interval *intervals;
+    bool *condition_dies;     // Desvio condicional cujo registrador não é mais lido depois dele
+    X86Operand *homes;        // Local de cada registrador virtual: registrador ou [rbp - n]
+    int *labels;              // Rótulo de cada instrução alvo de desvio (-1 se nenhum)
+    bool used_callee_saved[16];
+    int saved_count;
+    int spill_count;
+    int max_args;
+    int param_base;           // Deslocamento da área onde os parâmetros recebidos são salvos
+    int epilogue_label;
+    int division_label;
+    int index_label;
+    bool avx2;                // VLOOP com registradores ymm
+    int pc;                   // Instrução de bytecode sendo traduzida; -1 fora delas
+    bool failed;
+} X86Gen;
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *grown = realloc(array, size);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static X86Operand reg(int r) {
+    return (X86Operand){.kind = OPER_REG, .reg = r};
+}
+
+static X86Operand xmm(int r) {
+    return (X86Operand){.kind = OPER_XMM, .reg = r};
+}
+
+static X86Operand imm(int64_t value) {
+    return (X86Operand){.kind = OPER_IMM, .imm = value};
+}
+
+static X86Operand mem(int base, int32_t disp) {
+    return (X86Operand){.kind = OPER_MEM, .reg = base, .disp = disp};
+}
+
+static X86Operand indexed(int base, int index, int scale, int32_t disp) {
+    return (X86Operand){.kind = OPER_MEM, .reg = base, .index = index, .scale = scale, .disp = disp};
+}
+
+static X86Operand rip(X86SymbolKind symbol, int index, int32_t disp) {
+    return (X86Operand){.kind = OPER_RIP, .symbol = symbol, .symbol_index = index, .disp = disp};
+}
+
+static X86Operand none(void) {
+    return (X86Operand){.kind = OPER_NONE};
+}
+
+static bool sameOperand(X86Operand a, X86Operand b) {
+    if (a.kind != b.kind) return false;
+    switch (a.kind) {
+        case OPER_REG:
+        case OPER_XMM: return a.reg == b.reg;
+        case OPER_MEM: return a.reg == b.reg && a.disp == b.disp && a.scale == b.scale && (!a.scale || a.index == b.index);
+        default: return false;
+    }
+}
+
+static bool isRegister(X86Operand o) {
+    return o.kind == OPER_REG || o.kind == OPER_XMM;
+}
+
+static X86Inst *emitInst(X86Gen *g, X86Op op) {
+    X86Function *f = g->out;
+    if (f->count == f->capacity) {
+        f->capacity = f->capacity ? f->capacity * 2 : 256;
+        f->code = checkedRealloc(f->code, sizeof(X86Inst) * f->capacity);
+    }
+    X86Inst *ins = &f->code[f->count++];
+    memset(ins, 0, sizeof(*ins));
+    ins->op = op;
+    ins->pc = g->pc;
+    return ins;
+}
+
+static void emit2(X86Gen *g, X86Op op, X86Operand dst, X86Operand src) {
+    X86Inst *ins = emitInst(g, op);
+    ins->dst = dst;
+    ins->src = src;
+}
+
+static void emit1(X86Gen *g, X86Op op, X86Operand dst) {
+    emit2(g, op, dst, none());
+}
+
+// Instrução SSE do VLOOP: VEX com -mavx2, e então ymm se wide
+static void emitVector(X86Gen *g, X86Op op, X86Operand dst, X86Operand src, bool wide) {
+    X86Inst *ins = emitInst(g, op);
+    ins->dst = dst;
+    ins->src = src;
+    ins->vex = g->avx2;
+    ins->wide = g->avx2 && wide;
+}
+
+static void emitJump(X86Gen *g, X86Op op, X86Cond cond, int label) {
+    X86Inst *ins = emitInst(g, op);
+    ins->cond = cond;
+    ins->target = label;
+}
+
+static void emitLabel(X86Gen *g, int label) {
+    emitInst(g, X86_LABEL)->target = label;
+}
+
+static void emitSetcc(X86Gen *g, X86Cond cond, int r) {
+    X86Inst *ins = emitInst(g, X86_SETCC);
+    ins->cond = cond;
+    ins->dst = reg(r);
+    emit2(g, X86_MOVZXB, reg(r), reg(r));
+}
+
+static void emitCall(X86Gen *g, X86SymbolKind kind, int target) {
+    X86Inst *ins = emitInst(g, X86_CALL);
+    ins->call_kind = kind;
+    ins->target = target;
+}
+
+static int newLabel(X86Gen *g) {
+    return g->out->label_count++;
+}
+
+// Cópia entre dois locais quaisquer; memória para memória passa por rax/xmm0
+static void emitMove(X86Gen *g, X86Operand dst, X86Operand src, bool real) {
+    if (sameOperand(dst, src)) return;
+    X86Op op = real ? X86_MOVSD : X86_MOV;
+    if (!isRegister(dst) && !isRegister(src) && !(src.kind == OPER_IMM && !real)) {
+        X86Operand scratch = real ? xmm(0) : reg(RAX);
+        emit2(g, op, scratch, src);
+        src = scratch;
+    }
+    emit2(g, op, dst, src);
+}
+
+static X86Operand home(X86Gen *g, int v) {
+    return g->homes[v];
+}
+
+static bool isReal(const X86Gen *g, int v) {
+    return g->function->register_types[v] == TYPE_REAL;
+}
+
+// ---------------------------------------------------------------------------
+// Análise de vida
+
+static bool isCallPoint(OpCode op) {
+    switch (op) {
+        case OP_CALL: case OP_WRITE_I: case OP_WRITE_R: case OP_WRITE_B: case OP_WRITE_S:
+        case OP_WRITELN: case OP_READ_I: case OP_READ_R:
+        case OP_VLOOP:        // Usa todos os registradores SSE
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Registradores lidos pela instrução; retorna quantos
+static int instructionUses(const Instruction *ins, int uses[2]) {
+    int operands = opcodeOperands((OpCode)ins->op);
+    int count = 0;
+    if (operands & OPERAND_USE_A) uses[count++] = ins->a;
+    if (operands & OPERAND_USE_B) uses[count++] = ins->b;
+    if (operands & OPERAND_USE_C) uses[count++] = ins->c;
+    return count;
+}
+
+// Registrador escrito pela instrução, ou -1
+static int instructionDef(const Instruction *ins) {
+    return opcodeOperands((OpCode)ins->op) & OPERAND_DEF_A ? ins->a : -1;
+}
+
+static bool endsBlock(OpCode op) {
+    return op == OP_JMP || op == OP_JMPF || op == OP_JMPT || op == OP_RET || op == OP_HALT;
+}
+
+typedef uint64_t Word;
+#define WORD_BITS 64
+#define BIT_TEST(set, i) (((set)[(i) / WORD_BITS] >> ((i) % WORD_BITS)) & 1)
+#define BIT_SET(set, i) ((set)[(i) / WORD_BITS] |= (Word)1 << ((i) % WORD_BITS))
+
+// Calcula os intervalos de vida (envoltória de todas as posições em que cada
+// registrador está vivo) por análise de fluxo de dados sobre os blocos básicos
+static void computeIntervals(X86Gen *g, bool *live_at_entry) {
+    const Function *f = g->function;
+    int n = f->count;
+    int regs = f->register_count;
+    int words = (regs + WORD_BITS - 1) / WORD_BITS + 1;
+
+    bool *leader = calloc(n + 1, sizeof(bool));
+    int *block_of = malloc(sizeof(int) * (n + 1));
+    if (!leader || !block_of) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    leader[0] = true;
+    for (int i = 0; i < n; i++) {
+        const Instruction *ins = &f->code[i];
+        if (ins->op == OP_JMP || ins->op == OP_JMPF || ins->op == OP_JMPT) leader[ins->k] = true;
+        if (endsBlock((OpCode)ins->op)) leader[i + 1] = true;
+    }
+
+    int block_count = 0;
+    for (int i = 0; i < n; i++) {
+        if (leader[i]) block_count++;
+        block_of[i] = block_count - 1;
+    }
+    int *block_start = malloc(sizeof(int) * (block_count + 1));
+    Word *sets = calloc((size_t)block_count * 4 * words, sizeof(Word));
+    if (!block_start || !sets) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0, b = 0; i < n; i++) {
+        if (leader[i]) block_start[b++] = i;
+    }
+    block_start[block_count] = n;
+
+#define USE(b) (sets + ((size_t)(b) * 4 + 0) * words)
+#define DEF(b) (sets + ((size_t)(b) * 4 + 1) * words)
+#define IN(b) (sets + ((size_t)(b) * 4 + 2) * words)
+#define OUT(b) (sets + ((size_t)(b) * 4 + 3) * words)
+
+    for (int b = 0; b < block_count; b++) {
+        for (int i = block_start[b]; i < block_start[b + 1]; i++) {
+            int uses[2];
+            int use_count = instructionUses(&f->code[i], uses);
+            for (int u = 0; u < use_count; u++) {
+                if (!BIT_TEST(DEF(b), uses[u])) BIT_SET(USE(b), uses[u]);
+            }
+            int def = instructionDef(&f->code[i]);
+            if (def >= 0) BIT_SET(DEF(b), def);
+        }
+    }
+
+    // Iteração até o ponto fixo, de trás para frente
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = block_count - 1; b >= 0; b--) {
+            const Instruction *last = &f->code[block_start[b + 1] - 1];
+            int successors[2];
+            int successor_count = 0;
+            if (last->op == OP_JMP) {
+                successors[successor_count++] = block_of[last->k];
+            } else if (last->op == OP_JMPF || last->op == OP_JMPT) {
+                successors[successor_count++] = block_of[last->k];
+                if (b + 1 < block_count) successors[successor_count++] = b + 1;
+            } else if (last->op != OP_RET && last->op != OP_HALT && b + 1 < block_count) {
+                successors[successor_count++] = b + 1;
+            }
+            for (int s = 0; s < successor_count; s++) {
+                Word *in = IN(successors[s]);
+                for (int w = 0; w < words; w++) OUT(b)[w] |= in[w];
+            }
+            for (int w = 0; w < words; w++) {
+                Word in = USE(b)[w] | (OUT(b)[w] & ~DEF(b)[w]);
+                if (in != IN(b)[w]) {
+                    IN(b)[w] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Vida exata dentro de cada bloco, de trás para frente, para marcar os desvios
+    // que consomem a última leitura de uma comparação
+    Word *live = malloc(sizeof(Word) * words);
+    if (!live) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int b = 0; b < block_count; b++) {
+        memcpy(live, OUT(b), sizeof(Word) * words);
+        for (int i = block_start[b + 1] - 1; i >= block_start[b]; i--) {
+            const Instruction *ins = &f->code[i];
+            g->condition_dies[i] = (ins->op == OP_JMPF || ins->op == OP_JMPT) && !BIT_TEST(live, ins->a);
+            int def = instructionDef(ins);
+            if (def >= 0) live[def / WORD_BITS] &= ~((Word)1 << (def % WORD_BITS));
+            int uses[2];
+            int use_count = instructionUses(ins, uses);
+            for (int u = 0; u < use_count; u++) BIT_SET(live, uses[u]);
+        }
+    }
+    free(live);
+
+    for (int v = 0; v < regs; v++) {
+        g->intervals[v] = (Interval){INT_MAX, -1, false};
+        live_at_entry[v] = block_count > 0 && BIT_TEST(IN(0), v);
+    }
+    for (int v = 0; v < f->param_count; v++) {
+        g->intervals[v].start = 0;
+    }
+    for (int b = 0; b < block_count; b++) {
+        for (int v = 0; v < regs; v++) {
+            if (BIT_TEST(IN(b), v) && block_start[b] < g->intervals[v].start) g->intervals[v].start = block_start[b];
+            if (BIT_TEST(OUT(b), v) && block_start[b + 1] - 1 > g->intervals[v].end) g->intervals[v].end = block_start[b + 1] - 1;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        int uses[3];
+        int count = instructionUses(&f->code[i], uses);
+        int def = instructionDef(&f->code[i]);
+        if (def >= 0) uses[count++] = def;
+        for (int u = 0; u < count; u++) {
+            Interval *interval = &g->intervals[uses[u]];
+            if (i < interval->start) interval->start = i;
+            if (i > interval->end) interval->end = i;
+        }
+    }
+
+    // Um intervalo atravessa uma chamada se ela ocorre dentro dele; a chamada na
+    // primeira posição só conta se o valor já estava vivo antes dela (parâmetros,
+    // valores vivos na entrada de um laço), e não quando é ela que o define
+    int *calls_before = malloc(sizeof(int) * (n + 1));
+    if (!calls_before) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    calls_before[0] = 0;
+    for (int i = 0; i < n; i++) {
+        calls_before[i + 1] = calls_before[i] + isCallPoint((OpCode)f->code[i].op);
+    }
+    for (int v = 0; v < regs; v++) {
+        Interval *interval = &g->intervals[v];
+        if (interval->end > interval->start) {
+            int first = interval->start + (instructionDef(&f->code[interval->start]) == v ? 1 : 0);
+            interval->crosses_call = calls_before[interval->end] - calls_before[first] > 0;
+        }
+    }
+
+#undef USE
+#undef DEF
+#undef IN
+#undef OUT
+    free(calls_before);
+    free(sets);
+    free(block_start);
+    free(block_of);
+    free(leader);
+}
+
+// ---------------------------------------------------------------------------
+// Alocação por varredura linear (Poletto e Sarkar)
+
+static X86Operand spillSlot(X86Gen *g) {
+    // As posições de derramamento ficam logo abaixo dos registradores salvos;
+    // o deslocamento final é ajustado depois que saved_count é conhecido
+    return mem(RBP, -8 * ++g->spill_count);
+}
+
+// qsort não recebe contexto: os intervalos da função atual ficam em uma variável do arquivo
+static const Interval *sort_intervals;
+
+static int compareByStart(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    if (sort_intervals[x].start != sort_intervals[y].start) {
+        return sort_intervals[x].start < sort_intervals[y].start ? -1 : 1;
+    }
+    return x - y;
+}
+
+static void allocateRegisters(X86Gen *g, bool naive, X86AllocStats *stats) {
+    const Function *f = g->function;
+    int regs = f->register_count;
+    int *order = malloc(sizeof(int) * (regs + 1));
+    int *active = malloc(sizeof(int) * (regs + 1));
+    if (!order || !active) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int count = 0;
+    for (int v = 0; v < regs; v++) {
+        g->homes[v] = none();
+        if (g->intervals[v].end >= 0) order[count++] = v;
+    }
+    stats->intervals += count;
+
+    if (naive) {
+        for (int i = 0; i < count; i++) g->homes[order[i]] = spillSlot(g);
+        stats->spilled += count;
+        free(order);
+        free(active);
+        return;
+    }
+
+    sort_intervals = g->intervals;
+    qsort(order, count, sizeof(int), compareByStart);
+
+    bool gpr_free[16], xmm_free[XMM_COUNT];
+    memset(gpr_free, 0, sizeof(gpr_free));
+    memset(xmm_free, 0, sizeof(xmm_free));
+    for (int i = 0; i < CALLEE_SAVED_COUNT; i++) gpr_free[callee_saved[i]] = true;
+    for (int i = 0; i < CALLER_SAVED_COUNT; i++) gpr_free[caller_saved[i]] = true;
+    for (int i = FIRST_XMM; i < XMM_COUNT; i++) xmm_free[i] = true;
+
+    int active_count = 0;
+    for (int i = 0; i < count; i++) {
+        int v = order[i];
+        Interval *current = &g->intervals[v];
+
+        // Libera os intervalos que terminaram antes do início do atual
+        int kept = 0;
+        for (int j = 0; j < active_count; j++) {
+            int w = active[j];
+            if (g->intervals[w].end < current->start) {
+                if (g->homes[w].kind == OPER_XMM) xmm_free[g->homes[w].reg] = true;
+                else gpr_free[g->homes[w].reg] = true;
+            } else {
+                active[kept++] = w;
+            }
+        }
+        active_count = kept;
+
+        bool real = isReal(g, v);
+        int chosen = -1;
+        if (real) {
+            // Todos os registradores SSE são destruídos por chamadas
+            if (!current->crosses_call) {
+                for (int r = FIRST_XMM; r < XMM_COUNT && chosen < 0; r++) {
+                    if (xmm_free[r]) chosen = r;
+                }
+            }
+        } else {
+            if (!current->crosses_call) {
+                for (int r = 0; r < CALLER_SAVED_COUNT && chosen < 0; r++) {
+                    if (gpr_free[caller_saved[r]]) chosen = caller_saved[r];
+                }
+            }
+            for (int r = 0; r < CALLEE_SAVED_COUNT && chosen < 0; r++) {
+                if (gpr_free[callee_saved[r]]) chosen = callee_saved[r];
+            }
+        }
+
+        if (chosen < 0) {
+            // Derrama o intervalo ativo compatível que termina mais tarde
+            int victim = -1;
+            for (int j = 0; j < active_count; j++) {
+                int w = active[j];
+                X86Operand h = g->homes[w];
+                if (real != (h.kind == OPER_XMM)) continue;
+                if (!real && current->crosses_call) {
+                    bool saved = false;
+                    for (int r = 0; r < CALLEE_SAVED_COUNT; r++) saved |= h.reg == callee_saved[r];
+                    if (!saved) continue;
+                }
+                if (real && current->crosses_call) continue;
+                if (victim < 0 || g->intervals[w].end > g->intervals[victim].end) victim = w;
+            }
+            if (victim >= 0 && g->intervals[victim].end > current->end) {
+                g->homes[v] = g->homes[victim];
+                g->homes[victim] = spillSlot(g);
+                stats->spilled++;
+                for (int j = 0; j < active_count; j++) {
+                    if (active[j] == victim) active[j] = v;
+                }
+            } else {
+                g->homes[v] = spillSlot(g);
+                stats->spilled++;
+            }
+            continue;
+        }
+
+        if (real) {
+            xmm_free[chosen] = false;
+            g->homes[v] = xmm(chosen);
+        } else {
+            gpr_free[chosen] = false;
+            g->homes[v] = reg(chosen);
+            for (int r = 0; r < CALLEE_SAVED_COUNT; r++) {
+                if (callee_saved[r] == chosen) g->used_callee_saved[chosen] = true;
+            }
+        }
+        active[active_count++] = v;
+    }
+
+    free(order);
+    free(active);
+}
+
+// ---------------------------------------------------------------------------
+// Seleção de instruções
+
+static void genIntBinary(X86Gen *g, X86Op op, const Instruction *ins, bool commutative) {
+    X86Operand a = home(g, ins->a), b = home(g, ins->b), c = home(g, ins->c);
+    if (a.kind == OPER_REG) {
+        if (!sameOperand(a, c) || sameOperand(a, b)) {
+            emitMove(g, a, b, false);
+            emit2(g, op, a, c);
+            return;
+        }
+        if (commutative) {
+            emit2(g, op, a, b);
+            return;
+        }
+    }
+    emit2(g, X86_MOV, reg(RAX), b);
+    emit2(g, op, reg(RAX), c);
+    emit2(g, X86_MOV, a, reg(RAX));
+}
+
+static void genRealBinary(X86Gen *g, X86Op op, const Instruction *ins) {
+    X86Operand a = home(g, ins->a), b = home(g, ins->b), c = home(g, ins->c);
+    if (a.kind == OPER_XMM && (!sameOperand(a, c) || sameOperand(a, b))) {
+        emitMove(g, a, b, true);
+        emit2(g, op, a, c);
+        return;
+    }
+    emit2(g, X86_MOVSD, xmm(0), b);
+    emit2(g, op, xmm(0), c);
+    emit2(g, X86_MOVSD, a, xmm(0));
+}
+
+// Divisão inteira com as mesmas regras da máquina virtual:
+// divisor zero é erro de execução e divisor -1 não pode gerar exceção
+static void genDivision(X86Gen *g, const Instruction *ins, bool modulo) {
+    X86Operand a = home(g, ins->a), b = home(g, ins->b), c = home(g, ins->c);
+    int minus_one = newLabel(g);
+    int done = newLabel(g);
+
+    emit2(g, X86_MOV, reg(R10), c);
+    emit2(g, X86_TEST, reg(R10), reg(R10));
+    emitJump(g, X86_JCC, CC_E, g->division_label);
+    emit2(g, X86_CMP, reg(R10), imm(-1));
+    emitJump(g, X86_JCC, CC_E, minus_one);
+    emit2(g, X86_MOV, reg(RAX), b);
+    emit1(g, X86_CQO, none());
+    emit1(g, X86_IDIV, reg(R10));
+    emit2(g, X86_MOV, a, reg(modulo ? RDX : RAX));
+    emitJump(g, X86_JMP, 0, done);
+    emitLabel(g, minus_one);
+    if (modulo) {
+        emit2(g, X86_MOV, a, imm(0));
+    } else {
+        emit2(g, X86_MOV, reg(RAX), b);
+        emit1(g, X86_NEG, reg(RAX));
+        emit2(g, X86_MOV, a, reg(RAX));
+    }
+    emitLabel(g, done);
+}
+
+static X86Cond intCondition(OpCode op) {
+    switch (op) {
+        case OP_EQ_I: return CC_E;
+        case OP_NE_I: return CC_NE;
+        case OP_LT_I: return CC_L;
+        case OP_LE_I: return CC_LE;
+        case OP_GT_I: return CC_G;
+        default: return CC_GE;
+    }
+}
+
+static X86Cond invertCondition(X86Cond cond) {
+    switch (cond) {
+        case CC_E: return CC_NE;
+        case CC_NE: return CC_E;
+        case CC_L: return CC_GE;
+        case CC_GE: return CC_L;
+        case CC_LE: return CC_G;
+        case CC_G: return CC_LE;
+        case CC_B: return CC_AE;
+        case CC_AE: return CC_B;
+        case CC_BE: return CC_A;
+        case CC_A: return CC_BE;
+        case CC_P: return CC_NP;
+        default: return CC_P;
+    }
+}
+
+static void genIntCompare(X86Gen *g, const Instruction *ins) {
+    X86Operand b = home(g, ins->b), c = home(g, ins->c);
+    if (b.kind == OPER_REG) {
+        emit2(g, X86_CMP, b, c);
+    } else {
+        emit2(g, X86_MOV, reg(RAX), b);
+        emit2(g, X86_CMP, reg(RAX), c);
+    }
+}
+
+// ucomisd só compara com o primeiro operando em registrador; < e <= trocam os operandos
+// para que a comparação sem sinal (A/AE) já trate NaN como falso
+static X86Cond genRealCompare(X86Gen *g, const Instruction *ins) {
+    OpCode op = (OpCode)ins->op;
+    bool swap = op == OP_LT_R || op == OP_LE_R;
+    X86Operand left = home(g, swap ? ins->c : ins->b);
+    X86Operand right = home(g, swap ? ins->b : ins->c);
+    if (left.kind != OPER_XMM) {
+        emit2(g, X86_MOVSD, xmm(0), left);
+        left = xmm(0);
+    }
+    emit2(g, X86_UCOMISD, left, right);
+    switch (op) {
+        case OP_EQ_R: return CC_E;
+        case OP_NE_R: return CC_NE;
+        case OP_LT_R: case OP_GT_R: return CC_A;
+        default: return CC_AE;
+    }
+}
+
+static void storeFlag(X86Gen *g, X86Operand a) {
+    emit2(g, X86_MOV, a, reg(RAX));
+}
+
+// Comparação seguida de um desvio sobre seu resultado: usa jcc direto.
+// O resultado só é materializado se ainda for lido depois do desvio.
+static bool fusesWithNext(X86Gen *g, int index) {
+    const Function *f = g->function;
+    if (index + 1 >= f->count || g->labels[index + 1] >= 0) return false;
+    const Instruction *ins = &f->code[index];
+    const Instruction *next = &f->code[index + 1];
+    if (next->op != OP_JMPF && next->op != OP_JMPT) return false;
+    if (next->a != ins->a) return false;
+    // = e <> reais dependem também do flag de paridade
+    return (ins->op >= OP_EQ_I && ins->op <= OP_GE_I) || (ins->op >= OP_LT_R && ins->op <= OP_GE_R);
+}
+
+static void genCall(X86Gen *g, const Instruction *ins, int arg_count) {
+    const Function *callee = &g->program->functions[ins->k];
+    int int_count = 0, real_count = 0;
+    for (int i = 0; i < arg_count && i < callee->param_count; i++) {
+        if (callee->register_types[i] == TYPE_REAL) {
+            if (real_count == MAX_REAL_ARGS) break;
+            emit2(g, X86_MOVSD, xmm(real_count++), mem(RSP, 8 * i));
+        } else {
+            if (int_count == MAX_INT_ARGS) break;
+            emit2(g, X86_MOV, reg(int_arg_registers[int_count++]), mem(RSP, 8 * i));
+        }
+    }
+    if (int_count + real_count < arg_count) {
+        if (!g->failed) {
+            fprintf(stderr, "Erro: chamada a %s excede os parâmetros passados em registradores\n", callee->name);
+        }
+        g->failed = true;
+    }
+    emitCall(g, SYM_FUNCTION, ins->k);
+}
+
+// rax = índice - low, conferido contra o tamanho do array; rdx = início do array
+static void genElementAddress(X86Gen *g, const Instruction *ins) {
+    const ArrayInfo *array = &g->program->arrays[ins->c];
+    emit2(g, X86_MOV, reg(RAX), home(g, ins->b));
+    if (array->low != 0) emit2(g, X86_SUB, reg(RAX), imm(array->low));
+    emit2(g, X86_CMP, reg(RAX), imm(array->length));
+    emitJump(g, X86_JCC, CC_AE, g->index_label);
+    emit2(g, X86_LEA, reg(RDX), rip(SYM_GLOBALS, 0, 8 * (X86_ARRAY_SLOT(g->x86) + array->offset)));
+}
+
+static X86Op packedOp(OpCode op) {
+    switch (op) {
+        case OP_ADD_I: return X86_PADDQ;
+        case OP_SUB_I: return X86_PSUBQ;
+        case OP_ADD_R: return X86_ADDPD;
+        case OP_SUB_R: return X86_SUBPD;
+        case OP_MUL_R: return X86_MULPD;
+        default: return X86_DIVPD;
+    }
+}
+
+// Operação n do kernel sobre os elementos j..j + largura - 1, com resultado em xmm n
+static void genKernelOp(X86Gen *g, const KernelOp *op, int n) {
+    X86Operand element = indexed(R10, RAX, 8, 8 * op->k);
+    X86Operand a = xmm(op->a), b = xmm(op->b), result = xmm(n);
+    switch ((OpCode)op->op) {
+        case OP_ARG:
+            break;
+        case OP_LOADX:
+            emitVector(g, X86_MOVUPD, result, element, true);
+            break;
+        case OP_STOREX:
+            emitVector(g, X86_MOVUPD, element, a, true);
+            break;
+        case OP_NEG_I:
+            emitVector(g, X86_PXOR, result, result, true);
+            emitVector(g, X86_PSUBQ, result, a, true);
+            break;
+        case OP_MUL_I:
+            // Não há multiplicação de 64 bits por elemento antes do AVX-512: os produtos
+            // cruzados das metades de 32 bits vão para a metade alta (módulo 2^64)
+            emitVector(g, X86_MOVUPD, xmm(14), a, true);
+            emitVector(g, X86_PSRLQ, xmm(14), imm(32), true);
+            emitVector(g, X86_PMULUDQ, xmm(14), b, true);
+            emitVector(g, X86_MOVUPD, xmm(15), b, true);
+            emitVector(g, X86_PSRLQ, xmm(15), imm(32), true);
+            emitVector(g, X86_PMULUDQ, xmm(15), a, true);
+            emitVector(g, X86_PADDQ, xmm(14), xmm(15), true);
+            emitVector(g, X86_PSLLQ, xmm(14), imm(32), true);
+            emitVector(g, X86_MOVUPD, result, a, true);
+            emitVector(g, X86_PMULUDQ, result, b, true);
+            emitVector(g, X86_PADDQ, result, xmm(14), true);
+            break;
+        default:
+            emitVector(g, X86_MOVUPD, result, a, true);
+            emitVector(g, packedOp((OpCode)op->op), result, b, true);
+            break;
+    }
+}
+
+// Soma (ou subtrai) ao acumulador real xmm13 os elementos de xmm r um a um, na
+// ordem do laço escalar, para que o resultado seja o mesmo bit a bit
+static void genRealReduction(X86Gen *g, const Kernel *kernel) {
+    X86Op op = kernel->reduction_op == OP_ADD_R ? X86_ADDSD : X86_SUBSD;
+    int r = kernel->reduction;
+    for (int half = 0; half < (g->avx2 ? 2 : 1); half++) {
+        if (half == 0) emitVector(g, X86_MOVUPD, xmm(14), xmm(r), false);
+        else emitVector(g, X86_VEXTRACTF128, xmm(14), xmm(r), true);
+        emitVector(g, op, xmm(13), xmm(14), false);
+        emitVector(g, X86_UNPCKHPD, xmm(14), xmm(14), false);
+        emitVector(g, op, xmm(13), xmm(14), false);
+    }
+}
+
+// VLOOP: os argumentos estão em [rsp]; a operação n do kernel fica em xmm n (ymm com
+// AVX2), xmm13 acumula a redução e xmm14 e xmm15 são rascunho. r10 aponta para o
+// elemento start da área dos arrays, rax conta os elementos feitos e r11 é count,
+// múltiplo de 4 (ir_loop.c)
+static void genVectorLoop(X86Gen *g, const Instruction *ins) {
+    const Kernel *kernel = &g->program->kernels[ins->k];
+    bool reduces = kernel->reduction >= 0;
+    bool real = reduces && (kernel->reduction_op == OP_ADD_R || kernel->reduction_op == OP_SUB_R);
+    int loop = newLabel(g), done = newLabel(g);
+
+    if (real) emit2(g, X86_MOVSD, xmm(13), mem(RSP, 16));
+    else if (reduces) emitVector(g, X86_PXOR, xmm(13), xmm(13), true);
+    for (int n = 0; n < kernel->op_count; n++) {
+        const KernelOp *op = &kernel->ops[n];
+        if (op->op != OP_ARG) continue;
+        X86Operand input = mem(RSP, 8 * (2 + reduces + op->k));
+        if (g->avx2) {
+            emitVector(g, X86_VBROADCASTSD, xmm(n), input, true);
+        } else {
+            emit2(g, X86_MOVSD, xmm(n), input);
+            emitVector(g, X86_UNPCKLPD, xmm(n), xmm(n), false);
+        }
+    }
+    emit2(g, X86_MOV, reg(RAX), mem(RSP, 0));
+    emit2(g, X86_LEA, reg(R10), rip(SYM_GLOBALS, 0, 8 * X86_ARRAY_SLOT(g->x86)));
+    emit2(g, X86_LEA, reg(R10), indexed(R10, RAX, 8, 0));
+    emit2(g, X86_MOV, reg(R11), mem(RSP, 8));
+    emit2(g, X86_XOR, reg(RAX), reg(RAX));
+    emit2(g, X86_TEST, reg(R11), reg(R11));
+    emitJump(g, X86_JCC, CC_LE, done);
+
+    emitLabel(g, loop);
+    for (int n = 0; n < kernel->op_count; n++) genKernelOp(g, &kernel->ops[n], n);
+    if (real) {
+        genRealReduction(g, kernel);
+    } else if (reduces) {
+        // A soma inteira é modular: cada elemento do vetor acumula uma parte
+        X86Op op = kernel->reduction_op == OP_ADD_I ? X86_PADDQ : X86_PSUBQ;
+        emitVector(g, op, xmm(13), xmm(kernel->reduction), true);
+    }
+    emit2(g, X86_ADD, reg(RAX), imm(g->avx2 ? 4 : 2));
+    emit2(g, X86_CMP, reg(RAX), reg(R11));
+    emitJump(g, X86_JCC, CC_L, loop);
+    emitLabel(g, done);
+
+    X86Operand a = home(g, ins->a);
+    if (reduces && !real) {
+        if (g->avx2) {
+            emitVector(g, X86_VEXTRACTF128, xmm(14), xmm(13), true);
+            emitVector(g, X86_PADDQ, xmm(13), xmm(14), false);
+        }
+        emitVector(g, X86_MOVUPD, xmm(14), xmm(13), false);
+        emitVector(g, X86_UNPCKHPD, xmm(14), xmm(14), false);
+        emitVector(g, X86_PADDQ, xmm(13), xmm(14), false);
+    }
+    // Sai do estado AVX antes do código SSE escalar
+    if (g->avx2) emit1(g, X86_VZEROUPPER, none());
+    if (real) {
+        emitMove(g, a, xmm(13), true);
+    } else if (reduces) {
+        emit2(g, X86_MOVQ, reg(RAX), xmm(13));
+        emit2(g, X86_ADD, reg(RAX), mem(RSP, 16));
+        emit2(g, X86_MOV, a, reg(RAX));
+    } else {
+        emit2(g, X86_MOV, a, imm(0));
+    }
+}
+
+static void genInstruction(X86Gen *g, int index, int *arg_count) {
+    const Instruction *ins = &g->function->code[index];
+    X86Operand a = home(g, ins->a);
+    switch ((OpCode)ins->op) {
+        case OP_NOP:
+            break;
+        case OP_MOV:
+            emitMove(g, a, home(g, ins->b), isReal(g, ins->a));
+            break;
+        case OP_LOADI:
+            emit2(g, X86_MOV, a, imm(ins->k));
+            break;
+        case OP_LOADK:
+            if (isReal(g, ins->a)) {
+                emitMove(g, a, rip(SYM_CONSTANTS, 0, 8 * ins->k), true);
+            } else if (a.kind == OPER_REG) {
+                emit2(g, X86_MOVABS, a, imm(g->program->constants[ins->k].i));
+            } else {
+                emit2(g, X86_MOVABS, reg(RAX), imm(g->program->constants[ins->k].i));
+                emit2(g, X86_MOV, a, reg(RAX));
+            }
+            break;
+        case OP_LOADG:
+            emitMove(g, a, rip(SYM_GLOBALS, 0, 8 * ins->k), isReal(g, ins->a));
+            break;
+        case OP_STOREG:
+            emitMove(g, rip(SYM_GLOBALS, 0, 8 * ins->k), a, isReal(g, ins->a));
+            break;
+        case OP_LOADX:
+            genElementAddress(g, ins);
+            emitMove(g, a, indexed(RDX, RAX, 8, 0), isReal(g, ins->a));
+            break;
+        case OP_STOREX: {
+            bool real = isReal(g, ins->a);
+            X86Operand value = a;
+            if (!isRegister(a)) {
+                value = real ? xmm(0) : reg(R10);
+                emit2(g, real ? X86_MOVSD : X86_MOV, value, a);
+            }
+            genElementAddress(g, ins);
+            emit2(g, real ? X86_MOVSD : X86_MOV, indexed(RDX, RAX, 8, 0), value);
+            break;
+        }
+
+        case OP_ADD_I: genIntBinary(g, X86_ADD, ins, true); break;
+        case OP_SUB_I: genIntBinary(g, X86_SUB, ins, false); break;
+        case OP_AND: genIntBinary(g, X86_AND, ins, true); break;
+        case OP_OR: genIntBinary(g, X86_OR, ins, true); break;
+        case OP_MUL_I:
+            // imul exige destino em registrador
+            if (a.kind == OPER_REG) {
+                genIntBinary(g, X86_IMUL, ins, true);
+            } else {
+                emit2(g, X86_MOV, reg(RAX), home(g, ins->b));
+                emit2(g, X86_IMUL, reg(RAX), home(g, ins->c));
+                emit2(g, X86_MOV, a, reg(RAX));
+            }
+            break;
+        case OP_DIV_I: genDivision(g, ins, false); break;
+        case OP_MOD_I: genDivision(g, ins, true); break;
+        case OP_NEG_I:
+        case OP_NOT: {
+            X86Operand target = a.kind == OPER_REG ? a : reg(RAX);
+            emitMove(g, target, home(g, ins->b), false);
+            if (ins->op == OP_NEG_I) emit1(g, X86_NEG, target);
+            else emit2(g, X86_XOR, target, imm(1));
+            emitMove(g, a, target, false);
+            break;
+        }
+
+        case OP_ADD_R: genRealBinary(g, X86_ADDSD, ins); break;
+        case OP_SUB_R: genRealBinary(g, X86_SUBSD, ins); break;
+        case OP_MUL_R: genRealBinary(g, X86_MULSD, ins); break;
+        case OP_DIV_R: genRealBinary(g, X86_DIVSD, ins); break;
+        case OP_NEG_R: {
+            X86Operand target = a.kind == OPER_XMM ? a : xmm(0);
+            emitMove(g, target, home(g, ins->b), true);
+            emit2(g, X86_XORPD, target, rip(SYM_SIGN_MASK, 0, 0));
+            emitMove(g, a, target, true);
+            break;
+        }
+        case OP_I2R: {
+            X86Operand target = a.kind == OPER_XMM ? a : xmm(0);
+            emit2(g, X86_CVTSI2SD, target, home(g, ins->b));
+            emitMove(g, a, target, true);
+            break;
+        }
+
+        case OP_EQ_I: case OP_NE_I: case OP_LT_I: case OP_LE_I: case OP_GT_I: case OP_GE_I:
+        case OP_EQ_R: case OP_NE_R: case OP_LT_R: case OP_LE_R: case OP_GT_R: case OP_GE_R: {
+            bool real = ins->op >= OP_EQ_R;
+            X86Cond cond = real ? genRealCompare(g, ins) : (genIntCompare(g, ins), intCondition((OpCode)ins->op));
+            if (fusesWithNext(g, index)) {
+                const Instruction *next = &g->function->code[index + 1];
+                if (!g->condition_dies[index + 1]) {
+                    // setcc, movzx e mov preservam os flags
+                    emitSetcc(g, cond, RAX);
+                    storeFlag(g, a);
+                }
+                if (next->op == OP_JMPF) cond = invertCondition(cond);
+                emitJump(g, X86_JCC, cond, g->labels[next->k]);
+                return;
+            }
+            emitSetcc(g, cond, RAX);
+            if (ins->op == OP_EQ_R) {
+                emitSetcc(g, CC_NP, RDX);
+                emit2(g, X86_AND, reg(RAX), reg(RDX));
+            } else if (ins->op == OP_NE_R) {
+                emitSetcc(g, CC_P, RDX);
+                emit2(g, X86_OR, reg(RAX), reg(RDX));
+            }
+            storeFlag(g, a);
+            break;
+        }
+
+        case OP_JMP:
+            emitJump(g, X86_JMP, 0, g->labels[ins->k]);
+            break;
+        case OP_JMPF:
+        case OP_JMPT:
+            // Já emitido junto com a comparação anterior
+            if (index > 0 && fusesWithNext(g, index - 1)) break;
+            emit2(g, X86_CMP, a, imm(0));
+            emitJump(g, X86_JCC, ins->op == OP_JMPF ? CC_E : CC_NE, g->labels[ins->k]);
+            break;
+
+        case OP_ARG: {
+            X86Operand slot = mem(RSP, 8 * (*arg_count)++);
+            emitMove(g, slot, a, isReal(g, ins->a));
+            break;
+        }
+        case OP_CALL:
+            genCall(g, ins, *arg_count);
+            *arg_count = 0;
+            break;
+        case OP_VLOOP:
+            genVectorLoop(g, ins);
+            *arg_count = 0;
+            break;
+        case OP_RET:
+        case OP_HALT:
+            if (index + 1 < g->function->count) emitJump(g, X86_JMP, 0, g->epilogue_label);
+            break;
+
+        case OP_WRITE_I:
+        case OP_WRITE_B:
+            emit2(g, X86_MOV, reg(RDI), a);
+            emitCall(g, SYM_RUNTIME, ins->op == OP_WRITE_I ? RT_WRITE_INTEGER : RT_WRITE_BOOLEAN);
+            break;
+        case OP_WRITE_R:
+            emit2(g, X86_MOVSD, xmm(0), a);
+            emitCall(g, SYM_RUNTIME, RT_WRITE_REAL);
+            break;
+        case OP_WRITE_S:
+            emit2(g, X86_LEA, reg(RDI), rip(SYM_STRING, ins->k, 0));
+            emitCall(g, SYM_RUNTIME, RT_WRITE_STRING);
+            break;
+        case OP_WRITELN:
+            emitCall(g, SYM_RUNTIME, RT_WRITELN);
+            break;
+        case OP_READ_I:
+            emitCall(g, SYM_RUNTIME, RT_READ_INTEGER);
+            emit2(g, X86_MOV, a, reg(RAX));
+            break;
+        case OP_READ_R:
+            emitCall(g, SYM_RUNTIME, RT_READ_REAL);
+            emitMove(g, a, xmm(0), true);
+            break;
+        case OP_PROFILE:
+            emit2(g, X86_ADD, rip(SYM_GLOBALS, 0, 8 * (X86_PROFILE_SLOT(g->x86) + ins->k)), imm(1));
+            break;
+        default:
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+static int maxArguments(const Function *f) {
+    int max = 0, current = 0;
+    for (int i = 0; i < f->count; i++) {
+        if (f->code[i].op == OP_ARG) {
+            if (++current > max) max = current;
+        } else if (f->code[i].op == OP_CALL || f->code[i].op == OP_VLOOP) {
+            current = 0;
+        }
+    }
+    return max;
+}
+
+static char *functionSymbol(const BytecodeProgram *program, int index) {
+    const char *name = program->functions[index].name;
+    char *symbol = malloc(strlen(name) + 32);
+    if (!symbol) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    if (index == program->main_function) strcpy(symbol, "main");
+    else sprintf(symbol, "pas_p%d_%s", index, name);
+    return symbol;
+}
+
+static bool generateFunction(X86Gen *g, int index, bool naive, X86AllocStats *stats) {
+    const Function *f = &g->program->functions[index];
+    X86Function *out = &g->x86->functions[index];
+    g->function = f;
+    g->out = out;
+    out->symbol = functionSymbol(g->program, index);
+    memset(g->used_callee_saved, 0, sizeof(g->used_callee_saved));
+    g->spill_count = 0;
+    g->failed = false;
+    g->pc = -1;
+    // Os rótulos 0 e 1 de cada função são reservados para os erros de divisão e de índice
+    g->division_label = 0;
+    g->index_label = 1;
+    out->label_count = 2;
+
+    int regs = f->register_count;
+    g->intervals = malloc(sizeof(Interval) * (regs + 1));
+    g->homes = malloc(sizeof(X86Operand) * (regs + 1));
+    g->labels = malloc(sizeof(int) * (f->count + 1));
+    g->condition_dies = calloc(f->count + 1, sizeof(bool));
+    bool *live_at_entry = calloc(regs + 1, sizeof(bool));
+    if (!g->intervals || !g->homes || !g->labels || !g->condition_dies || !live_at_entry) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+
+    computeIntervals(g, live_at_entry);
+    allocateRegisters(g, naive, stats);
+
+    for (int i = 0; i <= f->count; i++) g->labels[i] = -1;
+    for (int i = 0; i < f->count; i++) {
+        const Instruction *ins = &f->code[i];
+        if ((ins->op == OP_JMP || ins->op == OP_JMPF || ins->op == OP_JMPT) && g->labels[ins->k] < 0) {
+            g->labels[ins->k] = newLabel(g);
+        }
+    }
+    g->epilogue_label = newLabel(g);
+
+    // Quadro: rbp, registradores preservados, derramamentos, parâmetros recebidos
+    // e, no topo, a área de argumentos de saída
+    g->saved_count = 0;
+    for (int i = 0; i < CALLEE_SAVED_COUNT; i++) g->saved_count += g->used_callee_saved[callee_saved[i]];
+    int saved_bytes = 8 * g->saved_count;
+    for (int v = 0; v < regs; v++) {
+        if (g->homes[v].kind == OPER_MEM) g->homes[v].disp -= saved_bytes;
+    }
+    g->param_base = saved_bytes + 8 * g->spill_count;
+    g->max_args = maxArguments(f);
+    int frame = 8 * (g->spill_count + f->param_count + g->max_args);
+    if ((16 + saved_bytes + frame) % 16 != 0) frame += 8;
+
+    g->pc = X86_PC_NO_FRAME;
+    emit1(g, X86_PUSH, reg(RBP));
+    emit2(g, X86_MOV, reg(RBP), reg(RSP));
+    g->pc = -1;
+    for (int i = 0; i < CALLEE_SAVED_COUNT; i++) {
+        if (g->used_callee_saved[callee_saved[i]]) emit1(g, X86_PUSH, reg(callee_saved[i]));
+    }
+    if (frame > 0) emit2(g, X86_SUB, reg(RSP), imm(frame));
+    if (g->x86->call_counters && index != g->program->main_function) {
+        int counter = 8 * (g->program->global_count + 1 + index);
+        emit2(g, X86_ADD, rip(SYM_GLOBALS, 0, counter), imm(1));
+    }
+
+    // Parâmetros chegam em registradores pela convenção System V
+    int int_count = 0, real_count = 0;
+    for (int p = 0; p < f->param_count; p++) {
+        X86Operand saved = mem(RBP, -(g->param_base + 8 * (p + 1)));
+        if (f->register_types[p] == TYPE_REAL) {
+            if (real_count < MAX_REAL_ARGS) emit2(g, X86_MOVSD, saved, xmm(real_count++));
+        } else if (int_count < MAX_INT_ARGS) {
+            emit2(g, X86_MOV, saved, reg(int_arg_registers[int_count++]));
+        }
+    }
+    for (int p = 0; p < f->param_count; p++) {
+        if (g->homes[p].kind != OPER_NONE) {
+            emitMove(g, g->homes[p], mem(RBP, -(g->param_base + 8 * (p + 1))), isReal(g, p));
+        }
+    }
+    // Variáveis lidas antes de qualquer atribuição começam zeradas, como na máquina virtual
+    for (int v = f->param_count; v < regs; v++) {
+        if (!live_at_entry[v] || g->homes[v].kind == OPER_NONE) continue;
+        if (g->homes[v].kind == OPER_XMM) emit2(g, X86_XORPD, g->homes[v], g->homes[v]);
+        else emit2(g, X86_MOV, g->homes[v], imm(0));
+    }
+
+    int arg_count = 0;
+    bool divides = false, indexes = false;
+    for (int i = 0; i < f->count; i++) {
+        if (g->labels[i] >= 0) emitLabel(g, g->labels[i]);
+        g->pc = i;
+        genInstruction(g, i, &arg_count);
+        divides |= f->code[i].op == OP_DIV_I || f->code[i].op == OP_MOD_I;
+        indexes |= f->code[i].op == OP_LOADX || f->code[i].op == OP_STOREX;
+    }
+    g->pc = -1;
+    if (g->labels[f->count] >= 0) emitLabel(g, g->labels[f->count]);
+
+    emitLabel(g, g->epilogue_label);
+    if (index == g->program->main_function) emit2(g, X86_XOR, reg(RAX), reg(RAX));
+    if (g->saved_count > 0) emit2(g, X86_LEA, reg(RSP), mem(RBP, -saved_bytes));
+    else emit2(g, X86_MOV, reg(RSP), reg(RBP));
+    for (int i = CALLEE_SAVED_COUNT - 1; i >= 0; i--) {
+        if (g->used_callee_saved[callee_saved[i]]) emit1(g, X86_POP, reg(callee_saved[i]));
+    }
+    emit1(g, X86_POP, reg(RBP));
+    g->pc = X86_PC_NO_FRAME;
+    emit1(g, X86_RET, none());
+    g->pc = -1;
+
+    // Desvio compartilhado para divisão por zero
+    if (divides) {
+        emitLabel(g, g->division_label);
+        emit2(g, X86_LEA, reg(RDI), rip(SYM_STRING, g->x86->division_error, 0));
+        emitCall(g, SYM_RUNTIME, RT_RUNTIME_ERROR);
+    }
+    if (indexes) {
+        emitLabel(g, g->index_label);
+        emit2(g, X86_LEA, reg(RDI), rip(SYM_STRING, g->x86->index_error, 0));
+        emitCall(g, SYM_RUNTIME, RT_RUNTIME_ERROR);
+    }
+
+    free(live_at_entry);
+    free(g->condition_dies);
+    free(g->labels);
+    free(g->homes);
+    free(g->intervals);
+    return !g->failed;
+}
+
+bool generateX86(const BytecodeProgram *program, bool naive, bool count_calls, bool avx2,
+                 X86Program *out, X86AllocStats *stats) {
+    memset(out, 0, sizeof(*out));
+    out->call_counters = count_calls;
+    memset(stats, 0, sizeof(*stats));
+    out->function_count = program->function_count;
+    out->main_function = program->main_function;
+    out->global_count = program->global_count;
+    out->counter_count = program->counter_count;
+    out->array_slots = program->array_slots;
+    out->functions = calloc(program->function_count, sizeof(X86Function));
+    out->constant_count = program->constant_count;
+    out->constants = malloc(sizeof(uint64_t) * (program->constant_count + 1));
+    out->string_count = program->string_count + 2;
+    out->strings = malloc(sizeof(char *) * out->string_count);
+    if (!out->functions || !out->constants || !out->strings) {
+        fprintf(stderr, "Erro de alocação de memória ao gerar código x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    // Os reais são copiados bit a bit para a seção de dados somente leitura
+    for (int i = 0; i < program->constant_count; i++) {
+        memcpy(&out->constants[i], &program->constants[i], sizeof(uint64_t));
+    }
+    for (int i = 0; i < program->string_count; i++) {
+        out->strings[i] = strdup(program->strings[i]);
+    }
+    out->division_error = program->string_count;
+    out->strings[out->division_error] = strdup("division by zero");
+    out->index_error = program->string_count + 1;
+    out->strings[out->index_error] = strdup("index out of range");
+
+    X86Gen g;
+    memset(&g, 0, sizeof(g));
+    g.program = program;
+    g.x86 = out;
+    g.avx2 = avx2;
+    bool ok = true;
+    for (int i = 0; i < program->function_count; i++) {
+        uint64_t span = traceBegin();
+        ok &= generateFunction(&g, i, naive, stats);
+        traceSpan(span, "x86", program->functions[i].name, "instructions", out->functions[i].count);
+    }
+    return ok;
+}
+
+void freeX86(X86Program *program) {
+    for (int i = 0; i < program->function_count; i++) {
+        free(program->functions[i].symbol);
+        free(program->functions[i].code);
+    }
+    for (int i = 0; i < program->string_count; i++) {
+        free(program->strings[i]);
+    }
+    free(program->functions);
+    free(program->constants);
+    free(program->strings);
+    memset(program, 0, sizeof(*program));
+}
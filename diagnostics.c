@@ -0,0 +1,433 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "diagnostics.h"
+#include "tokens.h"
+
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+typedef enum {
+    POSITION_NONE,
+    POSITION_LINE,            // " at line L"
+    POSITION_COLUMN           // " at line L, column C"
+} PositionStyle;
+
+// Mensagem de cada código: %s, %d e %t marcam os argumentos, na ordem em que são passados
+static const struct {
+    const char *name;         // Código no JSON
+    const char *message;
+    DiagnosticSeverity severity;
+    bool syntax;              // "Syntax Error" em vez de "Semantic Error"
+    PositionStyle position;
+} catalog[DIAG_CODE_COUNT] = {
+    [DIAG_EXPECTED_TOKEN] = {"expected-token", "Expected %t", SEVERITY_ERROR, true, POSITION_COLUMN},
+    [DIAG_UNEXPECTED_END] = {"unexpected-end", "Unexpected end of input during expression parsing",
+                             SEVERITY_ERROR, true, POSITION_NONE},
+    [DIAG_INVALID_EXPRESSION] = {"invalid-expression", "Invalid expression", SEVERITY_ERROR, true, POSITION_COLUMN},
+    [DIAG_EXPECTED_EXPRESSION] = {"expected-expression", "Expected an expression after ':='",
+                                  SEVERITY_ERROR, true, POSITION_COLUMN},
+    [DIAG_UNEXPECTED_STATEMENT] = {"unexpected-statement", "Unexpected token in statement block",
+                                   SEVERITY_ERROR, true, POSITION_COLUMN},
+    [DIAG_INVALID_TYPE] = {"invalid-type", "Invalid variable type", SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_VARIABLE_REDECLARED] = {"variable-redeclared", "Variable %s already declared",
+                                  SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_PROCEDURE_REDECLARED] = {"procedure-redeclared", "Procedure %s already declared",
+                                   SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_TOO_MANY_PARAMETERS] = {"too-many-parameters", "Procedure %s has %d parameters; at most %d are allowed",
+                                  SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_INTERFACE_MISMATCH] = {"interface-mismatch", "Procedure %s does not match its interface",
+                                 SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_MISSING_BODY] = {"missing-body", "Procedure %s of the interface has no body",
+                           SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_UNIT_SELF] = {"unit-self", "Unit %s cannot use itself", SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_UNIT_NOT_LOADED] = {"unit-not-loaded", "Unit %s could not be loaded (%s)",
+                              SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_UNIT_REPEATED] = {"unit-repeated", "Unit %s already used", SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_ARRAY_BOUNDS] = {"array-bounds", "Invalid bounds for array %s", SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_ARRAY_PLACEMENT] = {"array-placement", "Arrays are only allowed as program variables: %s",
+                              SEVERITY_ERROR, false, POSITION_LINE},
+    [DIAG_ARITHMETIC_OPERANDS] = {"arithmetic-operands", "Arithmetic operator requires numeric operands",
+                                  SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_DIVIDE_OPERANDS] = {"divide-operands", "Operator '/' requires numeric operands",
+                              SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_INTEGER_OPERANDS] = {"integer-operands", "Operators div and mod require integer operands",
+                               SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_DIVISION_BY_ZERO] = {"division-by-zero", "Division by zero", SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_LOGICAL_OPERANDS] = {"logical-operands", "Logical operator requires boolean operands",
+                               SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_COMPARISON_OPERANDS] = {"comparison-operands", "Incompatible operands in comparison",
+                                  SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_NOT_OPERAND] = {"not-operand", "Operator not requires a boolean operand",
+                          SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_SIGN_OPERAND] = {"sign-operand", "Unary sign requires a numeric operand",
+                           SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_UNDECLARED_IDENTIFIER] = {"undeclared-identifier", "Undeclared identifier %s",
+                                    SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_PROCEDURE_AS_VALUE] = {"procedure-as-value", "Procedure used as a value: %s",
+                                 SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_ARRAY_AS_VALUE] = {"array-as-value", "Array used without an index: %s",
+                             SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_NOT_ARRAY] = {"not-array", "Not an array: %s", SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_INDEX_TYPE] = {"index-type", "Array index must be integer, found %s", SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_UNSUPPORTED_EXPRESSION] = {"unsupported-expression", "Invalid expression",
+                                     SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_CONDITION_TYPE] = {"condition-type", "Condition must be boolean, found %s",
+                             SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_IMPLICIT_CONVERSION] = {"implicit-conversion", "Implicit conversion from integer to real for %s",
+                                  SEVERITY_WARNING, false, POSITION_COLUMN},
+    [DIAG_ASSIGN_TYPE] = {"assign-type", "Cannot assign %s to %s %s", SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_ASSIGN_PROCEDURE] = {"assign-procedure", "Cannot assign to procedure %s",
+                               SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_UNDECLARED_PROCEDURE] = {"undeclared-procedure", "Undeclared procedure %s",
+                                   SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_NOT_PROCEDURE] = {"not-procedure", "Not a procedure: %s", SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_ARGUMENT_COUNT] = {"argument-count", "Procedure %s expects %d arguments, got %d",
+                             SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_FOR_VARIABLE_TYPE] = {"for-variable-type", "For loop control variable must be integer: %s",
+                                SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_FOR_BOUNDS_TYPE] = {"for-bounds-type", "For loop bounds must be integer, found %s",
+                              SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_READ_BOOLEAN] = {"read-boolean", "Cannot read a boolean variable: %s",
+                           SEVERITY_ERROR, false, POSITION_COLUMN},
+    [DIAG_INVALID_STATEMENT] = {"invalid-statement", "Invalid statement", SEVERITY_ERROR, false, POSITION_COLUMN},
+};
+
+// Grafia dos tokens nas mensagens (%t) e no campo "expected" do JSON
+static const char *const token_spellings[] = {
+    [TOKEN_PROGRAM] = "program", [TOKEN_VAR] = "var", [TOKEN_INTEGER] = "integer", [TOKEN_REAL] = "real",
+    [TOKEN_BOOLEAN] = "boolean", [TOKEN_PROCEDURE] = "procedure", [TOKEN_BEGIN] = "begin", [TOKEN_END] = "end",
+    [TOKEN_IF] = "if", [TOKEN_THEN] = "then", [TOKEN_ELSE] = "else", [TOKEN_WHILE] = "while", [TOKEN_DO] = "do",
+    [TOKEN_FOR] = "for", [TOKEN_TO] = "to", [TOKEN_DOWNTO] = "downto", [TOKEN_READ] = "read",
+    [TOKEN_WRITE] = "write", [TOKEN_WRITELN] = "writeln", [TOKEN_DIV] = "div", [TOKEN_MOD] = "mod",
+    [TOKEN_AND] = "and", [TOKEN_OR] = "or", [TOKEN_NOT] = "not", [TOKEN_UNIT] = "unit",
+    [TOKEN_INTERFACE] = "interface", [TOKEN_IMPLEMENTATION] = "implementation", [TOKEN_USES] = "uses",
+    [TOKEN_ARRAY] = "array", [TOKEN_OF] = "of",
+    [TOKEN_ASSIGN] = ":=", [TOKEN_PLUS] = "+", [TOKEN_MINUS] = "-", [TOKEN_MULTIPLY] = "*", [TOKEN_DIVIDE] = "/",
+    [TOKEN_EQ] = "=", [TOKEN_NEQ] = "<>", [TOKEN_LT] = "<", [TOKEN_GT] = ">", [TOKEN_LTE] = "<=",
+    [TOKEN_GTE] = ">=", [TOKEN_SEMICOLON] = ";", [TOKEN_COLON] = ":", [TOKEN_COMMA] = ",", [TOKEN_DOT] = ".",
+    [TOKEN_LPAREN] = "(", [TOKEN_RPAREN] = ")", [TOKEN_LBRACKET] = "[", [TOKEN_RBRACKET] = "]", [TOKEN_DOTDOT] = "..",
+    [TOKEN_IDENTIFIER] = "identifier",
+    [TOKEN_INTEGER_LITERAL] = "integer literal", [TOKEN_REAL_LITERAL] = "real literal",
+    [TOKEN_BOOLEAN_LITERAL] = "boolean literal", [TOKEN_STRING_LITERAL] = "string literal",
+    [TOKEN_EOF] = "end of file", [TOKEN_ERROR] = "invalid token",
+};
+
+static const char *tokenSpelling(int type) {
+    if (type < 0 || type >= (int)(sizeof(token_spellings) / sizeof(token_spellings[0]))) return NULL;
+    return token_spellings[type];
+}
+
+static void *checkedRealloc(void *memory, size_t size) {
+    void *result = realloc(memory, size);
+    if (!result) {
+        fprintf(stderr, "Erro de alocação de memória nos diagnósticos\n");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+void initDiagnostics(DiagnosticBuffer *buffer) {
+    buffer->records = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+    initArena(&buffer->strings);
+    buffer->sorted = true;
+    buffer->errors = 0;
+    buffer->warnings = 0;
+}
+
+void clearDiagnostics(DiagnosticBuffer *buffer) {
+    freeArena(&buffer->strings);
+    buffer->count = 0;
+    buffer->sorted = true;
+    buffer->errors = 0;
+    buffer->warnings = 0;
+}
+
+void freeDiagnostics(DiagnosticBuffer *buffer) {
+    freeArena(&buffer->strings);
+    free(buffer->records);
+    initDiagnostics(buffer);
+}
+
+// Sem sinal, a linha -1 (fim da entrada) vem depois de todas as outras
+static int comparePosition(const Diagnostic *a, const Diagnostic *b) {
+    unsigned line_a = (unsigned)a->line, line_b = (unsigned)b->line;
+    if (line_a != line_b) return line_a < line_b ? -1 : 1;
+    if (a->column != b->column) return a->column < b->column ? -1 : 1;
+    return 0;
+}
+
+static int compareRecords(const void *a, const void *b) {
+    const Diagnostic *x = a, *y = b;
+    int order = comparePosition(x, y);
+    if (order != 0) return order;
+    return x->sequence < y->sequence ? -1 : x->sequence > y->sequence;
+}
+
+static Diagnostic *addRecord(DiagnosticBuffer *buffer, DiagnosticCode code, int line, int column) {
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 64;
+        buffer->records = checkedRealloc(buffer->records, sizeof(Diagnostic) * buffer->capacity);
+    }
+    Diagnostic *record = &buffer->records[buffer->count];
+    *record = (Diagnostic){.code = (uint16_t)code, .severity = (uint8_t)catalog[code].severity,
+                           .line = line, .column = column, .sequence = (uint32_t)buffer->count};
+    if (buffer->count > 0 && comparePosition(record - 1, record) > 0) buffer->sorted = false;
+    buffer->count++;
+    if (record->severity == SEVERITY_ERROR) buffer->errors++; else buffer->warnings++;
+    return record;
+}
+
+void reportDiagnostic(DiagnosticBuffer *buffer, DiagnosticCode code, int line, int column, ...) {
+    Diagnostic *record = addRecord(buffer, code, line, column);
+    va_list args;
+    va_start(args, column);
+    int texts = 0, numbers = 0;
+    for (const char *c = catalog[code].message; *c; c++) {
+        if (*c != '%') continue;
+        c++;
+        if (*c == 's' && texts < DIAGNOSTIC_TEXTS) {
+            const char *text = va_arg(args, const char *);
+            record->texts[texts++] = arenaStrdup(&buffer->strings, text ? text : "");
+        } else if ((*c == 'd' || *c == 't') && numbers < DIAGNOSTIC_NUMBERS) {
+            record->numbers[numbers++] = va_arg(args, int);
+        }
+    }
+    va_end(args);
+}
+
+void appendDiagnostics(DiagnosticBuffer *buffer, const DiagnosticBuffer *source, int line_offset) {
+    for (int i = 0; i < source->count; i++) {
+        const Diagnostic *from = &source->records[i];
+        int line = from->line > 0 ? from->line + line_offset : from->line;
+        Diagnostic *record = addRecord(buffer, (DiagnosticCode)from->code, line, from->column);
+        for (int k = 0; k < DIAGNOSTIC_TEXTS && from->texts[k]; k++) {
+            record->texts[k] = arenaStrdup(&buffer->strings, from->texts[k]);
+        }
+        memcpy(record->numbers, from->numbers, sizeof(record->numbers));
+    }
+}
+
+static bool sameRecord(const Diagnostic *a, const Diagnostic *b) {
+    if (a->code != b->code || a->line != b->line || a->column != b->column) return false;
+    if (memcmp(a->numbers, b->numbers, sizeof(a->numbers)) != 0) return false;
+    for (int k = 0; k < DIAGNOSTIC_TEXTS; k++) {
+        if (!a->texts[k] || !b->texts[k]) {
+            if (a->texts[k] != b->texts[k]) return false;
+        } else if (strcmp(a->texts[k], b->texts[k]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Os registros quase sempre chegam em ordem: a ordenação só roda se algum veio fora dela.
+// Repetições têm a mesma posição, então basta compará-las com os registros já mantidos
+// dessa posição
+void finishDiagnostics(DiagnosticBuffer *buffer) {
+    if (!buffer->sorted) qsort(buffer->records, buffer->count, sizeof(Diagnostic), compareRecords);
+    buffer->sorted = true;
+    int kept = 0;
+    buffer->errors = buffer->warnings = 0;
+    for (int i = 0; i < buffer->count; i++) {
+        Diagnostic *record = &buffer->records[i];
+        bool repeated = false;
+        for (int j = kept - 1; j >= 0 && comparePosition(&buffer->records[j], record) == 0 && !repeated; j--) {
+            repeated = sameRecord(&buffer->records[j], record);
+        }
+        if (repeated) continue;
+        buffer->records[kept++] = *record;
+        if (record->severity == SEVERITY_ERROR) buffer->errors++; else buffer->warnings++;
+    }
+    buffer->count = kept;
+}
+
+// Saída em blocos: uma escrita para cada 64 KB de mensagens
+typedef struct {
+    FILE *file;
+    size_t length;
+    char data[OUTPUT_BUFFER_SIZE];
+} Output;
+
+static void flushOutput(Output *out) {
+    fwrite(out->data, 1, out->length, out->file);
+    out->length = 0;
+}
+
+static void putText(Output *out, const char *text, size_t length) {
+    if (out->length + length > OUTPUT_BUFFER_SIZE) {
+        flushOutput(out);
+        if (length > OUTPUT_BUFFER_SIZE) {
+            fwrite(text, 1, length, out->file);
+            return;
+        }
+    }
+    memcpy(out->data + out->length, text, length);
+    out->length += length;
+}
+
+static void putString(Output *out, const char *text) {
+    putText(out, text, strlen(text));
+}
+
+static void putNumber(Output *out, long long value) {
+    char digits[24];
+    int position = sizeof(digits);
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[--position] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) digits[--position] = '-';
+    putText(out, digits + position, sizeof(digits) - position);
+}
+
+// Texto escapado para uma string JSON, sem as aspas
+static void putJsonText(Output *out, const char *text) {
+    static const char hex[] = "0123456789abcdef";
+    const char *run = text;
+    for (const char *c = text; *c; c++) {
+        unsigned char byte = (unsigned char)*c;
+        if (byte >= 0x20 && byte != '"' && byte != '\\') continue;
+        putText(out, run, (size_t)(c - run));
+        if (byte == '"' || byte == '\\') {
+            char escaped[2] = {'\\', (char)byte};
+            putText(out, escaped, 2);
+        } else {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 15]};
+            putText(out, escaped, 6);
+        }
+        run = c + 1;
+    }
+    putString(out, run);
+}
+
+// Texto da mensagem com os argumentos do registro; no JSON os textos já vêm escapados
+static void putMessage(Output *out, const Diagnostic *record, bool json) {
+    const char *message = catalog[record->code].message;
+    const char *run = message;
+    int texts = 0, numbers = 0;
+    for (const char *c = message; *c; c++) {
+        if (*c != '%') continue;
+        putText(out, run, (size_t)(c - run));
+        c++;
+        if (*c == 's') {
+            const char *text = texts < DIAGNOSTIC_TEXTS && record->texts[texts] ? record->texts[texts] : "";
+            texts++;
+            if (json) putJsonText(out, text); else putString(out, text);
+        } else if (*c == 'd') {
+            putNumber(out, numbers < DIAGNOSTIC_NUMBERS ? record->numbers[numbers] : 0);
+            numbers++;
+        } else if (*c == 't') {
+            // Palavras-chave e símbolos entre aspas; classes (identifier, end of file) como estão
+            int type = numbers < DIAGNOSTIC_NUMBERS ? record->numbers[numbers] : -1;
+            const char *spelling = tokenSpelling(type);
+            numbers++;
+            if (!spelling) {
+                putString(out, "token type ");
+                putNumber(out, type);
+            } else if (type < TOKEN_IDENTIFIER) {
+                putText(out, "'", 1);
+                if (json) putJsonText(out, spelling); else putString(out, spelling);
+                putText(out, "'", 1);
+            } else {
+                putString(out, spelling);
+            }
+        }
+        run = c + 1;
+    }
+    putString(out, run);
+}
+
+static void putTextRecord(Output *out, const Diagnostic *record) {
+    putString(out, catalog[record->code].syntax ? "Syntax " : "Semantic ");
+    putString(out, record->severity == SEVERITY_ERROR ? "Error: " : "Warning: ");
+    putMessage(out, record, false);
+    PositionStyle position = catalog[record->code].position;
+    if (position != POSITION_NONE) {
+        putString(out, " at line ");
+        putNumber(out, record->line);
+        if (position == POSITION_COLUMN) {
+            putString(out, ", column ");
+            putNumber(out, record->column);
+        }
+    }
+    putText(out, "\n", 1);
+}
+
+static void putJsonRecord(Output *out, const Diagnostic *record) {
+    putString(out, "{\"code\":\"");
+    putString(out, catalog[record->code].name);
+    putString(out, record->severity == SEVERITY_ERROR ? "\",\"severity\":\"error\"" : "\",\"severity\":\"warning\"");
+    if (record->line > 0) {
+        putString(out, ",\"line\":");
+        putNumber(out, record->line);
+        if (record->column > 0) {
+            putString(out, ",\"column\":");
+            putNumber(out, record->column);
+        }
+    }
+    putString(out, ",\"message\":\"");
+    putMessage(out, record, true);
+    putText(out, "\"", 1);
+    const char *expected = record->code == DIAG_EXPECTED_TOKEN ? tokenSpelling(record->numbers[0]) : NULL;
+    if (expected) {
+        putString(out, ",\"expected\":\"");
+        putJsonText(out, expected);
+        putText(out, "\"", 1);
+    }
+    putText(out, "}", 1);
+}
+
+void writeDiagnostics(DiagnosticBuffer *buffer, FILE *output, DiagnosticFormat format, int max_errors, bool fatal) {
+    finishDiagnostics(buffer);
+    Output *out = checkedRealloc(NULL, sizeof(Output));
+    out->file = output;
+    out->length = 0;
+
+    bool json = format == DIAGNOSTICS_JSON;
+    if (json) putString(out, "{\"diagnostics\":[");
+    int shown_errors = 0;
+    for (int i = 0; i < buffer->count; i++) {
+        const Diagnostic *record = &buffer->records[i];
+        if (max_errors > 0 && shown_errors == max_errors) break;
+        if (record->severity == SEVERITY_ERROR) shown_errors++;
+        if (json) {
+            if (i > 0) putText(out, ",", 1);
+            putText(out, "\n", 1);
+            putJsonRecord(out, record);
+        } else {
+            putTextRecord(out, record);
+        }
+    }
+    int omitted = buffer->errors - shown_errors;
+
+    if (json) {
+        putString(out, "\n],\"errors\":");
+        putNumber(out, buffer->errors);
+        putString(out, ",\"warnings\":");
+        putNumber(out, buffer->warnings);
+        putString(out, ",\"omitted\":");
+        putNumber(out, omitted);
+        putString(out, fatal ? ",\"fatal\":true}\n" : ",\"fatal\":false}\n");
+    } else {
+        if (omitted > 0) {
+            putString(out, "Too many errors: ");
+            putNumber(out, omitted);
+            putString(out, " more not shown.\n");
+        }
+        if (fatal) {
+            putString(out, "Analysis failed with fatal errors.\n");
+        } else if (buffer->errors == 0) {
+            putString(out, "Analysis completed successfully with no errors.\n");
+        } else {
+            putString(out, "Analysis completed with ");
+            putNumber(out, buffer->errors);
+            putString(out, " errors.\n");
+        }
+    }
+    flushOutput(out);
+    free(out);
+}
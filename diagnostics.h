@@ -0,0 +1,111 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "arena.h"
+
+// Diagnósticos do parser e da semântica. Quem encontra o erro só anota um registro
+// (código, severidade, posição e argumentos); a mensagem é montada uma única vez no fim,
+// por writeDiagnostics, depois de ordenar por posição e tirar as repetições
+
+typedef enum {
+    // Sintaxe
+    DIAG_EXPECTED_TOKEN,           // %t: TokenType esperado
+    DIAG_UNEXPECTED_END,
+    DIAG_INVALID_EXPRESSION,
+    DIAG_EXPECTED_EXPRESSION,
+    DIAG_UNEXPECTED_STATEMENT,
+    // Declarações
+    DIAG_INVALID_TYPE,
+    DIAG_VARIABLE_REDECLARED,
+    DIAG_PROCEDURE_REDECLARED,
+    DIAG_TOO_MANY_PARAMETERS,      // %s, %d, %d: procedimento, parâmetros e o limite
+    DIAG_INTERFACE_MISMATCH,
+    DIAG_MISSING_BODY,
+    DIAG_UNIT_SELF,
+    DIAG_UNIT_NOT_LOADED,
+    DIAG_UNIT_REPEATED,
+    DIAG_ARRAY_BOUNDS,
+    DIAG_ARRAY_PLACEMENT,
+    // Tipos e nomes
+    DIAG_ARITHMETIC_OPERANDS,
+    DIAG_DIVIDE_OPERANDS,
+    DIAG_INTEGER_OPERANDS,
+    DIAG_DIVISION_BY_ZERO,
+    DIAG_LOGICAL_OPERANDS,
+    DIAG_COMPARISON_OPERANDS,
+    DIAG_NOT_OPERAND,
+    DIAG_SIGN_OPERAND,
+    DIAG_UNDECLARED_IDENTIFIER,
+    DIAG_PROCEDURE_AS_VALUE,
+    DIAG_ARRAY_AS_VALUE,
+    DIAG_NOT_ARRAY,
+    DIAG_INDEX_TYPE,
+    DIAG_UNSUPPORTED_EXPRESSION,
+    DIAG_CONDITION_TYPE,
+    DIAG_IMPLICIT_CONVERSION,
+    DIAG_ASSIGN_TYPE,
+    DIAG_ASSIGN_PROCEDURE,
+    DIAG_UNDECLARED_PROCEDURE,
+    DIAG_NOT_PROCEDURE,
+    DIAG_ARGUMENT_COUNT,
+    DIAG_FOR_VARIABLE_TYPE,
+    DIAG_FOR_BOUNDS_TYPE,
+    DIAG_READ_BOOLEAN,
+    DIAG_INVALID_STATEMENT,
+    DIAG_CODE_COUNT
+} DiagnosticCode;
+
+typedef enum {
+    SEVERITY_ERROR,
+    SEVERITY_WARNING
+} DiagnosticSeverity;
+
+typedef enum {
+    DIAGNOSTICS_TEXT,
+    DIAGNOSTICS_JSON
+} DiagnosticFormat;
+
+#define DIAGNOSTIC_TEXTS 3
+#define DIAGNOSTIC_NUMBERS 2
+
+typedef struct {
+    uint16_t code;            // DiagnosticCode
+    uint8_t severity;         // DiagnosticSeverity
+    int line;                 // -1: fim da entrada, sem posição
+    int column;               // 0 quando só a linha é conhecida
+    uint32_t sequence;        // Ordem de chegada, que desempata a ordenação
+    const char *texts[DIAGNOSTIC_TEXTS];     // Cópias na arena do buffer
+    int numbers[DIAGNOSTIC_NUMBERS];
+} Diagnostic;
+
+typedef struct {
+    Diagnostic *records;
+    int count;
+    int capacity;
+    Arena strings;
+    bool sorted;              // Os registros chegaram em ordem de posição
+    int errors;               // Contagens dos registros atuais
+    int warnings;
+} DiagnosticBuffer;
+
+void initDiagnostics(DiagnosticBuffer *buffer);
+void clearDiagnostics(DiagnosticBuffer *buffer);
+void freeDiagnostics(DiagnosticBuffer *buffer);
+
+// Anota um diagnóstico. Os argumentos seguem a mensagem do código, como num printf:
+// %s para textos (copiados), %d para números e %t para um TokenType, escrito pela grafia;
+// argumentos a mais são ignorados
+void reportDiagnostic(DiagnosticBuffer *buffer, DiagnosticCode code, int line, int column, ...);
+// Copia os registros de source para buffer, com as linhas somadas a line_offset
+void appendDiagnostics(DiagnosticBuffer *buffer, const DiagnosticBuffer *source, int line_offset);
+// Ordena por posição (na ordem de chegada em cada posição) e remove as repetições exatas
+void finishDiagnostics(DiagnosticBuffer *buffer);
+
+// Ordena e grava os diagnósticos seguidos do resumo da análise. Com max_errors > 0, os
+// erros depois do limite só entram na contagem; fatal indica uma análise interrompida
+void writeDiagnostics(DiagnosticBuffer *buffer, FILE *output, DiagnosticFormat format, int max_errors, bool fatal);
+
+#endif
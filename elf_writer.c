@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "x86.h"
+
+// Escrita de objetos ELF64 relocáveis (x86-64, little-endian) sem depender de <elf.h>
+
+typedef struct {
+    uint8_t ident[16];
+    uint16_t type;
+    uint16_t machine;
+    uint32_t version;
+    uint64_t entry;
+    uint64_t phoff;
+    uint64_t shoff;
+    uint32_t flags;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t phnum;
+    uint16_t shentsize;
+    uint16_t shnum;
+    uint16_t shstrndx;
+} ElfHeader;
+
+typedef struct {
+    uint32_t name;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t addr;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+    uint32_t info;
+    uint64_t addralign;
+    uint64_t entsize;
+} ElfSection;
+
+typedef struct {
+    uint32_t name;
+    uint8_t info;
+    uint8_t other;
+    uint16_t shndx;
+    uint64_t value;
+    uint64_t size;
+} ElfSymbol;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t info;
+    int64_t addend;
+} ElfRela;
+
+enum {
+    SHT_PROGBITS = 1, SHT_SYMTAB = 2, SHT_STRTAB = 3, SHT_RELA = 4, SHT_NOBITS = 8,
+    SHF_WRITE = 1, SHF_ALLOC = 2, SHF_EXECINSTR = 4, SHF_INFO_LINK = 0x40,
+    STB_LOCAL = 0, STB_GLOBAL = 1, STT_NOTYPE = 0, STT_FUNC = 2, STT_SECTION = 3,
+    R_X86_64_PC32 = 2, R_X86_64_PLT32 = 4
+};
+
+// Índices das seções no arquivo
+enum {
+    SEC_NULL, SEC_TEXT, SEC_RODATA, SEC_BSS, SEC_RELA_TEXT, SEC_SYMTAB, SEC_STRTAB,
+    SEC_SHSTRTAB, SEC_NOTE_STACK, SEC_COUNT
+};
+
+// Tabela de strings em construção
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} StringTable;
+
+static uint32_t addString(StringTable *table, const char *text) {
+    size_t length = strlen(text) + 1;
+    if (table->size + length > table->capacity) {
+        table->capacity = (table->size + length) * 2;
+        table->data = realloc(table->data, table->capacity);
+        if (!table->data) {
+            fprintf(stderr, "Erro de alocação de memória ao escrever objeto ELF\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(table->data + table->size, text, length);
+    table->size += length;
+    return (uint32_t)(table->size - length);
+}
+
+static void pad(FILE *out, long alignment) {
+    while (ftell(out) % alignment != 0) fputc(0, out);
+}
+
+bool writeElfObject(const X86Program *program, const X86Image *image, FILE *out) {
+    StringTable strtab = {0}, shstrtab = {0};
+    addString(&strtab, "");
+    addString(&shstrtab, "");
+
+    // Símbolos locais primeiro: seções e procedimentos; depois main e o runtime
+    int symbol_count = 1 + 3 + program->function_count + RT_COUNT;
+    ElfSymbol *symbols = calloc(symbol_count, sizeof(ElfSymbol));
+    ElfRela *relas = calloc(image->reloc_count + 1, sizeof(ElfRela));
+    if (!symbols || !relas) {
+        fprintf(stderr, "Erro de alocação de memória ao escrever objeto ELF\n");
+        exit(EXIT_FAILURE);
+    }
+    int count = 1;
+    int section_symbol[SEC_COUNT] = {0};
+    for (int section = SEC_TEXT; section <= SEC_BSS; section++) {
+        section_symbol[section] = count;
+        symbols[count++] = (ElfSymbol){.info = (STB_LOCAL << 4) | STT_SECTION, .shndx = (uint16_t)section};
+    }
+    for (int i = 0; i < program->function_count; i++) {
+        if (i == program->main_function) continue;
+        int end = i + 1 < program->function_count ? image->function_offsets[i + 1] : image->text_size;
+        symbols[count++] = (ElfSymbol){
+            .name = addString(&strtab, program->functions[i].symbol),
+            .info = (STB_LOCAL << 4) | STT_FUNC, .shndx = SEC_TEXT,
+            .value = (uint64_t)image->function_offsets[i],
+            .size = (uint64_t)(end - image->function_offsets[i])
+        };
+    }
+    int first_global = count;
+    int main_index = program->main_function;
+    int main_end = main_index + 1 < program->function_count ? image->function_offsets[main_index + 1] : image->text_size;
+    symbols[count++] = (ElfSymbol){
+        .name = addString(&strtab, program->functions[main_index].symbol),
+        .info = (STB_GLOBAL << 4) | STT_FUNC, .shndx = SEC_TEXT,
+        .value = (uint64_t)image->function_offsets[main_index],
+        .size = (uint64_t)(main_end - image->function_offsets[main_index])
+    };
+    int runtime_symbol = count;
+    for (int i = 0; i < RT_COUNT; i++) {
+        symbols[count++] = (ElfSymbol){
+            .name = addString(&strtab, x86RuntimeNames[i]),
+            .info = (STB_GLOBAL << 4) | STT_NOTYPE
+        };
+    }
+
+    for (int i = 0; i < image->reloc_count; i++) {
+        const X86Reloc *reloc = &image->relocs[i];
+        uint64_t symbol, type;
+        if (reloc->target == TARGET_RUNTIME) {
+            symbol = (uint64_t)(runtime_symbol + reloc->index);
+            type = R_X86_64_PLT32;
+        } else {
+            symbol = (uint64_t)section_symbol[reloc->target == TARGET_BSS ? SEC_BSS : SEC_RODATA];
+            type = R_X86_64_PC32;
+        }
+        relas[i] = (ElfRela){(uint64_t)reloc->offset, (symbol << 32) | type, reloc->addend};
+    }
+
+    ElfSection sections[SEC_COUNT];
+    memset(sections, 0, sizeof(sections));
+    sections[SEC_TEXT] = (ElfSection){.name = addString(&shstrtab, ".text"), .type = SHT_PROGBITS,
+                                      .flags = SHF_ALLOC | SHF_EXECINSTR, .addralign = 16};
+    sections[SEC_RODATA] = (ElfSection){.name = addString(&shstrtab, ".rodata"), .type = SHT_PROGBITS,
+                                        .flags = SHF_ALLOC, .addralign = 16};
+    sections[SEC_BSS] = (ElfSection){.name = addString(&shstrtab, ".bss"), .type = SHT_NOBITS,
+                                     .flags = SHF_ALLOC | SHF_WRITE, .addralign = 8,
+                                     .size = (uint64_t)image->bss_size};
+    sections[SEC_RELA_TEXT] = (ElfSection){.name = addString(&shstrtab, ".rela.text"), .type = SHT_RELA,
+                                           .flags = SHF_INFO_LINK, .link = SEC_SYMTAB, .info = SEC_TEXT,
+                                           .addralign = 8, .entsize = sizeof(ElfRela)};
+    sections[SEC_SYMTAB] = (ElfSection){.name = addString(&shstrtab, ".symtab"), .type = SHT_SYMTAB,
+                                        .link = SEC_STRTAB, .info = (uint32_t)first_global,
+                                        .addralign = 8, .entsize = sizeof(ElfSymbol)};
+    sections[SEC_STRTAB] = (ElfSection){.name = addString(&shstrtab, ".strtab"), .type = SHT_STRTAB,
+                                        .addralign = 1};
+    sections[SEC_SHSTRTAB] = (ElfSection){.name = addString(&shstrtab, ".shstrtab"), .type = SHT_STRTAB,
+                                          .addralign = 1};
+    sections[SEC_NOTE_STACK] = (ElfSection){.name = addString(&shstrtab, ".note.GNU-stack"),
+                                            .type = SHT_PROGBITS, .addralign = 1};
+
+    // Conteúdo das seções logo após o cabeçalho; a tabela de seções fica no fim
+    ElfHeader header;
+    memset(&header, 0, sizeof(header));
+    fseek(out, sizeof(header), SEEK_SET);
+
+    pad(out, 16);
+    sections[SEC_TEXT].offset = (uint64_t)ftell(out);
+    sections[SEC_TEXT].size = (uint64_t)image->text_size;
+    fwrite(image->text, 1, image->text_size, out);
+
+    pad(out, 16);
+    sections[SEC_RODATA].offset = (uint64_t)ftell(out);
+    sections[SEC_RODATA].size = (uint64_t)image->rodata_size;
+    fwrite(image->rodata, 1, image->rodata_size, out);
+    sections[SEC_BSS].offset = (uint64_t)ftell(out);
+
+    pad(out, 8);
+    sections[SEC_RELA_TEXT].offset = (uint64_t)ftell(out);
+    sections[SEC_RELA_TEXT].size = sizeof(ElfRela) * (uint64_t)image->reloc_count;
+    fwrite(relas, sizeof(ElfRela), image->reloc_count, out);
+
+    sections[SEC_SYMTAB].offset = (uint64_t)ftell(out);
+    sections[SEC_SYMTAB].size = sizeof(ElfSymbol) * (uint64_t)count;
+    fwrite(symbols, sizeof(ElfSymbol), count, out);
+
+    sections[SEC_STRTAB].offset = (uint64_t)ftell(out);
+    sections[SEC_STRTAB].size = strtab.size;
+    fwrite(strtab.data, 1, strtab.size, out);
+
+    sections[SEC_SHSTRTAB].offset = (uint64_t)ftell(out);
+    sections[SEC_SHSTRTAB].size = shstrtab.size;
+    fwrite(shstrtab.data, 1, shstrtab.size, out);
+    sections[SEC_NOTE_STACK].offset = (uint64_t)ftell(out);
+
+    pad(out, 8);
+    long section_table = ftell(out);
+    fwrite(sections, sizeof(ElfSection), SEC_COUNT, out);
+
+    memcpy(header.ident, "\x7F" "ELF", 4);
+    header.ident[4] = 2;   // ELFCLASS64
+    header.ident[5] = 1;   // Little-endian
+    header.ident[6] = 1;   // EV_CURRENT
+    header.type = 1;       // ET_REL
+    header.machine = 62;   // EM_X86_64
+    header.version = 1;
+    header.shoff = (uint64_t)section_table;
+    header.ehsize = sizeof(ElfHeader);
+    header.shentsize = sizeof(ElfSection);
+    header.shnum = SEC_COUNT;
+    header.shstrndx = SEC_SHSTRTAB;
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+
+    bool ok = !ferror(out);
+    free(strtab.data);
+    free(shstrtab.data);
+    free(symbols);
+    free(relas);
+    return ok;
+}
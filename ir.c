@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *grown = realloc(array, size);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static void appendInt(int **array, int *count, int *capacity, int value) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 8;
+        *array = checkedRealloc(*array, sizeof(int) * *capacity);
+    }
+    (*array)[(*count)++] = value;
+}
+
+const char *irOpcodeName(IrOpcode op) {
+    static const char *names[] = {
+#define X(name) #name,
+        IR_OPCODES(X)
+#undef X
+    };
+    return op < IR_COUNT ? names[op] : "?";
+}
+
+int irAddBlock(IrFunction *f) {
+    if (f->block_count == f->block_capacity) {
+        f->block_capacity = f->block_capacity ? f->block_capacity * 2 : 16;
+        f->blocks = checkedRealloc(f->blocks, sizeof(IrBlock) * f->block_capacity);
+    }
+    int id = f->block_count++;
+    memset(&f->blocks[id], 0, sizeof(IrBlock));
+    f->blocks[id].frequency = -1;
+    return id;
+}
+
+// Cria uma instrução no fim do bloco (ou solta, se block < 0); devolve seu índice
+int irAddInst(IrFunction *f, int block, IrOpcode op, DataType type, int operand_count) {
+    if (f->inst_count == f->inst_capacity) {
+        f->inst_capacity = f->inst_capacity ? f->inst_capacity * 2 : 64;
+        f->insts = checkedRealloc(f->insts, sizeof(IrInst) * f->inst_capacity);
+    }
+    int id = f->inst_count++;
+    IrInst *inst = &f->insts[id];
+    memset(inst, 0, sizeof(*inst));
+    inst->op = op;
+    inst->type = (uint8_t)type;
+    inst->block = block;
+    inst->operand_count = operand_count;
+    if (operand_count > 0) inst->operands = arenaAlloc(&f->arena, sizeof(int) * operand_count);
+    if (block >= 0) {
+        IrBlock *b = &f->blocks[block];
+        appendInt(&b->insts, &b->count, &b->capacity, id);
+    }
+    return id;
+}
+
+void irInsertInst(IrFunction *f, int block, int position, int inst) {
+    IrBlock *b = &f->blocks[block];
+    appendInt(&b->insts, &b->count, &b->capacity, inst);
+    memmove(b->insts + position + 1, b->insts + position, sizeof(int) * (b->count - 1 - position));
+    b->insts[position] = inst;
+    f->insts[inst].block = block;
+}
+
+void irAddEdge(IrFunction *f, int from, int to) {
+    f->blocks[from].succs[f->blocks[from].succ_count++] = to;
+    IrBlock *b = &f->blocks[to];
+    appendInt(&b->preds, &b->pred_count, &b->pred_capacity, from);
+}
+
+// Remove a aresta e o operando correspondente dos phis do destino
+void irRemoveEdge(IrFunction *f, int from, int to) {
+    IrBlock *source = &f->blocks[from];
+    for (int i = 0; i < source->succ_count; i++) {
+        if (source->succs[i] == to) {
+            if (i == 0) source->succs[0] = source->succs[1];
+            source->succ_count--;
+            break;
+        }
+    }
+    IrBlock *target = &f->blocks[to];
+    int index = -1;
+    for (int i = 0; i < target->pred_count && index < 0; i++) {
+        if (target->preds[i] == from) index = i;
+    }
+    if (index < 0) return;
+    memmove(target->preds + index, target->preds + index + 1, sizeof(int) * (target->pred_count - index - 1));
+    target->pred_count--;
+    for (int i = 0; i < target->count; i++) {
+        IrInst *inst = &f->insts[target->insts[i]];
+        if (inst->op != IR_PHI || inst->removed) continue;
+        memmove(inst->operands + index, inst->operands + index + 1, sizeof(int) * (inst->operand_count - index - 1));
+        inst->operand_count--;
+    }
+}
+
+static int resolve(const int *replacement, int value) {
+    while (replacement[value] >= 0 && replacement[value] != value) value = replacement[value];
+    return value;
+}
+
+// Substitui cada operando v por replacement[v] (seguindo cadeias); -1 mantém o valor
+void irReplaceUses(IrFunction *f, int *replacement) {
+    for (int i = 0; i < f->inst_count; i++) {
+        IrInst *inst = &f->insts[i];
+        if (inst->removed) continue;
+        for (int j = 0; j < inst->operand_count; j++) {
+            inst->operands[j] = resolve(replacement, inst->operands[j]);
+        }
+    }
+}
+
+// Retira das listas dos blocos as instruções removidas
+void irCompact(IrFunction *f) {
+    for (int b = 0; b < f->block_count; b++) {
+        IrBlock *block = &f->blocks[b];
+        int kept = 0;
+        for (int i = 0; i < block->count; i++) {
+            int id = block->insts[i];
+            if (!f->insts[id].removed && !block->removed) block->insts[kept++] = id;
+            else f->insts[id].removed = true;
+        }
+        block->count = kept;
+    }
+}
+
+int irLiveCount(const IrFunction *f) {
+    int count = 0;
+    for (int b = 0; b < f->block_count; b++) {
+        const IrBlock *block = &f->blocks[b];
+        if (block->removed) continue;
+        for (int i = 0; i < block->count; i++) {
+            if (!f->insts[block->insts[i]].removed) count++;
+        }
+    }
+    return count;
+}
+
+// Execuções de uma aresta, quando as frequências dos blocos a determinam: a origem
+// só tem esse sucessor ou o destino só tem essa origem; -1 caso contrário
+int64_t irEdgeFrequency(const IrFunction *f, int from, int to) {
+    const IrBlock *source = &f->blocks[from], *target = &f->blocks[to];
+    if (source->succ_count == 1) return source->frequency;
+    if (target->pred_count == 1) return target->frequency;
+    return -1;
+}
+
+// Instruções que não podem ser removidas mesmo sem uso. Divisões e acessos a arrays
+// podem gerar erro de execução, as divisões exceto quando o divisor é uma constante
+// diferente de zero.
+bool irHasSideEffects(const IrFunction *f, const IrInst *inst) {
+    switch (inst->op) {
+        case IR_STOREG: case IR_LOADX: case IR_STOREX: case IR_VLOOP: case IR_CALL:
+        case IR_WRITE_I: case IR_WRITE_R: case IR_WRITE_B: case IR_WRITE_S: case IR_WRITELN: case IR_READ_I: case IR_READ_R: case IR_PROFILE:
+        case IR_JMP: case IR_BR: case IR_RET:
+            return true;
+        case IR_DIV_I: case IR_MOD_I: {
+            const IrInst *divisor = &f->insts[inst->operands[1]];
+            return divisor->op != IR_CONST || divisor->constant.i == 0;
+        }
+        default:
+            return false;
+    }
+}
+
+// Ordem pós-ordem reversa a partir da entrada; devolve quantos blocos são alcançáveis
+int irReversePostorder(const IrFunction *f, int *order) {
+    int *stack = malloc(sizeof(int) * (f->block_count + 1));
+    int *next_succ = calloc(f->block_count + 1, sizeof(int));
+    bool *visited = calloc(f->block_count + 1, sizeof(bool));
+    if (!stack || !next_succ || !visited) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    int count = 0, depth = 0;
+    stack[depth++] = 0;
+    visited[0] = true;
+    while (depth > 0) {
+        int b = stack[depth - 1];
+        const IrBlock *block = &f->blocks[b];
+        if (next_succ[b] < block->succ_count) {
+            int s = block->succs[next_succ[b]++];
+            if (!visited[s]) {
+                visited[s] = true;
+                stack[depth++] = s;
+            }
+        } else {
+            order[count++] = b;
+            depth--;
+        }
+    }
+    for (int i = 0; i < count / 2; i++) {
+        int t = order[i];
+        order[i] = order[count - 1 - i];
+        order[count - 1 - i] = t;
+    }
+    free(stack);
+    free(next_succ);
+    free(visited);
+    return count;
+}
+
+// Dominadores imediatos pelo algoritmo iterativo de Cooper, Harvey e Kennedy;
+// idom[b] = -1 para blocos inalcançáveis e idom[entrada] = entrada
+void irDominators(const IrFunction *f, const int *order, int count, int *idom) {
+    int *rpo_index = malloc(sizeof(int) * (f->block_count + 1));
+    if (!rpo_index) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int b = 0; b < f->block_count; b++) {
+        idom[b] = -1;
+        rpo_index[b] = -1;
+    }
+    for (int i = 0; i < count; i++) rpo_index[order[i]] = i;
+    idom[order[0]] = order[0];
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 1; i < count; i++) {
+            int b = order[i];
+            const IrBlock *block = &f->blocks[b];
+            int new_idom = -1;
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (rpo_index[pred] < 0 || idom[pred] < 0) continue;
+                if (new_idom < 0) {
+                    new_idom = pred;
+                    continue;
+                }
+                int x = pred, y = new_idom;
+                while (x != y) {
+                    while (rpo_index[x] > rpo_index[y]) x = idom[x];
+                    while (rpo_index[y] > rpo_index[x]) y = idom[y];
+                }
+                new_idom = x;
+            }
+            if (new_idom >= 0 && idom[b] != new_idom) {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    free(rpo_index);
+}
+
+bool irDominates(const int *idom, const int *rpo_index, int a, int b) {
+    while (b != a && rpo_index[b] > rpo_index[a]) b = idom[b];
+    return a == b;
+}
+
+static void printValue(const IrFunction *f, int id, FILE *out) {
+    const IrInst *inst = &f->insts[id];
+    if (inst->op == IR_CONST) {
+        if (inst->type == TYPE_REAL) fprintf(out, "%g", inst->constant.r);
+        else fprintf(out, "%lld", (long long)inst->constant.i);
+    } else {
+        fprintf(out, "v%d", id);
+    }
+}
+
+void dumpIr(const IrProgram *program, FILE *out) {
+    for (int fi = 0; fi < program->function_count; fi++) {
+        const IrFunction *f = &program->functions[fi];
+        fprintf(out, "function %d %s (params %d)\n", fi, f->name, f->param_count);
+        for (int b = 0; b < f->block_count; b++) {
+            const IrBlock *block = &f->blocks[b];
+            if (block->removed) continue;
+            fprintf(out, "  b%d:", b);
+            if (block->frequency >= 0) fprintf(out, "  ; freq %lld", (long long)block->frequency);
+            if (block->pred_count > 0) {
+                fprintf(out, "  ; preds");
+                for (int p = 0; p < block->pred_count; p++) fprintf(out, " b%d", block->preds[p]);
+            }
+            fputc('\n', out);
+            for (int i = 0; i < block->count; i++) {
+                int id = block->insts[i];
+                const IrInst *inst = &f->insts[id];
+                if (inst->removed) continue;
+                fprintf(out, "    ");
+                if (inst->type != TYPE_UNKNOWN) fprintf(out, "v%d = ", id);
+                fprintf(out, "%s", irOpcodeName(inst->op));
+                if (inst->op == IR_CONST) {
+                    fputc(' ', out);
+                    printValue(f, id, out);
+                } else if (inst->op == IR_PARAM || inst->op == IR_LOADG || inst->op == IR_STOREG ||
+                           inst->op == IR_LOADX || inst->op == IR_STOREX || inst->op == IR_VLOOP ||
+                           inst->op == IR_CALL || inst->op == IR_WRITE_S || inst->op == IR_PROFILE) {
+                    fprintf(out, " #%d", inst->index);
+                }
+                for (int j = 0; j < inst->operand_count; j++) {
+                    fprintf(out, j == 0 ? " " : ", ");
+                    printValue(f, inst->operands[j], out);
+                }
+                if (inst->op == IR_JMP || inst->op == IR_BR) {
+                    fprintf(out, " ->");
+                    for (int s = 0; s < block->succ_count; s++) fprintf(out, " b%d", block->succs[s]);
+                }
+                if (inst->type != TYPE_UNKNOWN) fprintf(out, " : %s", typeName((DataType)inst->type));
+                fputc('\n', out);
+            }
+        }
+    }
+}
+
+void irFreeFunction(IrFunction *f) {
+    for (int b = 0; b < f->block_count; b++) {
+        free(f->blocks[b].insts);
+        free(f->blocks[b].preds);
+    }
+    free(f->blocks);
+    free(f->insts);
+    free(f->param_types);
+    free(f->name);
+    freeArena(&f->arena);
+}
+
+void freeIr(IrProgram *program) {
+    for (int i = 0; i < program->function_count; i++) {
+        irFreeFunction(&program->functions[i]);
+    }
+    for (int i = 0; i < program->string_count; i++) {
+        free(program->strings[i]);
+    }
+    free(program->functions);
+    free(program->strings);
+    free(program->global_types);
+    free(program->arrays);
+    for (int i = 0; i < program->kernel_count; i++) {
+        free(program->kernels[i].ops);
+    }
+    free(program->kernels);
+    memset(program, 0, sizeof(*program));
+}
@@ -0,0 +1,205 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "ast.h"
+#include "arena.h"
+#include "bytecode.h"
+#include "symbol_table.h"
+
+// Representação intermediária em SSA sobre um grafo de fluxo de controle.
+// Cada instrução define no máximo um valor, identificado pelo índice da instrução.
+// As operações aritméticas têm o mesmo nome e semântica dos opcodes do bytecode.
+#define IR_ARITHMETIC(X) \
+    X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(MOD_I) X(NEG_I) \
+    X(ADD_R) X(SUB_R) X(MUL_R) X(DIV_R) X(NEG_R) X(I2R) \
+    X(EQ_I) X(NE_I) X(LT_I) X(LE_I) X(GT_I) X(GE_I) \
+    X(EQ_R) X(NE_R) X(LT_R) X(LE_R) X(GT_R) X(GE_R) \
+    X(AND) X(OR) X(NOT)
+
+//   CONST             valor constante (constant)
+//   PARAM             parâmetro index do procedimento
+//   PHI               um operando por predecessor, na ordem de preds
+//   COPY              cópia do operando
+//   LOADG / STOREG    lê / grava a global index
+//   LOADX             lê o elemento operands[0] do array index
+//   STOREX            grava operands[0] no elemento operands[1] do array index
+//   VLOOP             executa o kernel index com os operandos start, count, [redução],
+//                     entradas (vetorização); o valor é o da redução, ou 0 sem ela
+//   CALL              chama a função index com os operandos como argumentos; index < 0
+//                     é um procedimento importado de uma unit, opaco para os passes
+//   WRITE_*, READ_*   entrada e saída; WRITE_S escreve strings[index]
+//   PROFILE           soma 1 ao contador index (-fprofile-generate)
+//   JMP, BR, RET      terminadores; BR desvia para succs[0] se o operando for verdadeiro
+#define IR_OPCODES(X) \
+    X(CONST) X(PARAM) X(PHI) X(COPY) X(LOADG) X(STOREG) X(LOADX) X(STOREX) \
+    IR_ARITHMETIC(X) \
+    X(VLOOP) X(CALL) X(WRITE_I) X(WRITE_R) X(WRITE_B) X(WRITE_S) X(WRITELN) X(READ_I) X(READ_R) X(PROFILE) \
+    X(JMP) X(BR) X(RET)
+
+typedef enum {
+#define X(name) IR_##name,
+    IR_OPCODES(X)
+#undef X
+    IR_COUNT
+} IrOpcode;
+
+typedef struct {
+    IrOpcode op;
+    uint8_t type;             // DataType do valor produzido (TYPE_UNKNOWN se nenhum)
+    bool removed;
+    int block;
+    int line;
+    int column;
+    int *operands;            // Alocados na arena da função
+    int operand_count;
+    Value constant;           // CONST
+    int index;                // PARAM, LOADG, STOREG, LOADX, STOREX, VLOOP, CALL, WRITE_S, PROFILE
+} IrInst;
+
+typedef struct {
+    int *insts;               // Instruções na ordem de execução; phis primeiro
+    int count;
+    int capacity;
+    int *preds;
+    int pred_count;
+    int pred_capacity;
+    int succs[2];
+    int succ_count;
+    int64_t frequency;        // Execuções medidas (-fprofile-use) ou estimadas pelos passes; -1 sem perfil
+    bool removed;
+} IrBlock;
+
+typedef struct {
+    char *name;
+    IrInst *insts;
+    int inst_count;
+    int inst_capacity;
+    IrBlock *blocks;          // O bloco 0 é a entrada
+    int block_count;
+    int block_capacity;
+    int param_count;
+    uint8_t *param_types;
+    Arena arena;
+} IrFunction;
+
+typedef struct {
+    IrFunction *functions;    // Mesma numeração do bytecode: procedimentos e, por último, o bloco principal
+    int function_count;
+    int main_function;
+    char **strings;
+    int string_count;
+    int global_count;
+    uint8_t *global_types;
+    int counter_count;        // Contadores de PROFILE
+    ArrayInfo *arrays;        // Mesma disposição do bytecode
+    int array_count;
+    int array_slots;
+    Kernel *kernels;          // Criados pela vetorização, na ordem dos índices de VLOOP
+    int kernel_count;
+    bool library;             // Unit: todo procedimento é uma raiz do grafo de chamadas
+} IrProgram;
+
+// Tempo e efeito de cada passe, acumulados sobre todas as funções
+typedef struct {
+    const char *name;
+    double seconds;
+    int removed;              // Instruções eliminadas (negativo se o passe cria instruções)
+    int runs;
+} IrPassStats;
+
+#define IR_MAX_PASSES 16
+
+typedef struct {
+    int level;                // 0, 1 ou 2
+    int unroll;               // Fator de desdobramento dos laços contados; 1 desliga
+    int inline_limit;         // Tamanho máximo (instruções) de um procedimento expandido; 0 desliga
+    bool vectorize;           // Laços elemento a elemento sobre arrays viram VLOOP (-O2)
+} IrOptions;
+
+#define IR_DEFAULT_UNROLL 4
+#define IR_DEFAULT_INLINE 32
+
+// Laço natural com um único predecessor externo (o pré-cabeçalho)
+typedef struct {
+    int header;
+    int preheader;            // Termina em JMP para o cabeçalho
+    int parent;               // Laço imediatamente externo, -1 se nenhum
+    int *blocks;              // Blocos do laço em pós-ordem reversa; o cabeçalho primeiro
+    int block_count;
+} IrLoop;
+
+typedef struct {
+    IrLoop *loops;            // Cada laço aparece antes dos que o contêm
+    int count;
+    int *innermost;           // Laço mais interno de cada bloco, -1 fora de laços
+    int block_count;          // Blocos existentes na análise; os criados depois ficam fora dos laços
+} IrLoopInfo;
+
+typedef struct {
+    IrPassStats passes[IR_MAX_PASSES];
+    int pass_count;
+    int instructions_before;
+    int instructions_after;
+    int functions_removed;    // Procedimentos inalcançáveis a partir do bloco principal
+    int calls_inlined;
+    int loops_vectorized;
+} IrStats;
+
+// Perfil por bloco (ir_profile.c): os contadores entram logo depois de buildIr e o
+// perfil é aplicado no mesmo ponto, então os blocos têm a mesma numeração nas duas compilações
+typedef struct {
+    char **names;             // Funções na numeração de buildIr
+    int *first;               // Primeiro contador de cada função: um por bloco
+    int *blocks;
+    int function_count;
+    int counter_count;
+} IrProfileMap;
+
+uint64_t irSourceHash(const char *source);
+void irInstrumentBlocks(IrProgram *program, IrProfileMap *map);
+void irFreeProfileMap(IrProfileMap *map);
+bool irWriteProfile(const IrProfileMap *map, const uint64_t *counters, uint64_t source_hash, const char *path);
+// Devolve quantas funções receberam frequências, ou -1 se o arquivo não pôde ser lido
+int irApplyProfile(IrProgram *program, uint64_t source_hash, const char *path);
+int64_t irEdgeFrequency(const IrFunction *f, int from, int to);
+
+// Construção, otimização e tradução para bytecode
+bool buildIr(AstNode *program, SymbolTable *globals, IrProgram *out);
+void optimizeIr(IrProgram *program, const IrOptions *options, IrStats *stats);
+bool lowerIr(const IrProgram *program, BytecodeProgram *out);
+void freeIr(IrProgram *program);
+void irFreeFunction(IrFunction *f);
+void dumpIr(const IrProgram *program, FILE *out);
+const char *irOpcodeName(IrOpcode op);
+
+// Utilitários compartilhados pelos passes
+int irAddBlock(IrFunction *f);
+int irAddInst(IrFunction *f, int block, IrOpcode op, DataType type, int operand_count);
+void irInsertInst(IrFunction *f, int block, int position, int inst);
+void irAddEdge(IrFunction *f, int from, int to);
+void irRemoveEdge(IrFunction *f, int from, int to);
+void irReplaceUses(IrFunction *f, int *replacement);
+void irCompact(IrFunction *f);
+int irLiveCount(const IrFunction *f);
+bool irHasSideEffects(const IrFunction *f, const IrInst *inst);
+int irReversePostorder(const IrFunction *f, int *order);
+void irDominators(const IrFunction *f, const int *order, int count, int *idom);
+bool irDominates(const int *idom, const int *rpo_index, int a, int b);
+
+// Laços naturais (ir_loop.c); cria pré-cabeçalhos quando necessário
+void irFindLoops(IrFunction *f, IrLoopInfo *info);
+bool irLoopContains(const IrLoopInfo *info, int loop, int block);
+void irFreeLoops(IrLoopInfo *info);
+void irHoistInvariants(IrFunction *f);
+void irOptimizeInductionVariables(IrFunction *f);
+void irUnrollLoops(IrFunction *f, int factor);
+// Devolve quantos laços foram vetorizados; os kernels são acrescentados ao programa
+int irVectorizeLoops(IrProgram *program, IrFunction *f);
+
+// Grafo de chamadas (ir_inline.c); ambos retornam quantos procedimentos / chamadas tratou
+int irRemoveDeadFunctions(IrProgram *program);
+int irInlineCalls(IrProgram *program, int limit);
+
+#endif
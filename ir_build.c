@@ -0,0 +1,592 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+
+// Construção da SSA diretamente a partir da AST, no estilo de Braun et al.
+// ("Simple and Efficient Construction of Static Single Assignment Form"):
+// cada bloco guarda a definição corrente de cada variável e os phis são
+// criados sob demanda; blocos de laço ficam abertos até o fim do corpo.
+//
+// Variáveis locais e parâmetros são as variáveis 0..local_count-1; as globais
+// vêm em seguida. Globais vivem em SSA dentro da função e são gravadas na
+// memória antes de cada chamada (e no retorno), e relidas depois dela.
+
+// Phi criado em bloco ainda não selado; os operandos são preenchidos no selo
+typedef struct {
+    int block;
+    int var;
+    int phi;
+    int next;
+} PendingPhi;
+
+typedef struct {
+    IrProgram *program;
+    IrFunction *function;
+    int current;
+    int var_count;
+    int local_count;
+    uint8_t *var_types;
+    bool *global_read;        // Globais lidas ou escritas na função
+    bool *global_written;
+    int **defs;               // defs[bloco][variável], -1 se não definida no bloco
+    bool *sealed;
+    int *pending_head;        // Primeiro phi pendente de cada bloco
+    PendingPhi *pending;
+    int pending_count;
+    int pending_capacity;
+    bool is_main;
+    int line;
+    int column;
+    bool failed;
+} IrBuilder;
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *grown = realloc(array, size);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static int addInst(IrBuilder *b, IrOpcode op, DataType type, int operand_count) {
+    int id = irAddInst(b->function, b->current, op, type, operand_count);
+    b->function->insts[id].line = b->line;
+    b->function->insts[id].column = b->column;
+    return id;
+}
+
+static int newBlock(IrBuilder *b) {
+    IrFunction *f = b->function;
+    if (f->block_count == f->block_capacity) {
+        f->block_capacity = f->block_capacity ? f->block_capacity * 2 : 16;
+        f->blocks = checkedRealloc(f->blocks, sizeof(IrBlock) * f->block_capacity);
+        b->defs = checkedRealloc(b->defs, sizeof(int *) * f->block_capacity);
+        b->sealed = checkedRealloc(b->sealed, sizeof(bool) * f->block_capacity);
+        b->pending_head = checkedRealloc(b->pending_head, sizeof(int) * f->block_capacity);
+    }
+    int id = f->block_count++;
+    memset(&f->blocks[id], 0, sizeof(IrBlock));
+    f->blocks[id].frequency = -1;
+    b->defs[id] = NULL;
+    b->sealed[id] = false;
+    b->pending_head[id] = -1;
+    return id;
+}
+
+static void writeVariable(IrBuilder *b, int var, int block, int value) {
+    if (!b->defs[block]) {
+        b->defs[block] = checkedRealloc(NULL, sizeof(int) * b->var_count);
+        memset(b->defs[block], 0xFF, sizeof(int) * b->var_count);
+    }
+    b->defs[block][var] = value;
+}
+
+static int readVariable(IrBuilder *b, int var, int block);
+
+static int newPhi(IrBuilder *b, int var, int block) {
+    int phi = irAddInst(b->function, -1, IR_PHI, (DataType)b->var_types[var], 0);
+    b->function->insts[phi].line = b->line;
+    b->function->insts[phi].column = b->column;
+    irInsertInst(b->function, block, 0, phi);
+    return phi;
+}
+
+static void addPhiOperands(IrBuilder *b, int var, int phi) {
+    IrFunction *f = b->function;
+    int block = f->insts[phi].block;
+    int count = f->blocks[block].pred_count;
+    int *operands = arenaAlloc(&f->arena, sizeof(int) * (count ? count : 1));
+    for (int i = 0; i < count; i++) {
+        operands[i] = readVariable(b, var, f->blocks[block].preds[i]);
+    }
+    f->insts[phi].operands = operands;
+    f->insts[phi].operand_count = count;
+}
+
+static int readVariable(IrBuilder *b, int var, int block) {
+    if (b->defs[block] && b->defs[block][var] >= 0) return b->defs[block][var];
+
+    IrFunction *f = b->function;
+    int value;
+    if (!b->sealed[block]) {
+        value = newPhi(b, var, block);
+        if (b->pending_count == b->pending_capacity) {
+            b->pending_capacity = b->pending_capacity ? b->pending_capacity * 2 : 32;
+            b->pending = checkedRealloc(b->pending, sizeof(PendingPhi) * b->pending_capacity);
+        }
+        b->pending[b->pending_count] = (PendingPhi){block, var, value, b->pending_head[block]};
+        b->pending_head[block] = b->pending_count++;
+    } else if (f->blocks[block].pred_count == 1) {
+        value = readVariable(b, var, f->blocks[block].preds[0]);
+    } else if (f->blocks[block].pred_count == 0) {
+        // Bloco inalcançável: qualquer valor serve
+        value = irAddInst(f, -1, IR_CONST, (DataType)b->var_types[var], 0);
+        irInsertInst(f, block, 0, value);
+    } else {
+        value = newPhi(b, var, block);
+        writeVariable(b, var, block, value);
+        addPhiOperands(b, var, value);
+    }
+    writeVariable(b, var, block, value);
+    return value;
+}
+
+static void sealBlock(IrBuilder *b, int block) {
+    for (int i = b->pending_head[block]; i >= 0; i = b->pending[i].next) {
+        addPhiOperands(b, b->pending[i].var, b->pending[i].phi);
+    }
+    b->pending_head[block] = -1;
+    b->sealed[block] = true;
+}
+
+static void jumpTo(IrBuilder *b, int target) {
+    addInst(b, IR_JMP, TYPE_UNKNOWN, 0);
+    irAddEdge(b->function, b->current, target);
+}
+
+// Desvia para if_true se cond for verdadeiro e para if_false caso contrário
+static void branch(IrBuilder *b, int cond, int if_true, int if_false) {
+    int br = addInst(b, IR_BR, TYPE_UNKNOWN, 1);
+    b->function->insts[br].operands[0] = cond;
+    irAddEdge(b->function, b->current, if_true);
+    irAddEdge(b->function, b->current, if_false);
+}
+
+static int variableId(IrBuilder *b, const Symbol *symbol) {
+    return symbol->scope == 0 ? b->local_count + symbol->index : symbol->index;
+}
+
+static int constant(IrBuilder *b, DataType type, Value value) {
+    int id = addInst(b, IR_CONST, type, 0);
+    b->function->insts[id].constant = value;
+    return id;
+}
+
+static int unary(IrBuilder *b, IrOpcode op, DataType type, int operand) {
+    int id = addInst(b, op, type, 1);
+    b->function->insts[id].operands[0] = operand;
+    return id;
+}
+
+static int binary(IrBuilder *b, IrOpcode op, DataType type, int left, int right) {
+    int id = addInst(b, op, type, 2);
+    b->function->insts[id].operands[0] = left;
+    b->function->insts[id].operands[1] = right;
+    return id;
+}
+
+static int addString(IrBuilder *b, const char *text) {
+    IrProgram *p = b->program;
+    for (int i = 0; i < p->string_count; i++) {
+        if (strcmp(p->strings[i], text) == 0) return i;
+    }
+    p->strings = checkedRealloc(p->strings, sizeof(char *) * (p->string_count + 1));
+    p->strings[p->string_count] = strdup(text);
+    return p->string_count++;
+}
+
+static IrOpcode binaryOpcode(TokenType op, DataType operand_type) {
+    bool real = operand_type == TYPE_REAL;
+    switch (op) {
+        case TOKEN_PLUS: return real ? IR_ADD_R : IR_ADD_I;
+        case TOKEN_MINUS: return real ? IR_SUB_R : IR_SUB_I;
+        case TOKEN_MULTIPLY: return real ? IR_MUL_R : IR_MUL_I;
+        case TOKEN_DIVIDE: return IR_DIV_R;
+        case TOKEN_DIV: return IR_DIV_I;
+        case TOKEN_MOD: return IR_MOD_I;
+        case TOKEN_AND: return IR_AND;
+        case TOKEN_OR: return IR_OR;
+        case TOKEN_EQ: return real ? IR_EQ_R : IR_EQ_I;
+        case TOKEN_NEQ: return real ? IR_NE_R : IR_NE_I;
+        case TOKEN_LT: return real ? IR_LT_R : IR_LT_I;
+        case TOKEN_LTE: return real ? IR_LE_R : IR_LE_I;
+        case TOKEN_GT: return real ? IR_GT_R : IR_GT_I;
+        case TOKEN_GTE: return real ? IR_GE_R : IR_GE_I;
+        default: return IR_COUNT;
+    }
+}
+
+static int buildExpression(IrBuilder *b, AstNode *node);
+
+// Elementos de array ficam na memória, fora da SSA; numa atribuição o índice é
+// avaliado depois do valor, como no bytecode
+static int loadElement(IrBuilder *b, AstNode *node) {
+    int load = unary(b, IR_LOADX, node->type, buildExpression(b, node->as.element.index));
+    b->function->insts[load].index = node->as.element.array->as.variable.symbol->index;
+    return load;
+}
+
+static void storeElement(IrBuilder *b, AstNode *target, int value) {
+    int index = buildExpression(b, target->as.element.index);
+    int store = binary(b, IR_STOREX, TYPE_UNKNOWN, value, index);
+    b->function->insts[store].index = target->as.element.array->as.variable.symbol->index;
+}
+
+static int buildExpression(IrBuilder *b, AstNode *node) {
+    switch (node->kind) {
+        case NODE_INT_LITERAL:
+            return constant(b, node->type, (Value){.i = node->as.int_value});
+        case NODE_BOOL_LITERAL:
+            return constant(b, node->type, (Value){.i = node->as.bool_value});
+        case NODE_REAL_LITERAL:
+            return constant(b, TYPE_REAL, (Value){.r = node->as.real_value});
+        case NODE_VARIABLE:
+            return readVariable(b, variableId(b, node->as.variable.symbol), b->current);
+        case NODE_INDEX:
+            return loadElement(b, node);
+        case NODE_WIDEN:
+            return unary(b, IR_I2R, TYPE_REAL, buildExpression(b, node->as.unary.operand));
+        case NODE_UNARY: {
+            int operand = buildExpression(b, node->as.unary.operand);
+            if (node->as.unary.op == TOKEN_PLUS) return operand;
+            IrOpcode op = node->as.unary.op == TOKEN_NOT ? IR_NOT
+                        : node->type == TYPE_REAL ? IR_NEG_R : IR_NEG_I;
+            return unary(b, op, node->type, operand);
+        }
+        case NODE_BINARY: {
+            int left = buildExpression(b, node->as.binary.left);
+            int right = buildExpression(b, node->as.binary.right);
+            IrOpcode op = binaryOpcode(node->as.binary.op, node->as.binary.left->type);
+            if (op == IR_COUNT) {
+                b->failed = true;
+                return left;
+            }
+            return binary(b, op, node->type, left, right);
+        }
+        default:
+            b->failed = true;
+            return constant(b, TYPE_INTEGER, (Value){.i = 0});
+    }
+}
+
+// Grava na memória as globais escritas pela função
+static void storeGlobals(IrBuilder *b) {
+    for (int g = 0; g < b->program->global_count; g++) {
+        if (!b->global_written[g]) continue;
+        int value = readVariable(b, b->local_count + g, b->current);
+        int store = addInst(b, IR_STOREG, TYPE_UNKNOWN, 1);
+        b->function->insts[store].operands[0] = value;
+        b->function->insts[store].index = g;
+    }
+}
+
+static void loadGlobals(IrBuilder *b) {
+    for (int g = 0; g < b->program->global_count; g++) {
+        if (!b->global_read[g]) continue;
+        int load = addInst(b, IR_LOADG, (DataType)b->program->global_types[g], 0);
+        b->function->insts[load].index = g;
+        writeVariable(b, b->local_count + g, b->current, load);
+    }
+}
+
+static void buildStatement(IrBuilder *b, AstNode *node);
+
+// Mesma semântica do laço for do bytecode: o limite é avaliado uma vez,
+// antes do valor inicial, e o contador para ao atingir o limite
+static void buildFor(IrBuilder *b, AstNode *node) {
+    int var = variableId(b, node->as.for_stmt.var->as.variable.symbol);
+    bool downto = node->as.for_stmt.downto;
+
+    int limit = buildExpression(b, node->as.for_stmt.end);
+    writeVariable(b, var, b->current, buildExpression(b, node->as.for_stmt.start));
+    int counter = readVariable(b, var, b->current);
+    int skip = binary(b, downto ? IR_LT_I : IR_GT_I, TYPE_BOOLEAN, counter, limit);
+
+    int body = newBlock(b);
+    int exit = newBlock(b);
+    branch(b, skip, exit, body);
+
+    b->current = body;
+    buildStatement(b, node->as.for_stmt.body);
+
+    b->line = node->line;
+    b->column = node->column;
+    counter = readVariable(b, var, b->current);
+    int done = binary(b, IR_EQ_I, TYPE_BOOLEAN, counter, limit);
+    int step = newBlock(b);
+    branch(b, done, exit, step);
+    sealBlock(b, step);
+
+    b->current = step;
+    int one = constant(b, TYPE_INTEGER, (Value){.i = 1});
+    writeVariable(b, var, step, binary(b, downto ? IR_SUB_I : IR_ADD_I, TYPE_INTEGER, counter, one));
+    jumpTo(b, body);
+    sealBlock(b, body);
+    sealBlock(b, exit);
+    b->current = exit;
+}
+
+static void buildStatement(IrBuilder *b, AstNode *node) {
+    b->line = node->line;
+    b->column = node->column;
+
+    switch (node->kind) {
+        case NODE_BLOCK:
+            for (AstNode *stmt = node->as.block.statements; stmt; stmt = stmt->next) {
+                buildStatement(b, stmt);
+            }
+            break;
+        case NODE_ASSIGN: {
+            int value = buildExpression(b, node->as.assign.value);
+            if (node->as.assign.target->kind == NODE_INDEX) {
+                storeElement(b, node->as.assign.target, value);
+                break;
+            }
+            writeVariable(b, variableId(b, node->as.assign.target->as.variable.symbol), b->current, value);
+            break;
+        }
+        case NODE_IF: {
+            int cond = buildExpression(b, node->as.if_stmt.cond);
+            int then_block = newBlock(b);
+            int else_block = node->as.if_stmt.else_branch ? newBlock(b) : -1;
+            int join = newBlock(b);
+            branch(b, cond, then_block, else_block >= 0 ? else_block : join);
+            sealBlock(b, then_block);
+            b->current = then_block;
+            buildStatement(b, node->as.if_stmt.then_branch);
+            jumpTo(b, join);
+            if (else_block >= 0) {
+                sealBlock(b, else_block);
+                b->current = else_block;
+                buildStatement(b, node->as.if_stmt.else_branch);
+                jumpTo(b, join);
+            }
+            sealBlock(b, join);
+            b->current = join;
+            break;
+        }
+        case NODE_WHILE: {
+            int header = newBlock(b);
+            jumpTo(b, header);
+            b->current = header;
+            int cond = buildExpression(b, node->as.while_stmt.cond);
+            int body = newBlock(b);
+            int exit = newBlock(b);
+            branch(b, cond, body, exit);
+            sealBlock(b, body);
+            sealBlock(b, exit);
+            b->current = body;
+            buildStatement(b, node->as.while_stmt.body);
+            jumpTo(b, header);
+            sealBlock(b, header);
+            b->current = exit;
+            break;
+        }
+        case NODE_FOR:
+            buildFor(b, node);
+            break;
+        case NODE_CALL: {
+            int count = 0;
+            for (AstNode *arg = node->as.call.args; arg; arg = arg->next) count++;
+            if (count > MAX_ARGS) {
+                fprintf(stderr, "Erro: chamada de %s com %d argumentos excede o limite de %d\n",
+                        node->as.call.name, count, MAX_ARGS);
+                b->failed = true;
+                break;
+            }
+            int *args = arenaAlloc(&b->function->arena, sizeof(int) * (count ? count : 1));
+            count = 0;
+            for (AstNode *arg = node->as.call.args; arg; arg = arg->next) {
+                args[count++] = buildExpression(b, arg);
+            }
+            storeGlobals(b);
+            int call = addInst(b, IR_CALL, TYPE_UNKNOWN, 0);
+            b->function->insts[call].operands = args;
+            b->function->insts[call].operand_count = count;
+            b->function->insts[call].index = node->as.call.symbol->index;
+            loadGlobals(b);
+            break;
+        }
+        case NODE_WRITE:
+            for (AstNode *arg = node->as.write.args; arg; arg = arg->next) {
+                if (arg->kind == NODE_STRING_LITERAL) {
+                    int write = addInst(b, IR_WRITE_S, TYPE_UNKNOWN, 0);
+                    b->function->insts[write].index = addString(b, arg->as.string_value);
+                    continue;
+                }
+                int value = buildExpression(b, arg);
+                IrOpcode op = arg->type == TYPE_REAL ? IR_WRITE_R
+                            : arg->type == TYPE_BOOLEAN ? IR_WRITE_B : IR_WRITE_I;
+                unary(b, op, TYPE_UNKNOWN, value);
+            }
+            if (node->as.write.newline) addInst(b, IR_WRITELN, TYPE_UNKNOWN, 0);
+            break;
+        case NODE_READ:
+            for (AstNode *target = node->as.read.targets; target; target = target->next) {
+                int value = addInst(b, target->type == TYPE_REAL ? IR_READ_R : IR_READ_I, target->type, 0);
+                if (target->kind == NODE_INDEX) {
+                    storeElement(b, target, value);
+                    continue;
+                }
+                writeVariable(b, variableId(b, target->as.variable.symbol), b->current, value);
+            }
+            break;
+        default:
+            b->failed = true;
+            break;
+    }
+}
+
+// Marca as globais lidas e escritas pelo corpo da função
+static void scanGlobals(IrBuilder *b, AstNode *node) {
+    for (; node; node = node->next) {
+        switch (node->kind) {
+            case NODE_VARIABLE:
+                if (node->as.variable.symbol->scope == 0) b->global_read[node->as.variable.symbol->index] = true;
+                break;
+            case NODE_BLOCK: scanGlobals(b, node->as.block.statements); break;
+            case NODE_INDEX: scanGlobals(b, node->as.element.index); break;
+            case NODE_ASSIGN:
+                scanGlobals(b, node->as.assign.target);
+                scanGlobals(b, node->as.assign.value);
+                if (node->as.assign.target->kind == NODE_VARIABLE &&
+                    node->as.assign.target->as.variable.symbol->scope == 0) {
+                    b->global_written[node->as.assign.target->as.variable.symbol->index] = true;
+                }
+                break;
+            case NODE_IF:
+                scanGlobals(b, node->as.if_stmt.cond);
+                scanGlobals(b, node->as.if_stmt.then_branch);
+                scanGlobals(b, node->as.if_stmt.else_branch);
+                break;
+            case NODE_WHILE:
+                scanGlobals(b, node->as.while_stmt.cond);
+                scanGlobals(b, node->as.while_stmt.body);
+                break;
+            case NODE_FOR:
+                scanGlobals(b, node->as.for_stmt.var);
+                scanGlobals(b, node->as.for_stmt.start);
+                scanGlobals(b, node->as.for_stmt.end);
+                scanGlobals(b, node->as.for_stmt.body);
+                if (node->as.for_stmt.var->as.variable.symbol->scope == 0) {
+                    b->global_written[node->as.for_stmt.var->as.variable.symbol->index] = true;
+                }
+                break;
+            case NODE_CALL: scanGlobals(b, node->as.call.args); break;
+            case NODE_WRITE: scanGlobals(b, node->as.write.args); break;
+            case NODE_READ:
+                scanGlobals(b, node->as.read.targets);
+                for (AstNode *target = node->as.read.targets; target; target = target->next) {
+                    if (target->kind == NODE_VARIABLE && target->as.variable.symbol->scope == 0) {
+                        b->global_written[target->as.variable.symbol->index] = true;
+                    }
+                }
+                break;
+            case NODE_BINARY:
+                scanGlobals(b, node->as.binary.left);
+                scanGlobals(b, node->as.binary.right);
+                break;
+            case NODE_UNARY: case NODE_WIDEN: scanGlobals(b, node->as.unary.operand); break;
+            default: break;
+        }
+    }
+}
+
+static void buildFunction(IrBuilder *b, IrFunction *f, const char *name, AstNode *body,
+                          SymbolTable *locals, int param_count) {
+    memset(f, 0, sizeof(*f));
+    initArena(&f->arena);
+    f->name = strdup(name ? name : "main");
+    f->param_count = param_count;
+    f->param_types = calloc(param_count + 1, 1);
+
+    IrProgram *p = b->program;
+    b->function = f;
+    b->is_main = locals == NULL;
+    b->local_count = locals ? locals->variable_count : 0;
+    b->var_count = b->local_count + p->global_count;
+    b->var_types = checkedRealloc(b->var_types, b->var_count + 1);
+    b->global_read = checkedRealloc(b->global_read, p->global_count + 1);
+    b->global_written = checkedRealloc(b->global_written, p->global_count + 1);
+    memset(b->global_read, 0, p->global_count + 1);
+    memset(b->global_written, 0, p->global_count + 1);
+    memcpy(b->var_types + b->local_count, p->global_types, p->global_count);
+    if (body) scanGlobals(b, body);
+    for (int g = 0; g < p->global_count; g++) {
+        if (b->global_written[g]) b->global_read[g] = true;
+    }
+
+    b->current = newBlock(b);
+    sealBlock(b, b->current);
+    b->line = body ? body->line : 0;
+    b->column = body ? body->column : 0;
+
+    // Parâmetros chegam como argumentos; as demais locais começam zeradas
+    if (locals) {
+        for (Symbol *s = locals->head; s; s = s->next) {
+            b->var_types[s->index] = (uint8_t)s->type;
+            int value;
+            if (s->index < param_count) {
+                f->param_types[s->index] = (uint8_t)s->type;
+                value = addInst(b, IR_PARAM, s->type, 0);
+                f->insts[value].index = s->index;
+            } else {
+                value = constant(b, s->type, (Value){.i = 0});
+            }
+            writeVariable(b, s->index, b->current, value);
+        }
+    }
+    // O bloco principal começa com as globais zeradas; procedimentos as leem da memória
+    for (int g = 0; g < p->global_count; g++) {
+        if (!b->global_read[g]) continue;
+        int value;
+        if (b->is_main) {
+            value = constant(b, (DataType)p->global_types[g], (Value){.i = 0});
+        } else {
+            value = addInst(b, IR_LOADG, (DataType)p->global_types[g], 0);
+            f->insts[value].index = g;
+        }
+        writeVariable(b, b->local_count + g, b->current, value);
+    }
+
+    if (body) buildStatement(b, body);
+    b->line = 0;
+    b->column = 0;
+    if (!b->is_main) storeGlobals(b);
+    addInst(b, IR_RET, TYPE_UNKNOWN, 0);
+
+    for (int i = 0; i < f->block_count; i++) free(b->defs[i]);
+    b->pending_count = 0;
+}
+
+bool buildIr(AstNode *program, SymbolTable *globals, IrProgram *out) {
+    memset(out, 0, sizeof(*out));
+    IrBuilder b;
+    memset(&b, 0, sizeof(b));
+    b.program = out;
+
+    out->global_count = globals->variable_count;
+    out->global_types = calloc(globals->variable_count + 1, 1);
+
+    out->function_count = globals->procedure_count + 1;
+    out->main_function = globals->procedure_count;
+    out->library = program->as.program.unit;
+    out->functions = calloc(out->function_count, sizeof(IrFunction));
+    out->array_count = globals->array_count;
+    out->arrays = calloc(globals->array_count + 1, sizeof(ArrayInfo));
+    if (!out->global_types || !out->functions || !out->arrays) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    globalTypes(globals, out->global_types);
+    out->array_slots = arrayLayout(globals, out->arrays);
+
+    for (AstNode *proc = program->as.program.procedures; proc; proc = proc->next) {
+        Symbol *symbol = proc->as.procedure.symbol;
+        buildFunction(&b, &out->functions[symbol->index], proc->as.procedure.name,
+                      proc->as.procedure.body, proc->as.procedure.locals, symbol->param_count);
+    }
+    buildFunction(&b, &out->functions[out->main_function], program->as.program.name,
+                  program->as.program.body, NULL, 0);
+
+    free(b.var_types);
+    free(b.global_read);
+    free(b.global_written);
+    free(b.defs);
+    free(b.sealed);
+    free(b.pending_head);
+    free(b.pending);
+    return !b.failed;
+}
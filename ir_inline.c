@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+
+// Grafo de chamadas sobre a SSA: remoção dos procedimentos que o bloco
+// principal nunca alcança e expansão em linha das chamadas pequenas
+
+// Procedimentos chamados de um só lugar são expandidos até este tamanho
+#define INLINE_ONCE_LIMIT 400
+// Tamanho máximo de uma função depois de receber as expansões
+#define INLINE_CALLER_LIMIT 4000
+// Com perfil: pontos de chamada com ao menos 1/INLINE_HOT_RATIO das execuções do mais
+// quente aceitam funções INLINE_HOT_FACTOR vezes maiores; os nunca executados, nenhuma
+#define INLINE_HOT_RATIO 20
+#define INLINE_HOT_FACTOR 8
+
+static void *checkedCalloc(size_t count, size_t size) {
+    void *memory = calloc(count ? count : 1, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+// Procedimentos importados de units não têm corpo na SSA e ficam fora do grafo
+static bool isLocalCall(const IrInst *inst) {
+    return inst->op == IR_CALL && inst->index >= 0;
+}
+
+// Arestas em formato compacto: as chamadas da função f são
+// callees[first[f]] .. callees[first[f + 1] - 1], uma por instrução CALL
+typedef struct {
+    int *first;
+    int *callees;
+    int *site_count;          // Chamadas recebidas de funções alcançáveis
+    bool *reachable;
+    bool *recursive;          // Faz parte de um ciclo do grafo
+    int *order;               // Funções alcançáveis; cada uma depois das que chama, exceto em ciclos
+    int order_count;
+} CallGraph;
+
+// Componentes fortemente conexos (Tarjan); a ordem em que os componentes
+// se fecham já é a ordem de baixo para cima do grafo
+typedef struct {
+    CallGraph *graph;
+    int *index;
+    int *low;
+    int *stack;
+    bool *on_stack;
+    int depth;
+    int next_index;
+} Tarjan;
+
+static void visitFunction(Tarjan *t, int f) {
+    CallGraph *g = t->graph;
+    t->index[f] = t->low[f] = t->next_index++;
+    t->stack[t->depth++] = f;
+    t->on_stack[f] = true;
+    g->reachable[f] = true;
+    for (int e = g->first[f]; e < g->first[f + 1]; e++) {
+        int callee = g->callees[e];
+        if (callee == f) g->recursive[f] = true;
+        if (t->index[callee] < 0) {
+            visitFunction(t, callee);
+            if (t->low[callee] < t->low[f]) t->low[f] = t->low[callee];
+        } else if (t->on_stack[callee] && t->index[callee] < t->low[f]) {
+            t->low[f] = t->index[callee];
+        }
+    }
+    if (t->low[f] != t->index[f]) return;
+    int start = t->depth;
+    do {
+        start--;
+    } while (t->stack[start] != f);
+    for (int i = start; i < t->depth; i++) {
+        int member = t->stack[i];
+        t->on_stack[member] = false;
+        if (t->depth - start > 1) g->recursive[member] = true;
+        g->order[g->order_count++] = member;
+    }
+    t->depth = start;
+}
+
+static void buildCallGraph(const IrProgram *program, CallGraph *g) {
+    int n = program->function_count;
+    g->first = checkedCalloc(n + 1, sizeof(int));
+    int total = 0;
+    for (int f = 0; f < n; f++) {
+        const IrFunction *function = &program->functions[f];
+        g->first[f] = total;
+        for (int b = 0; b < function->block_count; b++) {
+            const IrBlock *block = &function->blocks[b];
+            if (block->removed) continue;
+            for (int i = 0; i < block->count; i++) {
+                if (isLocalCall(&function->insts[block->insts[i]])) total++;
+            }
+        }
+    }
+    g->first[n] = total;
+    g->callees = checkedCalloc(total, sizeof(int));
+    for (int f = 0, e = 0; f < n; f++) {
+        const IrFunction *function = &program->functions[f];
+        for (int b = 0; b < function->block_count; b++) {
+            const IrBlock *block = &function->blocks[b];
+            if (block->removed) continue;
+            for (int i = 0; i < block->count; i++) {
+                const IrInst *inst = &function->insts[block->insts[i]];
+                if (isLocalCall(inst)) g->callees[e++] = inst->index;
+            }
+        }
+    }
+
+    g->site_count = checkedCalloc(n, sizeof(int));
+    g->reachable = checkedCalloc(n, sizeof(bool));
+    g->recursive = checkedCalloc(n, sizeof(bool));
+    g->order = checkedCalloc(n, sizeof(int));
+    g->order_count = 0;
+    Tarjan t = {g, checkedCalloc(n, sizeof(int)), checkedCalloc(n, sizeof(int)),
+                checkedCalloc(n, sizeof(int)), checkedCalloc(n, sizeof(bool)), 0, 0};
+    for (int f = 0; f < n; f++) t.index[f] = -1;
+    visitFunction(&t, program->main_function);
+    for (int f = 0; f < n && program->library; f++) {
+        if (t.index[f] < 0) visitFunction(&t, f);
+    }
+    for (int f = 0; f < n; f++) {
+        if (!g->reachable[f]) continue;
+        for (int e = g->first[f]; e < g->first[f + 1]; e++) g->site_count[g->callees[e]]++;
+    }
+    free(t.index);
+    free(t.low);
+    free(t.stack);
+    free(t.on_stack);
+}
+
+static void freeCallGraph(CallGraph *g) {
+    free(g->first);
+    free(g->callees);
+    free(g->site_count);
+    free(g->reachable);
+    free(g->recursive);
+    free(g->order);
+}
+
+// Descarta as funções inalcançáveis e renumera as chamadas restantes
+static int removeUnreachable(IrProgram *program, const CallGraph *g) {
+    int *number = checkedCalloc(program->function_count, sizeof(int));
+    int kept = 0;
+    for (int f = 0; f < program->function_count; f++) {
+        if (g->reachable[f]) {
+            number[f] = kept;
+            program->functions[kept++] = program->functions[f];
+        } else {
+            number[f] = -1;
+            irFreeFunction(&program->functions[f]);
+        }
+    }
+    int removed = program->function_count - kept;
+    program->function_count = kept;
+    program->main_function = number[program->main_function];
+    for (int f = 0; f < kept; f++) {
+        IrFunction *function = &program->functions[f];
+        for (int i = 0; i < function->inst_count; i++) {
+            IrInst *inst = &function->insts[i];
+            if (isLocalCall(inst) && !inst->removed) inst->index = number[inst->index];
+        }
+    }
+    free(number);
+    return removed;
+}
+
+int irRemoveDeadFunctions(IrProgram *program) {
+    CallGraph g;
+    buildCallGraph(program, &g);
+    int removed = removeUnreachable(program, &g);
+    freeCallGraph(&g);
+    return removed;
+}
+
+static int retBlockCount(const IrFunction *f, int *last) {
+    int count = 0;
+    for (int b = 0; b < f->block_count; b++) {
+        const IrBlock *block = &f->blocks[b];
+        if (block->removed || block->count == 0) continue;
+        if (f->insts[block->insts[block->count - 1]].op == IR_RET) {
+            *last = b;
+            count++;
+        }
+    }
+    return count;
+}
+
+// Substitui a chamada pelo corpo da função chamada. O bloco da chamada recebe
+// o bloco de entrada; o que vinha depois da chamada passa para o bloco do RET
+// (ou para um bloco novo de junção, se houver mais de um RET)
+// Parte das execuções de um bloco da função chamada que vem deste ponto de chamada
+static int64_t siteShare(int64_t frequency, int64_t site, int64_t entry) {
+    if (frequency < 0 || site < 0 || entry < 0) return -1;
+    if (entry == 0) return 0;
+    return (int64_t)((double)frequency * (double)site / (double)entry + 0.5);
+}
+
+static void inlineCall(IrFunction *f, int call, const IrFunction *callee) {
+    int site = f->insts[call].block;
+    int64_t site_frequency = f->blocks[site].frequency, entry_frequency = callee->blocks[0].frequency;
+    int line = f->insts[call].line;
+    const int *args = f->insts[call].operands;
+    IrBlock *block = &f->blocks[site];
+    int position = 0;
+    while (block->insts[position] != call) position++;
+    int tail_count = block->count - position - 1;
+    int *tail = checkedCalloc(tail_count, sizeof(int));
+    memcpy(tail, block->insts + position + 1, sizeof(int) * tail_count);
+    block->count = position;
+    f->insts[call].removed = true;
+    int old_succs[2] = {block->succs[0], block->succs[1]};
+    int old_succ_count = block->succ_count;
+    block->succ_count = 0;
+
+    int ret_block = -1;
+    int ret_count = retBlockCount(callee, &ret_block);
+    int *block_map = checkedCalloc(callee->block_count, sizeof(int));
+    for (int b = 0; b < callee->block_count; b++) {
+        block_map[b] = callee->blocks[b].removed ? -1 : b == 0 ? site : irAddBlock(f);
+    }
+    int join = ret_count == 1 ? block_map[ret_block] : irAddBlock(f);
+    for (int b = 1; b < callee->block_count; b++) {
+        if (block_map[b] >= 0) {
+            f->blocks[block_map[b]].frequency = siteShare(callee->blocks[b].frequency, site_frequency, entry_frequency);
+        }
+    }
+    if (ret_count != 1) f->blocks[join].frequency = site_frequency;
+
+    // Cópia das instruções; os operandos são traduzidos depois porque os phis
+    // podem usar valores definidos mais adiante
+    int *map = checkedCalloc(callee->inst_count, sizeof(int));
+    int first_copy = f->inst_count;
+    for (int b = 0; b < callee->block_count; b++) {
+        const IrBlock *source = &callee->blocks[b];
+        if (source->removed) continue;
+        for (int i = 0; i < source->count; i++) {
+            int id = source->insts[i];
+            const IrInst *inst = &callee->insts[id];
+            if (inst->removed) continue;
+            if (inst->op == IR_PARAM) {
+                map[id] = args[inst->index];
+                continue;
+            }
+            if (inst->op == IR_RET) {
+                if (ret_count > 1) f->insts[irAddInst(f, block_map[b], IR_JMP, TYPE_UNKNOWN, 0)].line = line;
+                continue;
+            }
+            int copy = irAddInst(f, block_map[b], inst->op, (DataType)inst->type, inst->operand_count);
+            IrInst *dst = &f->insts[copy];
+            dst->line = inst->line;
+            dst->column = inst->column;
+            dst->constant = inst->constant;
+            dst->index = inst->index;
+            if (inst->operand_count > 0) memcpy(dst->operands, inst->operands, sizeof(int) * inst->operand_count);
+            map[id] = copy;
+        }
+    }
+    for (int i = first_copy; i < f->inst_count; i++) {
+        IrInst *inst = &f->insts[i];
+        for (int j = 0; j < inst->operand_count; j++) inst->operands[j] = map[inst->operands[j]];
+    }
+    for (int i = 0; i < tail_count; i++) irInsertInst(f, join, f->blocks[join].count, tail[i]);
+
+    // Arestas: os blocos copiados mantêm a ordem dos predecessores (e dos phis)
+    for (int b = 0; b < callee->block_count; b++) {
+        const IrBlock *source = &callee->blocks[b];
+        int target = block_map[b];
+        if (target < 0) continue;
+        if (target != site) {
+            IrBlock *copy = &f->blocks[target];
+            copy->preds = checkedCalloc(source->pred_count, sizeof(int));
+            for (int p = 0; p < source->pred_count; p++) copy->preds[p] = block_map[source->preds[p]];
+            copy->pred_count = copy->pred_capacity = source->pred_count;
+        }
+        if (source->succ_count == 0) continue;
+        IrBlock *copy = &f->blocks[target];
+        for (int s = 0; s < source->succ_count; s++) copy->succs[s] = block_map[source->succs[s]];
+        copy->succ_count = source->succ_count;
+    }
+    if (ret_count > 1) {
+        IrBlock *junction = &f->blocks[join];
+        junction->preds = checkedCalloc(ret_count, sizeof(int));
+        for (int b = 0; b < callee->block_count; b++) {
+            if (block_map[b] < 0 || callee->blocks[b].succ_count > 0) continue;
+            int target = block_map[b];
+            f->blocks[target].succs[0] = join;
+            f->blocks[target].succ_count = 1;
+            junction->preds[junction->pred_count++] = target;
+        }
+        junction->pred_capacity = ret_count;
+    }
+    IrBlock *junction = &f->blocks[join];
+    memcpy(junction->succs, old_succs, sizeof(old_succs));
+    junction->succ_count = old_succ_count;
+    for (int s = 0; s < old_succ_count && join != site; s++) {
+        IrBlock *next = &f->blocks[old_succs[s]];
+        for (int p = 0; p < next->pred_count; p++) {
+            if (next->preds[p] == site) {
+                next->preds[p] = join;
+                break;
+            }
+        }
+    }
+
+    free(tail);
+    free(block_map);
+    free(map);
+}
+
+// Cada chamada copiada junto com o corpo é um novo ponto de chamada
+static void countCalls(const IrFunction *f, int *site_count) {
+    for (int b = 0; b < f->block_count; b++) {
+        const IrBlock *block = &f->blocks[b];
+        if (block->removed) continue;
+        for (int i = 0; i < block->count; i++) {
+            const IrInst *inst = &f->insts[block->insts[i]];
+            if (isLocalCall(inst) && !inst->removed) site_count[inst->index]++;
+        }
+    }
+}
+
+// Critério de expansão: funções não recursivas, pequenas ou chamadas de um só lugar,
+// sem desvios de volta para a entrada, que não façam o chamador passar do limite
+// Com perfil (site_frequency >= 0), o limite depende de quanto o ponto executa
+static bool shouldInline(const IrProgram *program, const CallGraph *g, const int *size,
+                         int caller, int callee, int limit, int64_t site_frequency, int64_t hottest) {
+    const IrFunction *target = &program->functions[callee];
+    int ret_block;
+    if (callee == caller || g->recursive[callee]) return false;
+    if (target->blocks[0].pred_count > 0 || retBlockCount(target, &ret_block) == 0) return false;
+    if (size[caller] + size[callee] > INLINE_CALLER_LIMIT) return false;
+    if (site_frequency == 0) limit = 0;
+    else if (site_frequency > 0 && site_frequency * INLINE_HOT_RATIO >= hottest) limit *= INLINE_HOT_FACTOR;
+    return size[callee] <= limit || (g->site_count[callee] == 1 && size[callee] <= INLINE_ONCE_LIMIT);
+}
+
+// Execuções do ponto de chamada mais quente do programa; -1 sem perfil
+static int64_t hottestSite(const IrProgram *program) {
+    int64_t hottest = -1;
+    for (int i = 0; i < program->function_count; i++) {
+        const IrFunction *f = &program->functions[i];
+        for (int b = 0; b < f->block_count; b++) {
+            const IrBlock *block = &f->blocks[b];
+            if (block->removed || block->frequency <= hottest) continue;
+            for (int j = 0; j < block->count; j++) {
+                if (f->insts[block->insts[j]].op == IR_CALL) {
+                    hottest = block->frequency;
+                    break;
+                }
+            }
+        }
+    }
+    return hottest;
+}
+
+int irInlineCalls(IrProgram *program, int limit) {
+    if (limit <= 0) return 0;
+    CallGraph g;
+    buildCallGraph(program, &g);
+    int *size = checkedCalloc(program->function_count, sizeof(int));
+    for (int f = 0; f < program->function_count; f++) size[f] = irLiveCount(&program->functions[f]);
+    int64_t hottest = hottestSite(program);
+
+    // De baixo para cima: quando uma função é expandida, as chamadas dela já foram tratadas
+    int inlined = 0;
+    for (int o = 0; o < g.order_count; o++) {
+        int caller = g.order[o];
+        IrFunction *f = &program->functions[caller];
+        int call_count = 0;
+        int *calls = checkedCalloc(f->inst_count, sizeof(int));
+        for (int b = 0; b < f->block_count; b++) {
+            const IrBlock *block = &f->blocks[b];
+            if (block->removed) continue;
+            for (int i = 0; i < block->count; i++) {
+                if (isLocalCall(&f->insts[block->insts[i]])) calls[call_count++] = block->insts[i];
+            }
+        }
+        for (int c = 0; c < call_count; c++) {
+            int callee = f->insts[calls[c]].index;
+            int64_t site_frequency = f->blocks[f->insts[calls[c]].block].frequency;
+            if (!shouldInline(program, &g, size, caller, callee, limit, site_frequency, hottest)) continue;
+            IrFunction *target = &program->functions[callee];
+            inlineCall(f, calls[c], target);
+            // As execuções expandidas saem da cópia que ainda atende os outros pontos
+            int64_t entry_frequency = target->blocks[0].frequency;
+            for (int b = 0; b < target->block_count && site_frequency >= 0; b++) {
+                int64_t share = siteShare(target->blocks[b].frequency, site_frequency, entry_frequency);
+                if (share > target->blocks[b].frequency) share = target->blocks[b].frequency;
+                if (share > 0) target->blocks[b].frequency -= share;
+            }
+            size[caller] += size[callee];
+            g.site_count[callee]--;
+            countCalls(target, g.site_count);
+            inlined++;
+        }
+        free(calls);
+    }
+    free(size);
+    freeCallGraph(&g);
+
+    // Funções expandidas em todos os pontos de chamada deixam de ser alcançáveis
+    if (inlined > 0) irRemoveDeadFunctions(program);
+    return inlined;
+}
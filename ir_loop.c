@@ -0,0 +1,1244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+
+// Laços naturais sobre a SSA e as otimizações que dependem deles: movimentação
+// de código invariante, redução de força e simplificação do contador
+
+static void *checkedCalloc(size_t count, size_t size) {
+    void *memory = calloc(count ? count : 1, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+static bool isArithmetic(IrOpcode op) {
+    return op >= IR_ADD_I && op <= IR_NOT;
+}
+
+// Ordem e dominadores recalculados sempre que o grafo muda
+typedef struct {
+    int *order;
+    int count;
+    int *idom;
+    int *rpo_index;
+} Dominance;
+
+static void computeDominance(const IrFunction *f, Dominance *d) {
+    d->order = checkedCalloc(f->block_count, sizeof(int));
+    d->idom = checkedCalloc(f->block_count, sizeof(int));
+    d->rpo_index = checkedCalloc(f->block_count, sizeof(int));
+    d->count = irReversePostorder(f, d->order);
+    irDominators(f, d->order, d->count, d->idom);
+    for (int b = 0; b < f->block_count; b++) d->rpo_index[b] = -1;
+    for (int i = 0; i < d->count; i++) d->rpo_index[d->order[i]] = i;
+}
+
+static void freeDominance(Dominance *d) {
+    free(d->order);
+    free(d->idom);
+    free(d->rpo_index);
+}
+
+// Aresta de retorno: o destino domina a origem
+static bool isBackEdge(const Dominance *d, int from, int to) {
+    return d->rpo_index[from] >= 0 && irDominates(d->idom, d->rpo_index, to, from);
+}
+
+static bool isHeader(const IrFunction *f, const Dominance *d, int block) {
+    const IrBlock *b = &f->blocks[block];
+    for (int p = 0; p < b->pred_count; p++) {
+        if (isBackEdge(d, b->preds[p], block)) return true;
+    }
+    return false;
+}
+
+// Garante um único predecessor externo terminado em JMP. Quando o cabeçalho é
+// alcançado por um desvio condicional ou por vários blocos, um bloco novo
+// recebe essas arestas e os phis do cabeçalho passam a ter um só operando externo.
+static void ensurePreheader(IrFunction *f, const Dominance *d, int h) {
+    int outside = -1, outside_count = 0;
+    for (int p = 0; p < f->blocks[h].pred_count; p++) {
+        int pred = f->blocks[h].preds[p];
+        if (isBackEdge(d, pred, h)) continue;
+        outside = pred;
+        outside_count++;
+    }
+    if (outside_count == 1 && f->blocks[outside].succ_count == 1) return;
+
+    // Com perfil, o pré-cabeçalho executa uma vez por entrada no laço: a soma das
+    // arestas externas ou, se alguma for desconhecida, o cabeçalho menos as voltas
+    int64_t entries = 0, back = 0;
+    for (int p = 0; p < f->blocks[h].pred_count && entries >= 0; p++) {
+        int pred = f->blocks[h].preds[p];
+        if (!isBackEdge(d, pred, h)) {
+            int64_t edge = irEdgeFrequency(f, pred, h);
+            entries = edge < 0 ? -1 : entries + edge;
+        }
+    }
+    for (int p = 0; p < f->blocks[h].pred_count && back >= 0 && entries < 0; p++) {
+        int pred = f->blocks[h].preds[p];
+        if (isBackEdge(d, pred, h)) {
+            int64_t edge = irEdgeFrequency(f, pred, h);
+            back = edge < 0 ? -1 : back + edge;
+        }
+    }
+    if (entries < 0 && back >= 0 && f->blocks[h].frequency >= back) entries = f->blocks[h].frequency - back;
+
+    int pre = irAddBlock(f);
+    f->blocks[pre].frequency = entries;
+    IrBlock *header = &f->blocks[h];
+    int line = header->count > 0 ? f->insts[header->insts[0]].line : 0;
+    for (int i = 0; i < header->count; i++) {
+        int phi = header->insts[i];
+        if (f->insts[phi].op != IR_PHI) break;
+        int value = -1;
+        if (outside_count == 1) {
+            for (int p = 0; p < header->pred_count; p++) {
+                if (!isBackEdge(d, header->preds[p], h)) value = f->insts[phi].operands[p];
+            }
+        } else {
+            value = irAddInst(f, -1, IR_PHI, (DataType)f->insts[phi].type, outside_count);
+            f->insts[value].line = f->insts[phi].line;
+            f->insts[value].column = f->insts[phi].column;
+            int n = 0;
+            for (int p = 0; p < header->pred_count; p++) {
+                if (!isBackEdge(d, header->preds[p], h)) f->insts[value].operands[n++] = f->insts[phi].operands[p];
+            }
+            irInsertInst(f, pre, f->blocks[pre].count, value);
+        }
+        IrInst *inst = &f->insts[phi];
+        int kept = 0;
+        for (int p = 0; p < header->pred_count; p++) {
+            if (isBackEdge(d, header->preds[p], h)) inst->operands[kept++] = inst->operands[p];
+        }
+        inst->operands[kept++] = value;
+        inst->operand_count = kept;
+    }
+
+    IrBlock *preheader = &f->blocks[pre];
+    preheader->preds = checkedCalloc(outside_count, sizeof(int));
+    preheader->pred_capacity = outside_count;
+    int kept = 0;
+    for (int p = 0; p < header->pred_count; p++) {
+        int pred = header->preds[p];
+        if (isBackEdge(d, pred, h)) {
+            header->preds[kept++] = pred;
+            continue;
+        }
+        IrBlock *source = &f->blocks[pred];
+        for (int s = 0; s < source->succ_count; s++) {
+            if (source->succs[s] == h) source->succs[s] = pre;
+        }
+        preheader->preds[preheader->pred_count++] = pred;
+    }
+    header->preds[kept++] = pre;
+    header->pred_count = kept;
+
+    int jump = irAddInst(f, pre, IR_JMP, TYPE_UNKNOWN, 0);
+    f->insts[jump].line = line;
+    preheader->succs[0] = h;
+    preheader->succ_count = 1;
+}
+
+void irFindLoops(IrFunction *f, IrLoopInfo *info) {
+    memset(info, 0, sizeof(*info));
+    Dominance d;
+    computeDominance(f, &d);
+    int original_blocks = f->block_count;
+    for (int i = 0; i < d.count; i++) {
+        if (isHeader(f, &d, d.order[i])) ensurePreheader(f, &d, d.order[i]);
+    }
+    if (f->block_count != original_blocks) {
+        freeDominance(&d);
+        computeDominance(f, &d);
+    }
+
+    info->block_count = f->block_count;
+    info->innermost = checkedCalloc(f->block_count, sizeof(int));
+    int *loop_of_header = checkedCalloc(f->block_count, sizeof(int));
+    int *mark = checkedCalloc(f->block_count, sizeof(int));
+    int *stack = checkedCalloc(f->block_count, sizeof(int));
+    for (int b = 0; b < f->block_count; b++) {
+        info->innermost[b] = -1;
+        loop_of_header[b] = -1;
+        mark[b] = -1;
+    }
+    int capacity = 0;
+
+    // Cabeçalhos internos vêm depois dos externos na pós-ordem reversa; percorrê-los
+    // de trás para frente visita cada laço antes dos que o contêm
+    for (int i = d.count - 1; i >= 0; i--) {
+        int h = d.order[i];
+        if (!isHeader(f, &d, h)) continue;
+        if (info->count == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            info->loops = realloc(info->loops, sizeof(IrLoop) * capacity);
+            if (!info->loops) {
+                fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        int l = info->count++;
+        IrLoop *loop = &info->loops[l];
+        memset(loop, 0, sizeof(*loop));
+        loop->header = h;
+        loop->parent = -1;
+        loop_of_header[h] = l;
+
+        // Corpo: blocos que alcançam uma aresta de retorno sem passar pelo cabeçalho
+        int depth = 0;
+        mark[h] = l;
+        const IrBlock *header = &f->blocks[h];
+        for (int p = 0; p < header->pred_count; p++) {
+            int pred = header->preds[p];
+            if (isBackEdge(&d, pred, h)) {
+                if (mark[pred] != l) {
+                    mark[pred] = l;
+                    stack[depth++] = pred;
+                }
+            } else {
+                loop->preheader = pred;
+            }
+        }
+        while (depth > 0) {
+            const IrBlock *block = &f->blocks[stack[--depth]];
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (d.rpo_index[pred] < 0 || mark[pred] == l) continue;
+                mark[pred] = l;
+                stack[depth++] = pred;
+            }
+        }
+
+        loop->blocks = checkedCalloc(d.count, sizeof(int));
+        for (int k = 0; k < d.count; k++) {
+            int b = d.order[k];
+            if (mark[b] != l) continue;
+            loop->blocks[loop->block_count++] = b;
+            if (info->innermost[b] < 0) info->innermost[b] = l;
+            int inner = loop_of_header[b];
+            if (inner >= 0 && inner != l && info->loops[inner].parent < 0) info->loops[inner].parent = l;
+        }
+    }
+
+    free(loop_of_header);
+    free(mark);
+    free(stack);
+    freeDominance(&d);
+}
+
+bool irLoopContains(const IrLoopInfo *info, int loop, int block) {
+    if (block >= info->block_count) return false;
+    for (int l = info->innermost[block]; l >= 0; l = info->loops[l].parent) {
+        if (l == loop) return true;
+    }
+    return false;
+}
+
+void irFreeLoops(IrLoopInfo *info) {
+    for (int l = 0; l < info->count; l++) free(info->loops[l].blocks);
+    free(info->loops);
+    free(info->innermost);
+    memset(info, 0, sizeof(*info));
+}
+
+// Blocos que só contêm JMP e têm um único predecessor são contornados; a
+// aresta do predecessor assume a posição do bloco nos phis do destino
+static void removeEmptyBlocks(IrFunction *f) {
+    for (int b = 1; b < f->block_count; b++) {
+        IrBlock *block = &f->blocks[b];
+        if (block->removed || block->count != 1 || block->pred_count != 1 || block->succ_count != 1) continue;
+        int pred = block->preds[0], target = block->succs[0];
+        IrBlock *source = &f->blocks[pred];
+        bool duplicate = target == b;
+        for (int s = 0; s < source->succ_count; s++) {
+            if (source->succs[s] == target) duplicate = true;
+        }
+        if (duplicate) continue;
+        for (int s = 0; s < source->succ_count; s++) {
+            if (source->succs[s] == b) source->succs[s] = target;
+        }
+        IrBlock *destination = &f->blocks[target];
+        for (int p = 0; p < destination->pred_count; p++) {
+            if (destination->preds[p] == b) destination->preds[p] = pred;
+        }
+        block->removed = true;
+        block->pred_count = 0;
+        block->succ_count = 0;
+    }
+    irCompact(f);
+}
+
+static bool isInvariant(const IrFunction *f, const IrLoopInfo *info, int loop, int value) {
+    return !irLoopContains(info, loop, f->insts[value].block);
+}
+
+// Insere a instrução antes do terminador do bloco
+static void placeBeforeTerminator(IrFunction *f, int block, int inst) {
+    irInsertInst(f, block, f->blocks[block].count - 1, inst);
+}
+
+// ---------------------------------------------------------------------------
+// Movimentação de código invariante: operações sem efeitos cujos operandos
+// vêm de fora do laço sobem para o pré-cabeçalho. Os laços internos são
+// tratados primeiro, então uma expressão pode subir vários níveis.
+
+void irHoistInvariants(IrFunction *f) {
+    IrLoopInfo info;
+    irFindLoops(f, &info);
+    for (int l = 0; l < info.count; l++) {
+        const IrLoop *loop = &info.loops[l];
+        for (int k = 0; k < loop->block_count; k++) {
+            IrBlock *block = &f->blocks[loop->blocks[k]];
+            int kept = 0;
+            for (int i = 0; i < block->count; i++) {
+                int id = block->insts[i];
+                const IrInst *inst = &f->insts[id];
+                bool hoist = !inst->removed && (inst->op == IR_CONST ||
+                             (isArithmetic(inst->op) && !irHasSideEffects(f, inst)));
+                for (int j = 0; j < inst->operand_count && hoist; j++) {
+                    hoist = isInvariant(f, &info, l, inst->operands[j]);
+                }
+                if (hoist) {
+                    placeBeforeTerminator(f, loop->preheader, id);
+                } else {
+                    block->insts[kept++] = id;
+                }
+            }
+            block->count = kept;
+        }
+    }
+    irFreeLoops(&info);
+    removeEmptyBlocks(f);
+}
+
+// ---------------------------------------------------------------------------
+// Variáveis de indução básicas: phi no cabeçalho que recebe, por todas as
+// arestas de retorno, o próprio valor somado ou subtraído de um invariante
+
+typedef struct {
+    int phi;
+    int next;
+    int step;
+    IrOpcode update;          // IR_ADD_I ou IR_SUB_I
+    int init;
+} InductionVariable;
+
+static int findInductionVariables(const IrFunction *f, const IrLoopInfo *info, int l, InductionVariable *out) {
+    const IrLoop *loop = &info->loops[l];
+    const IrBlock *header = &f->blocks[loop->header];
+    int count = 0;
+    for (int i = 0; i < header->count; i++) {
+        int phi = header->insts[i];
+        const IrInst *inst = &f->insts[phi];
+        if (inst->op != IR_PHI) break;
+        if (inst->type != TYPE_INTEGER || inst->removed) continue;
+        int init = -1, next = -1;
+        bool valid = true;
+        for (int p = 0; p < header->pred_count; p++) {
+            int operand = inst->operands[p];
+            if (header->preds[p] == loop->preheader) init = operand;
+            else if (next < 0) next = operand;
+            else if (next != operand) valid = false;
+        }
+        if (!valid || init < 0 || next < 0 || !irLoopContains(info, l, f->insts[next].block)) continue;
+        const IrInst *update = &f->insts[next];
+        int step = -1;
+        if (update->op == IR_ADD_I) {
+            if (update->operands[0] == phi) step = update->operands[1];
+            else if (update->operands[1] == phi) step = update->operands[0];
+        } else if (update->op == IR_SUB_I && update->operands[0] == phi) {
+            step = update->operands[1];
+        }
+        if (step < 0 || !isInvariant(f, info, l, step)) continue;
+        out[count++] = (InductionVariable){phi, next, step, update->op, init};
+    }
+    return count;
+}
+
+static bool isConstant(const IrFunction *f, int value, int64_t constant) {
+    const IrInst *inst = &f->insts[value];
+    return inst->op == IR_CONST && inst->constant.i == constant;
+}
+
+static int emitInst(IrFunction *f, int block, IrOpcode op, DataType type, int a, int b, int line) {
+    int id = irAddInst(f, -1, op, type, 2);
+    f->insts[id].line = line;
+    f->insts[id].operands[0] = a;
+    f->insts[id].operands[1] = b;
+    placeBeforeTerminator(f, block, id);
+    return id;
+}
+
+static int emitConstant(IrFunction *f, int block, DataType type, int64_t value, int line) {
+    int id = irAddInst(f, -1, IR_CONST, type, 0);
+    f->insts[id].line = line;
+    f->insts[id].constant.i = value;
+    placeBeforeTerminator(f, block, id);
+    return id;
+}
+
+// Cria op(a, b) antes do terminador do bloco, calculando em tempo de compilação
+// quando os dois operandos são constantes ou a operação é uma identidade
+static int emitBinary(IrFunction *f, int block, IrOpcode op, int a, int b, int line) {
+    if (op == IR_MUL_I && isConstant(f, a, 1)) return b;
+    if ((op == IR_MUL_I && isConstant(f, b, 1)) || (op != IR_MUL_I && isConstant(f, b, 0))) return a;
+    if (op == IR_ADD_I && isConstant(f, a, 0)) return b;
+    if (f->insts[a].op == IR_CONST && f->insts[b].op == IR_CONST) {
+        uint64_t x = (uint64_t)f->insts[a].constant.i, y = (uint64_t)f->insts[b].constant.i;
+        uint64_t result = op == IR_ADD_I ? x + y : op == IR_SUB_I ? x - y : x * y;
+        return emitConstant(f, block, TYPE_INTEGER, (int64_t)result, line);
+    }
+    return emitInst(f, block, op, TYPE_INTEGER, a, b, line);
+}
+
+static int positionOf(const IrBlock *block, int inst) {
+    for (int i = 0; i < block->count; i++) {
+        if (block->insts[i] == inst) return i;
+    }
+    return -1;
+}
+
+// Redução de força: phi * k, com k invariante, vira uma nova variável de
+// indução que começa em init * k e avança step * k a cada iteração. A
+// aritmética do inteiro é modular, então a igualdade vale mesmo com estouro.
+typedef struct {
+    int iv;
+    int factor;
+    int phi;
+} Reduction;
+
+static void reduceStrength(IrFunction *f, const IrLoopInfo *info, int l, const InductionVariable *ivs, int iv_count) {
+    const IrLoop *loop = &info->loops[l];
+    Reduction *reductions = NULL;
+    int reduction_count = 0, reduction_capacity = 0;
+    int *replaced = NULL;     // Pares (multiplicação, phi novo)
+    int replaced_count = 0, replaced_capacity = 0;
+
+    for (int k = 0; k < loop->block_count; k++) {
+        int b = loop->blocks[k];
+        for (int i = 0; i < f->blocks[b].count; i++) {
+            int id = f->blocks[b].insts[i];
+            const IrInst *inst = &f->insts[id];
+            if (inst->op != IR_MUL_I || inst->removed) continue;
+            int v = -1, factor = -1;
+            for (int n = 0; n < iv_count && v < 0; n++) {
+                if (inst->operands[0] == ivs[n].phi) factor = inst->operands[1];
+                else if (inst->operands[1] == ivs[n].phi) factor = inst->operands[0];
+                else continue;
+                v = n;
+            }
+            if (v < 0 || factor == ivs[v].phi || !isInvariant(f, info, l, factor)) continue;
+
+            int phi = -1;
+            for (int r = 0; r < reduction_count && phi < 0; r++) {
+                if (reductions[r].iv == v && reductions[r].factor == factor) phi = reductions[r].phi;
+            }
+            if (phi < 0) {
+                int line = inst->line;
+                int init = emitBinary(f, loop->preheader, IR_MUL_I, ivs[v].init, factor, line);
+                int step = emitBinary(f, loop->preheader, IR_MUL_I, ivs[v].step, factor, line);
+                const IrBlock *header = &f->blocks[loop->header];
+                phi = irAddInst(f, -1, IR_PHI, TYPE_INTEGER, header->pred_count);
+                int next = irAddInst(f, -1, ivs[v].update, TYPE_INTEGER, 2);
+                f->insts[phi].line = f->insts[ivs[v].phi].line;
+                f->insts[next].line = f->insts[ivs[v].next].line;
+                f->insts[next].column = f->insts[ivs[v].next].column;
+                f->insts[next].operands[0] = phi;
+                f->insts[next].operands[1] = step;
+                for (int p = 0; p < header->pred_count; p++) {
+                    f->insts[phi].operands[p] = header->preds[p] == loop->preheader ? init : next;
+                }
+                // Inserções antes da posição corrente deslocam a instrução visitada;
+                // revisitá-la é inofensivo porque ela será marcada como removida
+                irInsertInst(f, loop->header, 0, phi);
+                int update_block = f->insts[ivs[v].next].block;
+                irInsertInst(f, update_block, positionOf(&f->blocks[update_block], ivs[v].next) + 1, next);
+                if (b == loop->header) i++;
+
+                if (reduction_count == reduction_capacity) {
+                    reduction_capacity = reduction_capacity ? reduction_capacity * 2 : 4;
+                    reductions = realloc(reductions, sizeof(Reduction) * reduction_capacity);
+                    if (!reductions) {
+                        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                reductions[reduction_count++] = (Reduction){v, factor, phi};
+            }
+            if (replaced_count == replaced_capacity) {
+                replaced_capacity = replaced_capacity ? replaced_capacity * 2 : 8;
+                replaced = realloc(replaced, sizeof(int) * replaced_capacity);
+                if (!replaced) {
+                    fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            replaced[replaced_count++] = id;
+            replaced[replaced_count++] = phi;
+            f->insts[id].removed = true;
+        }
+    }
+
+    if (replaced_count > 0) {
+        int *replacement = checkedCalloc(f->inst_count, sizeof(int));
+        memset(replacement, 0xFF, sizeof(int) * f->inst_count);
+        for (int r = 0; r < replaced_count; r += 2) replacement[replaced[r]] = replaced[r + 1];
+        irReplaceUses(f, replacement);
+        free(replacement);
+    }
+    free(reductions);
+    free(replaced);
+}
+
+// Substituição do teste de saída: o laço for testa phi = limite antes de
+// incrementar. Comparar o valor já incrementado com limite + passo é
+// equivalente e deixa o bloco do incremento vazio, de modo que o desvio
+// condicional volta direto ao cabeçalho e o phi morre antes do incremento.
+static void replaceExitTest(IrFunction *f, const IrLoopInfo *info, int l, const InductionVariable *ivs,
+                            int iv_count, const int *use_count, int use_count_size) {
+    const IrLoop *loop = &info->loops[l];
+    for (int k = 0; k < loop->block_count; k++) {
+        int x = loop->blocks[k];
+        IrBlock *block = &f->blocks[x];
+        if (block->count == 0 || block->succ_count != 2) continue;
+        int br = block->insts[block->count - 1];
+        int cond = f->insts[br].operands[0];
+        const IrInst *test = &f->insts[cond];
+        if (cond >= use_count_size || use_count[cond] != 1) continue;
+        if (test->op != IR_EQ_I || test->block != x) continue;
+
+        int v = -1, limit = -1;
+        for (int n = 0; n < iv_count && v < 0; n++) {
+            if (test->operands[0] == ivs[n].phi) limit = test->operands[1];
+            else if (test->operands[1] == ivs[n].phi) limit = test->operands[0];
+            else continue;
+            v = n;
+        }
+        if (v < 0 || !isInvariant(f, info, l, limit)) continue;
+        int step_block = f->insts[ivs[v].next].block;
+        const IrBlock *step = &f->blocks[step_block];
+        bool movable = step->pred_count == 1 && step->preds[0] == x &&
+                       (block->succs[0] == step_block) != (block->succs[1] == step_block);
+        for (int i = 0; i + 1 < step->count && movable; i++) {
+            const IrInst *inst = &f->insts[step->insts[i]];
+            movable = inst->op == IR_CONST || (isArithmetic(inst->op) && !irHasSideEffects(f, inst));
+        }
+        if (!movable) continue;
+
+        // O incremento (e o que mais houver no bloco) sobe para antes do desvio
+        IrBlock *moved = &f->blocks[step_block];
+        int jump = moved->insts[moved->count - 1];
+        for (int i = 0; i + 1 < moved->count; i++) placeBeforeTerminator(f, x, moved->insts[i]);
+        moved->insts[0] = jump;
+        moved->count = 1;
+
+        int line = f->insts[cond].line;
+        int new_limit = emitBinary(f, loop->preheader, ivs[v].update, limit, ivs[v].step, line);
+        int new_test = irAddInst(f, -1, IR_EQ_I, TYPE_BOOLEAN, 2);
+        f->insts[new_test].line = line;
+        f->insts[new_test].operands[0] = ivs[v].next;
+        f->insts[new_test].operands[1] = new_limit;
+        placeBeforeTerminator(f, x, new_test);
+        f->insts[br].operands[0] = new_test;
+        f->insts[cond].removed = true;
+    }
+}
+
+void irOptimizeInductionVariables(IrFunction *f) {
+    IrLoopInfo info;
+    irFindLoops(f, &info);
+    int use_count_size = f->inst_count;
+    int *use_count = checkedCalloc(use_count_size, sizeof(int));
+    for (int i = 0; i < f->inst_count; i++) {
+        const IrInst *inst = &f->insts[i];
+        if (inst->removed) continue;
+        for (int j = 0; j < inst->operand_count; j++) use_count[inst->operands[j]]++;
+    }
+
+    for (int l = 0; l < info.count; l++) {
+        const IrBlock *header = &f->blocks[info.loops[l].header];
+        InductionVariable *ivs = checkedCalloc(header->count, sizeof(InductionVariable));
+        int iv_count = findInductionVariables(f, &info, l, ivs);
+        if (iv_count > 0) {
+            reduceStrength(f, &info, l, ivs, iv_count);
+            replaceExitTest(f, &info, l, ivs, iv_count, use_count, use_count_size);
+        }
+        free(ivs);
+    }
+
+    free(use_count);
+    irFreeLoops(&info);
+    irCompact(f);
+    removeEmptyBlocks(f);
+}
+
+// ---------------------------------------------------------------------------
+// Desdobramento de laços contados. Um laço interno cujo único bloco de saída
+// é o que volta ao cabeçalho, testando contador + 1 = limite (a forma deixada
+// pelo passe de variáveis de indução), executa exatamente limite - início
+// iterações. Esse número é calculado uma vez no pré-cabeçalho; o laço original
+// faz as (número mod fator) primeiras e uma cópia com o corpo repetido fator
+// vezes faz o restante, com um único teste de saída por volta:
+//
+//   pré-cabeçalho --resto = 0--> meio --acabou--> depois --> saída original
+//        |                        ^   |              ^
+//        v                        |   v              |
+//   laço original (resto) --------+  laço desdobrado +
+
+#define UNROLL_BUDGET 64      // Instruções do corpo depois de repetido
+
+typedef struct {
+    int loop;
+    int latch;                // Único bloco que volta ao cabeçalho e sai do laço
+    int exit;
+    int exit_index;           // Posição da saída nos sucessores do latch
+    int phi;                  // Contador
+    int next;                 // Contador + 1 (ou - 1 em downto)
+    int limit;
+    IrOpcode update;
+    int pre_index;            // Posições nos predecessores do cabeçalho
+    int latch_index;
+    int size;                 // Instruções do corpo
+    bool inclusive;           // O teste é contador = limite, antes do incremento (só a vetorização trata)
+} CountedLoop;
+
+static bool findCountedLoop(const IrFunction *f, const IrLoopInfo *info, int l, CountedLoop *out) {
+    const IrLoop *loop = &info->loops[l];
+    const IrBlock *header = &f->blocks[loop->header];
+    if (header->pred_count != 2) return false;
+    int pre_index = header->preds[0] == loop->preheader ? 0 : 1;
+    int latch = header->preds[1 - pre_index];
+    if (header->preds[pre_index] != loop->preheader || latch == loop->preheader) return false;
+
+    int size = 0;
+    for (int k = 0; k < loop->block_count; k++) {
+        int b = loop->blocks[k];
+        const IrBlock *block = &f->blocks[b];
+        if (info->innermost[b] != l) return false;
+        for (int s = 0; s < block->succ_count && b != latch; s++) {
+            if (!irLoopContains(info, l, block->succs[s])) return false;
+        }
+        size += block->count;
+    }
+
+    const IrBlock *x = &f->blocks[latch];
+    if (x->succ_count != 2 || x->count == 0) return false;
+    int exit_index = x->succs[0] == loop->header ? 1 : 0;
+    if (x->succs[1 - exit_index] != loop->header || irLoopContains(info, l, x->succs[exit_index])) return false;
+    const IrInst *br = &f->insts[x->insts[x->count - 1]];
+    const IrInst *test = &f->insts[br->operands[0]];
+    // O desvio sai quando o teste é verdadeiro
+    if (br->op != IR_BR || test->op != IR_EQ_I || exit_index != 0) return false;
+
+    for (int side = 0; side < 2; side++) {
+        int next = test->operands[side], limit = test->operands[1 - side];
+        const IrInst *update = &f->insts[next];
+        if (!isInvariant(f, info, l, limit) || (update->op != IR_ADD_I && update->op != IR_SUB_I)) continue;
+        int phi = -1;
+        if (isConstant(f, update->operands[1], 1)) phi = update->operands[0];
+        else if (update->op == IR_ADD_I && isConstant(f, update->operands[0], 1)) phi = update->operands[1];
+        if (phi < 0 || f->insts[phi].op != IR_PHI || f->insts[phi].block != loop->header) continue;
+        if (f->insts[phi].operands[1 - pre_index] != next) continue;
+        *out = (CountedLoop){l, latch, x->succs[exit_index], exit_index, phi, next, limit, update->op,
+                             pre_index, 1 - pre_index, size, false};
+        return true;
+    }
+    // Forma que o passe de variáveis de indução não trocou (o incremento tem outros usos)
+    for (int side = 0; side < 2; side++) {
+        int phi = test->operands[side], limit = test->operands[1 - side];
+        const IrInst *inst = &f->insts[phi];
+        if (inst->op != IR_PHI || inst->block != loop->header || !isInvariant(f, info, l, limit)) continue;
+        int next = inst->operands[1 - pre_index];
+        const IrInst *update = &f->insts[next];
+        if (update->op != IR_ADD_I && update->op != IR_SUB_I) continue;
+        bool steps = (update->operands[0] == phi && isConstant(f, update->operands[1], 1)) ||
+                     (update->op == IR_ADD_I && update->operands[1] == phi && isConstant(f, update->operands[0], 1));
+        if (!steps) continue;
+        *out = (CountedLoop){l, latch, x->succs[exit_index], exit_index, phi, next, limit, update->op,
+                             pre_index, 1 - pre_index, size, true};
+        return true;
+    }
+    return false;
+}
+
+static void setEdges(IrFunction *f, int block, const int *preds, int pred_count, const int *succs, int succ_count) {
+    IrBlock *b = &f->blocks[block];
+    b->preds = checkedCalloc(pred_count, sizeof(int));
+    memcpy(b->preds, preds, sizeof(int) * pred_count);
+    b->pred_count = b->pred_capacity = pred_count;
+    memcpy(b->succs, succs, sizeof(int) * succ_count);
+    b->succ_count = succ_count;
+}
+
+static int addPhi(IrFunction *f, int block, DataType type, int first, int second, int line) {
+    int phi = irAddInst(f, block, IR_PHI, type, 2);
+    f->insts[phi].line = line;
+    f->insts[phi].operands[0] = first;
+    f->insts[phi].operands[1] = second;
+    return phi;
+}
+
+static void addBranch(IrFunction *f, int block, int cond, int line) {
+    int br = irAddInst(f, block, IR_BR, TYPE_UNKNOWN, 1);
+    f->insts[br].line = line;
+    f->insts[br].operands[0] = cond;
+}
+
+static void unrollLoop(IrFunction *f, const IrLoopInfo *info, const CountedLoop *c, int factor) {
+    const IrLoop *loop = &info->loops[c->loop];
+    int l = c->loop, header = loop->header, pre = loop->preheader, latch = c->latch;
+    int body_count = loop->block_count;
+    int inst_count = f->inst_count, block_count = f->block_count;
+    int line = f->insts[c->phi].line;
+
+    // Valores do laço usados fora dele; depois do desdobramento chegam por phis
+    bool *escapes = checkedCalloc(inst_count, sizeof(bool));
+    int escape_count = 0;
+    for (int b = 0; b < block_count; b++) {
+        const IrBlock *block = &f->blocks[b];
+        if (block->removed || irLoopContains(info, l, b)) continue;
+        for (int i = 0; i < block->count; i++) {
+            const IrInst *inst = &f->insts[block->insts[i]];
+            for (int j = 0; j < inst->operand_count; j++) {
+                int v = inst->operands[j];
+                if (!escapes[v] && irLoopContains(info, l, f->insts[v].block)) {
+                    escapes[v] = true;
+                    escape_count++;
+                }
+            }
+        }
+    }
+
+    // Número de iterações e tamanho do resto, calculados uma vez
+    int init = f->insts[c->phi].operands[c->pre_index];
+    int trips = c->update == IR_ADD_I ? emitBinary(f, pre, IR_SUB_I, c->limit, init, line)
+                                      : emitBinary(f, pre, IR_SUB_I, init, c->limit, line);
+    int rest = emitInst(f, pre, IR_AND, TYPE_INTEGER, trips,
+                        emitConstant(f, pre, TYPE_INTEGER, factor - 1, line), line);
+    int rest_limit = emitBinary(f, pre, c->update, init, rest, line);
+    int no_rest = emitInst(f, pre, IR_EQ_I, TYPE_BOOLEAN, rest, emitConstant(f, pre, TYPE_INTEGER, 0, line), line);
+
+    int middle = irAddBlock(f);
+    int after = irAddBlock(f);
+    int *clones = checkedCalloc((size_t)factor * body_count, sizeof(int));
+    for (int n = 0; n < factor * body_count; n++) clones[n] = irAddBlock(f);
+    int *position = checkedCalloc(block_count, sizeof(int));
+    for (int k = 0; k < body_count; k++) position[loop->blocks[k]] = k;
+    int header_clone = clones[0], last_latch = clones[(factor - 1) * body_count + position[latch]];
+
+    // O pré-cabeçalho pula o laço de resto quando ele não tem iterações
+    IrInst *jump = &f->insts[f->blocks[pre].insts[f->blocks[pre].count - 1]];
+    jump->op = IR_BR;
+    jump->operands = arenaAlloc(&f->arena, sizeof(int));
+    jump->operands[0] = no_rest;
+    jump->operand_count = 1;
+    f->blocks[pre].succs[0] = middle;
+    f->blocks[pre].succs[1] = header;
+    f->blocks[pre].succ_count = 2;
+
+    // O laço original para em início + resto e sai para o meio
+    const IrBlock *latch_block = &f->blocks[latch];
+    int latch_br = latch_block->insts[latch_block->count - 1];
+    int rest_test = emitInst(f, latch, IR_EQ_I, TYPE_BOOLEAN, c->next, rest_limit, f->insts[latch_br].line);
+    f->insts[latch_br].operands[0] = rest_test;
+    f->blocks[latch].succs[c->exit_index] = middle;
+    IrBlock *exit = &f->blocks[c->exit];
+    for (int p = 0; p < exit->pred_count; p++) {
+        if (exit->preds[p] == latch) exit->preds[p] = after;
+    }
+
+    // Meio: valores na saída do laço de resto (ou iniciais, se ele não rodou)
+    const IrBlock *header_block = &f->blocks[header];
+    int phi_count = 0;
+    while (phi_count < header_block->count && f->insts[header_block->insts[phi_count]].op == IR_PHI) phi_count++;
+    int *phis = checkedCalloc(phi_count, sizeof(int));
+    int *middle_phis = checkedCalloc(phi_count, sizeof(int));
+    int *carried = checkedCalloc(phi_count, sizeof(int));
+    memcpy(phis, header_block->insts, sizeof(int) * phi_count);
+    int counter = -1;
+    for (int j = 0; j < phi_count; j++) {
+        const IrInst *phi = &f->insts[phis[j]];
+        middle_phis[j] = addPhi(f, middle, (DataType)phi->type, phi->operands[c->pre_index],
+                                phi->operands[c->latch_index], phi->line);
+        if (phis[j] == c->phi) counter = middle_phis[j];
+    }
+    int *middle_escapes = checkedCalloc(inst_count, sizeof(int));
+    for (int v = 0; v < inst_count; v++) {
+        if (!escapes[v]) continue;
+        int undefined = emitConstant(f, pre, (DataType)f->insts[v].type, 0, line);
+        middle_escapes[v] = addPhi(f, middle, (DataType)f->insts[v].type, undefined, v, line);
+    }
+    int done = irAddInst(f, middle, IR_EQ_I, TYPE_BOOLEAN, 2);
+    f->insts[done].line = line;
+    f->insts[done].operands[0] = counter;
+    f->insts[done].operands[1] = c->limit;
+    addBranch(f, middle, done, line);
+    setEdges(f, middle, (int[]){pre, latch}, 2, (int[]){after, header_clone}, 2);
+
+    // Cópias do corpo; na cópia k > 0 os phis do cabeçalho são os valores
+    // que a cópia anterior levaria de volta ao cabeçalho
+    // O latch ganhou o teste do resto, que também é copiado (e morre nas cópias)
+    int *map = checkedCalloc(f->inst_count, sizeof(int));
+    for (int k = 0; k < factor; k++) {
+        for (int n = 0; n < body_count; n++) {
+            int b = loop->blocks[n], cb = clones[k * body_count + n];
+            const IrBlock *source = &f->blocks[b];
+            for (int i = 0; i < source->count; i++) {
+                int id = source->insts[i];
+                if (f->insts[id].removed) continue;
+                if (b == header && i < phi_count) {
+                    map[id] = k == 0 ? irAddInst(f, cb, IR_PHI, (DataType)f->insts[id].type, 2) : carried[i];
+                    if (k == 0) f->insts[map[id]].line = f->insts[id].line;
+                    continue;
+                }
+                if (id == latch_br) {
+                    if (k < factor - 1) {
+                        int next_jump = irAddInst(f, cb, IR_JMP, TYPE_UNKNOWN, 0);
+                        f->insts[next_jump].line = f->insts[id].line;
+                    } else {
+                        int next = irLoopContains(info, l, f->insts[c->next].block) ? map[c->next] : c->next;
+                        int test = irAddInst(f, cb, IR_EQ_I, TYPE_BOOLEAN, 2);
+                        f->insts[test].line = f->insts[id].line;
+                        f->insts[test].operands[0] = next;
+                        f->insts[test].operands[1] = c->limit;
+                        addBranch(f, cb, test, f->insts[id].line);
+                    }
+                    continue;
+                }
+                int clone = irAddInst(f, cb, f->insts[id].op, (DataType)f->insts[id].type, f->insts[id].operand_count);
+                IrInst *copy = &f->insts[clone];
+                const IrInst *original = &f->insts[id];
+                copy->line = original->line;
+                copy->column = original->column;
+                copy->constant = original->constant;
+                copy->index = original->index;
+                for (int j = 0; j < original->operand_count; j++) {
+                    int v = original->operands[j];
+                    copy->operands[j] = irLoopContains(info, l, f->insts[v].block) ? map[v] : v;
+                }
+                map[id] = clone;
+            }
+
+            int preds[2], succs[2];
+            int pred_count = 0, succ_count = 0;
+            int *cloned_preds = NULL;
+            if (b == header) {
+                if (k == 0) {
+                    preds[pred_count++] = middle;
+                    preds[pred_count++] = last_latch;
+                } else {
+                    preds[pred_count++] = clones[(k - 1) * body_count + position[latch]];
+                }
+            } else {
+                cloned_preds = checkedCalloc(source->pred_count, sizeof(int));
+                for (int p = 0; p < source->pred_count; p++) {
+                    cloned_preds[p] = clones[k * body_count + position[source->preds[p]]];
+                }
+            }
+            if (b == latch) {
+                if (k < factor - 1) {
+                    succs[succ_count++] = clones[(k + 1) * body_count];
+                } else {
+                    succs[succ_count++] = after;
+                    succs[succ_count++] = header_clone;
+                }
+            } else {
+                for (int s = 0; s < source->succ_count; s++) {
+                    succs[succ_count++] = clones[k * body_count + position[source->succs[s]]];
+                }
+            }
+            if (cloned_preds) {
+                setEdges(f, cb, cloned_preds, f->blocks[b].pred_count, succs, succ_count);
+                free(cloned_preds);
+            } else {
+                setEdges(f, cb, preds, pred_count, succs, succ_count);
+            }
+        }
+        for (int j = 0; j < phi_count; j++) {
+            int v = f->insts[phis[j]].operands[c->latch_index];
+            carried[j] = irLoopContains(info, l, f->insts[v].block) ? map[v] : v;
+        }
+    }
+    for (int j = 0; j < phi_count; j++) {
+        IrInst *phi = &f->insts[f->blocks[header_clone].insts[j]];
+        phi->operands[0] = middle_phis[j];
+        phi->operands[1] = carried[j];
+    }
+
+    // Depois: junta a saída do meio e a do laço desdobrado
+    int *after_escapes = checkedCalloc(inst_count, sizeof(int));
+    for (int v = 0; v < inst_count; v++) {
+        if (!escapes[v]) continue;
+        after_escapes[v] = addPhi(f, after, (DataType)f->insts[v].type, middle_escapes[v], map[v], line);
+    }
+    int after_jump = irAddInst(f, after, IR_JMP, TYPE_UNKNOWN, 0);
+    f->insts[after_jump].line = line;
+    setEdges(f, after, (int[]){middle, last_latch}, 2, (int[]){c->exit}, 1);
+
+    if (escape_count > 0) {
+        for (int b = 0; b < block_count; b++) {
+            const IrBlock *block = &f->blocks[b];
+            if (block->removed || irLoopContains(info, l, b)) continue;
+            for (int i = 0; i < block->count; i++) {
+                IrInst *inst = &f->insts[block->insts[i]];
+                for (int j = 0; j < inst->operand_count; j++) {
+                    int v = inst->operands[j];
+                    if (v < inst_count && escapes[v]) inst->operands[j] = after_escapes[v];
+                }
+            }
+        }
+    }
+
+    // Frequências estimadas: o laço de resto roda em média (fator - 1) / 2 voltas por
+    // entrada e as cópias dividem o restante; meio e depois executam uma vez por entrada
+    int64_t entries = f->blocks[pre].frequency, turns = f->blocks[header].frequency;
+    if (entries >= 0 && turns > 0) {
+        double rest_share = (double)entries * (factor - 1) / 2.0 / (double)turns;
+        if (rest_share > 1.0) rest_share = 1.0;
+        for (int n = 0; n < body_count; n++) {
+            IrBlock *original = &f->blocks[loop->blocks[n]];
+            if (original->frequency < 0) continue;
+            double total = (double)original->frequency;
+            for (int k = 0; k < factor; k++) {
+                f->blocks[clones[k * body_count + n]].frequency = (int64_t)(total * (1.0 - rest_share) / factor);
+            }
+            original->frequency = (int64_t)(total * rest_share);
+        }
+        f->blocks[middle].frequency = entries;
+        f->blocks[after].frequency = entries;
+    }
+
+    free(escapes);
+    free(clones);
+    free(position);
+    free(phis);
+    free(middle_phis);
+    free(carried);
+    free(middle_escapes);
+    free(after_escapes);
+    free(map);
+}
+
+void irUnrollLoops(IrFunction *f, int factor) {
+    if (factor < 2) return;
+    IrLoopInfo info;
+    irFindLoops(f, &info);
+    CountedLoop counted;
+    for (int l = 0; l < info.count; l++) {
+        if (!findCountedLoop(f, &info, l, &counted) || counted.inclusive) continue;
+        // Com perfil, o fator acompanha a média de voltas por entrada (até o dobro do
+        // pedido) e laços que nunca executaram não crescem; como só os laços medidos
+        // como longos crescem, o orçamento de tamanho dobra
+        int effective = factor, budget = UNROLL_BUDGET;
+        int64_t turns = f->blocks[info.loops[l].header].frequency;
+        int64_t entries = f->blocks[info.loops[l].preheader].frequency;
+        if (turns >= 0 && entries >= 0) {
+            int64_t average = entries > 0 ? turns / entries : turns;
+            effective = 1;
+            while (effective < 2 * factor && effective * 2 <= average / 2) effective *= 2;
+            budget = 2 * UNROLL_BUDGET;
+        }
+        // Corpos grandes usam um fator menor; o ganho no desvio já seria pequeno
+        while (effective > 1 && counted.size * effective > budget) effective /= 2;
+        if (effective > 1) unrollLoop(f, &info, &counted, effective);
+    }
+    irFreeLoops(&info);
+    irCompact(f);
+    removeEmptyBlocks(f);
+}
+
+// ---------------------------------------------------------------------------
+// Vetorização. Um laço contado de um só bloco cujo corpo lê e grava elementos
+// a[i + c] e combina esses valores com aritmética inteira ou real vira um
+// VLOOP no pré-cabeçalho, que os back-ends executam vários elementos por vez.
+// O VLOOP faz as primeiras count voltas, count múltiplo de VECTOR_WIDTH e menor
+// que o número de voltas; o laço original continua depois dele e faz o resto,
+// então os valores que saem do laço são sempre os da última volta escalar.
+// count é zerado quando algum acesso sairia dos limites, e o erro fica com o
+// laço escalar. Um phi acc = acc + x (ou acc - x) vira a redução do kernel
+
+#define VECTOR_WIDTH 4        // count serve às larguras de 2 (SSE2) e 4 (AVX2) elementos
+#define VECTOR_MAX_OFFSET (1 << 20)
+
+// Acesso a um array: elemento i + offset, na posição op do kernel
+typedef struct {
+    int array;
+    int64_t offset;
+    int op;
+    bool store;
+} VectorAccess;
+
+typedef struct {
+    IrProgram *program;
+    IrFunction *f;
+    const IrLoopInfo *info;
+    const CountedLoop *counted;
+    Kernel kernel;
+    KernelOp ops[KERNEL_MAX_OPS];
+    int *value_op;            // Operação do kernel de cada valor do laço, -1 se nenhuma
+    int inputs[KERNEL_MAX_OPS];
+    VectorAccess accesses[KERNEL_MAX_OPS];
+    int access_count;
+} Vectorizer;
+
+static OpCode kernelOpcode(IrOpcode op) {
+    switch (op) {
+        case IR_ADD_I: return OP_ADD_I;
+        case IR_SUB_I: return OP_SUB_I;
+        case IR_MUL_I: return OP_MUL_I;
+        case IR_NEG_I: return OP_NEG_I;
+        case IR_ADD_R: return OP_ADD_R;
+        case IR_SUB_R: return OP_SUB_R;
+        case IR_MUL_R: return OP_MUL_R;
+        case IR_DIV_R: return OP_DIV_R;
+        default: return OP_NOP;
+    }
+}
+
+static int addKernelOp(Vectorizer *v, OpCode op, DataType type, int a, int b, int32_t k) {
+    if (v->kernel.op_count == KERNEL_MAX_OPS) return -1;
+    int n = v->kernel.op_count++;
+    v->ops[n] = (KernelOp){(uint8_t)op, (uint8_t)type, (uint16_t)a, (uint16_t)b, k};
+    return n;
+}
+
+// Operação que fornece o valor: a do laço que o calcula ou uma entrada invariante
+static int kernelOperand(Vectorizer *v, int value) {
+    const IrInst *inst = &v->f->insts[value];
+    if (irLoopContains(v->info, v->counted->loop, inst->block)) return v->value_op[value];
+    for (int n = 0; n < v->kernel.op_count; n++) {
+        if (v->ops[n].op == OP_ARG && v->inputs[v->ops[n].k] == value) return n;
+    }
+    if (v->kernel.input_count == KERNEL_MAX_OPS) return -1;
+    int input = v->kernel.input_count;
+    int n = addKernelOp(v, OP_ARG, (DataType)inst->type, 0, 0, input);
+    if (n >= 0) v->inputs[v->kernel.input_count++] = value;
+    return n;
+}
+
+// Deslocamento c de um índice i + c (ou i - c); false se o índice tiver outra forma
+static bool indexOffset(const Vectorizer *v, int value, int64_t *offset) {
+    const IrFunction *f = v->f;
+    const IrInst *inst = &f->insts[value];
+    int phi = v->counted->phi;
+    if (value == phi) {
+        *offset = 0;
+        return true;
+    }
+    if (inst->op != IR_ADD_I && inst->op != IR_SUB_I) return false;
+    int other;
+    if (inst->operands[0] == phi) other = inst->operands[1];
+    else if (inst->op == IR_ADD_I && inst->operands[1] == phi) other = inst->operands[0];
+    else return false;
+    const IrInst *constant = &f->insts[other];
+    if (constant->op != IR_CONST) return false;
+    int64_t c = constant->constant.i;
+    if (c < -VECTOR_MAX_OFFSET || c > VECTOR_MAX_OFFSET) return false;
+    *offset = inst->op == IR_ADD_I ? c : -c;
+    return true;
+}
+
+static int addAccess(Vectorizer *v, const IrInst *inst, int index, int value, bool store) {
+    int64_t offset;
+    if (!indexOffset(v, index, &offset)) return -1;
+    const ArrayInfo *array = &v->program->arrays[inst->index];
+    int64_t k = (int64_t)array->offset + offset - array->low;
+    if (k <= -(1 << 27) || k >= (1 << 27)) return -1;
+    int a = 0;
+    if (store && (a = kernelOperand(v, value)) < 0) return -1;
+    int n = addKernelOp(v, store ? OP_STOREX : OP_LOADX, (DataType)(store ? TYPE_UNKNOWN : inst->type), a, a, (int32_t)k);
+    if (n < 0) return -1;
+    v->accesses[v->access_count++] = (VectorAccess){inst->index, offset, n, store};
+    return n;
+}
+
+// Dependências entre voltas: a leitura de a[i + l] e a gravação de a[i + s] só
+// podem ser feitas em blocos de elementos se nenhuma volta ler o que uma
+// anterior gravou (l < s) nem a gravação de um bloco atropelar leituras ainda
+// por fazer (l > s com a leitura depois da gravação). Duas gravações no mesmo
+// array precisam do mesmo deslocamento
+static bool independentAccesses(const Vectorizer *v) {
+    for (int x = 0; x < v->access_count; x++) {
+        const VectorAccess *store = &v->accesses[x];
+        if (!store->store) continue;
+        for (int y = 0; y < v->access_count; y++) {
+            const VectorAccess *other = &v->accesses[y];
+            if (y == x || other->array != store->array) continue;
+            if (other->store) {
+                if (other->offset != store->offset) return false;
+            } else if (other->offset < store->offset ||
+                       (other->offset > store->offset && other->op > store->op)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Reconhece o corpo; devolve o phi da redução em *reduction (-1 se nenhuma)
+static bool buildKernel(Vectorizer *v, int *reduction_phi, int *reduction_init) {
+    IrFunction *f = v->f;
+    const CountedLoop *c = v->counted;
+    const IrBlock *block = &f->blocks[c->latch];
+    int br = block->insts[block->count - 1];
+    int test = f->insts[br].operands[0];
+    int update = -1;
+    *reduction_phi = -1;
+    *reduction_init = -1;
+
+    for (int i = 0; i < block->count; i++) {
+        int id = block->insts[i];
+        const IrInst *inst = &f->insts[id];
+        if (inst->removed || id == br || id == test || id == c->phi || id == c->next) continue;
+        if (inst->op == IR_PHI) {
+            // Único phi além do contador: acumulador somado uma vez por volta
+            if (*reduction_phi >= 0) return false;
+            *reduction_phi = id;
+            *reduction_init = inst->operands[c->pre_index];
+            update = inst->operands[c->latch_index];
+            const IrInst *u = &f->insts[update];
+            if (u->block != c->latch) return false;
+            if (!(u->op == IR_ADD_I || u->op == IR_SUB_I || u->op == IR_ADD_R || u->op == IR_SUB_R)) return false;
+            if (u->operands[0] != id && !(u->operands[1] == id && (u->op == IR_ADD_I || u->op == IR_ADD_R))) {
+                return false;
+            }
+            continue;
+        }
+        if (id == update) {
+            const IrInst *u = inst;
+            int term = u->operands[0] == *reduction_phi ? u->operands[1] : u->operands[0];
+            if (term == *reduction_phi) return false;
+            int n = kernelOperand(v, term);
+            if (n < 0) return false;
+            v->kernel.reduction = n;
+            v->kernel.reduction_op = (uint8_t)kernelOpcode(u->op);
+            continue;
+        }
+        switch (inst->op) {
+            case IR_CONST:
+                // Constantes ficam no laço só se a movimentação de invariantes não rodou
+                return false;
+            case IR_LOADX: {
+                int n = addAccess(v, inst, inst->operands[0], -1, false);
+                if (n < 0) return false;
+                v->value_op[id] = n;
+                break;
+            }
+            case IR_STOREX:
+                if (addAccess(v, inst, inst->operands[1], inst->operands[0], true) < 0) return false;
+                break;
+            default: {
+                int64_t offset;
+                // Índices i + c só alimentam LOADX e STOREX, que os reconhecem pelo operando
+                if (indexOffset(v, id, &offset)) break;
+                OpCode op = kernelOpcode(inst->op);
+                if (op == OP_NOP) return false;
+                int a = kernelOperand(v, inst->operands[0]);
+                int b = inst->operand_count > 1 ? kernelOperand(v, inst->operands[1]) : a;
+                if (a < 0 || b < 0) return false;
+                int n = addKernelOp(v, op, (DataType)inst->type, a, b, 0);
+                if (n < 0) return false;
+                v->value_op[id] = n;
+                break;
+            }
+        }
+    }
+
+    if (*reduction_phi >= 0 && v->kernel.reduction < 0) return false;
+    bool stores = false;
+    for (int x = 0; x < v->access_count; x++) stores |= v->accesses[x].store;
+    return (stores || v->kernel.reduction >= 0) && v->access_count > 0 && independentAccesses(v);
+}
+
+static bool vectorizeLoop(IrProgram *program, IrFunction *f, const IrLoopInfo *info, const CountedLoop *c) {
+    const IrLoop *loop = &info->loops[c->loop];
+    if (loop->block_count != 1 || c->update != IR_ADD_I) return false;
+
+    Vectorizer v;
+    memset(&v, 0, sizeof(v));
+    v.program = program;
+    v.f = f;
+    v.info = info;
+    v.counted = c;
+    v.kernel.reduction = -1;
+    v.value_op = checkedCalloc(f->inst_count, sizeof(int));
+    for (int i = 0; i < f->inst_count; i++) v.value_op[i] = -1;
+    int reduction_phi, reduction_init;
+    bool ok = buildKernel(&v, &reduction_phi, &reduction_init);
+    free(v.value_op);
+    if (!ok) return false;
+
+    // count = ((voltas - 1) & -VECTOR_WIDTH), zerado se algum acesso sair do array;
+    // no teste antes do incremento, voltas = limite - início + 1
+    int pre = loop->preheader;
+    int line = f->insts[c->phi].line;
+    int init = f->insts[c->phi].operands[c->pre_index];
+    int trips = emitBinary(f, pre, IR_SUB_I, c->limit, init, line);
+    int before_last = c->inclusive ? trips
+                    : emitBinary(f, pre, IR_SUB_I, trips, emitConstant(f, pre, TYPE_INTEGER, 1, line), line);
+    int wide = emitInst(f, pre, IR_AND, TYPE_INTEGER, before_last,
+                        emitConstant(f, pre, TYPE_INTEGER, -VECTOR_WIDTH, line), line);
+    int zero = emitConstant(f, pre, TYPE_INTEGER, 0, line);
+    int inside = emitInst(f, pre, IR_GT_I, TYPE_BOOLEAN, wide, zero, line);
+    for (int x = 0; x < v.access_count; x++) {
+        const VectorAccess *access = &v.accesses[x];
+        bool repeated = false;
+        for (int y = 0; y < x; y++) {
+            repeated |= v.accesses[y].array == access->array && v.accesses[y].offset == access->offset;
+        }
+        if (repeated) continue;
+        // Posição do primeiro elemento: 0 <= first e count <= length - first
+        const ArrayInfo *array = &program->arrays[access->array];
+        int first = emitBinary(f, pre, IR_ADD_I, init,
+                               emitConstant(f, pre, TYPE_INTEGER, access->offset - array->low, line), line);
+        int room = emitBinary(f, pre, IR_SUB_I, emitConstant(f, pre, TYPE_INTEGER, array->length, line), first, line);
+        inside = emitInst(f, pre, IR_AND, TYPE_BOOLEAN, inside, emitInst(f, pre, IR_GE_I, TYPE_BOOLEAN, first, zero, line), line);
+        inside = emitInst(f, pre, IR_AND, TYPE_BOOLEAN, inside, emitInst(f, pre, IR_LE_I, TYPE_BOOLEAN, wide, room, line), line);
+    }
+    int count = emitInst(f, pre, IR_MUL_I, TYPE_INTEGER, wide, inside, line);
+
+    int reduces = reduction_phi >= 0;
+    DataType type = reduces ? (DataType)f->insts[reduction_phi].type : TYPE_INTEGER;
+    int vloop = irAddInst(f, -1, IR_VLOOP, type, 2 + reduces + v.kernel.input_count);
+    f->insts[vloop].line = line;
+    f->insts[vloop].index = program->kernel_count;
+    f->insts[vloop].operands[0] = init;
+    f->insts[vloop].operands[1] = count;
+    if (reduces) f->insts[vloop].operands[2] = reduction_init;
+    for (int n = 0; n < v.kernel.input_count; n++) f->insts[vloop].operands[2 + reduces + n] = v.inputs[n];
+    placeBeforeTerminator(f, pre, vloop);
+
+    // O laço escalar continua de onde o VLOOP parou
+    f->insts[c->phi].operands[c->pre_index] = emitBinary(f, pre, IR_ADD_I, init, count, line);
+    if (reduces) f->insts[reduction_phi].operands[c->pre_index] = vloop;
+
+    Kernel *kernels = realloc(program->kernels, sizeof(Kernel) * (program->kernel_count + 1));
+    v.kernel.ops = malloc(sizeof(KernelOp) * v.kernel.op_count);
+    if (!kernels || !v.kernel.ops) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(v.kernel.ops, v.ops, sizeof(KernelOp) * v.kernel.op_count);
+    program->kernels = kernels;
+    program->kernels[program->kernel_count++] = v.kernel;
+    return true;
+}
+
+int irVectorizeLoops(IrProgram *program, IrFunction *f) {
+    if (program->array_count == 0) return 0;
+    IrLoopInfo info;
+    irFindLoops(f, &info);
+    CountedLoop counted;
+    int vectorized = 0;
+    for (int l = 0; l < info.count; l++) {
+        if (findCountedLoop(f, &info, l, &counted) && vectorizeLoop(program, f, &info, &counted)) vectorized++;
+    }
+    irFreeLoops(&info);
+    irCompact(f);
+    return vectorized;
+}
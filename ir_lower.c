@@ -0,0 +1,1070 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+#include "trace.h"
+
+// Tradução da SSA para o bytecode de registradores: blocos em pós-ordem
+// reversa, saída da SSA por coalescência de phis e cópias paralelas, e
+// alocação por varredura linear sobre registradores virtuais (o bytecode
+// não limita o número de registradores)
+
+// Instrução com registradores virtuais; nos desvios k é um rótulo
+typedef struct {
+    OpCode op;
+    int a, b, c;
+    int k;
+    int line;
+    int column;
+} LInst;
+
+typedef struct {
+    const IrProgram *program;
+    const IrFunction *ir;
+    BytecodeProgram *out;
+    LInst *code;
+    int count;
+    int capacity;
+    uint8_t *vreg_types;
+    int vreg_count;
+    int *vreg;                // Registrador virtual de cada valor (classe do phi)
+    int *label_pos;           // Rótulos 0..block_count-1 são blocos; os demais, trechos de cópias
+    int label_count;
+    int *stubs;               // Pares (origem, destino) de cada trecho de cópias
+    int stub_count;
+    int *copies;              // Cópia paralela em construção: pares (destino, origem)
+    int copy_capacity;
+    int column;               // Coluna da instrução da SSA sendo traduzida
+    bool failed;
+} Lowerer;
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *grown = realloc(array, size ? size : 1);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static void *checkedCalloc(size_t count, size_t size) {
+    void *memory = calloc(count ? count : 1, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+static int emit(Lowerer *l, OpCode op, int a, int b, int c, int k, int line) {
+    if (l->count == l->capacity) {
+        l->capacity = l->capacity ? l->capacity * 2 : 64;
+        l->code = checkedRealloc(l->code, sizeof(LInst) * l->capacity);
+    }
+    l->code[l->count] = (LInst){op, a, b, c, k, line, l->column};
+    return l->count++;
+}
+
+static int newTemp(Lowerer *l, DataType type) {
+    l->vreg_types = checkedRealloc(l->vreg_types, l->vreg_count + 1);
+    l->vreg_types[l->vreg_count] = (uint8_t)type;
+    return l->vreg_count++;
+}
+
+static int addConstant(Lowerer *l, Value value) {
+    BytecodeProgram *p = l->out;
+    p->constants = checkedRealloc(p->constants, sizeof(Value) * (p->constant_count + 1));
+    p->constants[p->constant_count] = value;
+    return p->constant_count++;
+}
+
+// ---------------------------------------------------------------------------
+// Coalescência: cada phi e seus operandos formam uma classe com um único
+// registrador virtual, desde que nenhum par de membros interfira
+
+typedef struct {
+    const IrFunction *f;
+    size_t words;
+    uint64_t *live_out;       // Valores vivos na saída de cada bloco
+    int *idom;
+    int *rpo_index;
+    int *position;            // Posição de cada instrução no seu bloco
+    int *parent;              // Union-find das classes
+    int *next_member;         // Lista dos membros de cada classe
+} Coalescer;
+
+#define LIVE_BIT(set, words, b, v) ((set)[(size_t)(b) * (words) + (size_t)(v) / 64] & (1ULL << ((v) % 64)))
+#define LIVE_SET(set, words, b, v) ((set)[(size_t)(b) * (words) + (size_t)(v) / 64] |= (1ULL << ((v) % 64)))
+
+// Liveness por bloco; o operando de um phi é usado no fim do predecessor
+static void computeLiveOut(Coalescer *c, const int *order, int block_count) {
+    const IrFunction *f = c->f;
+    size_t words = c->words;
+    size_t size = (size_t)f->block_count * words;
+    uint64_t *live_in = checkedCalloc(size, sizeof(uint64_t));
+    uint64_t *use = checkedCalloc(size, sizeof(uint64_t));
+    uint64_t *def = checkedCalloc(size, sizeof(uint64_t));
+    uint64_t *phi_use = checkedCalloc(size, sizeof(uint64_t));
+    c->live_out = checkedCalloc(size, sizeof(uint64_t));
+
+    for (int i = 0; i < block_count; i++) {
+        int b = order[i];
+        const IrBlock *block = &f->blocks[b];
+        for (int j = 0; j < block->count; j++) {
+            int id = block->insts[j];
+            const IrInst *inst = &f->insts[id];
+            LIVE_SET(def, words, b, id);
+            if (inst->op == IR_PHI) {
+                for (int k = 0; k < inst->operand_count; k++) {
+                    LIVE_SET(phi_use, words, block->preds[k], inst->operands[k]);
+                }
+                continue;
+            }
+            for (int k = 0; k < inst->operand_count; k++) {
+                int v = inst->operands[k];
+                if (f->insts[v].block != b) LIVE_SET(use, words, b, v);
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = block_count - 1; i >= 0; i--) {
+            int b = order[i];
+            const IrBlock *block = &f->blocks[b];
+            for (size_t w = 0; w < words; w++) {
+                size_t at = (size_t)b * words + w;
+                uint64_t out = phi_use[at];
+                for (int s = 0; s < block->succ_count; s++) out |= live_in[(size_t)block->succs[s] * words + w];
+                uint64_t in = use[at] | (out & ~def[at]);
+                if (out != c->live_out[at] || in != live_in[at]) {
+                    c->live_out[at] = out;
+                    live_in[at] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+    free(live_in);
+    free(use);
+    free(def);
+    free(phi_use);
+}
+
+// a continua vivo logo depois da definição de b?
+static bool liveAfter(const Coalescer *c, int a, int b) {
+    const IrFunction *f = c->f;
+    int block = f->insts[b].block;
+    if (LIVE_BIT(c->live_out, c->words, block, a)) return true;
+    const IrBlock *blk = &f->blocks[block];
+    for (int j = c->position[b] + 1; j < blk->count; j++) {
+        const IrInst *inst = &f->insts[blk->insts[j]];
+        if (inst->removed || inst->op == IR_PHI) continue;
+        for (int k = 0; k < inst->operand_count; k++) {
+            if (inst->operands[k] == a) return true;
+        }
+    }
+    return false;
+}
+
+// Em SSA estrita dois valores interferem se um deles está vivo na definição do outro,
+// e isso só é possível quando a definição de um domina a do outro
+static bool interfere(const Coalescer *c, int a, int b) {
+    const IrFunction *f = c->f;
+    int block_a = f->insts[a].block, block_b = f->insts[b].block;
+    bool a_first = block_a == block_b ? c->position[a] < c->position[b]
+                 : irDominates(c->idom, c->rpo_index, block_a, block_b);
+    bool b_first = block_a == block_b ? c->position[b] < c->position[a]
+                 : irDominates(c->idom, c->rpo_index, block_b, block_a);
+    if (a_first) return liveAfter(c, a, b);
+    if (b_first) return liveAfter(c, b, a);
+    return false;
+}
+
+static int findClass(int *parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+static bool classesInterfere(const Coalescer *c, int x, int y) {
+    for (int a = x; a >= 0; a = c->next_member[a]) {
+        for (int b = y; b >= 0; b = c->next_member[b]) {
+            if (interfere(c, a, b)) return true;
+        }
+    }
+    return false;
+}
+
+static void coalescePhis(Lowerer *l, const int *order, int block_count) {
+    const IrFunction *f = l->ir;
+    Coalescer c;
+    c.f = f;
+    c.words = (size_t)(f->inst_count + 63) / 64;
+    c.idom = checkedCalloc(f->block_count, sizeof(int));
+    c.rpo_index = checkedCalloc(f->block_count, sizeof(int));
+    c.position = checkedCalloc(f->inst_count, sizeof(int));
+    c.parent = checkedCalloc(f->inst_count, sizeof(int));
+    c.next_member = checkedCalloc(f->inst_count, sizeof(int));
+    irDominators(f, order, block_count, c.idom);
+    for (int i = 0; i < block_count; i++) c.rpo_index[order[i]] = i;
+    for (int v = 0; v < f->inst_count; v++) {
+        c.parent[v] = v;
+        c.next_member[v] = -1;
+    }
+    bool any_phi = false;
+    for (int i = 0; i < block_count; i++) {
+        const IrBlock *block = &f->blocks[order[i]];
+        for (int j = 0; j < block->count; j++) {
+            c.position[block->insts[j]] = j;
+            if (f->insts[block->insts[j]].op == IR_PHI) any_phi = true;
+        }
+    }
+
+    if (any_phi) {
+        computeLiveOut(&c, order, block_count);
+        for (int i = 0; i < block_count; i++) {
+            const IrBlock *block = &f->blocks[order[i]];
+            for (int j = 0; j < block->count; j++) {
+                int phi = block->insts[j];
+                const IrInst *inst = &f->insts[phi];
+                if (inst->op != IR_PHI) continue;
+                for (int k = 0; k < inst->operand_count; k++) {
+                    int operand = inst->operands[k];
+                    // Parâmetros ficam presos aos registradores de argumento
+                    if (f->insts[operand].op == IR_PARAM) continue;
+                    int x = findClass(c.parent, phi), y = findClass(c.parent, operand);
+                    if (x == y || classesInterfere(&c, x, y)) continue;
+                    int tail = x;
+                    while (c.next_member[tail] >= 0) tail = c.next_member[tail];
+                    c.next_member[tail] = y;
+                    c.parent[y] = x;
+                }
+            }
+        }
+        free(c.live_out);
+    }
+
+    for (int v = 0; v < f->inst_count; v++) l->vreg[v] = findClass(c.parent, v);
+    free(c.idom);
+    free(c.rpo_index);
+    free(c.position);
+    free(c.parent);
+    free(c.next_member);
+}
+
+// Cópias da aresta from -> to para os phis de to que não foram coalescidos
+static int collectCopies(Lowerer *l, int from, int to) {
+    const IrFunction *f = l->ir;
+    const IrBlock *target = &f->blocks[to];
+    int index = 0;
+    while (index < target->pred_count && target->preds[index] != from) index++;
+    int count = 0;
+    for (int i = 0; i < target->count; i++) {
+        int phi = target->insts[i];
+        if (f->insts[phi].op != IR_PHI) continue;
+        int dst = l->vreg[phi], src = l->vreg[f->insts[phi].operands[index]];
+        if (dst == src) continue;
+        if (2 * (count + 1) > l->copy_capacity) {
+            l->copy_capacity = 2 * (count + 1) * 2;
+            l->copies = checkedRealloc(l->copies, sizeof(int) * l->copy_capacity);
+        }
+        l->copies[2 * count] = dst;
+        l->copies[2 * count + 1] = src;
+        count++;
+    }
+    return count;
+}
+
+// Sequencializa a cópia paralela: primeiro os destinos que ninguém mais lê;
+// ciclos são quebrados salvando um destino em um temporário
+static void emitEdgeCopies(Lowerer *l, int from, int to, int line) {
+    int count = collectCopies(l, from, to);
+    int *copies = l->copies;
+    while (count > 0) {
+        bool progress = false;
+        for (int i = 0; i < count; i++) {
+            int dst = copies[2 * i];
+            bool read = false;
+            for (int j = 0; j < count && !read; j++) read = j != i && copies[2 * j + 1] == dst;
+            if (read) continue;
+            emit(l, OP_MOV, dst, copies[2 * i + 1], 0, 0, line);
+            copies[2 * i] = copies[2 * (count - 1)];
+            copies[2 * i + 1] = copies[2 * (count - 1) + 1];
+            count--;
+            progress = true;
+            break;
+        }
+        if (progress) continue;
+        int dst = copies[0];
+        int temp = newTemp(l, (DataType)l->vreg_types[dst]);
+        emit(l, OP_MOV, temp, dst, 0, 0, line);
+        for (int j = 0; j < count; j++) {
+            if (copies[2 * j + 1] == dst) copies[2 * j + 1] = temp;
+        }
+    }
+}
+
+// Rótulo para desviar de from a to: o próprio bloco ou um trecho com as cópias
+static int edgeLabel(Lowerer *l, int from, int to) {
+    if (collectCopies(l, from, to) == 0) return to;
+    l->stubs = checkedRealloc(l->stubs, sizeof(int) * 2 * (l->stub_count + 1));
+    l->stubs[2 * l->stub_count] = from;
+    l->stubs[2 * l->stub_count + 1] = to;
+    l->stub_count++;
+    return l->label_count++;
+}
+
+static void lowerInst(Lowerer *l, int id, int next_block) {
+    const IrFunction *f = l->ir;
+    const IrInst *inst = &f->insts[id];
+    const IrBlock *block = &f->blocks[inst->block];
+    const int *vreg = l->vreg;
+    int def = vreg[id];
+    int line = inst->line;
+    l->column = inst->column;
+
+    switch (inst->op) {
+        case IR_CONST:
+            if (inst->type != TYPE_REAL && inst->constant.i >= INT32_MIN && inst->constant.i <= INT32_MAX) {
+                emit(l, OP_LOADI, def, 0, 0, (int32_t)inst->constant.i, line);
+            } else {
+                emit(l, OP_LOADK, def, 0, 0, addConstant(l, inst->constant), line);
+            }
+            break;
+        case IR_PARAM:
+        case IR_PHI:
+            break;
+        case IR_COPY:
+            emit(l, OP_MOV, def, vreg[inst->operands[0]], 0, 0, line);
+            break;
+        case IR_LOADG:
+            emit(l, OP_LOADG, def, 0, 0, inst->index, line);
+            break;
+        case IR_STOREG:
+            emit(l, OP_STOREG, vreg[inst->operands[0]], 0, 0, inst->index, line);
+            break;
+        case IR_LOADX:
+            emit(l, OP_LOADX, def, vreg[inst->operands[0]], inst->index, 0, line);
+            break;
+        case IR_STOREX:
+            emit(l, OP_STOREX, vreg[inst->operands[0]], vreg[inst->operands[1]], inst->index, 0, line);
+            break;
+        case IR_VLOOP:
+            for (int j = 0; j < inst->operand_count; j++) emit(l, OP_ARG, vreg[inst->operands[j]], 0, 0, 0, line);
+            emit(l, OP_VLOOP, def, 0, 0, inst->index, line);
+            break;
+        case IR_CALL:
+            for (int j = 0; j < inst->operand_count; j++) emit(l, OP_ARG, vreg[inst->operands[j]], 0, 0, 0, line);
+            emit(l, OP_CALL, 0, 0, 0, inst->index, line);
+            break;
+        case IR_WRITE_I: emit(l, OP_WRITE_I, vreg[inst->operands[0]], 0, 0, 0, line); break;
+        case IR_WRITE_R: emit(l, OP_WRITE_R, vreg[inst->operands[0]], 0, 0, 0, line); break;
+        case IR_WRITE_B: emit(l, OP_WRITE_B, vreg[inst->operands[0]], 0, 0, 0, line); break;
+        case IR_WRITE_S: emit(l, OP_WRITE_S, 0, 0, 0, inst->index, line); break;
+        case IR_WRITELN: emit(l, OP_WRITELN, 0, 0, 0, 0, line); break;
+        case IR_READ_I: emit(l, OP_READ_I, def, 0, 0, 0, line); break;
+        case IR_READ_R: emit(l, OP_READ_R, def, 0, 0, 0, line); break;
+        case IR_PROFILE: emit(l, OP_PROFILE, 0, 0, 0, inst->index, line); break;
+        case IR_JMP:
+            emitEdgeCopies(l, inst->block, block->succs[0], line);
+            if (block->succs[0] != next_block) emit(l, OP_JMP, 0, 0, 0, block->succs[0], line);
+            break;
+        case IR_BR: {
+            // O desvio condicional leva ao trecho de cópias da sua aresta; as
+            // cópias do outro lado vêm logo depois dele
+            int cond = vreg[inst->operands[0]];
+            int taken = block->succs[0], other = block->succs[1];
+            OpCode op = OP_JMPT;
+            if (taken == next_block) {
+                taken = block->succs[1];
+                other = block->succs[0];
+                op = OP_JMPF;
+            }
+            emit(l, op, cond, 0, 0, edgeLabel(l, inst->block, taken), line);
+            emitEdgeCopies(l, inst->block, other, line);
+            if (other != next_block) emit(l, OP_JMP, 0, 0, 0, other, line);
+            break;
+        }
+        case IR_RET:
+            emit(l, l->ir == &l->program->functions[l->program->main_function] ? OP_HALT : OP_RET, 0, 0, 0, 0, line);
+            break;
+        default:
+            if (inst->op >= IR_ADD_I && inst->op <= IR_NOT) {
+                OpCode op = (OpCode)(OP_ADD_I + (inst->op - IR_ADD_I));
+                int right = inst->operand_count > 1 ? vreg[inst->operands[1]] : 0;
+                emit(l, op, def, vreg[inst->operands[0]], right, 0, line);
+            } else {
+                l->failed = true;
+            }
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Liveness sobre o código linear e alocação de registradores
+
+// Posições: o uso na instrução i é 2i e a definição é 2i+1; um valor vivo na
+// entrada de um bloco começa antes dos usos da primeira instrução
+typedef struct {
+    int *start;
+    int *end;
+} Intervals;
+
+static bool isJump(OpCode op) {
+    return op == OP_JMP || op == OP_JMPF || op == OP_JMPT;
+}
+
+static bool endsBlock(OpCode op) {
+    return isJump(op) || op == OP_RET || op == OP_HALT;
+}
+
+static void computeIntervals(Lowerer *l, const int *label_pos, Intervals *iv) {
+    int n = l->count, v_count = l->vreg_count;
+    iv->start = checkedCalloc(v_count, sizeof(int));
+    iv->end = checkedCalloc(v_count, sizeof(int));
+    for (int v = 0; v < v_count; v++) {
+        iv->start[v] = -1;
+        iv->end[v] = -1;
+    }
+
+    // Blocos do código linear
+    bool *leader = checkedCalloc(n + 1, sizeof(bool));
+    leader[0] = true;
+    for (int i = 0; i < n; i++) {
+        if (isJump(l->code[i].op)) leader[label_pos[l->code[i].k]] = true;
+        if (endsBlock(l->code[i].op)) leader[i + 1] = true;
+    }
+    int *block_of = checkedCalloc(n + 1, sizeof(int));
+    int *block_start = checkedCalloc(n + 1, sizeof(int));
+    int block_count = 0;
+    for (int i = 0; i < n; i++) {
+        if (leader[i]) block_start[block_count++] = i;
+        block_of[i] = block_count - 1;
+    }
+    block_start[block_count] = n;
+
+    size_t words = (size_t)(v_count + 63) / 64;
+    uint64_t *live_in = checkedCalloc((size_t)block_count * words, sizeof(uint64_t));
+    uint64_t *live_out = checkedCalloc((size_t)block_count * words, sizeof(uint64_t));
+    uint64_t *use = checkedCalloc((size_t)block_count * words, sizeof(uint64_t));
+    uint64_t *def = checkedCalloc((size_t)block_count * words, sizeof(uint64_t));
+#define BIT(set, b, v) ((set)[(size_t)(b) * words + (size_t)(v) / 64] & (1ULL << ((v) % 64)))
+#define SET(set, b, v) ((set)[(size_t)(b) * words + (size_t)(v) / 64] |= (1ULL << ((v) % 64)))
+
+    for (int i = 0; i < n; i++) {
+        const LInst *ins = &l->code[i];
+        int b = block_of[i];
+        int operands = opcodeOperands(ins->op);
+        int uses[3] = {-1, -1, -1};
+        if (operands & OPERAND_USE_A) uses[0] = ins->a;
+        if (operands & OPERAND_USE_B) uses[1] = ins->b;
+        if (operands & OPERAND_USE_C) uses[2] = ins->c;
+        for (int u = 0; u < 3; u++) {
+            int v = uses[u];
+            if (v < 0) continue;
+            if (!BIT(def, b, v)) SET(use, b, v);
+            if (iv->start[v] < 0) iv->start[v] = 2 * i;
+            iv->end[v] = 2 * i;
+        }
+        if (operands & OPERAND_DEF_A) {
+            int v = ins->a;
+            SET(def, b, v);
+            if (iv->start[v] < 0 || iv->start[v] > 2 * i + 1) iv->start[v] = 2 * i + 1;
+            if (iv->end[v] < 2 * i + 1) iv->end[v] = 2 * i + 1;
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = block_count - 1; b >= 0; b--) {
+            const LInst *last = &l->code[block_start[b + 1] - 1];
+            int succs[2], succ_count = 0;
+            if (isJump(last->op)) succs[succ_count++] = block_of[label_pos[last->k]];
+            bool falls = last->op != OP_JMP && last->op != OP_RET && last->op != OP_HALT;
+            if (falls && b + 1 < block_count) succs[succ_count++] = b + 1;
+            for (size_t w = 0; w < words; w++) {
+                uint64_t out = 0;
+                for (int s = 0; s < succ_count; s++) out |= live_in[(size_t)succs[s] * words + w];
+                uint64_t in = use[(size_t)b * words + w] | (out & ~def[(size_t)b * words + w]);
+                if (out != live_out[(size_t)b * words + w] || in != live_in[(size_t)b * words + w]) {
+                    live_out[(size_t)b * words + w] = out;
+                    live_in[(size_t)b * words + w] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Estende os intervalos sobre os blocos em que o valor está vivo
+    for (int b = 0; b < block_count; b++) {
+        for (size_t w = 0; w < words; w++) {
+            uint64_t in = live_in[(size_t)b * words + w], out = live_out[(size_t)b * words + w];
+            for (uint64_t bits = in | out; bits; bits &= bits - 1) {
+                int v = (int)(w * 64 + (size_t)__builtin_ctzll(bits));
+                if (in & (1ULL << (v % 64))) {
+                    int s = block_start[b] > 0 ? 2 * block_start[b] - 1 : 0;
+                    if (iv->start[v] < 0 || iv->start[v] > s) iv->start[v] = s;
+                }
+                if (out & (1ULL << (v % 64))) {
+                    int e = 2 * (block_start[b + 1] - 1) + 1;
+                    if (iv->end[v] < e) iv->end[v] = e;
+                }
+            }
+        }
+    }
+#undef BIT
+#undef SET
+    free(leader);
+    free(block_of);
+    free(block_start);
+    free(live_in);
+    free(live_out);
+    free(use);
+    free(def);
+}
+
+// Heap de intervalos ativos ordenado pelo fim
+typedef struct {
+    int *items;
+    int count;
+    const int *end;
+} ActiveHeap;
+
+static void heapPush(ActiveHeap *h, int v) {
+    int i = h->count++;
+    while (i > 0 && h->end[h->items[(i - 1) / 2]] > h->end[v]) {
+        h->items[i] = h->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->items[i] = v;
+}
+
+static int heapPop(ActiveHeap *h) {
+    int top = h->items[0];
+    int last = h->items[--h->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= h->count) break;
+        if (child + 1 < h->count && h->end[h->items[child + 1]] < h->end[h->items[child]]) child++;
+        if (h->end[h->items[child]] >= h->end[last]) break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if (h->count > 0) h->items[i] = last;
+    return top;
+}
+
+// Registradores livres por classe (real ou inteiro), com marcação para
+// permitir retirar um registrador específico pela dica de cópia
+typedef struct {
+    int *stack[2];
+    int count[2];
+    bool *is_free;
+} FreeRegisters;
+
+static const int *sortStart;
+
+static int compareByStart(const void *x, const void *y) {
+    int a = *(const int *)x, b = *(const int *)y;
+    if (sortStart[a] != sortStart[b]) return sortStart[a] < sortStart[b] ? -1 : 1;
+    return (a > b) - (a < b);
+}
+
+// Devolve o número de registradores usados; reg[v] recebe o registrador de cada valor
+static int allocateRegisters(Lowerer *l, const Intervals *iv, int *reg, uint8_t **types_out) {
+    const IrFunction *f = l->ir;
+    int v_count = l->vreg_count;
+    int *order = checkedCalloc(v_count, sizeof(int));
+    int order_count = 0;
+    for (int v = 0; v < v_count; v++) {
+        reg[v] = -1;
+        bool param = v < f->inst_count && f->insts[v].op == IR_PARAM;
+        if (iv->start[v] >= 0 && !param) order[order_count++] = v;
+    }
+    sortStart = iv->start;
+    qsort(order, order_count, sizeof(int), compareByStart);
+
+    // Dica de cópia: o valor definido por MOV tenta herdar o registrador da origem
+    int *hint = checkedCalloc(v_count, sizeof(int));
+    for (int v = 0; v < v_count; v++) hint[v] = -1;
+    for (int i = 0; i < l->count; i++) {
+        if (l->code[i].op == OP_MOV) hint[l->code[i].a] = l->code[i].b;
+    }
+
+    int capacity = v_count + f->param_count + 1;
+    uint8_t *types = checkedCalloc(capacity, 1);
+    FreeRegisters free_regs;
+    free_regs.stack[0] = checkedCalloc(capacity * 2, sizeof(int));
+    free_regs.stack[1] = checkedCalloc(capacity * 2, sizeof(int));
+    free_regs.count[0] = free_regs.count[1] = 0;
+    free_regs.is_free = checkedCalloc(capacity, sizeof(bool));
+    ActiveHeap active = {checkedCalloc(v_count + 1, sizeof(int)), 0, iv->end};
+    int register_count = f->param_count;
+
+    // Parâmetros ficam nos registradores 0..P-1, onde a chamada os deposita
+    for (int p = 0; p < f->param_count; p++) types[p] = f->param_types[p];
+    bool *param_live = checkedCalloc(f->param_count + 1, sizeof(bool));
+    for (int v = 0; v < f->inst_count; v++) {
+        const IrInst *inst = &f->insts[v];
+        if (inst->removed || inst->op != IR_PARAM || iv->start[v] < 0) continue;
+        reg[v] = inst->index;
+        param_live[inst->index] = true;
+        heapPush(&active, v);
+    }
+    for (int p = f->param_count - 1; p >= 0; p--) {
+        if (param_live[p]) continue;
+        int cls = types[p] == TYPE_REAL;
+        free_regs.stack[cls][free_regs.count[cls]++] = p;
+        free_regs.is_free[p] = true;
+    }
+
+    for (int i = 0; i < order_count; i++) {
+        int v = order[i];
+        while (active.count > 0 && iv->end[active.items[0]] < iv->start[v]) {
+            int r = reg[heapPop(&active)];
+            int cls = types[r] == TYPE_REAL;
+            free_regs.stack[cls][free_regs.count[cls]++] = r;
+            free_regs.is_free[r] = true;
+        }
+        int cls = l->vreg_types[v] == TYPE_REAL;
+        int r = -1;
+        int source = hint[v];
+        if (source >= 0 && reg[source] >= 0 && free_regs.is_free[reg[source]] &&
+            (types[reg[source]] == TYPE_REAL) == cls) {
+            r = reg[source];
+        }
+        while (r < 0 && free_regs.count[cls] > 0) {
+            int candidate = free_regs.stack[cls][--free_regs.count[cls]];
+            if (free_regs.is_free[candidate]) r = candidate;
+        }
+        if (r < 0) {
+            r = register_count++;
+            types[r] = l->vreg_types[v];
+        }
+        free_regs.is_free[r] = false;
+        reg[v] = r;
+        heapPush(&active, v);
+    }
+
+    free(order);
+    free(hint);
+    free(free_regs.stack[0]);
+    free(free_regs.stack[1]);
+    free(free_regs.is_free);
+    free(active.items);
+    free(param_live);
+    *types_out = types;
+    return register_count;
+}
+
+// ---------------------------------------------------------------------------
+// Desvios: ordem dos blocos, rotação dos laços e encadeamento de saltos
+
+#define ROTATE_LIMIT 3        // Instruções do teste de um laço copiadas para o fim do corpo
+
+// Instruções sem efeito além do registrador que definem: podem ser copiadas
+static bool isDuplicable(OpCode op) {
+    return (opcodeOperands(op) & OPERAND_DEF_A) && op != OP_READ_I && op != OP_READ_R;
+}
+
+// Rotação: o JMP de volta ao cabeçalho de um laço cujo teste é curto recebe uma
+// cópia do teste e desvia direto para o corpo. Cada volta passa a ter um único desvio
+// tomado em vez do JMP para o cabeçalho seguido do desvio condicional
+static void rotateLoops(Lowerer *l) {
+    int n = l->count, extra = 0;
+    int *test = checkedCalloc(n, sizeof(int));
+    for (int i = 0; i < n; i++) {
+        test[i] = -1;
+        if (l->code[i].op != OP_JMP || l->label_pos[l->code[i].k] > i) continue;
+        int p = l->label_pos[l->code[i].k], q = p;
+        while (q < n && q - p < ROTATE_LIMIT && isDuplicable(l->code[q].op)) q++;
+        if (q >= n - 1 || q >= i || (l->code[q].op != OP_JMPF && l->code[q].op != OP_JMPT)) continue;
+        test[i] = q;
+        extra += q - p + 1;
+    }
+    if (extra == 0) {
+        free(test);
+        return;
+    }
+
+    LInst *code = checkedCalloc(n + extra, sizeof(LInst));
+    int *new_index = checkedCalloc(n + 1, sizeof(int));
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        new_index[i] = count;
+        if (test[i] < 0) {
+            code[count++] = l->code[i];
+            continue;
+        }
+        int p = l->label_pos[l->code[i].k], q = test[i];
+        const LInst *branch = &l->code[q];
+        // Rótulo novo para a instrução depois do teste, que o laço alcançava sem salto
+        l->label_pos = checkedRealloc(l->label_pos, sizeof(int) * (l->label_count + 1));
+        l->label_pos[l->label_count] = q + 1;
+        for (int j = p; j < q; j++) code[count++] = l->code[j];
+        code[count] = *branch;
+        code[count].op = branch->op == OP_JMPF ? OP_JMPT : OP_JMPF;
+        code[count++].k = l->label_count++;
+        code[count] = *branch;
+        code[count].op = OP_JMP;
+        code[count++].k = branch->k;
+    }
+    new_index[n] = count;
+    for (int label = 0; label < l->label_count; label++) {
+        if (l->label_pos[label] >= 0) l->label_pos[label] = new_index[l->label_pos[label]];
+    }
+    free(l->code);
+    l->code = code;
+    l->count = l->capacity = count;
+    free(new_index);
+    free(test);
+}
+
+// Valor conhecido de R[reg] ao chegar em pc pelo código anterior: 1 ou 0 quando um
+// desvio condicional sobre ele foi atravessado sem salto e nada o redefiniu; -1 se
+// desconhecido. Instruções que são destino de desvios juntam caminhos e param a busca
+static int knownCondition(const Function *f, const bool *target, const bool *removed, int pc, int reg) {
+    for (int j = pc - 1; j >= 0 && !target[j + 1]; j--) {
+        const Instruction *ins = &f->code[j];
+        if (removed[j]) continue;
+        if ((ins->op == OP_JMPF || ins->op == OP_JMPT) && ins->a == reg) return ins->op == OP_JMPF;
+        if (ins->op == OP_JMP || ins->op == OP_RET || ins->op == OP_HALT) return -1;
+        if ((opcodeOperands((OpCode)ins->op) & OPERAND_DEF_A) && ins->a == reg) return -1;
+    }
+    return -1;
+}
+
+// Encadeamento sobre o bytecode final, onde as cópias coalescidas já sumiram e
+// deixaram blocos vazios: desvios para um JMP vão direto ao destino dele, desvios
+// para um teste de resultado conhecido pulam o teste, e saltos para a instrução
+// seguinte e código inalcançável desaparecem
+static void threadJumps(Function *f) {
+    int n = f->count;
+    bool *target = checkedCalloc(n + 1, sizeof(bool));
+    bool *removed = checkedCalloc(n, sizeof(bool));
+    for (bool changed = true; changed;) {
+        changed = false;
+        memset(target, 0, sizeof(bool) * (n + 1));
+        for (int pc = 0; pc < n; pc++) {
+            if (!removed[pc] && isJump((OpCode)f->code[pc].op)) target[f->code[pc].k] = true;
+        }
+        for (int pc = 0; pc < n; pc++) {
+            Instruction *ins = &f->code[pc];
+            if (removed[pc] || !isJump((OpCode)ins->op)) continue;
+            // Um teste já decidido pelo caminho até ele vira salto ou desaparece
+            if (ins->op != OP_JMP) {
+                int known = knownCondition(f, target, removed, pc, ins->a);
+                if (known >= 0) {
+                    if (known == (ins->op == OP_JMPT)) ins->op = OP_JMP;
+                    else removed[pc] = true;
+                    changed = true;
+                    continue;
+                }
+            }
+            // Valor do registrador do teste no destino, do ponto de vista deste desvio
+            int k = ins->k;
+            for (int hops = 0; hops < n; hops++) {
+                while (k < n - 1 && removed[k]) k++;
+                const Instruction *next = &f->code[k];
+                if (next->op == OP_JMP && next->k != k) {
+                    k = next->k;
+                    continue;
+                }
+                if (next->op != OP_JMPF && next->op != OP_JMPT) break;
+                int known = ins->op != OP_JMP && ins->a == next->a ? ins->op == OP_JMPT
+                          : knownCondition(f, target, removed, pc, next->a);
+                if (known < 0) break;
+                k = known == (next->op == OP_JMPT) ? next->k : k + 1;
+            }
+            if (k != ins->k) {
+                // O novo destino junta caminhos: as buscas seguintes param nele
+                ins->k = k;
+                target[k] = true;
+                changed = true;
+            }
+            // Salto para a próxima instrução mantida
+            int next = pc + 1;
+            while (next < n && removed[next]) next++;
+            if (ins->k == next) {
+                removed[pc] = true;
+                changed = true;
+            }
+        }
+        // Depois de um salto incondicional, só um destino de desvio volta a ser alcançável
+        for (int pc = 0; pc + 1 < n; pc++) {
+            OpCode op = (OpCode)f->code[pc].op;
+            if (removed[pc] || (op != OP_JMP && op != OP_RET && op != OP_HALT)) continue;
+            for (int dead = pc + 1; dead < n && !target[dead] && !removed[dead]; dead++) {
+                removed[dead] = true;
+                changed = true;
+            }
+        }
+    }
+
+    int *new_index = checkedCalloc(n + 1, sizeof(int));
+    int kept = 0;
+    for (int pc = 0; pc < n; pc++) {
+        new_index[pc] = kept;
+        if (!removed[pc]) kept++;
+    }
+    new_index[n] = kept;
+    for (int pc = 0, out = 0; pc < n; pc++) {
+        if (removed[pc]) continue;
+        f->code[out] = f->code[pc];
+        if (isJump((OpCode)f->code[out].op)) f->code[out].k = new_index[f->code[out].k];
+        f->lines[out] = f->lines[pc];
+        f->columns[out++] = f->columns[pc];
+    }
+    f->count = kept;
+    free(new_index);
+    free(target);
+    free(removed);
+}
+
+// Profundidade de laço de cada bloco: quantos laços naturais o contêm
+static void loopDepths(const IrFunction *f, const int *order, int block_count, int *depth) {
+    int *idom = checkedCalloc(f->block_count, sizeof(int));
+    int *rpo_index = checkedCalloc(f->block_count, sizeof(int));
+    int *mark = checkedCalloc(f->block_count, sizeof(int));
+    int *stack = checkedCalloc(f->block_count, sizeof(int));
+    irDominators(f, order, block_count, idom);
+    for (int b = 0; b < f->block_count; b++) {
+        rpo_index[b] = -1;
+        mark[b] = -1;
+    }
+    for (int i = 0; i < block_count; i++) rpo_index[order[i]] = i;
+    for (int i = 0; i < block_count; i++) {
+        int h = order[i];
+        const IrBlock *header = &f->blocks[h];
+        int top = 0;
+        for (int p = 0; p < header->pred_count; p++) {
+            int latch = header->preds[p];
+            if (rpo_index[latch] >= 0 && irDominates(idom, rpo_index, h, latch)) stack[top++] = latch;
+        }
+        if (top == 0) continue;
+        // Corpo: blocos que chegam a uma aresta de retorno sem passar pelo cabeçalho
+        mark[h] = h;
+        depth[h]++;
+        while (top > 0) {
+            int b = stack[--top];
+            if (mark[b] == h) continue;
+            mark[b] = h;
+            depth[b]++;
+            for (int p = 0; p < f->blocks[b].pred_count; p++) {
+                int pred = f->blocks[b].preds[p];
+                if (rpo_index[pred] >= 0 && mark[pred] != h) stack[top++] = pred;
+            }
+        }
+    }
+    free(idom);
+    free(rpo_index);
+    free(mark);
+    free(stack);
+}
+
+// Ordem de emissão: uma pós-ordem reversa que visita por último o sucessor mais
+// provável, que então fica logo depois do desvio e vira o caminho sem salto. Com
+// perfil, o provável é a aresta mais executada e os blocos nunca executados vão para
+// o fim da função; sem perfil, é o sucessor mais profundo em laços (continuar no laço
+// é mais provável do que sair dele)
+static void layoutBlocks(const IrFunction *f, const int *order, int block_count, int *layout) {
+    bool profiled = f->blocks[0].frequency >= 0;
+    int *depth = checkedCalloc(f->block_count, sizeof(int));
+    if (!profiled) loopDepths(f, order, block_count, depth);
+    int *stack = checkedCalloc(f->block_count, sizeof(int));
+    int *next_succ = checkedCalloc(f->block_count, sizeof(int));
+    bool *visited = checkedCalloc(f->block_count, sizeof(bool));
+    int count = block_count, top = 0;
+    stack[top++] = 0;
+    visited[0] = true;
+    while (top > 0) {
+        int b = stack[top - 1];
+        const IrBlock *block = &f->blocks[b];
+        if (next_succ[b] < block->succ_count) {
+            int s = next_succ[b]++;
+            if (block->succ_count == 2) {
+                int first = block->succs[0], second = block->succs[1];
+                bool swap;
+                if (profiled) {
+                    int64_t a = irEdgeFrequency(f, b, first), c = irEdgeFrequency(f, b, second);
+                    if (a < 0) a = f->blocks[first].frequency;
+                    if (c < 0) c = f->blocks[second].frequency;
+                    swap = c >= 0 && a > c;
+                } else {
+                    swap = depth[first] > depth[second];
+                }
+                if (swap) s = 1 - s;
+            }
+            int target = block->succs[s];
+            if (!visited[target]) {
+                visited[target] = true;
+                stack[top++] = target;
+            }
+        } else {
+            layout[--count] = b;
+            top--;
+        }
+    }
+    int kept = 0, cold = 0;
+    for (int i = 0; i < block_count; i++) {
+        if (profiled && f->blocks[layout[i]].frequency == 0) stack[cold++] = layout[i];
+        else layout[kept++] = layout[i];
+    }
+    memcpy(layout + kept, stack, sizeof(int) * cold);
+    free(depth);
+    free(stack);
+    free(next_succ);
+    free(visited);
+}
+
+static bool lowerFunction(Lowerer *l, const IrFunction *f, Function *out) {
+    l->ir = f;
+    l->count = 0;
+    l->stub_count = 0;
+    l->vreg_count = f->inst_count;
+    l->vreg_types = checkedRealloc(l->vreg_types, f->inst_count + 1);
+    for (int i = 0; i < f->inst_count; i++) l->vreg_types[i] = f->insts[i].type;
+    l->vreg = checkedRealloc(l->vreg, sizeof(int) * (f->inst_count + 1));
+
+    int *order = checkedCalloc(f->block_count, sizeof(int));
+    int block_count = irReversePostorder(f, order);
+    coalescePhis(l, order, block_count);
+    int *layout = checkedCalloc(f->block_count, sizeof(int));
+    layoutBlocks(f, order, block_count, layout);
+    // Cada aresta gera no máximo um trecho de cópias
+    l->label_pos = checkedRealloc(l->label_pos, sizeof(int) * (f->block_count * 3 + 1));
+    l->label_count = f->block_count;
+    for (int b = 0; b < f->block_count; b++) l->label_pos[b] = -1;
+
+    for (int i = 0; i < block_count; i++) {
+        int b = layout[i];
+        int next = i + 1 < block_count ? layout[i + 1] : -1;
+        l->label_pos[b] = l->count;
+        const IrBlock *block = &f->blocks[b];
+        for (int j = 0; j < block->count; j++) {
+            if (!f->insts[block->insts[j]].removed) lowerInst(l, block->insts[j], next);
+        }
+    }
+    for (int s = 0; s < l->stub_count; s++) {
+        int from = l->stubs[2 * s], to = l->stubs[2 * s + 1];
+        // As cópias da aresta pertencem ao statement do desvio que a origina
+        const IrBlock *source = &f->blocks[from];
+        const IrInst *branch = &f->insts[source->insts[source->count - 1]];
+        l->column = branch->column;
+        l->label_pos[f->block_count + s] = l->count;
+        emitEdgeCopies(l, from, to, branch->line);
+        emit(l, OP_JMP, 0, 0, 0, to, branch->line);
+    }
+    free(order);
+    free(layout);
+    rotateLoops(l);
+
+    Intervals iv;
+    computeIntervals(l, l->label_pos, &iv);
+    int *reg = checkedCalloc(l->vreg_count, sizeof(int));
+    uint8_t *types;
+    int register_count = allocateRegisters(l, &iv, reg, &types);
+    if (register_count > MAX_REGISTERS) {
+        fprintf(stderr, "Erro: procedimento %s excede %d registradores\n", f->name, MAX_REGISTERS);
+        l->failed = true;
+    }
+
+    // Cópias entre o mesmo registrador desaparecem; os desvios são renumerados
+    int *new_index = checkedCalloc(l->count + 1, sizeof(int));
+    int kept = 0;
+    for (int i = 0; i < l->count; i++) {
+        new_index[i] = kept;
+        const LInst *ins = &l->code[i];
+        if (!(ins->op == OP_MOV && reg[ins->a] == reg[ins->b])) kept++;
+    }
+    new_index[l->count] = kept;
+
+    memset(out, 0, sizeof(*out));
+    out->name = strdup(f->name);
+    out->param_count = f->param_count;
+    out->register_count = register_count;
+    out->register_types = types;
+    out->code = checkedCalloc(kept, sizeof(Instruction));
+    out->lines = checkedCalloc(kept, sizeof(int));
+    out->columns = checkedCalloc(kept, sizeof(int));
+    out->count = out->capacity = kept;
+    for (int i = 0, pc = 0; i < l->count; i++) {
+        const LInst *ins = &l->code[i];
+        if (ins->op == OP_MOV && reg[ins->a] == reg[ins->b]) continue;
+        Instruction *target = &out->code[pc];
+        int operands = opcodeOperands(ins->op);
+        target->op = (uint8_t)ins->op;
+        if (operands & (OPERAND_DEF_A | OPERAND_USE_A)) target->a = (uint16_t)reg[ins->a];
+        if (operands & (OPERAND_USE_B | OPERAND_USE_C)) {
+            if (operands & OPERAND_USE_B) target->b = (uint16_t)reg[ins->b];
+            if (operands & OPERAND_USE_C) target->c = (uint16_t)reg[ins->c];
+            if (operands & OPERAND_ARRAY_C) target->c = (uint16_t)ins->c;
+        } else if (isJump(ins->op)) {
+            target->k = new_index[l->label_pos[ins->k]];
+        } else {
+            target->k = ins->k;
+        }
+        out->lines[pc] = ins->line;
+        out->columns[pc++] = ins->column;
+    }
+
+    threadJumps(out);
+
+    free(new_index);
+    free(reg);
+    free(iv.start);
+    free(iv.end);
+    return !l->failed;
+}
+
+bool lowerIr(const IrProgram *program, BytecodeProgram *out) {
+    memset(out, 0, sizeof(*out));
+    Lowerer l;
+    memset(&l, 0, sizeof(l));
+    l.program = program;
+    l.out = out;
+
+    out->global_count = program->global_count;
+    out->global_types = checkedCalloc(program->global_count + 1, 1);
+    memcpy(out->global_types, program->global_types, program->global_count);
+    out->counter_count = program->counter_count;
+    out->string_count = program->string_count;
+    out->strings = checkedCalloc(program->string_count + 1, sizeof(char *));
+    for (int i = 0; i < program->string_count; i++) out->strings[i] = strdup(program->strings[i]);
+    out->function_count = program->function_count;
+    out->main_function = program->main_function;
+    out->functions = checkedCalloc(program->function_count, sizeof(Function));
+    out->array_count = program->array_count;
+    out->array_slots = program->array_slots;
+    out->arrays = checkedCalloc(program->array_count + 1, sizeof(ArrayInfo));
+    memcpy(out->arrays, program->arrays, sizeof(ArrayInfo) * program->array_count);
+    out->kernel_count = program->kernel_count;
+    out->kernels = checkedCalloc(program->kernel_count + 1, sizeof(Kernel));
+    for (int i = 0; i < program->kernel_count; i++) {
+        const Kernel *kernel = &program->kernels[i];
+        out->kernels[i] = *kernel;
+        out->kernels[i].ops = checkedCalloc(kernel->op_count, sizeof(KernelOp));
+        memcpy(out->kernels[i].ops, kernel->ops, sizeof(KernelOp) * kernel->op_count);
+    }
+
+    bool ok = true;
+    for (int i = 0; i < program->function_count; i++) {
+        uint64_t span = traceBegin();
+        ok = lowerFunction(&l, &program->functions[i], &out->functions[i]) && ok;
+        traceSpan(span, "lower", program->functions[i].name, "instructions", out->functions[i].count);
+    }
+
+    free(l.code);
+    free(l.vreg_types);
+    free(l.vreg);
+    free(l.copies);
+    free(l.label_pos);
+    free(l.stubs);
+    return ok;
+}
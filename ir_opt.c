@@ -0,0 +1,700 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ir.h"
+#include "trace.h"
+
+// Passes de otimização sobre a SSA e o gerenciador que os executa
+
+static void *checkedCalloc(size_t count, size_t size) {
+    void *memory = calloc(count ? count : 1, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void removeInst(IrFunction *f, int id) {
+    f->insts[id].removed = true;
+    f->insts[id].operand_count = 0;
+}
+
+static bool isCommutative(IrOpcode op) {
+    switch (op) {
+        case IR_ADD_I: case IR_MUL_I: case IR_ADD_R: case IR_MUL_R:
+        case IR_EQ_I: case IR_NE_I: case IR_EQ_R: case IR_NE_R:
+        case IR_AND: case IR_OR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool isArithmetic(IrOpcode op) {
+    return op >= IR_ADD_I && op <= IR_NOT;
+}
+
+// Avalia uma operação aritmética com a semântica da máquina virtual;
+// devolve false quando o resultado não pode ser calculado em tempo de compilação
+static bool foldArithmetic(IrOpcode op, Value x, Value y, Value *out) {
+    uint64_t ux = (uint64_t)x.i, uy = (uint64_t)y.i;
+    switch (op) {
+        case IR_ADD_I: out->i = (int64_t)(ux + uy); return true;
+        case IR_SUB_I: out->i = (int64_t)(ux - uy); return true;
+        case IR_MUL_I: out->i = (int64_t)(ux * uy); return true;
+        case IR_DIV_I:
+            if (y.i == 0) return false;
+            out->i = y.i == -1 ? (int64_t)(0 - ux) : x.i / y.i;
+            return true;
+        case IR_MOD_I:
+            if (y.i == 0) return false;
+            out->i = y.i == -1 ? 0 : x.i % y.i;
+            return true;
+        case IR_NEG_I: out->i = (int64_t)(0 - ux); return true;
+        case IR_ADD_R: out->r = x.r + y.r; return true;
+        case IR_SUB_R: out->r = x.r - y.r; return true;
+        case IR_MUL_R: out->r = x.r * y.r; return true;
+        case IR_DIV_R: out->r = x.r / y.r; return true;
+        case IR_NEG_R: out->r = -x.r; return true;
+        case IR_I2R: out->r = (double)x.i; return true;
+        case IR_EQ_I: out->i = x.i == y.i; return true;
+        case IR_NE_I: out->i = x.i != y.i; return true;
+        case IR_LT_I: out->i = x.i < y.i; return true;
+        case IR_LE_I: out->i = x.i <= y.i; return true;
+        case IR_GT_I: out->i = x.i > y.i; return true;
+        case IR_GE_I: out->i = x.i >= y.i; return true;
+        case IR_EQ_R: out->i = x.r == y.r; return true;
+        case IR_NE_R: out->i = x.r != y.r; return true;
+        case IR_LT_R: out->i = x.r < y.r; return true;
+        case IR_LE_R: out->i = x.r <= y.r; return true;
+        case IR_GT_R: out->i = x.r > y.r; return true;
+        case IR_GE_R: out->i = x.r >= y.r; return true;
+        case IR_AND: out->i = x.i & y.i; return true;
+        case IR_OR: out->i = x.i | y.i; return true;
+        case IR_NOT: out->i = !x.i; return true;
+        default: return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Propagação de cópias: elimina COPY e phis triviais (todos os operandos
+// iguais, desconsiderando o próprio phi), até não haver mudança
+
+static int resolve(const int *replacement, int value) {
+    while (replacement[value] >= 0) value = replacement[value];
+    return value;
+}
+
+static void copyPropagation(IrFunction *f) {
+    int *replacement = checkedCalloc(f->inst_count, sizeof(int));
+    memset(replacement, 0xFF, sizeof(int) * f->inst_count);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < f->inst_count; i++) {
+            IrInst *inst = &f->insts[i];
+            if (inst->removed || replacement[i] >= 0) continue;
+            int same = -1;
+            if (inst->op == IR_COPY) {
+                same = resolve(replacement, inst->operands[0]);
+            } else if (inst->op == IR_PHI && inst->operand_count > 0) {
+                for (int j = 0; j < inst->operand_count; j++) {
+                    int operand = resolve(replacement, inst->operands[j]);
+                    if (operand == i || operand == same) continue;
+                    if (same >= 0) {
+                        same = -2;
+                        break;
+                    }
+                    same = operand;
+                }
+            }
+            if (same >= 0 && same != i) {
+                replacement[i] = same;
+                changed = true;
+            }
+        }
+    }
+    for (int i = 0; i < f->inst_count; i++) {
+        if (replacement[i] >= 0) removeInst(f, i);
+    }
+    irReplaceUses(f, replacement);
+    free(replacement);
+}
+
+// ---------------------------------------------------------------------------
+// Propagação de constantes esparsa condicional (Wegman e Zadeck)
+
+enum { LATTICE_TOP, LATTICE_CONST, LATTICE_BOTTOM };
+
+typedef struct {
+    IrFunction *f;
+    uint8_t *state;
+    Value *value;
+    int *user_start;          // Usuários de cada valor em formato CSR
+    int *users;
+    bool *block_executable;
+    bool (*edge_executable)[2];
+    int *ssa_work;
+    int ssa_count;
+    int *flow_work;           // Pares (origem, índice do sucessor)
+    int flow_count;
+} Sccp;
+
+static void buildUsers(Sccp *s) {
+    IrFunction *f = s->f;
+    s->user_start = checkedCalloc(f->inst_count + 1, sizeof(int));
+    for (int i = 0; i < f->inst_count; i++) {
+        const IrInst *inst = &f->insts[i];
+        if (inst->removed) continue;
+        for (int j = 0; j < inst->operand_count; j++) s->user_start[inst->operands[j] + 1]++;
+    }
+    for (int i = 0; i < f->inst_count; i++) s->user_start[i + 1] += s->user_start[i];
+    s->users = checkedCalloc(s->user_start[f->inst_count], sizeof(int));
+    int *fill = checkedCalloc(f->inst_count, sizeof(int));
+    for (int i = 0; i < f->inst_count; i++) {
+        const IrInst *inst = &f->insts[i];
+        if (inst->removed) continue;
+        for (int j = 0; j < inst->operand_count; j++) {
+            int v = inst->operands[j];
+            s->users[s->user_start[v] + fill[v]++] = i;
+        }
+    }
+    free(fill);
+}
+
+static void setLattice(Sccp *s, int id, int state, Value value) {
+    if (s->state[id] == state && (state != LATTICE_CONST || s->value[id].i == value.i)) return;
+    s->state[id] = (uint8_t)state;
+    s->value[id] = value;
+    for (int u = s->user_start[id]; u < s->user_start[id + 1]; u++) {
+        s->ssa_work[s->ssa_count++] = s->users[u];
+    }
+}
+
+static void markEdge(Sccp *s, int block, int succ) {
+    if (s->edge_executable[block][succ]) return;
+    s->edge_executable[block][succ] = true;
+    s->flow_work[s->flow_count++] = block * 2 + succ;
+}
+
+static bool edgeIsExecutable(const Sccp *s, int pred, int block) {
+    const IrBlock *p = &s->f->blocks[pred];
+    for (int k = 0; k < p->succ_count; k++) {
+        if (p->succs[k] == block && s->edge_executable[pred][k]) return true;
+    }
+    return false;
+}
+
+static void visitInst(Sccp *s, int id) {
+    IrFunction *f = s->f;
+    const IrInst *inst = &f->insts[id];
+    if (inst->removed || !s->block_executable[inst->block]) return;
+    Value zero = {.i = 0};
+
+    switch (inst->op) {
+        case IR_CONST:
+            setLattice(s, id, LATTICE_CONST, inst->constant);
+            return;
+        case IR_PHI: {
+            const IrBlock *block = &f->blocks[inst->block];
+            int state = LATTICE_TOP;
+            Value value = zero;
+            for (int j = 0; j < inst->operand_count && state != LATTICE_BOTTOM; j++) {
+                if (!edgeIsExecutable(s, block->preds[j], inst->block)) continue;
+                int operand = inst->operands[j];
+                if (s->state[operand] == LATTICE_BOTTOM) {
+                    state = LATTICE_BOTTOM;
+                } else if (s->state[operand] == LATTICE_CONST) {
+                    if (state == LATTICE_TOP) {
+                        state = LATTICE_CONST;
+                        value = s->value[operand];
+                    } else if (value.i != s->value[operand].i) {
+                        state = LATTICE_BOTTOM;
+                    }
+                }
+            }
+            setLattice(s, id, state, value);
+            return;
+        }
+        case IR_COPY:
+            setLattice(s, id, s->state[inst->operands[0]], s->value[inst->operands[0]]);
+            return;
+        case IR_JMP:
+            markEdge(s, inst->block, 0);
+            return;
+        case IR_BR: {
+            int cond = inst->operands[0];
+            if (s->state[cond] == LATTICE_CONST) {
+                markEdge(s, inst->block, s->value[cond].i ? 0 : 1);
+            } else if (s->state[cond] == LATTICE_BOTTOM) {
+                markEdge(s, inst->block, 0);
+                markEdge(s, inst->block, 1);
+            }
+            return;
+        }
+        default:
+            break;
+    }
+
+    if (!isArithmetic(inst->op)) {
+        if (inst->type != TYPE_UNKNOWN) setLattice(s, id, LATTICE_BOTTOM, zero);
+        return;
+    }
+    Value operands[2] = {zero, zero};
+    for (int j = 0; j < inst->operand_count; j++) {
+        int state = s->state[inst->operands[j]];
+        if (state == LATTICE_TOP) return;
+        if (state == LATTICE_BOTTOM) {
+            setLattice(s, id, LATTICE_BOTTOM, zero);
+            return;
+        }
+        operands[j] = s->value[inst->operands[j]];
+    }
+    Value result;
+    if (foldArithmetic(inst->op, operands[0], operands[1], &result)) {
+        setLattice(s, id, LATTICE_CONST, result);
+    } else {
+        setLattice(s, id, LATTICE_BOTTOM, zero);
+    }
+}
+
+static void sccp(IrFunction *f) {
+    Sccp s;
+    memset(&s, 0, sizeof(s));
+    s.f = f;
+    s.state = checkedCalloc(f->inst_count, 1);
+    s.value = checkedCalloc(f->inst_count, sizeof(Value));
+    s.block_executable = checkedCalloc(f->block_count, sizeof(bool));
+    s.edge_executable = checkedCalloc(f->block_count, sizeof(*s.edge_executable));
+    s.flow_work = checkedCalloc(f->block_count * 2 + 1, sizeof(int));
+    buildUsers(&s);
+    // Cada valor desce no reticulado no máximo duas vezes
+    s.ssa_work = checkedCalloc(s.user_start[f->inst_count] * 2 + 1, sizeof(int));
+
+    s.block_executable[0] = true;
+    for (int i = 0; i < f->blocks[0].count; i++) visitInst(&s, f->blocks[0].insts[i]);
+    while (s.flow_count > 0 || s.ssa_count > 0) {
+        while (s.flow_count > 0) {
+            int edge = s.flow_work[--s.flow_count];
+            int target = f->blocks[edge / 2].succs[edge % 2];
+            const IrBlock *block = &f->blocks[target];
+            if (!s.block_executable[target]) {
+                s.block_executable[target] = true;
+                for (int i = 0; i < block->count; i++) visitInst(&s, block->insts[i]);
+            } else {
+                for (int i = 0; i < block->count && f->insts[block->insts[i]].op == IR_PHI; i++) {
+                    visitInst(&s, block->insts[i]);
+                }
+            }
+        }
+        while (s.ssa_count > 0) visitInst(&s, s.ssa_work[--s.ssa_count]);
+    }
+
+    // Valores constantes viram CONST no próprio lugar
+    for (int i = 0; i < f->inst_count; i++) {
+        IrInst *inst = &f->insts[i];
+        if (inst->removed || inst->op == IR_CONST || s.state[i] != LATTICE_CONST) continue;
+        if (!s.block_executable[inst->block]) continue;
+        inst->op = IR_CONST;
+        inst->constant = s.value[i];
+        inst->operand_count = 0;
+    }
+    // Um phi que virou CONST deixa de estar no prefixo de phis do bloco;
+    // os phis restantes voltam para o começo (a própria propagação depende disso)
+    for (int b = 0; b < f->block_count; b++) {
+        IrBlock *block = &f->blocks[b];
+        int phis = 0;
+        for (int i = 0; i < block->count; i++) {
+            int id = block->insts[i];
+            if (f->insts[id].op != IR_PHI) continue;
+            memmove(block->insts + phis + 1, block->insts + phis, sizeof(int) * (i - phis));
+            block->insts[phis++] = id;
+        }
+    }
+    // Blocos inalcançáveis saem do grafo; desvios com condição constante viram JMP
+    for (int b = 0; b < f->block_count; b++) {
+        IrBlock *block = &f->blocks[b];
+        if (block->removed || s.block_executable[b]) continue;
+        while (block->succ_count > 0) irRemoveEdge(f, b, block->succs[0]);
+        block->removed = true;
+    }
+    for (int b = 0; b < f->block_count; b++) {
+        IrBlock *block = &f->blocks[b];
+        if (block->removed || block->count == 0) continue;
+        IrInst *last = &f->insts[block->insts[block->count - 1]];
+        if (last->op != IR_BR || block->succ_count != 2) continue;
+        bool taken0 = s.edge_executable[b][0], taken1 = s.edge_executable[b][1];
+        if (taken0 && taken1) continue;
+        int dead = block->succs[taken0 ? 1 : 0];
+        last->op = IR_JMP;
+        last->operand_count = 0;
+        irRemoveEdge(f, b, dead);
+    }
+    irCompact(f);
+
+    free(s.state);
+    free(s.value);
+    free(s.block_executable);
+    free(s.edge_executable);
+    free(s.flow_work);
+    free(s.ssa_work);
+    free(s.user_start);
+    free(s.users);
+}
+
+// ---------------------------------------------------------------------------
+// Eliminação de código morto: marca a partir das instruções com efeitos
+
+static void deadCodeElimination(IrFunction *f) {
+    bool *live = checkedCalloc(f->inst_count, sizeof(bool));
+    int *work = checkedCalloc(f->inst_count, sizeof(int));
+    int count = 0;
+    for (int i = 0; i < f->inst_count; i++) {
+        const IrInst *inst = &f->insts[i];
+        if (!inst->removed && irHasSideEffects(f, inst)) {
+            live[i] = true;
+            work[count++] = i;
+        }
+    }
+    while (count > 0) {
+        const IrInst *inst = &f->insts[work[--count]];
+        for (int j = 0; j < inst->operand_count; j++) {
+            int operand = inst->operands[j];
+            if (!live[operand]) {
+                live[operand] = true;
+                work[count++] = operand;
+            }
+        }
+    }
+    for (int i = 0; i < f->inst_count; i++) {
+        if (!live[i]) removeInst(f, i);
+    }
+    irCompact(f);
+    free(live);
+    free(work);
+}
+
+// ---------------------------------------------------------------------------
+// Numeração global de valores: tabela hash com escopo na árvore de dominadores
+
+typedef struct {
+    uint64_t hash;
+    int inst;
+    int next;
+} GvnEntry;
+
+static uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+static uint64_t hashInst(const IrInst *inst) {
+    uint64_t h = mix(inst->op, inst->type);
+    if (inst->op == IR_CONST) return mix(h, (uint64_t)inst->constant.i);
+    for (int j = 0; j < inst->operand_count; j++) h = mix(h, (uint64_t)inst->operands[j]);
+    return h;
+}
+
+static bool sameValue(const IrInst *a, const IrInst *b) {
+    if (a->op != b->op || a->type != b->type || a->operand_count != b->operand_count) return false;
+    if (a->op == IR_CONST) return a->constant.i == b->constant.i;
+    for (int j = 0; j < a->operand_count; j++) {
+        if (a->operands[j] != b->operands[j]) return false;
+    }
+    return true;
+}
+
+static void globalValueNumbering(IrFunction *f) {
+    int *order = checkedCalloc(f->block_count, sizeof(int));
+    int *idom = checkedCalloc(f->block_count, sizeof(int));
+    int reachable = irReversePostorder(f, order);
+    irDominators(f, order, reachable, idom);
+
+    // Filhos de cada bloco na árvore de dominadores, em formato CSR
+    int *child_start = checkedCalloc(f->block_count + 1, sizeof(int));
+    int *children = checkedCalloc(f->block_count, sizeof(int));
+    for (int i = 1; i < reachable; i++) child_start[idom[order[i]] + 1]++;
+    for (int b = 0; b < f->block_count; b++) child_start[b + 1] += child_start[b];
+    int *fill = checkedCalloc(f->block_count, sizeof(int));
+    for (int i = 1; i < reachable; i++) {
+        int parent = idom[order[i]];
+        children[child_start[parent] + fill[parent]++] = order[i];
+    }
+
+    int bucket_count = 1;
+    while (bucket_count < f->inst_count * 2) bucket_count <<= 1;
+    int *buckets = checkedCalloc(bucket_count, sizeof(int));
+    memset(buckets, 0xFF, sizeof(int) * bucket_count);
+    GvnEntry *entries = checkedCalloc(f->inst_count, sizeof(GvnEntry));
+    int entry_count = 0;
+    int *replacement = checkedCalloc(f->inst_count, sizeof(int));
+    memset(replacement, 0xFF, sizeof(int) * f->inst_count);
+
+    // Pilha da travessia: bloco e quantas entradas existiam ao entrar nele
+    int *stack = checkedCalloc(f->block_count * 2 + 2, sizeof(int));
+    int depth = 0;
+    stack[depth++] = order[0];
+    stack[depth++] = -1;
+    while (depth > 0) {
+        int mark = stack[depth - 1];
+        int b = stack[depth - 2];
+        if (mark >= 0) {
+            // Saída do bloco: descarta os valores que ele introduziu
+            while (entry_count > mark) {
+                GvnEntry *entry = &entries[--entry_count];
+                buckets[entry->hash & (uint64_t)(bucket_count - 1)] = entry->next;
+            }
+            depth -= 2;
+            continue;
+        }
+        stack[depth - 1] = entry_count;
+
+        const IrBlock *block = &f->blocks[b];
+        for (int i = 0; i < block->count; i++) {
+            int id = block->insts[i];
+            IrInst *inst = &f->insts[id];
+            if (inst->removed || inst->op == IR_PHI) continue;
+            for (int j = 0; j < inst->operand_count; j++) {
+                inst->operands[j] = resolve(replacement, inst->operands[j]);
+            }
+            if (inst->op != IR_CONST && !isArithmetic(inst->op)) continue;
+            if (isCommutative(inst->op) && inst->operands[0] > inst->operands[1]) {
+                int t = inst->operands[0];
+                inst->operands[0] = inst->operands[1];
+                inst->operands[1] = t;
+            }
+            uint64_t hash = hashInst(inst);
+            int slot = (int)(hash & (uint64_t)(bucket_count - 1));
+            int found = -1;
+            for (int e = buckets[slot]; e >= 0 && found < 0; e = entries[e].next) {
+                if (entries[e].hash == hash && sameValue(&f->insts[entries[e].inst], inst)) found = entries[e].inst;
+            }
+            if (found >= 0) {
+                replacement[id] = found;
+                removeInst(f, id);
+                continue;
+            }
+            entries[entry_count] = (GvnEntry){hash, id, buckets[slot]};
+            buckets[slot] = entry_count++;
+        }
+        for (int c = child_start[b + 1] - 1; c >= child_start[b]; c--) {
+            stack[depth++] = children[c];
+            stack[depth++] = -1;
+        }
+    }
+    irReplaceUses(f, replacement);
+    irCompact(f);
+
+    free(order);
+    free(idom);
+    free(child_start);
+    free(children);
+    free(fill);
+    free(buckets);
+    free(entries);
+    free(replacement);
+    free(stack);
+}
+
+// ---------------------------------------------------------------------------
+// Acessos à memória das globais dentro de um bloco: leituras de um valor já
+// conhecido, gravações do valor que a global já contém e gravações sobrescritas
+// antes de qualquer leitura. Depois da expansão em linha, os STOREG/LOADG que
+// cercavam a chamada e os do corpo copiado ficam no mesmo bloco
+
+static void redundantStores(IrFunction *f, int global_count) {
+    int *known = checkedCalloc(global_count, sizeof(int));
+    int *pending = checkedCalloc(global_count, sizeof(int));   // STOREG ainda não lido
+    int *replacement = checkedCalloc(f->inst_count, sizeof(int));
+    memset(replacement, 0xFF, sizeof(int) * f->inst_count);
+    bool forwarded = false;
+    for (int b = 0; b < f->block_count; b++) {
+        const IrBlock *block = &f->blocks[b];
+        if (block->removed) continue;
+        memset(known, 0xFF, sizeof(int) * global_count);
+        memset(pending, 0xFF, sizeof(int) * global_count);
+        for (int i = 0; i < block->count; i++) {
+            int id = block->insts[i];
+            IrInst *inst = &f->insts[id];
+            if (inst->removed) continue;
+            if (inst->op == IR_CALL) {
+                memset(known, 0xFF, sizeof(int) * global_count);
+                memset(pending, 0xFF, sizeof(int) * global_count);
+            } else if (inst->op == IR_LOADG) {
+                if (known[inst->index] >= 0) {
+                    replacement[id] = known[inst->index];
+                    removeInst(f, id);
+                    forwarded = true;
+                } else {
+                    known[inst->index] = id;
+                    pending[inst->index] = -1;
+                }
+            } else if (inst->op == IR_STOREG) {
+                int value = replacement[inst->operands[0]] >= 0 ? replacement[inst->operands[0]] : inst->operands[0];
+                if (known[inst->index] == value) {
+                    removeInst(f, id);
+                    continue;
+                }
+                if (pending[inst->index] >= 0) removeInst(f, pending[inst->index]);
+                known[inst->index] = value;
+                pending[inst->index] = id;
+            }
+        }
+    }
+    if (forwarded) irReplaceUses(f, replacement);
+    irCompact(f);
+    free(known);
+    free(pending);
+    free(replacement);
+}
+
+// ---------------------------------------------------------------------------
+// Gerenciador de passes
+
+typedef struct {
+    const char *name;
+    int min_level;
+    void (*run)(IrFunction *f, const IrProgram *program, const IrOptions *options);
+    // Passes interprocedurais rodam uma vez sobre o programa inteiro
+    void (*run_program)(IrProgram *program, const IrOptions *options, IrStats *stats);
+} IrPass;
+
+static void runCopyPropagation(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    (void)options;
+    copyPropagation(f);
+}
+
+static void runSccp(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    (void)options;
+    sccp(f);
+}
+
+static void runGvn(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    (void)options;
+    globalValueNumbering(f);
+}
+
+static void runRedundantStores(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)options;
+    redundantStores(f, program->global_count);
+}
+
+static void runLicm(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    (void)options;
+    irHoistInvariants(f);
+}
+
+static void runInductionVariables(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    (void)options;
+    irOptimizeInductionVariables(f);
+}
+
+static void runUnroll(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    irUnrollLoops(f, options->unroll);
+}
+
+static void runVectorize(IrProgram *program, const IrOptions *options, IrStats *stats) {
+    if (!options->vectorize) return;
+    for (int i = 0; i < program->function_count; i++) {
+        stats->loops_vectorized += irVectorizeLoops(program, &program->functions[i]);
+    }
+}
+
+static void runDce(IrFunction *f, const IrProgram *program, const IrOptions *options) {
+    (void)program;
+    (void)options;
+    deadCodeElimination(f);
+}
+
+static void runDeadFunctions(IrProgram *program, const IrOptions *options, IrStats *stats) {
+    (void)options;
+    stats->functions_removed += irRemoveDeadFunctions(program);
+}
+
+static void runInline(IrProgram *program, const IrOptions *options, IrStats *stats) {
+    stats->calls_inlined += irInlineCalls(program, options->inline_limit);
+}
+
+// Ordem de execução; cada passe roda a partir do nível indicado
+static const IrPass passes[] = {
+    {"calls", 1, NULL, runDeadFunctions},
+    {"copyprop", 1, runCopyPropagation, NULL},
+    {"sccp", 1, runSccp, NULL},
+    {"copyprop", 1, runCopyPropagation, NULL},
+    {"inline", 2, NULL, runInline},
+    {"sccp", 2, runSccp, NULL},
+    {"copyprop", 2, runCopyPropagation, NULL},
+    {"gvn", 2, runGvn, NULL},
+    {"stores", 2, runRedundantStores, NULL},
+    {"licm", 2, runLicm, NULL},
+    {"iv", 2, runInductionVariables, NULL},
+    {"vectorize", 2, NULL, runVectorize},
+    {"unroll", 2, runUnroll, NULL},
+    {"sccp", 2, runSccp, NULL},
+    {"copyprop", 2, runCopyPropagation, NULL},
+    {"gvn", 2, runGvn, NULL},
+    {"dce", 1, runDce, NULL},
+};
+
+static IrPassStats *passStats(IrStats *stats, const char *name) {
+    for (int i = 0; i < stats->pass_count; i++) {
+        if (strcmp(stats->passes[i].name, name) == 0) return &stats->passes[i];
+    }
+    if (stats->pass_count == IR_MAX_PASSES) return NULL;
+    IrPassStats *entry = &stats->passes[stats->pass_count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->name = name;
+    return entry;
+}
+
+void optimizeIr(IrProgram *program, const IrOptions *options, IrStats *stats) {
+    IrStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < program->function_count; i++) {
+        stats->instructions_before += irLiveCount(&program->functions[i]);
+    }
+
+    for (size_t p = 0; p < sizeof(passes) / sizeof(passes[0]); p++) {
+        if (options->level < passes[p].min_level) continue;
+        IrPassStats *entry = passStats(stats, passes[p].name);
+        double start = now();
+        uint64_t span = traceBegin();
+        int removed = 0;
+        if (passes[p].run_program) {
+            for (int i = 0; i < program->function_count; i++) removed += irLiveCount(&program->functions[i]);
+            passes[p].run_program(program, options, stats);
+            for (int i = 0; i < program->function_count; i++) removed -= irLiveCount(&program->functions[i]);
+        }
+        for (int i = 0; i < program->function_count && passes[p].run; i++) {
+            IrFunction *f = &program->functions[i];
+            int before = irLiveCount(f);
+            passes[p].run(f, program, options);
+            removed += before - irLiveCount(f);
+        }
+        traceSpan(span, "pass", passes[p].name, "removed", removed);
+        if (entry) {
+            entry->seconds += now() - start;
+            entry->removed += removed;
+            entry->runs++;
+        }
+    }
+
+    for (int i = 0; i < program->function_count; i++) {
+        stats->instructions_after += irLiveCount(&program->functions[i]);
+    }
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "ir.h"
+
+// Otimização guiada por perfil. A compilação instrumentada (-fprofile-generate) põe
+// um PROFILE no início de cada bloco da SSA recém-construída; como os passes tratam
+// PROFILE como efeito colateral, as contagens continuam exatas em qualquer nível de
+// otimização. A compilação seguinte (-fprofile-use) lê as contagens para os blocos
+// da mesma SSA, antes dos passes, que as mantêm aproximadas ao copiar blocos.
+//
+// Formato do arquivo:
+//   pascal-profile 1 <hash do fonte>
+//   function <nome> <blocos>
+//   <contagem do bloco 0> <contagem do bloco 1> ...
+
+#define PROFILE_VERSION 1
+#define MAX_NAME 256
+
+static void *checkedCalloc(size_t count, size_t size) {
+    void *memory = calloc(count ? count : 1, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória na representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+// FNV-1a de 64 bits: um perfil gravado para outro fonte não é aplicado
+uint64_t irSourceHash(const char *source) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *c = (const unsigned char *)source; *c; c++) {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void irInstrumentBlocks(IrProgram *program, IrProfileMap *map) {
+    memset(map, 0, sizeof(*map));
+    map->function_count = program->function_count;
+    map->names = checkedCalloc(program->function_count, sizeof(char *));
+    map->first = checkedCalloc(program->function_count, sizeof(int));
+    map->blocks = checkedCalloc(program->function_count, sizeof(int));
+    int counter = 0;
+    for (int i = 0; i < program->function_count; i++) {
+        IrFunction *f = &program->functions[i];
+        map->names[i] = strdup(f->name);
+        map->first[i] = counter;
+        map->blocks[i] = f->block_count;
+        for (int b = 0; b < f->block_count; b++) {
+            IrBlock *block = &f->blocks[b];
+            if (block->removed) continue;
+            int position = 0;
+            while (position < block->count && f->insts[block->insts[position]].op == IR_PHI) position++;
+            int probe = irAddInst(f, -1, IR_PROFILE, TYPE_UNKNOWN, 0);
+            f->insts[probe].index = counter + b;
+            if (position < block->count) {
+                f->insts[probe].line = f->insts[block->insts[position]].line;
+                f->insts[probe].column = f->insts[block->insts[position]].column;
+            }
+            irInsertInst(f, b, position, probe);
+        }
+        counter += f->block_count;
+    }
+    map->counter_count = counter;
+    program->counter_count = counter;
+}
+
+void irFreeProfileMap(IrProfileMap *map) {
+    for (int i = 0; i < map->function_count; i++) free(map->names[i]);
+    free(map->names);
+    free(map->first);
+    free(map->blocks);
+    memset(map, 0, sizeof(*map));
+}
+
+bool irWriteProfile(const IrProfileMap *map, const uint64_t *counters, uint64_t source_hash, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror("Error opening profile file");
+        return false;
+    }
+    fprintf(file, "pascal-profile %d %016" PRIx64 "\n", PROFILE_VERSION, source_hash);
+    for (int i = 0; i < map->function_count; i++) {
+        fprintf(file, "function %s %d\n", map->names[i], map->blocks[i]);
+        for (int b = 0; b < map->blocks[i]; b++) {
+            fprintf(file, b > 0 ? " %" PRIu64 : "%" PRIu64, counters[map->first[i] + b]);
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+int irApplyProfile(IrProgram *program, uint64_t source_hash, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror("Error opening profile file");
+        return -1;
+    }
+    int version = 0;
+    uint64_t hash = 0;
+    if (fscanf(file, "pascal-profile %d %" SCNx64, &version, &hash) != 2 || version != PROFILE_VERSION) {
+        fprintf(stderr, "Erro: %s não é um perfil gerado por -fprofile-generate\n", path);
+        fclose(file);
+        return -1;
+    }
+    if (hash != source_hash) {
+        fprintf(stderr, "Aviso: o perfil %s foi gravado para outra versão do fonte e será ignorado\n", path);
+        fclose(file);
+        return 0;
+    }
+
+    int applied = 0;
+    char name[MAX_NAME];
+    int block_count;
+    while (fscanf(file, " function %255s %d", name, &block_count) == 2) {
+        IrFunction *target = NULL;
+        for (int i = 0; i < program->function_count && !target; i++) {
+            IrFunction *f = &program->functions[i];
+            if (strcmp(f->name, name) == 0 && f->block_count == block_count) target = f;
+        }
+        for (int b = 0; b < block_count; b++) {
+            uint64_t count;
+            if (fscanf(file, "%" SCNu64, &count) != 1) {
+                fprintf(stderr, "Erro: perfil %s truncado\n", path);
+                fclose(file);
+                return -1;
+            }
+            if (target) target->blocks[b].frequency = count > INT64_MAX ? INT64_MAX : (int64_t)count;
+        }
+        applied += target != NULL;
+    }
+    fclose(file);
+    return applied;
+}
@@ -0,0 +1,187 @@
+#define _GNU_SOURCE           // REG_RIP e REG_RBP do ucontext
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "jit.h"
+#include "runtime.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define STUB_SIZE 16          // jmp [rip + 2]; 2 bytes de preenchimento; endereço de 64 bits
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static uintptr_t runtimeAddress(int index) {
+    switch ((X86Runtime)index) {
+        case RT_WRITE_INTEGER: return (uintptr_t)pas_write_integer;
+        case RT_WRITE_REAL: return (uintptr_t)pas_write_real;
+        case RT_WRITE_BOOLEAN: return (uintptr_t)pas_write_boolean;
+        case RT_WRITE_STRING: return (uintptr_t)pas_write_string;
+        case RT_WRITELN: return (uintptr_t)pas_writeln;
+        case RT_READ_INTEGER: return (uintptr_t)pas_read_integer;
+        case RT_READ_REAL: return (uintptr_t)pas_read_real;
+        default: return (uintptr_t)pas_runtime_error;
+    }
+}
+
+static bool fitsRel32(int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// Layout: código, constantes e saltos para o runtime (R+X) seguidos das globais (R+W)
+bool jitLoad(const X86Program *program, const X86Image *image, JitCode *code) {
+    memset(code, 0, sizeof(*code));
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t rodata_offset = alignUp((size_t)image->text_size, 16);
+    size_t stubs_offset = alignUp(rodata_offset + (size_t)image->rodata_size, 16);
+    size_t bss_offset = alignUp(stubs_offset + STUB_SIZE * RT_COUNT, page);
+    size_t size = alignUp(bss_offset + (size_t)image->bss_size, page);
+
+    // Pede a região perto do runtime para que as chamadas caibam em rel32
+    uintptr_t near = runtimeAddress(RT_WRITELN) & ~(uintptr_t)(page - 1);
+    void *hint = near > size + (64u << 20) ? (void *)(near - size - (64u << 20)) : NULL;
+    uint8_t *memory = mmap(hint, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    memcpy(memory, image->text, image->text_size);
+    memcpy(memory + rodata_offset, image->rodata, image->rodata_size);
+    for (int i = 0; i < RT_COUNT; i++) {
+        uint8_t *stub = memory + stubs_offset + STUB_SIZE * i;
+        static const uint8_t jump[] = {0xFF, 0x25, 0x02, 0x00, 0x00, 0x00, 0xCC, 0xCC};
+        uint64_t address = runtimeAddress(i);
+        memcpy(stub, jump, sizeof(jump));
+        memcpy(stub + sizeof(jump), &address, sizeof(address));
+    }
+
+    for (int i = 0; i < image->reloc_count; i++) {
+        const X86Reloc *reloc = &image->relocs[i];
+        uint8_t *place = memory + reloc->offset;
+        int64_t target;
+        if (reloc->target == TARGET_RUNTIME) {
+            target = (int64_t)runtimeAddress(reloc->index);
+            if (fitsRel32(target + reloc->addend - (int64_t)(uintptr_t)place)) {
+                code->direct_calls++;
+            } else {
+                target = (int64_t)(uintptr_t)(memory + stubs_offset + STUB_SIZE * reloc->index);
+                code->stub_calls++;
+            }
+        } else {
+            target = (int64_t)(uintptr_t)(memory + (reloc->target == TARGET_BSS ? bss_offset : rodata_offset));
+        }
+        int32_t value = (int32_t)(target + reloc->addend - (int64_t)(uintptr_t)place);
+        memcpy(place, &value, sizeof(value));
+    }
+
+    // W^X: o código deixa de ser gravável antes de executar
+    if (mprotect(memory, bss_offset, PROT_READ | PROT_EXEC) != 0) {
+        perror("mprotect");
+        munmap(memory, size);
+        return false;
+    }
+    code->memory = memory;
+    code->size = size;
+    code->data = memory + bss_offset;
+    uint8_t *entry = memory + image->function_offsets[program->main_function];
+    memcpy(&code->entry, &entry, sizeof(entry));
+    return true;
+}
+
+void jitFree(JitCode *code) {
+    if (code->memory) munmap(code->memory, code->size);
+    memset(code, 0, sizeof(*code));
+}
+
+// Estado lido pelo tratador de SIGPROF durante jitExecute
+static Profile *sampled_profile;
+static const X86Image *sampled_image;
+static const uint8_t *sampled_text;
+
+static const X86SourceRange *sourceAt(uintptr_t address) {
+    uintptr_t text = (uintptr_t)sampled_text;
+    if (address < text || address >= text + (uintptr_t)sampled_image->text_size) return NULL;
+    return findSourceRange(sampled_image, (int)(address - text));
+}
+
+// A amostra vem de rip; os chamadores, da cadeia de rbp, que todo procedimento gerado
+// mantém entre o mov rbp, rsp e o ret. Nesses extremos o retorno ainda está no topo
+// da pilha. A cadeia termina no retorno ao compilador
+static void sampleNative(int signal, siginfo_t *info, void *context) {
+    (void)signal;
+    (void)info;
+    const ucontext_t *uc = context;
+    const uint8_t *rip = (const uint8_t *)(uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+    const X86SourceRange *leaf = sourceAt((uintptr_t)rip);
+    if (!leaf) {
+        recordSample(sampled_profile, NULL, 0, -1, -1);
+        return;
+    }
+    int callers[PROFILE_MAX_DEPTH];
+    int depth = 0;
+    const uintptr_t *frame = (const uintptr_t *)(uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+    if (leaf->pc == X86_PC_NO_FRAME) {
+        // Em mov rbp, rsp (REX.W 0x48) o rbp do chamador já foi empilhado sobre o retorno
+        const uintptr_t *sp = (const uintptr_t *)(uintptr_t)uc->uc_mcontext.gregs[REG_RSP];
+        const X86SourceRange *caller = sourceAt((*rip == 0x48 ? sp[1] : sp[0]) - 1);
+        if (caller) callers[depth++] = caller->function;
+        else frame = NULL;
+    }
+    while (frame && depth < PROFILE_MAX_DEPTH - 1) {
+        const X86SourceRange *caller = sourceAt(frame[1] - 1);
+        if (!caller) break;
+        callers[depth++] = caller->function;
+        frame = (const uintptr_t *)frame[0];
+    }
+    for (int i = 0; i < depth / 2; i++) {
+        int swap = callers[i];
+        callers[i] = callers[depth - 1 - i];
+        callers[depth - 1 - i] = swap;
+    }
+    recordSample(sampled_profile, callers, depth, leaf->function, leaf->pc);
+}
+
+int jitExecute(const X86Program *program, const X86Image *image, const JitCode *code, Profile *profile) {
+    if (!profile) return code->entry();
+    sampled_profile = profile;
+    sampled_image = image;
+    sampled_text = code->memory;
+    bool sampling = startProfile(profile, sampleNative);
+    int status = code->entry();
+    if (sampling) stopProfile();
+    // Os contadores ficam logo depois das globais, na mesma ordem das funções
+    if (program->call_counters) {
+        memcpy(profile->calls, code->data + 8 * (program->global_count + 1), 8 * (size_t)program->function_count);
+    }
+    return status;
+}
+
+#else
+
+bool jitLoad(const X86Program *program, const X86Image *image, JitCode *code) {
+    (void)program;
+    (void)image;
+    memset(code, 0, sizeof(*code));
+    fprintf(stderr, "Error: --run requires an x86-64 POSIX host\n");
+    return false;
+}
+
+void jitFree(JitCode *code) {
+    memset(code, 0, sizeof(*code));
+}
+
+int jitExecute(const X86Program *program, const X86Image *image, const JitCode *code, Profile *profile) {
+    (void)program;
+    (void)image;
+    (void)profile;
+    return code->entry();
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "x86.h"
+#include "profile.h"
+
+// Programa carregado em memória executável
+typedef struct {
+    void *memory;
+    size_t size;
+    int (*entry)(void);
+    uint8_t *data;            // Globais seguidas dos contadores de chamadas e de PROFILE
+    int direct_calls;         // Chamadas ao runtime resolvidas como call rel32 direto
+    int stub_calls;           // Chamadas que precisaram de um salto indireto
+} JitCode;
+
+// Copia o código para uma região mmap, resolve as relocações e a torna executável
+bool jitLoad(const X86Program *program, const X86Image *image, JitCode *code);
+void jitFree(JitCode *code);
+
+// Executa o ponto de entrada; com profile, amostra o código nativo pelos trechos de image
+int jitExecute(const X86Program *program, const X86Image *image, const JitCode *code, Profile *profile);
+
+#endif
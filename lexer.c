@@ -0,0 +1,463 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h> // Para verificar caracteres
+#include <stdint.h>
+#include <math.h>
+#include "lexer.h"
+
+// Inicializa a lista de tokens
+void initTokenList(TokenList *list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->free_nodes = NULL;
+    list->count = 0;
+}
+
+// Cria um novo nó de token
+static tokenNode *createTokenNode(TokenList *list, TokenType type, const char *lexeme, int line, int column) {
+    tokenNode *newNode = list->free_nodes;
+    if (newNode) {
+        list->free_nodes = newNode->next;
+    } else {
+        newNode = (tokenNode *)malloc(sizeof(tokenNode));
+    }
+    if (!newNode) {
+        fprintf(stderr, "Erro de alocação de memória ao criar token\n");
+        exit(EXIT_FAILURE);
+    }
+    newNode->token.type = type;
+    newNode->token.lexeme = strdup(lexeme);
+    newNode->token.line = line;
+    newNode->token.column = column;
+    newNode->token.value.integer = 0;
+    newNode->next = NULL;
+    return newNode;
+}
+
+// Adiciona um token à lista
+void addToken(TokenList *list, TokenType type, const char *lexeme, int line, int column) {
+    tokenNode *node = createTokenNode(list, type, lexeme, line, column);
+    list->count++;
+    if (!list->head) {
+        list->head = list->tail = node;
+    } else {
+        list->tail->next = node;
+        list->tail = node;
+    }
+}
+
+// Acrescenta um token já montado por outra lista; o lexema passa a ser desta
+void appendToken(TokenList *list, const Token *token) {
+    tokenNode *node = list->free_nodes;
+    if (node) {
+        list->free_nodes = node->next;
+    } else {
+        node = (tokenNode *)malloc(sizeof(tokenNode));
+        if (!node) {
+            fprintf(stderr, "Erro de alocação de memória ao criar token\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    node->token = *token;
+    node->next = NULL;
+    list->count++;
+    if (!list->head) {
+        list->head = list->tail = node;
+    } else {
+        list->tail->next = node;
+        list->tail = node;
+    }
+}
+
+// Devolve ao pool os nós anteriores a keep (já consumidos pelo parser)
+void releaseTokens(TokenList *list, tokenNode *keep) {
+    while (list->head && list->head != keep) {
+        tokenNode *temp = list->head;
+        list->head = temp->next;
+        free(temp->token.lexeme);
+        temp->next = list->free_nodes;
+        list->free_nodes = temp;
+    }
+    if (!list->head) {
+        list->tail = NULL;
+    }
+}
+
+// Libera a memória da lista de tokens
+void freeTokenList(TokenList *list) {
+    releaseTokens(list, NULL);
+    tokenNode *current = list->free_nodes;
+    while (current) {
+        tokenNode *temp = current;
+        current = current->next;
+        free(temp);
+    }
+    list->free_nodes = NULL;
+}
+
+// Palavras reservadas da linguagem
+static const struct {
+    const char *word;
+    TokenType type;
+} keywords[] = {
+    {"program", TOKEN_PROGRAM}, {"var", TOKEN_VAR}, {"integer", TOKEN_INTEGER},
+    {"real", TOKEN_REAL}, {"boolean", TOKEN_BOOLEAN}, {"procedure", TOKEN_PROCEDURE},
+    {"begin", TOKEN_BEGIN}, {"end", TOKEN_END}, {"if", TOKEN_IF}, {"then", TOKEN_THEN},
+    {"else", TOKEN_ELSE}, {"while", TOKEN_WHILE}, {"do", TOKEN_DO}, {"for", TOKEN_FOR}, {"to", TOKEN_TO},
+    {"downto", TOKEN_DOWNTO}, {"read", TOKEN_READ},
+    {"write", TOKEN_WRITE}, {"writeln", TOKEN_WRITELN}, {"div", TOKEN_DIV}, {"mod", TOKEN_MOD},
+    {"and", TOKEN_AND}, {"or", TOKEN_OR}, {"not", TOKEN_NOT},
+    {"unit", TOKEN_UNIT}, {"interface", TOKEN_INTERFACE}, {"implementation", TOKEN_IMPLEMENTATION},
+    {"uses", TOKEN_USES}, {"array", TOKEN_ARRAY}, {"of", TOKEN_OF},
+    {"true", TOKEN_BOOLEAN_LITERAL}, {"false", TOKEN_BOOLEAN_LITERAL},
+};
+
+// Processa literais e identificadores
+static void processLiteral(char *buffer, const int bufferIndex, int line, int column, TokenList *list) {
+    buffer[bufferIndex] = '\0'; // Finaliza o buffer
+
+    // Verifica palavras-chave e identificadores
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if (strcmp(buffer, keywords[i].word) == 0) {
+            addToken(list, keywords[i].type, buffer, line, column - bufferIndex);
+            return;
+        }
+    }
+
+    // Identificadores genéricos
+    addToken(list, TOKEN_IDENTIFIER, buffer, line, column - bufferIndex);
+}
+
+// Processa delimitadores e operadores; retorna quantos caracteres foram consumidos
+static int processDelimiter(const char *c, int line, int column, bool quiet, TokenList *list) {
+    switch (*c) {
+        case ';': addToken(list, TOKEN_SEMICOLON, ";", line, column); break;
+        case ',': addToken(list, TOKEN_COMMA, ",", line, column); break;
+        case '.':
+            if (c[1] == '.') {
+                addToken(list, TOKEN_DOTDOT, "..", line, column);
+                return 2;
+            }
+            addToken(list, TOKEN_DOT, ".", line, column);
+            break;
+        case '(': addToken(list, TOKEN_LPAREN, "(", line, column); break;
+        case ')': addToken(list, TOKEN_RPAREN, ")", line, column); break;
+        case '[': addToken(list, TOKEN_LBRACKET, "[", line, column); break;
+        case ']': addToken(list, TOKEN_RBRACKET, "]", line, column); break;
+        case '+': addToken(list, TOKEN_PLUS, "+", line, column); break;
+        case '-': addToken(list, TOKEN_MINUS, "-", line, column); break;
+        case '*': addToken(list, TOKEN_MULTIPLY, "*", line, column); break;
+        case '/': addToken(list, TOKEN_DIVIDE, "/", line, column); break;
+        case '=': addToken(list, TOKEN_EQ, "=", line, column); break;
+        case ':':
+            if (c[1] == '=') {
+                addToken(list, TOKEN_ASSIGN, ":=", line, column);
+                return 2;
+            }
+            addToken(list, TOKEN_COLON, ":", line, column);
+            break;
+        case '<':
+            if (c[1] == '=') {
+                addToken(list, TOKEN_LTE, "<=", line, column);
+                return 2;
+            }
+            if (c[1] == '>') {
+                addToken(list, TOKEN_NEQ, "<>", line, column);
+                return 2;
+            }
+            addToken(list, TOKEN_LT, "<", line, column);
+            break;
+        case '>':
+            if (c[1] == '=') {
+                addToken(list, TOKEN_GTE, ">=", line, column);
+                return 2;
+            }
+            addToken(list, TOKEN_GT, ">", line, column);
+            break;
+        default:
+            if (!quiet) fprintf(stderr, "Erro: delimitador inesperado '%c' na linha %d, coluna %d\n", *c, line, column);
+            addToken(list, TOKEN_ERROR, (char[]){*c, '\0'}, line, column);
+            break;
+    }
+    return 1;
+}
+
+// Processa uma string entre aspas simples ('' representa uma aspa)
+static void processString(Lexer *lexer, TokenList *list) {
+    char buffer[256];
+    int bufferIndex = 0;
+    int start = lexer->column;
+    const char *c = lexer->current + 1;
+    int column = lexer->column + 1;
+
+    for (; *c && *c != '\n'; ++c, ++column) {
+        if (*c == '\'') {
+            if (c[1] != '\'') break;
+            ++c;
+            ++column;
+        }
+        if (bufferIndex < (int)sizeof(buffer) - 1) {
+            buffer[bufferIndex++] = *c;
+        }
+    }
+    buffer[bufferIndex] = '\0';
+    if (*c != '\'') {
+        if (!lexer->quiet) fprintf(stderr, "Erro: string não terminada na linha %d, coluna %d\n", lexer->line, start);
+        addToken(list, TOKEN_ERROR, buffer, lexer->line, start);
+    } else {
+        addToken(list, TOKEN_STRING_LITERAL, buffer, lexer->line, start);
+        ++c;
+        ++column;
+    }
+    lexer->current = c;
+    lexer->column = column;
+}
+
+// Ignora espaços e comentários entre chaves; um comentário aberto até o fim do fonte
+// vira um token de erro na posição da chave
+static void skipWhitespace(Lexer *lexer, TokenList *list) {
+    const char *c = lexer->current;
+    bool in_comment = false;
+    int comment_line = 0, comment_column = 0;
+    for (; *c; ++c) {
+        if (*c == '\n') {
+            lexer->line++;
+            lexer->column = 1;
+            continue;
+        }
+        if (in_comment) {
+            in_comment = *c != '}';
+        } else if (*c == '{') {
+            in_comment = true;
+            comment_line = lexer->line;
+            comment_column = lexer->column;
+        } else if (!isspace((unsigned char)*c)) {
+            break;
+        }
+        lexer->column++;
+    }
+    lexer->current = c;
+    if (in_comment) {
+        if (!lexer->quiet) {
+            fprintf(stderr, "Erro: comentário não terminado na linha %d, coluna %d\n", comment_line, comment_column);
+        }
+        addToken(list, TOKEN_ERROR, "{", comment_line, comment_column);
+    }
+}
+
+// Literais numéricos: inteiros (dígitos) e reais (dígitos, fração e/ou expoente, como
+// 3.14, 2e10 e 1.5E-3). O valor é decodificado aqui e guardado no token; o parser
+// não relê o texto.
+
+#define MAX_MANTISSA_DIGITS 19        // Cabem sempre num uint64_t
+#define EXACT_DOUBLE (1ULL << 53)     // Inteiros até aqui são representados exatamente
+
+static const double exact_powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Oito dígitos ASCII de uma vez (SWAR): confere que todos são dígitos e os converte
+// com três multiplicações, juntando pares, quartetos e por fim as duas metades
+static bool eightDigits(const char *p, uint32_t *value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) !=
+        0x3333333333333333ULL) {
+        return false;
+    }
+    chunk -= 0x3030303030303030ULL;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+             ((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >> 32;
+    *value = (uint32_t)chunk;
+    return true;
+#else
+    uint32_t result = 0;
+    for (int i = 0; i < 8; i++) {
+        if (!isdigit((unsigned char)p[i])) return false;
+        result = result * 10 + (uint32_t)(p[i] - '0');
+    }
+    *value = result;
+    return true;
+#endif
+}
+
+// Consome uma sequência de dígitos e acumula até MAX_MANTISSA_DIGITS significativos
+// em *mantissa; os demais só são contados em *dropped
+static const char *scanDigits(const char *p, const char *end, uint64_t *mantissa, int *digits, int *dropped) {
+    // Zeros à esquerda não são significativos; depois deles todo dígito conta
+    if (*mantissa == 0) {
+        while (*p == '0') p++;
+    }
+    while (end - p >= 8 && *digits + 8 <= MAX_MANTISSA_DIGITS) {
+        uint32_t chunk;
+        if (!eightDigits(p, &chunk)) break;
+        *mantissa = *mantissa * 100000000ULL + chunk;
+        *digits += 8;
+        p += 8;
+    }
+    for (; isdigit((unsigned char)*p); p++) {
+        if (*digits < MAX_MANTISSA_DIGITS) {
+            *mantissa = *mantissa * 10 + (uint64_t)(*p - '0');
+            (*digits)++;
+        } else {
+            (*dropped)++;
+        }
+    }
+    return p;
+}
+
+// m * 10^e com um único arredondamento quando m e 10^|e| são exatos em double
+// (caminho rápido de Clinger); fora dele, strtod sobre o texto do literal
+static double decodeReal(uint64_t mantissa, int exponent, bool exact, const char *text) {
+    if (exact && mantissa <= EXACT_DOUBLE) {
+        if (exponent >= 0 && exponent <= 22) return (double)mantissa * exact_powers[exponent];
+        if (exponent < 0 && exponent >= -22) return (double)mantissa / exact_powers[-exponent];
+        // Expoente um pouco maior: parte dele entra na mantissa enquanto ela for exata
+        if (exponent > 22 && exponent <= 22 + 15) {
+            uint64_t scaled = mantissa;
+            for (int e = exponent; e > 22 && scaled <= EXACT_DOUBLE; e--) scaled *= 10;
+            if (scaled <= EXACT_DOUBLE) return (double)scaled * exact_powers[22];
+        }
+    }
+    return strtod(text, NULL);
+}
+
+static void numberError(Lexer *lexer, TokenList *list, const char *message, const char *text) {
+    if (!lexer->quiet) fprintf(stderr, "Erro: %s '%s' na linha %d, coluna %d\n", message, text, lexer->line, lexer->column);
+    addToken(list, TOKEN_ERROR, text, lexer->line, lexer->column);
+}
+
+static void scanNumber(Lexer *lexer, TokenList *list) {
+    const char *start = lexer->current;
+    uint64_t mantissa = 0;
+    int digits = 0, dropped = 0, fraction = 0;
+    const char *p = scanDigits(start, lexer->end, &mantissa, &digits, &dropped);
+    int integer_dropped = dropped;
+    bool real = false;
+
+    // A fração exige um dígito depois do ponto: "end." e "x[1..2]" não são reais
+    if (*p == '.' && isdigit((unsigned char)p[1])) {
+        real = true;
+        const char *fraction_start = ++p;
+        p = scanDigits(p, lexer->end, &mantissa, &digits, &dropped);
+        fraction = (int)(p - fraction_start);
+    }
+    int exponent = 0;
+    if ((*p == 'e' || *p == 'E') &&
+        (isdigit((unsigned char)p[1]) || ((p[1] == '+' || p[1] == '-') && isdigit((unsigned char)p[2])))) {
+        real = true;
+        bool negative = *++p == '-';
+        if (*p == '+' || *p == '-') p++;
+        for (; isdigit((unsigned char)*p); p++) {
+            if (exponent < 100000) exponent = exponent * 10 + (*p - '0');
+        }
+        if (negative) exponent = -exponent;
+    }
+    bool malformed = isalnum((unsigned char)*p) || *p == '_';
+    while (isalnum((unsigned char)*p) || *p == '_') p++;
+
+    size_t length = (size_t)(p - start);
+    char small[64];
+    char *text = length < sizeof(small) ? small : malloc(length + 1);
+    if (!text) {
+        fprintf(stderr, "Erro de alocação de memória ao criar token\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(text, start, length);
+    text[length] = '\0';
+
+    if (malformed) {
+        numberError(lexer, list, "literal numérico malformado", text);
+    } else if (!real) {
+        // Sem dígitos descartados, o valor cabe em 19 dígitos; falta conferir o int64
+        if (integer_dropped > 0 || mantissa > (uint64_t)INT64_MAX) {
+            numberError(lexer, list, "literal inteiro fora do intervalo", text);
+        } else {
+            addToken(list, TOKEN_INTEGER_LITERAL, text, lexer->line, lexer->column);
+            list->tail->token.value.integer = (int64_t)mantissa;
+        }
+    } else {
+        // Dígitos descartados deslocam a vírgula para a direita; os da fração, para a esquerda
+        double value = decodeReal(mantissa, exponent + dropped - fraction, dropped == 0, text);
+        if (isinf(value)) {
+            numberError(lexer, list, "literal real fora do intervalo", text);
+        } else {
+            addToken(list, TOKEN_REAL_LITERAL, text, lexer->line, lexer->column);
+            list->tail->token.value.real = value;
+        }
+    }
+    if (text != small) free(text);
+    lexer->column += (int)length;
+    lexer->current = p;
+}
+
+void initLexer(Lexer *lexer, const char *source) {
+    lexer->source = source;
+    lexer->current = source;
+    lexer->end = source + strlen(source);
+    lexer->line = 1;
+    lexer->column = 1;
+    lexer->finished = false;
+    lexer->quiet = false;
+}
+
+// Reconhece o próximo token e o adiciona à lista
+static void scanToken(Lexer *lexer, TokenList *list) {
+    skipWhitespace(lexer, list);
+    const char *c = lexer->current;
+
+    if (!*c) {
+        addToken(list, TOKEN_EOF, "EOF", lexer->line, lexer->column);
+        lexer->finished = true;
+        return;
+    }
+
+    if (isdigit((unsigned char)*c)) {
+        scanNumber(lexer, list);
+    } else if (isalnum((unsigned char)*c) || *c == '_') {
+        // Acumula identificador ou palavra-chave
+        char buffer[256];
+        int bufferIndex = 0;
+        while (isalnum((unsigned char)*c) || *c == '_') {
+            if (bufferIndex < (int)sizeof(buffer) - 1) {
+                buffer[bufferIndex++] = *c++;
+            } else {
+                fprintf(stderr, "Erro: buffer excedido na linha %d, coluna %d\n", lexer->line, lexer->column);
+                exit(EXIT_FAILURE);
+            }
+        }
+        lexer->column += bufferIndex;
+        lexer->current = c;
+        processLiteral(buffer, bufferIndex, lexer->line, lexer->column, list);
+    } else if (*c == '\'') {
+        processString(lexer, list);
+    } else {
+        // Processa delimitadores
+        int consumed = processDelimiter(c, lexer->line, lexer->column, lexer->quiet, list);
+        lexer->current += consumed;
+        lexer->column += consumed;
+    }
+}
+
+// Produz até max_tokens tokens; retorna quantos foram adicionados
+int lexBatch(Lexer *lexer, TokenList *list, int max_tokens) {
+    int count = 0;
+    while (!lexer->finished && count < max_tokens) {
+        scanToken(lexer, list);
+        count++;
+    }
+    return count;
+}
+
+// Tokeniza o código-fonte
+void tokenizeSource(const char *source, TokenList *list) {
+    Lexer lexer;
+    initLexer(&lexer, source);
+    while (!lexer.finished) {
+        scanToken(&lexer, list);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stdbool.h>
+#include "tokens.h"
+
+// Estado do analisador léxico; permite retomar a tokenização
+// de onde parou para produzir tokens sob demanda
+typedef struct {
+    const char *source;
+    const char *current;
+    const char *end;     // Terminador do fonte: limite das leituras de oito bytes
+    int line;
+    int column;
+    bool finished;   // TOKEN_EOF já foi emitido
+    bool quiet;      // Não imprime os erros: varreduras de um texto que outro lexer também lê
+} Lexer;
+
+void initTokenList(TokenList *list);
+void addToken(TokenList *list, TokenType type, const char *lexeme, int line, int column);
+void appendToken(TokenList *list, const Token *token);
+void releaseTokens(TokenList *list, tokenNode *keep);
+void freeTokenList(TokenList *list);
+
+void initLexer(Lexer *lexer, const char *source);
+int lexBatch(Lexer *lexer, TokenList *list, int max_tokens);
+void tokenizeSource(const char *source, TokenList *list);
+
+#endif
@@ -1,165 +1,943 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h> // Para verificar caracteres
+#include <stdbool.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
 #include "tokens.h"
+#include "lexer.h"
 #include "parser.h"
+#include "semantic.h"
+#include "bytecode.h"
+#include "ir.h"
+#include "vm.h"
+#include "x86.h"
+#include "jit.h"
+#include "profile.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "codegen_c.h"
+#include "runtime.h"
+#include "unit.h"
+#include "build.h"
+#include "workspace.h"
+#include "parallel.h"
 
-static void processDelimiter(char c, int line, int column, TokenList *list);
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_WATCH 1
+#define HAVE_SPAWN 1
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+extern char **environ;
+#else
+#include <process.h>
+#endif
 
-// Inicializa a lista de tokens
-void initTokenList(TokenList *list) {
-    list->head = NULL;
-    list->tail = NULL;
+// Biblioteca de execução ligada pelo back-end nativo (definida pelo CMake)
+#ifndef PASRT_LIBRARY
+#define PASRT_LIBRARY "libpasrt.a"
+#endif
+
+// Arquivo de -fprofile-generate e -fprofile-use quando nenhum é indicado
+#define PGO_DEFAULT_PATH "pgo.profile"
+// Arquivo de --trace quando nenhum é indicado
+#define TRACE_DEFAULT_PATH "trace.json"
+// Intervalo entre as leituras do fonte no --watch
+#define WATCH_INTERVAL_MS 50
+
+// Opções da linha de comando
+typedef struct {
+    const char *source_path;
+    bool streaming;       // --stream: lexer e parser intercalados
+    bool pipeline;        // --pipeline: como --stream, com o lexer numa thread própria
+    bool run_vm;          // --vm: executa na máquina virtual
+    bool dump_bytecode;   // --dump-bytecode: lista o bytecode gerado
+    bool stats;           // --stats: tempos e contadores de execução
+    bool native;          // --native: gera um executável x86-64
+    bool emit_asm;        // -S: grava apenas o assembly x86-64
+    bool emit_object;     // -c: grava apenas o objeto ELF
+    bool via_asm;         // --via-asm: --native passa pelo assembler externo
+    bool run_jit;         // --run: executa o código nativo em memória
+    bool naive_regalloc;  // --naive-regalloc: todos os valores na pilha (comparação)
+    int opt_level;        // -O0, -O1, -O2: otimizações sobre a SSA (0 gera o bytecode direto da AST)
+    bool dump_ir;         // --dump-ir: lista a SSA depois dos passes
+    bool no_superinstructions; // --no-superinstructions: VM sem fusão de sequências (comparação)
+    bool opcode_pairs;    // --opcode-pairs: pares de opcodes mais despachados na VM
+    bool branch_stats;    // --branch-stats: desvios executados e tomados na VM
+    int unroll;           // --unroll: fator de desdobramento dos laços for em -O2
+    int inline_limit;     // --inline: tamanho máximo de um procedimento expandido em -O2
+    bool no_vectorize;    // --no-vectorize: laços sobre arrays ficam escalares em -O2 (comparação)
+    bool avx2;            // -mavx2: kernels vetoriais com AVX2 (--run detecta sozinho)
+    bool profile;         // --profile: amostra a execução (--vm ou --run) e relata as linhas quentes
+    int profile_interval; // --profile-interval: microssegundos de CPU entre amostras
+    const char *profile_path; // --profile-out: pilhas no formato folded para flame graphs
+    const char *profile_generate; // -fprofile-generate: grava as execuções de cada bloco da SSA
+    const char *profile_use;  // -fprofile-use: guia expansão, desdobramento e ordem dos blocos
+    uint64_t source_hash;     // Identifica o fonte dentro do arquivo de perfil
+    PerfCounters *perf;       // --perf: contadores de hardware por fase (NULL desliga)
+    const char *trace_path;   // --trace: linha do tempo das fases no formato trace-event
+    bool emit_c;              // --emit=c: grava o programa traduzido para C11
+    bool cc;                  // --cc: compila o C gerado com o compilador do sistema em -O2
+    const char *output_path; // -o: arquivo gerado
+    const char *unit_dir;     // Diretório do fonte: onde uses procura os .ppu e onde uma unit é gravada
+    uint64_t build_key;       // unitBuildKey do fonte, gravada no .ppu de uma unit
+    bool build;               // --build: recompila antes as units desatualizadas do grafo de uses
+    int jobs;                 // -j: threads do --build ou, sem ele, dos corpos dos procedimentos (0: uma por processador)
+    bool check;               // --check: só os diagnósticos, pela análise incremental
+    bool watch;               // --watch: refaz o --check a cada mudança do fonte
+    DiagnosticFormat diagnostic_format; // --diagnostics=json: diagnósticos em JSON
+    int max_errors;           // --max-errors: erros gravados antes de parar (0: todos)
+} Options;
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
-// Cria um novo nó de token
-tokenNode *createTokenNode(TokenType type, const char *lexeme, int line, int column) {
-    tokenNode *newNode = (tokenNode *)malloc(sizeof(tokenNode));
-    if (!newNode) {
-        fprintf(stderr, "Erro de alocação de memória ao criar token\n");
-        exit(EXIT_FAILURE);
+// Análise sintática seguida da semântica; a semântica só roda sobre uma árvore sem erros.
+// Os diagnósticos das duas são gravados juntos no fim, com o resumo
+static bool analyze(Parser *parser, FILE *output_file, const Options *options) {
+    bool parsed = parse(parser);
+    if (parsed && parser->error_count == 0) {
+        parser->error_count += analyzeProgram(parser->program, parser->symbol_table,
+                                              &parser->global_arena, parser->diagnostics, parser->jobs);
     }
-    newNode->token.type = type;
-    newNode->token.lexeme = strdup(lexeme);
-    newNode->token.line = line;
-    newNode->token.column = column;
-    newNode->next = NULL;
-    return newNode;
+    writeDiagnostics(parser->diagnostics, output_file, options->diagnostic_format, options->max_errors, !parsed);
+    return parsed && parser->error_count == 0;
 }
 
-// Adiciona um token à lista
-void addToken(TokenList *list, TokenType type, const char *lexeme, int line, int column) {
-    tokenNode *node = createTokenNode(type, lexeme, line, column);
-    if (!list->head) {
-        list->head = list->tail = node;
-    } else {
-        list->tail->next = node;
-        list->tail = node;
-    }
-}
-
-// Libera a memória da lista de tokens
-void freeTokenList(TokenList *list) {
-    tokenNode *current = list->head;
-    while (current) {
-        tokenNode *temp = current;
-        current = current->next;
-        free(temp->token.lexeme);
-        free(temp);
-    }
-}
-
-// Processa literais e identificadores
-static void processLiteral(char *buffer, const int bufferIndex, int line, int column, TokenList *list) {
-    buffer[bufferIndex] = '\0'; // Finaliza o buffer
-
-    // Verifica palavras-chave e identificadores
-    if (strcmp(buffer, "program") == 0) {
-        addToken(list, TOKEN_PROGRAM, buffer, line, column - bufferIndex);
-    } else if (strcmp(buffer, "var") == 0) {
-        addToken(list, TOKEN_VAR, buffer, line, column - bufferIndex);
-    } else if (strcmp(buffer, "begin") == 0) {
-        addToken(list, TOKEN_BEGIN, buffer, line, column - bufferIndex);
-    } else if (strcmp(buffer, "end") == 0) {
-        addToken(list, TOKEN_END, buffer, line, column - bufferIndex);
-    } else if (isdigit(buffer[0])) {
-        // Diferencia literais numéricos
-        addToken(list, TOKEN_INTEGER_LITERAL, buffer, line, column - bufferIndex);
-    } else if (strcmp(buffer, "integer") == 0) {
-        addToken(list, TOKEN_INTEGER, buffer, line, column - bufferIndex);
-    } else if (strcmp(buffer, "real") == 0) {
-        addToken(list, TOKEN_REAL, buffer, line, column - bufferIndex);
-    } else if (strcmp(buffer, "boolean") == 0) {
-        addToken(list, TOKEN_BOOLEAN, buffer, line, column - bufferIndex);
+// Fronteira entre fases para --perf e --trace; contagens negativas são omitidas
+static void endPhase(const Options *options, const char *name, long long bytes, long long tokens) {
+    perfPhase(options->perf, name);
+    tracePhase(name, bytes, tokens);
+}
+
+// Executa um programa externo sem passar pelo shell, com os caminhos intactos em argv;
+// retorna o código de saída, ou -1 se o processo não pôde ser criado
+static int runCommand(char *const argv[]) {
+#ifdef HAVE_SPAWN
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ) != 0) return -1;
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#else
+    return (int)_spawnvp(_P_WAIT, argv[0], (const char *const *)argv);
+#endif
+}
+
+// Grava o código x86-64 como assembly (-S ou --via-asm) ou como objeto ELF
+static bool writeNativeFile(const X86Program *x86, const char *path, bool assembly, const Options *options) {
+    FILE *file = fopen(path, assembly ? "w" : "wb");
+    if (!file) {
+        perror("Error opening output file");
+        return false;
+    }
+    double start = now();
+    bool ok = true;
+    if (assembly) {
+        writeX86Assembly(x86, file);
     } else {
-        // Identificadores genéricos
-        addToken(list, TOKEN_IDENTIFIER, buffer, line, column - bufferIndex);
-    }
-}
-
-// Processa delimitadores e operadores
-static void processDelimiter(char c, int line, int column, TokenList *list) {
-    switch (c) {
-        case ';': addToken(list, TOKEN_SEMICOLON, ";", line, column); break;
-        case ':': addToken(list, TOKEN_COLON, ":", line, column); break;
-        case '+': addToken(list, TOKEN_PLUS, "+", line, column); break;
-        case '.': addToken(list, TOKEN_DOT, ".", line, column); break;
-        case '(': addToken(list, TOKEN_LPAREN, "(", line, column); break;
-        case ')': addToken(list, TOKEN_RPAREN, ")", line, column); break;
-        default:
-            fprintf(stderr, "Erro: delimitador inesperado '%c' na linha %d, coluna %d\n", c, line, column);
-            break;
-    }
-}
-
-// Tokeniza o código-fonte
-void tokenizeSource(const char *source, TokenList *list) {
-    int line = 1, column = 1;
-    char buffer[256];
-    int bufferIndex = 0;
-
-    for (const char *c = source; *c; ++c) {
-        if (isspace(*c) || strchr(";,.:()+", *c)) {
-            // Processa o buffer acumulado
-            if (bufferIndex > 0) {
-                processLiteral(buffer, bufferIndex, line, column, list);
-                bufferIndex = 0;
-            }
-            // Processa delimitadores
-            if (strchr(";,.:()+", *c)) {
-                processDelimiter(*c, line, column, list);
-            }
-            if (*c == '\n') {
-                line++;
-                column = 1;
-            } else {
-                column++;
+        X86Image image;
+        encodeX86(x86, &image);
+        ok = writeElfObject(x86, &image, file);
+        endPhase(options, "encode", -1, -1);
+        if (options->stats) {
+            fprintf(stderr, "encode: %d bytes of code, %d relocations (%.3f ms)\n",
+                    image.text_size, image.reloc_count, (now() - start) * 1e3);
+        }
+        freeX86Image(&image);
+    }
+    if (fclose(file) != 0) ok = false;
+    endPhase(options, assembly ? "write asm" : "write object", -1, -1);
+    return ok;
+}
+
+// Relatório das linhas quentes em stderr e pilhas para o flamegraph.pl
+static void reportProfile(const Profile *profile, const Options *options) {
+    const char *path = options->profile_path ? options->profile_path : "profile.folded";
+    printProfile(profile, stderr);
+    if (writeFoldedStacks(profile, path)) fprintf(stderr, "profile: folded stacks written to %s\n", path);
+}
+
+// Compila para x86-64 em memória e executa sem gravar nada em disco; os contadores
+// de -fprofile-generate ficam na área das globais e são somados a counters
+static int runJit(const BytecodeProgram *program, const X86Program *x86, const Options *options,
+                  uint64_t *counters) {
+    double start = now();
+    X86Image image;
+    encodeX86(x86, &image);
+    JitCode code;
+    bool loaded = jitLoad(x86, &image, &code);
+    double compiled = now();
+    endPhase(options, "jit load", -1, -1);
+    if (!loaded) {
+        freeX86Image(&image);
+        return EXIT_FAILURE;
+    }
+
+    // A imagem continua disponível durante a execução: o perfil traduz endereços por ela
+    Profile profile;
+    if (options->profile) initProfile(&profile, program, options->profile_interval);
+    int status = jitExecute(x86, &image, &code, options->profile ? &profile : NULL);
+    pas_flush();
+    endPhase(options, "jit run", -1, -1);
+    const uint64_t *native_counters = (const uint64_t *)code.data + X86_PROFILE_SLOT(x86);
+    for (int i = 0; counters && i < x86->counter_count; i++) counters[i] += native_counters[i];
+    freeX86Image(&image);
+    if (options->stats) {
+        fprintf(stderr, "jit: load %.3f ms (%d direct runtime calls, %d via stubs), run %.3f ms\n",
+                (compiled - start) * 1e3, code.direct_calls, code.stub_calls, (now() - compiled) * 1e3);
+    }
+    if (options->profile) {
+        reportProfile(&profile, options);
+        freeProfile(&profile);
+    }
+    jitFree(&code);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// VLOOP em AVX2 com -mavx2 ou, no --run, quando a própria máquina o suporta
+static bool useAvx2(const Options *options) {
+    if (options->avx2) return true;
+#if defined(__GNUC__) && defined(__x86_64__)
+    return options->run_jit && __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Gera código x86-64; com --native liga o objeto com o compilador C do sistema
+static int runNative(const BytecodeProgram *program, const Options *options, uint64_t *counters) {
+    X86Program x86;
+    X86AllocStats alloc;
+    double start = now();
+    bool count_calls = options->profile && options->run_jit;
+    if (!generateX86(program, options->naive_regalloc, count_calls, useAvx2(options), &x86, &alloc)) {
+        freeX86(&x86);
+        return EXIT_FAILURE;
+    }
+    endPhase(options, "x86 codegen", -1, -1);
+    if (options->stats) {
+        fprintf(stderr, "x86: %d live intervals, %d spilled (%.3f ms)\n",
+                alloc.intervals, alloc.spilled, (now() - start) * 1e3);
+    }
+
+    if (options->run_jit) {
+        int status = runJit(program, &x86, options, counters);
+        freeX86(&x86);
+        return status;
+    }
+    if (options->emit_asm || options->emit_object) {
+        const char *output = options->output_path ? options->output_path
+                           : options->emit_asm ? "output.s" : "output.o";
+        bool ok = writeNativeFile(&x86, output, options->emit_asm, options);
+        freeX86(&x86);
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const char *output = options->output_path ? options->output_path : "a.out";
+    char temp_path[4096];
+    if (snprintf(temp_path, sizeof(temp_path), "%s.%s", output, options->via_asm ? "s" : "o") >= (int)sizeof(temp_path)) {
+        fprintf(stderr, "Erro: caminho de saída longo demais: %s\n", output);
+        freeX86(&x86);
+        return EXIT_FAILURE;
+    }
+    bool ok = writeNativeFile(&x86, temp_path, options->via_asm, options);
+    freeX86(&x86);
+    if (!ok) return EXIT_FAILURE;
+
+    char *command[] = {"cc", "-o", (char *)output, temp_path, PASRT_LIBRARY, NULL};
+    start = now();
+    int status = runCommand(command);
+    remove(temp_path);
+    endPhase(options, "link", -1, -1);
+    if (options->stats) {
+        fprintf(stderr, "link: %.3f ms\n", (now() - start) * 1e3);
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: linking %s failed\n", output);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static bool needsNativeCode(const Options *options) {
+    return options->native || options->emit_asm || options->emit_object || options->run_jit;
+}
+
+// Modos que passam pelo bytecode
+static bool needsBytecode(const Options *options) {
+    return options->run_vm || options->dump_bytecode || options->dump_ir || needsNativeCode(options);
+}
+
+// Traduz a árvore verificada para C; com --cc compila o resultado em -O2 junto com a
+// biblioteca de execução e só mantém o .c se --emit=c também foi pedido
+static int runCBackend(Parser *parser, const Options *options) {
+    if (parser->symbol_table->unit_count > 0) {
+        fprintf(stderr, "Erro: --emit=c e --cc ainda não aceitam programas com uses\n");
+        return EXIT_FAILURE;
+    }
+    const char *output = options->output_path ? options->output_path : options->cc ? "a.out" : "output.c";
+    char c_path[4096];
+    if (snprintf(c_path, sizeof(c_path), options->cc ? "%s.c" : "%s", output) >= (int)sizeof(c_path)) {
+        fprintf(stderr, "Erro: caminho de saída longo demais: %s\n", output);
+        return EXIT_FAILURE;
+    }
+    FILE *file = fopen(c_path, "w");
+    if (!file) {
+        perror("Error opening output file");
+        return EXIT_FAILURE;
+    }
+    bool ok = generateC(parser->program, parser->symbol_table, file);
+    if (fclose(file) != 0) ok = false;
+    endPhase(options, "emit c", -1, -1);
+    if (!ok || !options->cc) return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    char *command[] = {"cc", "-std=c11", "-O2", "-o", (char *)output, c_path, PASRT_LIBRARY, NULL};
+    double start = now();
+    int status = runCommand(command);
+    if (!options->emit_c) remove(c_path);
+    endPhase(options, "cc", -1, -1);
+    if (options->stats) {
+        fprintf(stderr, "cc: %.3f ms\n", (now() - start) * 1e3);
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: compiling %s failed\n", c_path);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Constrói a SSA, aplica os passes do nível pedido e a traduz para bytecode. Os
+// contadores de perfil entram (ou o perfil é lido) antes de qualquer passe
+static bool compileOptimized(Parser *parser, const Options *options, IrProfileMap *map, BytecodeProgram *program) {
+    double start = now();
+    IrProgram ir;
+    bool built_ok = buildIr(parser->program, parser->symbol_table, &ir);
+    int profiled = 0;
+    if (built_ok && options->profile_generate) {
+        irInstrumentBlocks(&ir, map);
+    } else if (built_ok && options->profile_use) {
+        profiled = irApplyProfile(&ir, options->source_hash, options->profile_use);
+        built_ok = profiled >= 0;
+    }
+    if (!built_ok) {
+        freeIr(&ir);
+        memset(program, 0, sizeof(*program));
+        return false;
+    }
+    double built = now();
+    endPhase(options, "ir build", -1, -1);
+    IrStats stats;
+    IrOptions ir_options = {options->opt_level, options->unroll, options->inline_limit, !options->no_vectorize};
+    optimizeIr(&ir, &ir_options, &stats);
+    if (options->dump_ir) {
+        dumpIr(&ir, stdout);
+    }
+    double optimized = now();
+    endPhase(options, "ir optimize", -1, -1);
+    bool ok = lowerIr(&ir, program);
+    freeIr(&ir);
+    endPhase(options, "ir lower", -1, -1);
+    if (options->stats) {
+        fprintf(stderr, "ir: build %.3f ms, %d instructions before, %d after\n",
+                (built - start) * 1e3, stats.instructions_before, stats.instructions_after);
+        fprintf(stderr, "ir: %d unreachable procedure(s) removed, %d call(s) inlined, %d function(s) left\n",
+                stats.functions_removed, stats.calls_inlined, program->function_count);
+        if (ir_options.level >= 2 && ir_options.vectorize) fprintf(stderr, "ir: %d loop(s) vectorized\n", stats.loops_vectorized);
+        for (int i = 0; i < stats.pass_count; i++) {
+            const IrPassStats *pass = &stats.passes[i];
+            fprintf(stderr, "  %-10s %2d run(s) %8.3f ms %7d removed\n",
+                    pass->name, pass->runs, pass->seconds * 1e3, pass->removed);
+        }
+        fprintf(stderr, "ir: optimize %.3f ms, lower %.3f ms\n",
+                (optimized - built) * 1e3, (now() - optimized) * 1e3);
+        if (options->profile_generate) {
+            fprintf(stderr, "pgo: %d block counter(s) in %d function(s)\n", map->counter_count, map->function_count);
+        } else if (options->profile_use) {
+            fprintf(stderr, "pgo: %s applied to %d function(s)\n", options->profile_use, profiled);
+        }
+    }
+    return ok;
+}
+
+// Os pares de opcodes mais despachados; orientam a escolha das superinstruções
+static void printOpcodePairs(const VMStats *stats) {
+    enum { TOP = 20 };
+    int best[TOP][2];
+    int count = 0;
+    for (int a = 0; a < VM_OPCODE_COUNT; a++) {
+        for (int b = 0; b < VM_OPCODE_COUNT; b++) {
+            uint64_t n = stats->pairs[a][b];
+            if (n == 0) continue;
+            // Inserção ordenada entre os TOP maiores
+            int pos = count < TOP ? count++ : TOP;
+            while (pos > 0 && stats->pairs[best[pos - 1][0]][best[pos - 1][1]] < n) {
+                if (pos < TOP) memcpy(best[pos], best[pos - 1], sizeof(best[pos]));
+                pos--;
             }
-        } else {
-            // Adiciona ao buffer
-            if (bufferIndex < sizeof(buffer) - 1) {
-                buffer[bufferIndex++] = *c;
-            } else {
-                fprintf(stderr, "Erro: buffer excedido na linha %d, coluna %d\n", line, column);
-                exit(EXIT_FAILURE);
+            if (pos < TOP) {
+                best[pos][0] = a;
+                best[pos][1] = b;
             }
-            column++;
         }
     }
-    // Processa o buffer restante
-    if (bufferIndex > 0) {
-        processLiteral(buffer, bufferIndex, line, column, list);
+    fprintf(stderr, "vm: most frequent opcode pairs\n");
+    for (int i = 0; i < count; i++) {
+        uint64_t n = stats->pairs[best[i][0]][best[i][1]];
+        fprintf(stderr, "  %-18s %-18s %12llu  %5.1f%%\n", vmOpcodeName(best[i][0]), vmOpcodeName(best[i][1]),
+                (unsigned long long)n, stats->instructions ? 100.0 * (double)n / (double)stats->instructions : 0.0);
     }
-    addToken(list, TOKEN_EOF, "EOF", line, column);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <source_file>\n", argv[0]);
+// Gera bytecode a partir da árvore verificada e o executa ou lista
+static int runBackend(Parser *parser, const Options *options) {
+    BytecodeProgram program;
+    IrProfileMap map = {0};
+    bool optimized = options->opt_level > 0 || options->dump_ir || options->profile_generate || options->profile_use;
+    bool compiled = optimized ? compileOptimized(parser, options, &map, &program)
+                  : compileProgram(parser->program, parser->symbol_table, &program);
+    if (!optimized) endPhase(options, "bytecode", -1, -1);
+    // O código das units entra depois da otimização do programa, que as vê como caixas-pretas
+    if (compiled && parser->symbol_table->unit_count > 0) {
+        compiled = linkUnits(&program, parser->symbol_table);
+        endPhase(options, "link units", -1, -1);
+    }
+    if (!compiled) {
+        freeBytecode(&program);
+        irFreeProfileMap(&map);
         return EXIT_FAILURE;
     }
+    uint64_t *counters = NULL;
+    if (options->profile_generate) {
+        counters = calloc(program.counter_count + 1, sizeof(uint64_t));
+        if (!counters) {
+            fprintf(stderr, "Memory allocation error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (options->dump_bytecode) {
+        disassembleProgram(&program, stdout);
+    }
 
-    // Open source file
-    FILE *file = fopen(argv[1], "r");
+    int status = EXIT_SUCCESS;
+    if (options->run_vm) {
+        static VMStats stats;
+        Profile profile;
+        if (options->profile) initProfile(&profile, &program, options->profile_interval);
+        VMOptions vm_options = {!options->no_superinstructions, options->opcode_pairs, options->branch_stats,
+                                options->profile ? &profile : NULL, counters};
+        double start = now();
+        status = runProgram(&program, &vm_options, &stats);
+        double elapsed = now() - start;
+        endPhase(options, "vm run", -1, -1);
+        if (options->profile) {
+            reportProfile(&profile, options);
+            freeProfile(&profile);
+        }
+        if (options->stats) {
+            fprintf(stderr, "vm: %llu dispatches in %.3f s (%.1f M dispatches/s)\n",
+                    (unsigned long long)stats.instructions, elapsed,
+                    elapsed > 0 ? (double)stats.instructions / elapsed / 1e6 : 0.0);
+        }
+        if (options->opcode_pairs) printOpcodePairs(&stats);
+        if (options->branch_stats) {
+            fprintf(stderr, "vm: %llu branches executed, %llu taken (%.1f%%)\n",
+                    (unsigned long long)stats.branches, (unsigned long long)stats.taken,
+                    stats.branches ? 100.0 * (double)stats.taken / (double)stats.branches : 0.0);
+        }
+    }
+    if (status == EXIT_SUCCESS && needsNativeCode(options)) {
+        status = runNative(&program, options, counters);
+    }
+    // Um perfil de uma execução interrompida por erro não é gravado
+    if (counters && status == EXIT_SUCCESS) {
+        if (irWriteProfile(&map, counters, options->source_hash, options->profile_generate)) {
+            fprintf(stderr, "pgo: block counts written to %s\n", options->profile_generate);
+        } else {
+            status = EXIT_FAILURE;
+        }
+    }
+    free(counters);
+    irFreeProfileMap(&map);
+    freeBytecode(&program);
+    return status;
+}
+
+// Gera o bytecode da unit (otimizado com -O1/-O2) e grava <diretório>/<nome>.ppu ou -o
+static int compileUnit(Parser *parser, const Options *options) {
+    BytecodeProgram program;
+    IrProfileMap map = {0};
+    bool optimized = options->opt_level > 0 || options->dump_ir || options->profile_use;
+    bool ok = optimized ? compileOptimized(parser, options, &map, &program)
+            : compileProgram(parser->program, parser->symbol_table, &program);
+    if (!optimized) endPhase(options, "bytecode", -1, -1);
+    if (ok && options->dump_bytecode) {
+        disassembleProgram(&program, stdout);
+    }
+    char path[1024];
+    if (options->output_path) {
+        snprintf(path, sizeof(path), "%s", options->output_path);
+    } else {
+        unitPath(path, sizeof(path), options->unit_dir, parser->program->as.program.name);
+    }
+    ok = ok && writeUnit(path, parser->program, parser->symbol_table, &program, options->build_key);
+    endPhase(options, "write unit", -1, -1);
+    if (ok && options->stats) {
+        fprintf(stderr, "unit: %s written (%d procedure(s), %d unit(s) used)\n",
+                path, program.function_count - 1, parser->symbol_table->unit_count);
+    }
+    irFreeProfileMap(&map);
+    freeBytecode(&program);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Conteúdo do arquivo terminado em zero; NULL se ele não pode ser lido, com o motivo em reason.
+// Só arquivos regulares: num diretório o ftell devolve LONG_MAX e num pipe o fseek falha
+static char *readSourceFile(const char *path, const char **reason) {
+    FILE *file = fopen(path, "rb");
     if (!file) {
-        perror("Error opening file");
+        *reason = strerror(errno);
+        return NULL;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat info;
+    if (fstat(fileno(file), &info) != 0 || !S_ISREG(info.st_mode)) {
+        fclose(file);
+        *reason = "not a regular file";
+        return NULL;
+    }
+#endif
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length < 0 || length == LONG_MAX || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        *reason = "not a regular file";
+        return NULL;
+    }
+    char *source = malloc((size_t)length + 1);
+    if (!source) {
+        fprintf(stderr, "Memory allocation error\n");
+        exit(EXIT_FAILURE);
+    }
+    source[fread(source, 1, (size_t)length, file)] = '\0';
+    fclose(file);
+    return source;
+}
+
+// Compila uma unit do grafo de --build numa thread de trabalho: sem fronteiras de fase do
+// --perf (os contadores herdados pela thread entram na fase "build units" da principal)
+// e com o diagnóstico num arquivo temporário, copiado para stderr em caso de erro
+static bool compileBuildUnit(const char *path, const char *name, void *context) {
+    Options options = *(const Options *)context;
+    options.source_path = path;
+    options.perf = NULL;
+    options.stats = false;
+    options.dump_bytecode = false;
+    options.dump_ir = false;
+    options.output_path = NULL;
+    options.profile_use = NULL;
+    char directory[1024];
+    const char *slash = strrchr(path, '/');
+    snprintf(directory, sizeof(directory), "%.*s", slash ? (int)(slash - path) : 1, slash ? path : ".");
+    options.unit_dir = directory[0] ? directory : "/";
+
+    const char *reason;
+    char *source = readSourceFile(path, &reason);
+    if (!source) {
+        fprintf(stderr, "Erro: não foi possível ler %s: %s\n", path, reason);
+        return false;
+    }
+    // As fases da unit começam agora, dentro do intervalo "build" dela, e não no fim da
+    // última fase desta thread (a origem do trace, numa thread de trabalho nova)
+    uint64_t phases = traceStartPhases();
+    options.build_key = unitBuildKey(source, options.opt_level);
+
+    FILE *diagnostics = tmpfile();
+    if (!diagnostics) {
+        perror("Error opening diagnostics file");
+        free(source);
+        traceRestorePhases(phases);
+        return false;
+    }
+    Lexer lexer;
+    initLexer(&lexer, source);
+    DiagnosticBuffer buffer;
+    initDiagnostics(&buffer);
+    Parser parser;
+    initStreamingParser(&parser, &lexer, &buffer);
+    parser.unit_dir = options.unit_dir;
+    bool ok = analyze(&parser, diagnostics, &options);
+    if (ok && (!parser.program->as.program.unit || strcmp(parser.program->as.program.name, name) != 0)) {
+        fprintf(stderr, "Erro: %s não declara a unit %s\n", path, name);
+        ok = false;
+    } else if (ok) {
+        ok = compileUnit(&parser, &options) == EXIT_SUCCESS;
+    } else {
+        // Uma só escrita por unit: as mensagens de threads diferentes não se misturam
+        long size = ftell(diagnostics);
+        char *text = malloc(size + 1);
+        if (text) {
+            rewind(diagnostics);
+            text[fread(text, 1, size, diagnostics)] = '\0';
+            fprintf(stderr, "%s:\n%s", path, text);
+            free(text);
+        }
+    }
+    fclose(diagnostics);
+    freeParser(&parser);
+    freeDiagnostics(&buffer);
+    free(source);
+    traceRestorePhases(phases);
+    return ok;
+}
+
+// Modo em fluxo: o parser consome os tokens à medida que o lexer os produz, na mesma
+// thread ou, com --pipeline, numa thread própria. Com -j (fora do --build), a lista
+// completa de tokens é montada antes e os corpos dos procedimentos são analisados em paralelo
+static int runStreaming(const char *source, const Options *options) {
+    FILE *output_file = fopen("output.lex", "w");
+    if (!output_file) {
+        perror("Error opening output file");
         return EXIT_FAILURE;
     }
 
-    // Read file content into a buffer
-    fseek(file, 0, SEEK_END);
-    long length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    char *buffer = (char *)malloc(length + 1);
-    if (!buffer) {
-        fprintf(stderr, "Memory allocation error\n");
-        fclose(file);
+    Lexer lexer;
+    initLexer(&lexer, source);
+    TokenList tokens;
+    initTokenList(&tokens);
+    DiagnosticBuffer diagnostics;
+    initDiagnostics(&diagnostics);
+    Parser parser;
+    TokenRing *ring = NULL;
+    if (options->jobs > 0 && !options->build) {
+        tokenizeSource(source, &tokens);
+        initParser(&parser, &tokens, &diagnostics);
+        parser.jobs = options->jobs;
+    } else if (options->pipeline && (ring = startTokenRing(source))) {
+        initPipelinedParser(&parser, ring, &diagnostics);
+    } else {
+        initStreamingParser(&parser, &lexer, &diagnostics);
+    }
+    parser.unit_dir = options->unit_dir;
+
+    fprintf(output_file, "Syntactic and Semantic Analysis Results:\n");
+    bool ok = analyze(&parser, output_file, options);
+    fclose(output_file);
+    endPhase(options, "front-end", (long long)strlen(source), parser.tokens->count);
+
+    int status = EXIT_SUCCESS;
+    if (ok && parser.program->as.program.unit) {
+        // Uma unit só é compilada: executá-la ou traduzi-la não faz sentido
+        if (options->emit_c || options->cc || options->run_vm || needsNativeCode(options)) {
+            fprintf(stderr, "Erro: %s é uma unit; compile-a sem --vm, --run, --native, -S, -c, --emit=c ou --cc\n",
+                    parser.program->as.program.name);
+            status = EXIT_FAILURE;
+        } else {
+            status = compileUnit(&parser, options);
+        }
+    } else if (options->emit_c || options->cc || needsBytecode(options)) {
+        if (ok) {
+            if (options->emit_c || options->cc) status = runCBackend(&parser, options);
+            if (status == EXIT_SUCCESS && needsBytecode(options)) status = runBackend(&parser, options);
+        } else {
+            fprintf(stderr, "Compilation failed with %d errors (see output.lex)\n", diagnostics.errors);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    freeParser(&parser);
+    stopTokenRing(ring);
+    freeTokenList(&tokens);
+    freeDiagnostics(&diagnostics);
+    return status;
+}
+
+// Atualiza o workspace com o fonte e imprime os diagnósticos; retorna o número de erros
+static int checkSource(Workspace *workspace, const char *source, const Options *options) {
+    QueryStats before = workspace->db.stats;
+    double start = now();
+    updateWorkspace(workspace, source);
+    DiagnosticBuffer *diagnostics = checkWorkspace(workspace);
+    writeDiagnostics(diagnostics, stdout, options->diagnostic_format, options->max_errors, false);
+    fflush(stdout);
+    if (options->stats) {
+        QueryStats *stats = &workspace->db.stats;
+        fprintf(stderr, "check: %d item(s), %d queries run (%d unchanged), %d reused (%.3f ms)\n",
+                workspace->item_count, stats->executed - before.executed, stats->unchanged - before.unchanged,
+                stats->reused - before.reused, (now() - start) * 1e3);
+    }
+    return diagnostics->errors;
+}
+
+// --check e --watch: diagnósticos pela análise incremental (workspace.h), sem gerar código.
+// No --watch o fonte é relido a cada intervalo e, se mudou, só os itens alterados e os que
+// dependem deles são analisados de novo; termina com Ctrl-C
+static int runCheck(char *source, const Options *options) {
+    Workspace workspace;
+    initWorkspace(&workspace, options->unit_dir);
+    int errors = checkSource(&workspace, source, options);
+    endPhase(options, "check", (long long)strlen(source), -1);
+#ifdef HAVE_WATCH
+    while (options->watch) {
+        nanosleep(&(struct timespec){0, WATCH_INTERVAL_MS * 1000000L}, NULL);
+        const char *reason;
+        char *text = readSourceFile(options->source_path, &reason);
+        if (!text) continue;      // Editores que gravam por renomeação deixam o arquivo ausente por um instante
+        if (strcmp(text, workspace.source) != 0) errors = checkSource(&workspace, text, options);
+        free(text);
+    }
+#endif
+    freeWorkspace(&workspace);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Fecha a última fase, imprime a tabela de --perf e grava a linha do tempo antes de sair
+static int finish(const Options *options, int status) {
+    endPhase(options, "exit", -1, -1);
+    if (options->perf) {
+        perfReport(options->perf, stderr);
+        perfClose(options->perf);
+    }
+    if (options->trace_path) {
+        if (traceClose()) fprintf(stderr, "trace: timeline written to %s\n", options->trace_path);
+        else status = EXIT_FAILURE;
+    }
+    return status;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options] <source_file>\n", program);
+    fputs("  --stream | --pipeline       interleave lexer and parser (--pipeline: lexer on its own thread)\n"
+          "  --vm | --run                run in the virtual machine | run native code in memory\n"
+          "  --dump-bytecode             list the generated bytecode\n"
+          "  --native [--via-asm]        build an x86-64 executable (--via-asm: through the system assembler)\n"
+          "  -S | -c                     write only the assembly | only the ELF object\n"
+          "  --emit=c                    write the program translated to C11\n"
+          "  --cc                        compile the generated C with the system compiler\n"
+          "  --naive-regalloc            keep every value on the stack (comparison)\n"
+          "  -O0 | -O1 | -O2             optimization level\n"
+          "  --unroll <n>                for-loop unroll factor at -O2\n"
+          "  --inline <n>                largest procedure inlined at -O2\n"
+          "  --no-vectorize              keep array loops scalar at -O2\n"
+          "  -mavx2                      vector kernels with AVX2\n"
+          "  --dump-ir                   list the SSA after the passes\n"
+          "  --no-superinstructions      VM without fused sequences (comparison)\n"
+          "  --opcode-pairs              most dispatched opcode pairs in the VM\n"
+          "  --branch-stats              branches executed and taken in the VM\n"
+          "  --profile                   sample the execution and report the hot lines\n"
+          "  --profile-interval <us>     CPU time between samples\n"
+          "  --profile-out <file>        folded stacks for flame graphs\n"
+          "  -fprofile-generate[=<file>] record block counts for profile-guided optimization\n"
+          "  -fprofile-use[=<file>]      optimize with the recorded block counts\n"
+          "  --build                     rebuild out-of-date units first\n"
+          "  -j <n>                      threads for --build or, without it, for procedure bodies\n"
+          "  --check | --watch           diagnostics only (--watch: again on every change)\n"
+          "  --diagnostics=text|json     diagnostic output format\n"
+          "  --max-errors <n>            stop after n errors (0: all)\n"
+          "  -o <file>                   output file\n"
+          "  --stats                     phase times and execution counters\n"
+          "  --perf                      hardware counters per phase, worker threads included\n"
+          "  --trace[=<file>]            phase timeline in trace-event format\n", stderr);
+}
+
+int main(int argc, char *argv[]) {
+    static PerfCounters perf;
+    Options options = {.unroll = IR_DEFAULT_UNROLL, .inline_limit = IR_DEFAULT_INLINE,
+                       .profile_interval = PROFILE_DEFAULT_INTERVAL};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0) {
+            options.streaming = true;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            options.pipeline = true;
+        } else if (strcmp(argv[i], "--vm") == 0) {
+            options.run_vm = true;
+        } else if (strcmp(argv[i], "--dump-bytecode") == 0) {
+            options.dump_bytecode = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            options.stats = true;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            options.perf = &perf;
+        } else if (strncmp(argv[i], "--trace", 7) == 0 && (argv[i][7] == '\0' || argv[i][7] == '=')) {
+            options.trace_path = argv[i][7] == '=' ? argv[i] + 8 : TRACE_DEFAULT_PATH;
+        } else if (strcmp(argv[i], "--emit=c") == 0) {
+            options.emit_c = true;
+        } else if (strcmp(argv[i], "--cc") == 0) {
+            options.cc = true;
+        } else if (strcmp(argv[i], "--run") == 0) {
+            options.run_jit = true;
+        } else if (strcmp(argv[i], "--native") == 0) {
+            options.native = true;
+        } else if (strcmp(argv[i], "-S") == 0) {
+            options.emit_asm = true;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            options.emit_object = true;
+        } else if (strcmp(argv[i], "--via-asm") == 0) {
+            options.via_asm = true;
+        } else if (strcmp(argv[i], "--naive-regalloc") == 0) {
+            options.naive_regalloc = true;
+        } else if (strcmp(argv[i], "-O0") == 0 || strcmp(argv[i], "-O1") == 0 || strcmp(argv[i], "-O2") == 0) {
+            options.opt_level = argv[i][2] - '0';
+        } else if (strcmp(argv[i], "--unroll") == 0 && i + 1 < argc) {
+            // Potência de dois: o resto da divisão pelo fator sai de uma máscara
+            options.unroll = atoi(argv[++i]);
+            if (options.unroll < 1 || options.unroll > 64 || (options.unroll & (options.unroll - 1)) != 0) {
+                fprintf(stderr, "Erro: --unroll espera uma potência de dois entre 1 e 64\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--inline") == 0 && i + 1 < argc) {
+            options.inline_limit = atoi(argv[++i]);
+            if (options.inline_limit < 0) {
+                fprintf(stderr, "Erro: --inline espera um número de instruções (0 desliga)\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--no-vectorize") == 0) {
+            options.no_vectorize = true;
+        } else if (strcmp(argv[i], "-mavx2") == 0) {
+            options.avx2 = true;
+        } else if (strcmp(argv[i], "--no-superinstructions") == 0) {
+            options.no_superinstructions = true;
+        } else if (strcmp(argv[i], "--opcode-pairs") == 0) {
+            options.opcode_pairs = true;
+        } else if (strcmp(argv[i], "--branch-stats") == 0) {
+            options.branch_stats = true;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            options.profile = true;
+        } else if (strcmp(argv[i], "--profile-interval") == 0 && i + 1 < argc) {
+            options.profile_interval = atoi(argv[++i]);
+            if (options.profile_interval <= 0) {
+                fprintf(stderr, "Erro: --profile-interval espera um intervalo positivo em microssegundos\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--profile-out") == 0 && i + 1 < argc) {
+            options.profile_path = argv[++i];
+        } else if (strncmp(argv[i], "-fprofile-generate", 18) == 0 && (argv[i][18] == '\0' || argv[i][18] == '=')) {
+            options.profile_generate = argv[i][18] == '=' ? argv[i] + 19 : PGO_DEFAULT_PATH;
+        } else if (strncmp(argv[i], "-fprofile-use", 13) == 0 && (argv[i][13] == '\0' || argv[i][13] == '=')) {
+            options.profile_use = argv[i][13] == '=' ? argv[i] + 14 : PGO_DEFAULT_PATH;
+        } else if (strcmp(argv[i], "--dump-ir") == 0) {
+            options.dump_ir = true;
+        } else if (strcmp(argv[i], "--build") == 0) {
+            options.build = true;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char *count = argv[i][2] ? argv[i] + 2 : i + 1 < argc ? argv[++i] : "";
+            options.jobs = atoi(count);
+            if (options.jobs <= 0) {
+                fprintf(stderr, "Erro: -j espera um número positivo de threads\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--diagnostics=json") == 0 || strcmp(argv[i], "--diagnostics=text") == 0) {
+            options.diagnostic_format = argv[i][14] == 'j' ? DIAGNOSTICS_JSON : DIAGNOSTICS_TEXT;
+        } else if (strcmp(argv[i], "--max-errors") == 0 && i + 1 < argc) {
+            options.max_errors = atoi(argv[++i]);
+            if (options.max_errors < 0) {
+                fprintf(stderr, "Erro: --max-errors espera um número de erros (0 grava todos)\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--check") == 0) {
+            options.check = true;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+#ifdef HAVE_WATCH
+            options.check = options.watch = true;
+#else
+            fprintf(stderr, "Erro: --watch não é suportado nesta plataforma\n");
+            return EXIT_FAILURE;
+#endif
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            options.source_path = argv[i];
+        }
+    }
+
+    if (!options.source_path) {
+        usage(argv[0]);
         return EXIT_FAILURE;
     }
-    fread(buffer, 1, length, file);
-    buffer[length] = '\0';
-    fclose(file);
+    if (options.profile && !options.run_vm && !options.run_jit) {
+        fprintf(stderr, "Erro: --profile requer --vm ou --run\n");
+        return EXIT_FAILURE;
+    }
+#ifndef HAVE_PROFILER
+    if (options.profile) {
+        fprintf(stderr, "Erro: --profile não está disponível nesta plataforma\n");
+        return EXIT_FAILURE;
+    }
+#endif
+    if (options.profile_generate && !options.run_vm && !options.run_jit) {
+        fprintf(stderr, "Erro: -fprofile-generate requer --vm ou --run\n");
+        return EXIT_FAILURE;
+    }
+    if (options.check && (options.build || options.emit_c || options.cc || needsBytecode(&options))) {
+        fprintf(stderr, "Erro: --check e --watch só analisam o fonte; não gere nem execute código com eles\n");
+        return EXIT_FAILURE;
+    }
+    if (options.profile_generate && options.profile_use) {
+        fprintf(stderr, "Erro: -fprofile-generate e -fprofile-use não podem ser usados juntos\n");
+        return EXIT_FAILURE;
+    }
+    const char *source_path = options.source_path;
+    static char unit_dir[1024];
+    const char *slash = strrchr(source_path, '/');
+    snprintf(unit_dir, sizeof(unit_dir), "%.*s", slash ? (int)(slash - source_path) : 1, slash ? source_path : ".");
+    options.unit_dir = unit_dir[0] ? unit_dir : "/";
+    if (options.perf) perfOpen(options.perf);
+    if (options.trace_path && !traceOpen(options.trace_path)) {
+        options.trace_path = NULL;
+        return finish(&options, EXIT_FAILURE);
+    }
+
+    const char *reason;
+    char *buffer = readSourceFile(source_path, &reason);
+    if (!buffer) {
+        fprintf(stderr, "Error opening file %s: %s\n", source_path, reason);
+        return finish(&options, EXIT_FAILURE);
+    }
+    // O lexer para no primeiro '\0': os bytes lidos de fato
+    long length = (long)strlen(buffer);
+    options.source_hash = irSourceHash(buffer);
+    options.build_key = unitBuildKey(buffer, options.opt_level);
+    endPhase(&options, "read", length, -1);
+
+    if (options.build) {
+        BuildOptions build_options = {options.jobs, options.opt_level, compileBuildUnit, &options};
+        BuildStats build_stats;
+        double start = now();
+        bool built = buildUnits(source_path, &build_options, &build_stats);
+        endPhase(&options, "build units", -1, -1);
+        if (options.stats) {
+            fprintf(stderr, "build: %d unit(s), %d compiled, %d up to date, %d failed, %d thread(s) (%.3f ms)\n",
+                    build_stats.units, build_stats.compiled, build_stats.up_to_date, build_stats.failed,
+                    build_stats.jobs,
+                    (now() - start) * 1e3);
+        }
+        if (!built) {
+            free(buffer);
+            return finish(&options, EXIT_FAILURE);
+        }
+    }
+
+    if (options.check) {
+        int status = runCheck(buffer, &options);
+        free(buffer);
+        return finish(&options, status);
+    }
+
+    // Os modos de execução usam o front-end em fluxo: a lista de tokens não é necessária
+    if (options.streaming || options.pipeline || options.build || options.emit_c || options.cc || needsBytecode(&options)) {
+        int status = runStreaming(buffer, &options);
+        free(buffer);
+        return finish(&options, status);
+    }
 
     // Initialize token list
     TokenList tokenList;
@@ -168,12 +946,13 @@ int main(int argc, char *argv[]) {
     // Tokenize the source code
     tokenizeSource(buffer, &tokenList);
     free(buffer);
+    endPhase(&options, "lex", length, tokenList.count);
 
     FILE *output_file = fopen("output.lex", "w");
     if (!output_file) {
         perror("Error opening output file");
         freeTokenList(&tokenList);
-        return EXIT_FAILURE;
+        return finish(&options, EXIT_FAILURE);
     }
 
     // Print lexical analysis results
@@ -184,22 +963,23 @@ int main(int argc, char *argv[]) {
     }
 
     // Perform syntactic and semantic analysis
-    //Parser parser;
-    //initParser(&parser, &tokenList, output_file);
+    DiagnosticBuffer diagnostics;
+    initDiagnostics(&diagnostics);
+    Parser parser;
+    initParser(&parser, &tokenList, &diagnostics);
+    parser.unit_dir = options.unit_dir;
+    parser.jobs = options.jobs > 0 ? options.jobs : defaultJobs();
 
     fprintf(output_file, "\nSyntactic and Semantic Analysis Results:\n");
-    // if (parse(&parser)) {
-    //     if (parser.error_count == 0) {
-    //         fprintf(output_file, "Analysis completed successfully with no errors.\n");
-    //     } else {
-    //         fprintf(output_file, "Analysis completed with %d errors.\n", parser.error_count);
-    //     }
-    // } else {
-    //     fprintf(output_file, "Analysis failed with fatal errors.\n");
-    // }
-
-    //freeParser(&parser);
+    int status = EXIT_SUCCESS;
+    if (analyze(&parser, output_file, &options) && parser.program->as.program.unit) {
+        status = compileUnit(&parser, &options);
+    }
+
+    freeParser(&parser);
+    freeDiagnostics(&diagnostics);
     fclose(output_file);
+    endPhase(&options, "parse+semantic", -1, tokenList.count);
 
     // Print tokens
     printf("Tokens:\n");
@@ -210,6 +990,7 @@ int main(int argc, char *argv[]) {
 
     // Free token list
     freeTokenList(&tokenList);
+    endPhase(&options, "print tokens", -1, -1);
 
-    return EXIT_SUCCESS;
+    return finish(&options, status);
 }
@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "parallel.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#define HAVE_PTHREADS 1
+#endif
+
+int defaultJobs(void) {
+#ifdef HAVE_PTHREADS
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (int)processors : 1;
+#else
+    return 1;
+#endif
+}
+
+#ifdef HAVE_PTHREADS
+typedef struct {
+    void (*task)(void *context, int index);
+    void *context;
+    int count;
+    atomic_int next;          // Próximo índice livre: cada thread pega um por vez
+} ParallelLoop;
+
+static void *runLoop(void *argument) {
+    ParallelLoop *loop = argument;
+    for (int i = atomic_fetch_add(&loop->next, 1); i < loop->count; i = atomic_fetch_add(&loop->next, 1)) {
+        loop->task(loop->context, i);
+    }
+    return NULL;
+}
+#endif
+
+void parallelFor(int count, int jobs, void (*task)(void *context, int index), void *context) {
+    if (jobs > count) jobs = count;
+#ifdef HAVE_PTHREADS
+    if (jobs > 1) {
+        ParallelLoop loop = {task, context, count, 0};
+        pthread_t *threads = malloc(sizeof(pthread_t) * (jobs - 1));
+        if (!threads) {
+            fprintf(stderr, "Erro de alocação de memória ao criar threads\n");
+            exit(EXIT_FAILURE);
+        }
+        int started = 0;
+        for (int i = 1; i < jobs; i++) {
+            if (pthread_create(&threads[started], NULL, runLoop, &loop) == 0) started++;
+        }
+        runLoop(&loop);
+        for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+        free(threads);
+        return;
+    }
+#endif
+    for (int i = 0; i < count; i++) task(context, i);
+}
@@ -0,0 +1,15 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Abaixo disto, criar as threads custa mais que o trabalho dividido entre elas
+#define PARALLEL_MIN_ITEMS 32
+
+// Laço paralelo das fases do front-end: task(context, i) roda uma vez para cada i em
+// [0, count), distribuído entre até jobs threads, das quais a chamadora é uma. Sem
+// pthreads, ou com jobs <= 1, os índices rodam em ordem na própria thread
+void parallelFor(int count, int jobs, void (*task)(void *context, int index), void *context);
+
+// Uma thread por processador disponível
+int defaultJobs(void);
+
+#endif
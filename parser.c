@@ -9,243 +9,1024 @@
 #include "tokens.h"
 #include "parser.h"
 #include "symbol_table.h"
+#include "unit.h"
+#include "parallel.h"
+#include "trace.h"
+
+#define TOKEN_BATCH 256
+
+static AstNode *parseExpression(Parser *parser);
+static AstNode *parseStatement(Parser *parser);
+
+// Modo em fluxo: descarta os tokens já consumidos e pede mais ao lexer, na mesma thread
+// ou pela fila da thread do lexer
+static void fillTokens(Parser *parser) {
+    releaseTokens(parser->tokens, parser->current_token);
+    if (parser->ring) {
+        receiveTokens(parser->ring, parser->tokens, TOKEN_BATCH);
+    } else {
+        lexBatch(parser->lexer, parser->tokens, TOKEN_BATCH);
+    }
+}
+
+static bool streaming(const Parser *parser) {
+    return parser->lexer || parser->ring;
+}
 
 static void advance(Parser *parser) {
     if (parser->current_token) {
+        if (streaming(parser) && !parser->current_token->next) {
+            fillTokens(parser);
+        }
         parser->current_token = parser->current_token->next;
     }
 }
 
+static TokenNode *peekToken(Parser *parser) {
+    if (!parser->current_token) return NULL;
+    if (streaming(parser) && !parser->current_token->next) {
+        fillTokens(parser);
+    }
+    return parser->current_token->next;
+}
+
+static bool check(const Parser *parser, TokenType type) {
+    return parser->current_token && parser->current_token->token.type == type;
+}
+
+static int currentLine(const Parser *parser) {
+    return parser->current_token ? parser->current_token->token.line : -1;
+}
+
+static int currentColumn(const Parser *parser) {
+    return parser->current_token ? parser->current_token->token.column : -1;
+}
+
 static bool expect(Parser *parser, TokenType type) {
-    if (parser->current_token && parser->current_token->token.type == type) {
+    if (check(parser, type)) {
         advance(parser);
         return true;
     }
-    fprintf(parser->output_file, "Syntax Error: Expected token type %d at line %d, column %d\n",
-            type, parser->current_token ? parser->current_token->token.line : -1,
-            parser->current_token ? parser->current_token->token.column : -1);
+    reportDiagnostic(parser->diagnostics, DIAG_EXPECTED_TOKEN, currentLine(parser), currentColumn(parser), type);
     parser->error_count++;
     return false;
 }
 
+static AstNode *newNode(Parser *parser, NodeKind kind) {
+    return createNode(parser->arena, kind, currentLine(parser), currentColumn(parser));
+}
+
 // Function to check if the current token is an expression
 static bool isExpression(Parser *parser) {
     if (!parser->current_token) return false;
 
     TokenType type = parser->current_token->token.type;
-    // Expande para suportar mais casos se necessário
     return (type == TOKEN_IDENTIFIER ||
             type == TOKEN_INTEGER_LITERAL ||
             type == TOKEN_REAL_LITERAL ||
-            type == TOKEN_LPAREN);
+            type == TOKEN_BOOLEAN_LITERAL ||
+            type == TOKEN_STRING_LITERAL ||
+            type == TOKEN_LPAREN ||
+            type == TOKEN_NOT ||
+            type == TOKEN_PLUS ||
+            type == TOKEN_MINUS);
 }
 
+// variable := identifier ['[' expression ']']
+static AstNode *parseVariableReference(Parser *parser) {
+    AstNode *variable = newNode(parser, NODE_VARIABLE);
+    variable->as.variable.name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
+    advance(parser);
+    if (!check(parser, TOKEN_LBRACKET)) return variable;
+
+    AstNode *node = createNode(parser->arena, NODE_INDEX, variable->line, variable->column);
+    node->as.element.array = variable;
+    advance(parser);
+    node->as.element.index = parseExpression(parser);
+    if (!node->as.element.index || !expect(parser, TOKEN_RBRACKET)) return NULL;
+    return node;
+}
 
-// Parse a single expression (simplified)
-static bool parseExpression(Parser *parser) {
-    // Simple expression parsing: identifier or literal
+// factor := variable | literal | '(' expression ')' | not factor
+static AstNode *parseFactor(Parser *parser) {
     if (!parser->current_token) {
-        fprintf(parser->output_file, "Syntax Error: Unexpected end of input during expression parsing\n");
+        reportDiagnostic(parser->diagnostics, DIAG_UNEXPECTED_END, -1, -1);
         parser->error_count++;
-        return false;
+        return NULL;
     }
 
-    TokenType type = parser->current_token->token.type;
+    Token *token = &parser->current_token->token;
+    AstNode *node;
 
-    // Check for valid expression types
-    if (type == TOKEN_IDENTIFIER ||
-        type == TOKEN_INTEGER_LITERAL ||
-        type == TOKEN_REAL_LITERAL) {
-        advance(parser);
-        return true;
+    switch (token->type) {
+        case TOKEN_IDENTIFIER:
+            return parseVariableReference(parser);
+        case TOKEN_INTEGER_LITERAL:
+            node = newNode(parser, NODE_INT_LITERAL);
+            node->as.int_value = token->value.integer;
+            advance(parser);
+            return node;
+        case TOKEN_REAL_LITERAL:
+            node = newNode(parser, NODE_REAL_LITERAL);
+            node->as.real_value = token->value.real;
+            advance(parser);
+            return node;
+        case TOKEN_BOOLEAN_LITERAL:
+            node = newNode(parser, NODE_BOOL_LITERAL);
+            node->as.bool_value = strcmp(token->lexeme, "true") == 0;
+            advance(parser);
+            return node;
+        case TOKEN_STRING_LITERAL:
+            node = newNode(parser, NODE_STRING_LITERAL);
+            node->as.string_value = arenaStrdup(parser->arena, token->lexeme);
+            advance(parser);
+            return node;
+        case TOKEN_LPAREN:
+            advance(parser);
+            node = parseExpression(parser);
+            if (!node || !expect(parser, TOKEN_RPAREN)) return NULL;
+            return node;
+        case TOKEN_NOT: {
+            node = newNode(parser, NODE_UNARY);
+            node->as.unary.op = TOKEN_NOT;
+            advance(parser);
+            node->as.unary.operand = parseFactor(parser);
+            return node->as.unary.operand ? node : NULL;
         }
+        default:
+            reportDiagnostic(parser->diagnostics, DIAG_INVALID_EXPRESSION, token->line, token->column);
+            parser->error_count++;
+            return NULL;
+    }
+}
 
-    // Support simple arithmetic expressions
-    if (type == TOKEN_PLUS || type == TOKEN_MINUS) {
+static AstNode *makeBinary(Parser *parser, TokenType op, AstNode *left, int line, int column) {
+    AstNode *node = createNode(parser->arena, NODE_BINARY, line, column);
+    node->as.binary.op = op;
+    node->as.binary.left = left;
+    return node;
+}
+
+// term := factor { ('*' | '/' | div | mod | and) factor }
+static AstNode *parseTerm(Parser *parser) {
+    AstNode *left = parseFactor(parser);
+    while (left && (check(parser, TOKEN_MULTIPLY) || check(parser, TOKEN_DIVIDE) ||
+                    check(parser, TOKEN_DIV) || check(parser, TOKEN_MOD) || check(parser, TOKEN_AND))) {
+        AstNode *node = makeBinary(parser, parser->current_token->token.type, left,
+                                   currentLine(parser), currentColumn(parser));
         advance(parser);
-        return isExpression(parser);
+        node->as.binary.right = parseFactor(parser);
+        left = node->as.binary.right ? node : NULL;
     }
-
-    fprintf(parser->output_file, "Syntax Error: Invalid expression at line %d, column %d\n",
-            parser->current_token->token.line,
-            parser->current_token->token.column);
-    parser->error_count++;
-    return false;
+    return left;
 }
 
-static bool parseVariableDeclaration(Parser *parser) {
-    while (parser->current_token && parser->current_token->token.type == TOKEN_IDENTIFIER) {
-        char *var_name = strdup(parser->current_token->token.lexeme);
+// simple := ['+' | '-'] term { ('+' | '-' | or) term }
+static AstNode *parseSimpleExpression(Parser *parser) {
+    AstNode *left;
+    if (check(parser, TOKEN_PLUS) || check(parser, TOKEN_MINUS)) {
+        AstNode *node = newNode(parser, NODE_UNARY);
+        node->as.unary.op = parser->current_token->token.type;
         advance(parser);
+        node->as.unary.operand = parseTerm(parser);
+        left = node->as.unary.operand ? node : NULL;
+    } else {
+        left = parseTerm(parser);
+    }
 
-        // Espera ':' após o identificador
-        if (!expect(parser, TOKEN_COLON)) {
-            free(var_name);
-            return false;
+    while (left && (check(parser, TOKEN_PLUS) || check(parser, TOKEN_MINUS) || check(parser, TOKEN_OR))) {
+        AstNode *node = makeBinary(parser, parser->current_token->token.type, left,
+                                   currentLine(parser), currentColumn(parser));
+        advance(parser);
+        node->as.binary.right = parseTerm(parser);
+        left = node->as.binary.right ? node : NULL;
+    }
+    return left;
+}
+
+// expression := simple [relop simple]
+static AstNode *parseExpression(Parser *parser) {
+    AstNode *left = parseSimpleExpression(parser);
+    if (left && parser->current_token) {
+        TokenType type = parser->current_token->token.type;
+        if (type == TOKEN_EQ || type == TOKEN_NEQ || type == TOKEN_LT ||
+            type == TOKEN_GT || type == TOKEN_LTE || type == TOKEN_GTE) {
+            AstNode *node = makeBinary(parser, type, left, currentLine(parser), currentColumn(parser));
+            advance(parser);
+            node->as.binary.right = parseSimpleExpression(parser);
+            return node->as.binary.right ? node : NULL;
         }
+    }
+    return left;
+}
 
-        DataType var_type = TYPE_UNKNOWN;
+// Forma de um tipo array: array '[' low '..' high ']' of element
+typedef struct {
+    DataType element;
+    int64_t low;
+    int64_t high;
+} ArrayShape;
 
-        // Identifica o tipo da variável
-        if (parser->current_token) {
-            if (parser->current_token->token.type == TOKEN_INTEGER) {
-                var_type = TYPE_INTEGER;
-            } else if (parser->current_token->token.type == TOKEN_REAL) {
-                var_type = TYPE_REAL;
-            } else if (parser->current_token->token.type == TOKEN_BOOLEAN) {
-                var_type = TYPE_BOOLEAN;
-            }
+static DataType parseScalarType(Parser *parser) {
+    DataType var_type = TYPE_UNKNOWN;
+
+    // Identifica o tipo da variável
+    if (parser->current_token) {
+        if (parser->current_token->token.type == TOKEN_INTEGER) {
+            var_type = TYPE_INTEGER;
+        } else if (parser->current_token->token.type == TOKEN_REAL) {
+            var_type = TYPE_REAL;
+        } else if (parser->current_token->token.type == TOKEN_BOOLEAN) {
+            var_type = TYPE_BOOLEAN;
         }
+    }
 
-        // Erro se o tipo for inválido ou ausente
-        if (var_type == TYPE_UNKNOWN) {
-            fprintf(parser->output_file, "Semantic Error: Invalid variable type at line %d\n",
-                    parser->current_token ? parser->current_token->token.line : -1);
-            parser->error_count++;
-            free(var_name);
-            return false;
+    // Erro se o tipo for inválido ou ausente
+    if (var_type == TYPE_UNKNOWN) {
+        reportDiagnostic(parser->diagnostics, DIAG_INVALID_TYPE, currentLine(parser), currentColumn(parser));
+        parser->error_count++;
+        return TYPE_UNKNOWN;
+    }
+    advance(parser); // Avança após o tipo
+    return var_type;
+}
+
+// Limite de um array: literal inteiro, talvez com sinal
+static bool parseBound(Parser *parser, int64_t *value) {
+    bool negative = check(parser, TOKEN_MINUS);
+    if (negative || check(parser, TOKEN_PLUS)) advance(parser);
+    if (!check(parser, TOKEN_INTEGER_LITERAL)) return expect(parser, TOKEN_INTEGER_LITERAL);
+    int64_t literal = parser->current_token->token.value.integer;
+    *value = negative ? -literal : literal;
+    advance(parser);
+    return true;
+}
+
+static DataType parseType(Parser *parser, ArrayShape *shape) {
+    if (!check(parser, TOKEN_ARRAY)) return parseScalarType(parser);
+    advance(parser);
+    if (!expect(parser, TOKEN_LBRACKET) || !parseBound(parser, &shape->low) ||
+        !expect(parser, TOKEN_DOTDOT) || !parseBound(parser, &shape->high) ||
+        !expect(parser, TOKEN_RBRACKET) || !expect(parser, TOKEN_OF)) {
+        return TYPE_UNKNOWN;
+    }
+    shape->element = parseScalarType(parser);
+    return shape->element == TYPE_UNKNOWN ? TYPE_UNKNOWN : TYPE_ARRAY;
+}
+
+// Adiciona ao escopo atual (local dentro de procedimentos, global no programa)
+static void declareSymbol(Parser *parser, const char *name, DataType type, int line) {
+    SymbolTable *scope = parser->local_table ? parser->local_table : parser->symbol_table;
+    if (!addSymbol(scope, name, type)) {
+        reportDiagnostic(parser->diagnostics, DIAG_VARIABLE_REDECLARED, line, 0, name);
+        parser->error_count++;
+    }
+}
+
+// Arrays só existem como variáveis do programa: ficam fora dos registradores e das
+// globais, numa área própria que nem procedimentos nem units compartilham
+static void declareArray(Parser *parser, const char *name, const ArrayShape *shape, int line) {
+    SymbolTable *table = parser->symbol_table;
+    SymbolTable *scope = parser->local_table ? parser->local_table : table;
+    if (findOwnSymbol(scope, name)) {
+        declareSymbol(parser, name, TYPE_ARRAY, line); // Reporta a redeclaração
+        return;
+    }
+    bool valid = false;
+    if (parser->local_table || (parser->program && parser->program->as.program.unit)) {
+        reportDiagnostic(parser->diagnostics, DIAG_ARRAY_PLACEMENT, line, 0, name);
+        parser->error_count++;
+    } else if (shape->low < INT32_MIN || shape->high > INT32_MAX || shape->low > shape->high ||
+               shape->high - shape->low + 1 > MAX_ARRAY_SLOTS - table->array_slots ||
+               table->array_count >= MAX_ARRAYS) {
+        reportDiagnostic(parser->diagnostics, DIAG_ARRAY_BOUNDS, line, 0, name);
+        parser->error_count++;
+    } else {
+        table->array_slots += shape->high - shape->low + 1;
+        valid = true;
+    }
+    // Declarado mesmo com erro, para que os usos não sejam reportados como não declarados
+    declareSymbol(parser, name, TYPE_ARRAY, line);
+    Symbol *symbol = findOwnSymbol(scope, name);
+    if (symbol) {
+        symbol->element_type = shape->element;
+        symbol->low = valid ? (int32_t)shape->low : 0;
+        symbol->high = valid ? (int32_t)shape->high : 0;
+    }
+}
+
+// Lê "a, b, c :" e devolve a lista de identificadores como NODE_VARIABLE
+static AstNode *parseIdentifierList(Parser *parser) {
+    AstNode *head = NULL, *tail = NULL;
+    do {
+        if (!check(parser, TOKEN_IDENTIFIER)) {
+            expect(parser, TOKEN_IDENTIFIER);
+            return NULL;
         }
+        AstNode *node = newNode(parser, NODE_VARIABLE);
+        node->as.variable.name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
+        advance(parser);
+        if (tail) tail->next = node; else head = node;
+        tail = node;
+        if (!check(parser, TOKEN_COMMA)) break;
+        advance(parser);
+    } while (true);
+
+    // Espera ':' após os identificadores
+    if (!expect(parser, TOKEN_COLON)) return NULL;
+    return head;
+}
+
+static bool parseVariableDeclaration(Parser *parser) {
+    while (check(parser, TOKEN_IDENTIFIER)) {
+        AstNode *names = parseIdentifierList(parser);
+        if (!names) return false;
+
+        ArrayShape shape;
+        DataType var_type = parseType(parser, &shape);
+        if (var_type == TYPE_UNKNOWN) return false;
 
         // Adiciona à tabela de símbolos
-        if (!addSymbol(parser->symbol_table, var_name, var_type)) {
-            fprintf(parser->output_file, "Semantic Error: Variable %s already declared at line %d\n",
-                    var_name, parser->current_token ? parser->current_token->token.line : -1);
-            parser->error_count++;
+        for (AstNode *name = names; name; name = name->next) {
+            if (var_type == TYPE_ARRAY) {
+                declareArray(parser, name->as.variable.name, &shape, name->line);
+            } else {
+                declareSymbol(parser, name->as.variable.name, var_type, name->line);
+            }
         }
 
-        free(var_name);
-        advance(parser); // Avança após o tipo
-
         // Verifica se termina com ponto e vírgula
-        if (parser->current_token && parser->current_token->token.type == TOKEN_SEMICOLON) {
-            advance(parser);
-        } else {
-            return false; // Erro se não houver ';' ou outro token esperado
-        }
+        if (!expect(parser, TOKEN_SEMICOLON)) return false;
     }
     return true;
 }
 
-
 // Parse assignment statement
-static bool parseAssignmentStatement(Parser *parser) {
-    // Expect an identifier (variable name)
-    if (!parser->current_token || parser->current_token->token.type != TOKEN_IDENTIFIER) {
-        fprintf(parser->output_file, "Syntax Error: Expected variable name in assignment\n");
+static AstNode *parseAssignmentStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_ASSIGN);
+    AstNode *target = parseVariableReference(parser);
+    if (!target) return NULL;
+
+    // Expect assignment operator
+    if (!expect(parser, TOKEN_ASSIGN)) return NULL;
+
+    // Expect a valid expression after assignment
+    if (!isExpression(parser)) {
+        reportDiagnostic(parser->diagnostics, DIAG_EXPECTED_EXPRESSION, currentLine(parser), currentColumn(parser));
         parser->error_count++;
-        return false;
+        return NULL;
     }
 
-    // Store variable name for potential semantic checks
-    char *var_name = strdup(parser->current_token->token.lexeme);
+    node->as.assign.target = target;
+    node->as.assign.value = parseExpression(parser);
+    return node->as.assign.value ? node : NULL;
+}
+
+// Chamada de procedimento: nome [ '(' argumentos ')' ]
+static AstNode *parseCallStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_CALL);
+    node->as.call.name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
     advance(parser);
 
-    // Expect assignment operator
-    if (!expect(parser, TOKEN_ASSIGN)) {
-        free(var_name);
-        return false;
+    if (check(parser, TOKEN_LPAREN)) {
+        advance(parser);
+        AstNode *tail = NULL;
+        while (!check(parser, TOKEN_RPAREN)) {
+            AstNode *arg = parseExpression(parser);
+            if (!arg) return NULL;
+            if (tail) tail->next = arg; else node->as.call.args = arg;
+            tail = arg;
+            if (!check(parser, TOKEN_COMMA)) break;
+            advance(parser);
+        }
+        if (!expect(parser, TOKEN_RPAREN)) return NULL;
     }
+    return node;
+}
 
-    // Expect a valid expression after assignment
-    if (!isExpression(parser)) {
-        fprintf(parser->output_file, "Syntax Error: Expected an expression after ':=' at line %d, column %d\n",
-                parser->current_token ? parser->current_token->token.line : -1,
-                parser->current_token ? parser->current_token->token.column : -1);
-        parser->error_count++;
-        free(var_name);
-        return false;
+static AstNode *parseWriteStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_WRITE);
+    node->as.write.newline = check(parser, TOKEN_WRITELN);
+    advance(parser);
+    if (!check(parser, TOKEN_LPAREN)) return node; // writeln sem argumentos
+    advance(parser);
+
+    // Parse múltiplos argumentos; a vírgula entre eles é opcional
+    AstNode *tail = NULL;
+    while (parser->current_token && !check(parser, TOKEN_RPAREN)) {
+        AstNode *arg = parseExpression(parser);
+        if (!arg) return NULL;
+        if (tail) tail->next = arg; else node->as.write.args = arg;
+        tail = arg;
+
+        if (check(parser, TOKEN_COMMA)) {
+            advance(parser);
+        }
     }
 
-    // Parse the expression
-    if (!parseExpression(parser)) {
-        free(var_name);
-        return false;
+    if (!expect(parser, TOKEN_RPAREN)) return NULL;
+    return node;
+}
+
+static AstNode *parseReadStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_READ);
+    advance(parser);
+    if (!expect(parser, TOKEN_LPAREN)) return NULL;
+
+    AstNode *tail = NULL;
+    do {
+        if (!check(parser, TOKEN_IDENTIFIER)) {
+            expect(parser, TOKEN_IDENTIFIER);
+            return NULL;
+        }
+        AstNode *target = parseVariableReference(parser);
+        if (!target) return NULL;
+        if (tail) tail->next = target; else node->as.read.targets = target;
+        tail = target;
+        if (!check(parser, TOKEN_COMMA)) break;
+        advance(parser);
+    } while (true);
+
+    if (!expect(parser, TOKEN_RPAREN)) return NULL;
+    return node;
+}
+
+static AstNode *parseIfStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_IF);
+    advance(parser);
+    node->as.if_stmt.cond = parseExpression(parser);
+    if (!node->as.if_stmt.cond || !expect(parser, TOKEN_THEN)) return NULL;
+    node->as.if_stmt.then_branch = parseStatement(parser);
+    if (!node->as.if_stmt.then_branch) return NULL;
+    if (check(parser, TOKEN_ELSE)) {
+        advance(parser);
+        node->as.if_stmt.else_branch = parseStatement(parser);
+        if (!node->as.if_stmt.else_branch) return NULL;
     }
+    return node;
+}
 
-    free(var_name);
-    return true;
+static AstNode *parseWhileStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_WHILE);
+    advance(parser);
+    node->as.while_stmt.cond = parseExpression(parser);
+    if (!node->as.while_stmt.cond || !expect(parser, TOKEN_DO)) return NULL;
+    node->as.while_stmt.body = parseStatement(parser);
+    return node->as.while_stmt.body ? node : NULL;
 }
 
+// for variável := início (to | downto) fim do statement
+static AstNode *parseForStatement(Parser *parser) {
+    AstNode *node = newNode(parser, NODE_FOR);
+    advance(parser);
+    if (!check(parser, TOKEN_IDENTIFIER)) {
+        expect(parser, TOKEN_IDENTIFIER);
+        return NULL;
+    }
+    AstNode *var = newNode(parser, NODE_VARIABLE);
+    var->as.variable.name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
+    advance(parser);
+    node->as.for_stmt.var = var;
 
-static bool parseStatementBlock(Parser *parser) {
-    while (parser->current_token && parser->current_token->token.type != TOKEN_END) {
-        // Handle different types of statements
-        if (parser->current_token->token.type == TOKEN_IDENTIFIER) {
-            // Assignment statement
-            if (!parseAssignmentStatement(parser)) {
-                return false;
-            }
+    if (!expect(parser, TOKEN_ASSIGN)) return NULL;
+    node->as.for_stmt.start = parseExpression(parser);
+    if (!node->as.for_stmt.start) return NULL;
 
-            // Expect semicolon between statements
-            if (!expect(parser, TOKEN_SEMICOLON)) {
-                return false;
-            }
+    if (check(parser, TOKEN_DOWNTO)) {
+        node->as.for_stmt.downto = true;
+        advance(parser);
+    } else if (!expect(parser, TOKEN_TO)) {
+        return NULL;
+    }
+    node->as.for_stmt.end = parseExpression(parser);
+    if (!node->as.for_stmt.end || !expect(parser, TOKEN_DO)) return NULL;
+    node->as.for_stmt.body = parseStatement(parser);
+    return node->as.for_stmt.body ? node : NULL;
+}
+
+// Descarta tokens até o fim do statement com erro
+static void synchronize(Parser *parser) {
+    while (parser->current_token && !check(parser, TOKEN_EOF) &&
+           !check(parser, TOKEN_SEMICOLON) && !check(parser, TOKEN_END)) {
+        advance(parser);
+    }
+}
+
+// Statements separados por ';' até o 'end' do bloco
+static AstNode *parseStatementBlock(Parser *parser) {
+    AstNode *block = newNode(parser, NODE_BLOCK);
+    AstNode *tail = NULL;
+
+    while (parser->current_token && !check(parser, TOKEN_END) && !check(parser, TOKEN_EOF)) {
+        if (check(parser, TOKEN_SEMICOLON)) {
+            advance(parser); // Statement vazio
+            continue;
         }
-        // Add support for other statement types like writeln, read, etc.
-        else if (parser->current_token->token.type == TOKEN_WRITELN) {
-            advance(parser);
-            if (!expect(parser, TOKEN_LPAREN)) return false;
 
-            // Parse múltiplos argumentos (simplificado)
-            while (parser->current_token && parser->current_token->token.type != TOKEN_RPAREN) {
-                if (!parseExpression(parser)) return false;
+        AstNode *stmt = parseStatement(parser);
+        if (!stmt) {
+            synchronize(parser);
+            continue;
+        }
+        if (tail) tail->next = stmt; else block->as.block.statements = stmt;
+        tail = stmt;
+
+        // Expect semicolon between statements
+        if (!check(parser, TOKEN_END) && !expect(parser, TOKEN_SEMICOLON)) {
+            synchronize(parser);
+        }
+    }
+    return block;
+}
+
+static AstNode *parseStatement(Parser *parser) {
+    if (!parser->current_token) return NULL;
 
-                // Opção: vírgula entre argumentos
-                if (parser->current_token && parser->current_token->token.type == TOKEN_COMMA) {
-                    advance(parser);
-                }
+    switch (parser->current_token->token.type) {
+        case TOKEN_IDENTIFIER:
+            if (peekToken(parser) && (peekToken(parser)->token.type == TOKEN_ASSIGN ||
+                                      peekToken(parser)->token.type == TOKEN_LBRACKET)) {
+                return parseAssignmentStatement(parser);
             }
+            return parseCallStatement(parser);
+        case TOKEN_BEGIN: {
+            advance(parser);
+            AstNode *block = parseStatementBlock(parser);
+            return expect(parser, TOKEN_END) ? block : NULL;
+        }
+        case TOKEN_IF:
+            return parseIfStatement(parser);
+        case TOKEN_WHILE:
+            return parseWhileStatement(parser);
+        case TOKEN_FOR:
+            return parseForStatement(parser);
+        case TOKEN_WRITE:
+        case TOKEN_WRITELN:
+            return parseWriteStatement(parser);
+        case TOKEN_READ:
+            return parseReadStatement(parser);
+        default:
+            reportDiagnostic(parser->diagnostics, DIAG_UNEXPECTED_STATEMENT, currentLine(parser), currentColumn(parser));
+            parser->error_count++;
+            return NULL;
+    }
+}
+
+// Lista de parâmetros formais: '(' a, b: integer; c: real ')'
+static AstNode *parseParameters(Parser *parser) {
+    AstNode *head = NULL, *tail = NULL;
+    if (!check(parser, TOKEN_LPAREN)) return NULL;
+    advance(parser);
 
-            if (!expect(parser, TOKEN_RPAREN)) return false;
-            if (!expect(parser, TOKEN_SEMICOLON)) return false;
+    while (check(parser, TOKEN_IDENTIFIER)) {
+        AstNode *names = parseIdentifierList(parser);
+        if (!names) return NULL;
+        ArrayShape shape;
+        DataType type = parseType(parser, &shape);
+        for (AstNode *name = names; name; name = name->next) {
+            if (type == TYPE_ARRAY) {
+                reportDiagnostic(parser->diagnostics, DIAG_ARRAY_PLACEMENT, name->line, 0, name->as.variable.name);
+                parser->error_count++;
+            }
+            name->type = type == TYPE_ARRAY ? TYPE_UNKNOWN : type;
         }
-        else {
-            fprintf(parser->output_file, "Syntax Error: Unexpected token in statement block\n");
+        if (tail) tail->next = names; else head = names;
+        for (tail = names; tail->next; tail = tail->next) {}
+        if (!check(parser, TOKEN_SEMICOLON)) break;
+        advance(parser);
+    }
+    expect(parser, TOKEN_RPAREN);
+    return head;
+}
+
+static bool sameSignature(const Symbol *symbol, int param_count, const DataType *param_types) {
+    if (symbol->param_count != param_count) return false;
+    for (int i = 0; i < param_count; i++) {
+        if (symbol->param_types[i] != param_types[i]) return false;
+    }
+    return true;
+}
+
+// Tipos dos parâmetros na ordem da lista; acima de MAX_PARAMS o procedimento é rejeitado
+static DataType *parameterTypes(Parser *parser, const AstNode *params, const char *name,
+                                int line, int column, int *count) {
+    int param_count = 0;
+    for (const AstNode *param = params; param; param = param->next) param_count++;
+    DataType *types = (DataType *)malloc(sizeof(DataType) * (param_count ? param_count : 1));
+    if (!types) {
+        fprintf(stderr, "Erro de alocação de memória ao declarar procedimento\n");
+        exit(EXIT_FAILURE);
+    }
+    param_count = 0;
+    for (const AstNode *param = params; param; param = param->next) types[param_count++] = param->type;
+    if (param_count > MAX_PARAMS) {
+        reportDiagnostic(parser->diagnostics, DIAG_TOO_MANY_PARAMETERS, line, column, name, param_count, MAX_PARAMS);
+        parser->error_count++;
+    }
+    *count = param_count;
+    return types;
+}
+
+// Cada procedimento tem sua própria arena e tabela de escopo local, e o escopo global
+// não é tocado aqui: a assinatura só é registrada depois, por declareProcedure
+static AstNode *parseProcedureText(Parser *parser) {
+    Arena *arena = (Arena *)malloc(sizeof(Arena));
+    SymbolTable *locals = (SymbolTable *)malloc(sizeof(SymbolTable));
+    if (!arena || !locals) {
+        fprintf(stderr, "Erro de alocação de memória ao criar procedimento\n");
+        exit(EXIT_FAILURE);
+    }
+    initArena(arena);
+    initSymbolTable(locals);
+    locals->current_scope = 1;
+
+    parser->arena = arena;
+    parser->local_table = locals;
+
+    AstNode *node = newNode(parser, NODE_PROCEDURE);
+    node->as.procedure.arena = arena;
+    node->as.procedure.locals = locals;
+    advance(parser);
+
+    if (check(parser, TOKEN_IDENTIFIER)) {
+        node->as.procedure.name = arenaStrdup(arena, parser->current_token->token.lexeme);
+        advance(parser);
+    } else {
+        expect(parser, TOKEN_IDENTIFIER);
+        node->as.procedure.name = arenaStrdup(arena, "?");
+    }
+
+    node->as.procedure.params = parseParameters(parser);
+    for (AstNode *param = node->as.procedure.params; param; param = param->next) {
+        declareSymbol(parser, param->as.variable.name, param->type, param->line);
+    }
+    expect(parser, TOKEN_SEMICOLON);
+
+    if (check(parser, TOKEN_VAR)) {
+        advance(parser);
+        if (!parseVariableDeclaration(parser)) synchronize(parser);
+    }
+
+    if (expect(parser, TOKEN_BEGIN)) {
+        node->as.procedure.body = parseStatementBlock(parser);
+        expect(parser, TOKEN_END);
+    }
+    expect(parser, TOKEN_SEMICOLON);
+
+    parser->arena = &parser->global_arena;
+    parser->local_table = NULL;
+    return node;
+}
+
+// Registra a assinatura no escopo global, na ordem do fonte
+static void declareProcedure(Parser *parser, AstNode *node) {
+    int param_count;
+    DataType *param_types = parameterTypes(parser, node->as.procedure.params, node->as.procedure.name,
+                                           node->line, node->column, &param_count);
+    // O corpo de um procedimento da interface precisa repetir a assinatura declarada
+    Symbol *declared = findOwnSymbol(parser->symbol_table, node->as.procedure.name);
+    if (declared && declared->forward) {
+        declared->forward = false;
+        if (!sameSignature(declared, param_count, param_types)) {
+            reportDiagnostic(parser->diagnostics, DIAG_INTERFACE_MISMATCH, node->line, node->column,
+                             node->as.procedure.name);
             parser->error_count++;
-            return false;
         }
+    } else if (!addProcedureSymbol(parser->symbol_table, node->as.procedure.name, param_count, param_types)) {
+        reportDiagnostic(parser->diagnostics, DIAG_PROCEDURE_REDECLARED, node->line, node->column,
+                         node->as.procedure.name);
+        parser->error_count++;
+    }
+    free(param_types);
+}
+
+static AstNode *parseProcedure(Parser *parser) {
+    AstNode *node = parseProcedureText(parser);
+    declareProcedure(parser, node);
+    return node;
+}
+
+// Cabeçalho na interface de uma unit: o símbolo é exportado e o corpo vem na implementação
+static void parseProcedureHeading(Parser *parser) {
+    advance(parser);
+    int line = currentLine(parser);
+    if (!check(parser, TOKEN_IDENTIFIER)) {
+        expect(parser, TOKEN_IDENTIFIER);
+        synchronize(parser);
+        return;
+    }
+    int column = currentColumn(parser);
+    char *name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
+    advance(parser);
+
+    int param_count;
+    DataType *param_types = parameterTypes(parser, parseParameters(parser), name, line, column, &param_count);
+    if (addProcedureSymbol(parser->symbol_table, name, param_count, param_types)) {
+        parser->symbol_table->head->exported = true;
+        parser->symbol_table->head->forward = true;
+    } else {
+        reportDiagnostic(parser->diagnostics, DIAG_PROCEDURE_REDECLARED, line, column, name);
+        parser->error_count++;
+    }
+    free(param_types);
+    expect(parser, TOKEN_SEMICOLON);
+}
+
+// Mapeia a unit pré-compilada e a torna visível no escopo global
+static void useUnitNamed(Parser *parser, const char *name, int line) {
+    if (strcmp(name, parser->program->as.program.name) == 0) {
+        reportDiagnostic(parser->diagnostics, DIAG_UNIT_SELF, line, 0, name);
+        parser->error_count++;
+        return;
+    }
+    const char *reason;
+    Unit *unit = openUnit(parser->unit_dir, name, &reason);
+    if (!unit) {
+        reportDiagnostic(parser->diagnostics, DIAG_UNIT_NOT_LOADED, line, 0, name, reason);
+        parser->error_count++;
+    } else if (!useUnit(parser->symbol_table, unit)) {
+        closeUnit(unit);
+        reportDiagnostic(parser->diagnostics, DIAG_UNIT_REPEATED, line, 0, name);
+        parser->error_count++;
+    }
+}
+
+// uses A, B; — as últimas units da lista têm prioridade nos nomes repetidos
+static bool parseUses(Parser *parser) {
+    advance(parser);
+    do {
+        if (!check(parser, TOKEN_IDENTIFIER)) return expect(parser, TOKEN_IDENTIFIER);
+        useUnitNamed(parser, parser->current_token->token.lexeme, currentLine(parser));
+        advance(parser);
+        if (!check(parser, TOKEN_COMMA)) break;
+        advance(parser);
+    } while (true);
+    return expect(parser, TOKEN_SEMICOLON);
+}
+
+// Procedimento analisado por uma thread de trabalho, entre start ('procedure') e end
+typedef struct {
+    TokenNode *start;
+    TokenNode *end;           // Primeiro token depois do ';' final
+    AstNode *node;
+    DiagnosticBuffer diagnostics;
+    int error_count;
+    bool complete;            // A análise parou exatamente em end
+} ProcedureJob;
+
+typedef struct {
+    const Parser *parser;
+    ProcedureJob *jobs;
+} ProcedureBatch;
+
+// Fim de um procedimento bem formado: o token depois do ';' que segue o 'end' do primeiro
+// 'begin'. NULL quando a forma foge disso, e o resto fica com a análise em sequência
+static TokenNode *procedureEnd(TokenNode *token) {
+    int depth = 0;
+    for (token = token->next; token; token = token->next) {
+        switch (token->token.type) {
+            case TOKEN_BEGIN:
+                depth++;
+                break;
+            case TOKEN_END:
+                if (depth == 0) return NULL;
+                if (--depth > 0) break;
+                token = token->next;
+                return token && token->token.type == TOKEN_SEMICOLON ? token->next : NULL;
+            case TOKEN_PROCEDURE:
+            case TOKEN_EOF:
+                return NULL;
+            default:
+                break;
+        }
+    }
+    return NULL;
+}
+
+// Cada thread usa uma cópia do parser que só lê a lista de tokens e grava no próprio buffer.
+// No --trace, um intervalo por procedimento na linha da thread que o analisou
+static void parseProcedureJob(void *context, int index) {
+    uint64_t span = traceBegin();
+    ProcedureBatch *batch = (ProcedureBatch *)context;
+    ProcedureJob *job = &batch->jobs[index];
+    Parser worker = *batch->parser;
+    worker.current_token = job->start;
+    worker.diagnostics = &job->diagnostics;
+    worker.error_count = 0;
+    job->node = parseProcedureText(&worker);
+    job->error_count = worker.error_count;
+    job->complete = worker.current_token == job->end;
+    if (span) {
+        int tokens = 0;
+        for (TokenNode *token = job->start; token != job->end; token = token->next) tokens++;
+        job->node->as.procedure.token_count = tokens;
+        int lines = job->end->token.line - job->start->token.line;
+        traceSpanArgs(span, "parse", job->node->as.procedure.name ? job->node->as.procedure.name : "procedure",
+                      "tokens", tokens, "lines", lines);
+    }
+}
+
+// Com a lista completa de tokens, os limites dos procedimentos saem de uma varredura de
+// begin/end e os corpos são analisados em paralelo. As assinaturas e os diagnósticos entram
+// depois, na ordem do fonte; um procedimento cuja recuperação de erro saiu dos limites
+// previstos é descartado com os seguintes, que a análise em sequência refaz. Devolve o
+// último procedimento aceito
+static AstNode *parseProceduresInParallel(Parser *parser, AstNode *program) {
+    ProcedureJob *jobs = NULL;
+    int count = 0, capacity = 0;
+    for (TokenNode *token = parser->current_token; token && token->token.type == TOKEN_PROCEDURE;) {
+        TokenNode *end = procedureEnd(token);
+        if (!end) break;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            jobs = (ProcedureJob *)realloc(jobs, sizeof(ProcedureJob) * capacity);
+            if (!jobs) {
+                fprintf(stderr, "Erro de alocação de memória ao dividir os procedimentos\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        memset(&jobs[count], 0, sizeof(ProcedureJob));
+        jobs[count].start = token;
+        jobs[count].end = end;
+        initDiagnostics(&jobs[count++].diagnostics);
+        token = end;
+    }
+    if (count < PARALLEL_MIN_ITEMS) {
+        for (int i = 0; i < count; i++) freeDiagnostics(&jobs[i].diagnostics);
+        free(jobs);
+        return NULL;
+    }
+
+    ProcedureBatch batch = {parser, jobs};
+    parallelFor(count, parser->jobs, parseProcedureJob, &batch);
+
+    AstNode *tail = NULL;
+    int merged = 0;
+    for (; merged < count && jobs[merged].complete; merged++) {
+        ProcedureJob *job = &jobs[merged];
+        appendDiagnostics(parser->diagnostics, &job->diagnostics, 0);
+        parser->error_count += job->error_count;
+        declareProcedure(parser, job->node);
+        if (tail) tail->next = job->node; else program->as.program.procedures = job->node;
+        tail = job->node;
+        parser->current_token = job->end;
+    }
+    for (int i = 0; i < count; i++) {
+        if (i >= merged) freeProcedure(jobs[i].node);
+        freeDiagnostics(&jobs[i].diagnostics);
+    }
+    free(jobs);
+    return tail;
+}
+
+static void parseProcedures(Parser *parser, AstNode *program) {
+    AstNode *tail = NULL;
+    if (parser->jobs > 1 && !streaming(parser)) tail = parseProceduresInParallel(parser, program);
+    while (check(parser, TOKEN_PROCEDURE)) {
+        AstNode *proc = parseProcedure(parser);
+        if (tail) tail->next = proc; else program->as.program.procedures = proc;
+        tail = proc;
+    }
+}
+
+// unit N; interface [uses] [var] {cabeçalhos} implementation [var] {procedimentos} end.
+static bool parseUnit(Parser *parser) {
+    advance(parser);
+    AstNode *unit = newNode(parser, NODE_PROGRAM);
+    unit->as.program.unit = true;
+    if (check(parser, TOKEN_IDENTIFIER)) {
+        unit->as.program.name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
+    }
+    parser->program = unit;
+    if (!expect(parser, TOKEN_IDENTIFIER)) return false;
+    if (!expect(parser, TOKEN_SEMICOLON)) return false;
+    if (!expect(parser, TOKEN_INTERFACE)) return false;
+    if (check(parser, TOKEN_USES) && !parseUses(parser)) return false;
+
+    if (check(parser, TOKEN_VAR)) {
+        advance(parser);
+        if (!parseVariableDeclaration(parser)) return false;
+        for (Symbol *s = parser->symbol_table->head; s; s = s->next) s->exported = true;
+    }
+    while (check(parser, TOKEN_PROCEDURE)) parseProcedureHeading(parser);
+
+    if (!expect(parser, TOKEN_IMPLEMENTATION)) return false;
+    if (check(parser, TOKEN_VAR)) {
+        advance(parser);
+        if (!parseVariableDeclaration(parser)) return false;
+    }
+    parseProcedures(parser, unit);
+
+    int end_line = currentLine(parser);
+    if (!expect(parser, TOKEN_END)) return false;
+    if (!expect(parser, TOKEN_DOT)) return false;
+
+    for (Symbol *s = parser->symbol_table->head; s; s = s->next) {
+        if (!s->forward) continue;
+        reportDiagnostic(parser->diagnostics, DIAG_MISSING_BODY, end_line, 0, s->name);
+        parser->error_count++;
     }
     return true;
 }
 
-// static bool parseProgram(Parser *parser) {
-//     // Parse program header
-//     if (!expect(parser, TOKEN_PROGRAM)) return false;
-//     if (!expect(parser, TOKEN_IDENTIFIER)) return false;
-//     if (!expect(parser, TOKEN_SEMICOLON)) return false;
-//
-//     // Parse variable declarations if present
-//     if (parser->current_token && parser->current_token->token.type == TOKEN_VAR) {
-//         advance(parser);
-//         if (!parseVariableDeclaration(parser)) return false;
-//     }
-//
-//     // Parse main program block
-//     if (!expect(parser, TOKEN_BEGIN)) return false;
-//
-//     // Parse statements
-//     if (!parseStatementBlock(parser)) return false;
-//
-//     if (!expect(parser, TOKEN_END)) return false;
-//     if (!expect(parser, TOKEN_DOT)) return false;
-//
-//     return true;
-// }
+// program N; [uses] [var]
+static bool parseProgramHeading(Parser *parser) {
+    if (!expect(parser, TOKEN_PROGRAM)) return false;
+    AstNode *program = newNode(parser, NODE_PROGRAM);
+    if (check(parser, TOKEN_IDENTIFIER)) {
+        program->as.program.name = arenaStrdup(parser->arena, parser->current_token->token.lexeme);
+    }
+    parser->program = program;
+    if (!expect(parser, TOKEN_IDENTIFIER)) return false;
+    if (!expect(parser, TOKEN_SEMICOLON)) return false;
+    if (check(parser, TOKEN_USES) && !parseUses(parser)) return false;
+
+    // Parse variable declarations if present
+    if (check(parser, TOKEN_VAR)) {
+        advance(parser);
+        if (!parseVariableDeclaration(parser)) return false;
+    }
+    return true;
+}
+
+// begin statements end.
+static bool parseMainBlock(Parser *parser, AstNode *program) {
+    if (!expect(parser, TOKEN_BEGIN)) return false;
+
+    // Parse statements
+    program->as.program.body = parseStatementBlock(parser);
 
-void initParser(Parser *parser, TokenList *tokens, FILE *output_file) {
+    if (!expect(parser, TOKEN_END)) return false;
+    return expect(parser, TOKEN_DOT);
+}
+
+static bool parseProgram(Parser *parser) {
+    if (!parseProgramHeading(parser)) return false;
+
+    // Parse procedure declarations
+    parseProcedures(parser, parser->program);
+
+    // Parse main program block
+    return parseMainBlock(parser, parser->program);
+}
+
+bool parseHeaderItem(Parser *parser) {
+    return parseProgramHeading(parser) && expect(parser, TOKEN_EOF);
+}
+
+bool parseProcedureItem(Parser *parser) {
+    parser->program = newNode(parser, NODE_PROGRAM);
+    parser->program->as.program.procedures = parseProcedure(parser);
+    return expect(parser, TOKEN_EOF);
+}
+
+bool parseMainItem(Parser *parser) {
+    parser->program = newNode(parser, NODE_PROGRAM);
+    return parseMainBlock(parser, parser->program);
+}
+
+void initParser(Parser *parser, TokenList *tokens, DiagnosticBuffer *diagnostics) {
     parser->tokens = tokens;
     parser->current_token = tokens->head;
-    parser->output_file = output_file;
+    parser->lexer = NULL;
+    parser->ring = NULL;
+    initTokenList(&parser->window);
+    parser->diagnostics = diagnostics;
     parser->error_count = 0;
     parser->symbol_table = (SymbolTable *)malloc(sizeof(SymbolTable));
     initSymbolTable(parser->symbol_table);
+    parser->local_table = NULL;
+    initArena(&parser->global_arena);
+    parser->arena = &parser->global_arena;
+    parser->program = NULL;
+    parser->unit_dir = ".";
+    parser->jobs = 0;
+}
+
+// Lexer e parser intercalados: a lista completa de tokens nunca é montada
+void initStreamingParser(Parser *parser, Lexer *lexer, DiagnosticBuffer *diagnostics) {
+    initParser(parser, &parser->window, diagnostics);
+    parser->lexer = lexer;
+    lexBatch(lexer, parser->tokens, TOKEN_BATCH);
+    parser->current_token = parser->tokens->head;
+}
+
+// Lexer na sua própria thread: os tokens chegam pela fila circular
+void initPipelinedParser(Parser *parser, TokenRing *ring, DiagnosticBuffer *diagnostics) {
+    initParser(parser, &parser->window, diagnostics);
+    parser->ring = ring;
+    receiveTokens(ring, parser->tokens, TOKEN_BATCH);
+    parser->current_token = parser->tokens->head;
 }
 
-// bool parse(Parser *parser) {
-//     return parseProgram(parser);
-// }
+bool parse(Parser *parser) {
+    return check(parser, TOKEN_UNIT) ? parseUnit(parser) : parseProgram(parser);
+}
 
-void freeParser(const Parser *parser) {
+void freeParser(Parser *parser) {
+    freeTokenList(&parser->window);
+    freeProgram(parser->program);
+    freeArena(&parser->global_arena);
     freeSymbolTable(parser->symbol_table);
     free(parser->symbol_table);
 }
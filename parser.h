@@ -5,19 +5,43 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdio.h>
 #include "tokens.h"
 #include "symbol_table.h"
+#include "arena.h"
+#include "ast.h"
+#include "lexer.h"
+#include "token_ring.h"
+#include "diagnostics.h"
 
 typedef struct {
     TokenList *tokens;
     TokenNode *current_token;
-    SymbolTable *symbol_table;
-    FILE *output_file;
+    Lexer *lexer;                // Modo em fluxo: tokens produzidos sob demanda
+    TokenRing *ring;             // Modo em fluxo com o lexer noutra thread (--pipeline)
+    TokenList window;            // Modo em fluxo: tokens ainda não consumidos
+    SymbolTable *symbol_table;   // Escopo global
+    SymbolTable *local_table;    // Escopo do procedimento sendo analisado
+    Arena *arena;                // Arena onde os nós atuais são alocados
+    Arena global_arena;          // Nós do programa e do bloco principal
+    AstNode *program;            // Resultado da análise
+    const char *unit_dir;        // Onde procurar os .ppu de uses (padrão ".")
+    DiagnosticBuffer *diagnostics; // Onde os erros são anotados
+    int jobs;                    // Threads para os corpos dos procedimentos (só com a lista completa de tokens)
     int error_count;
 } Parser;
 
-void initParser(Parser *parser, TokenList *tokens, FILE *output_file);
+void initParser(Parser *parser, TokenList *tokens, DiagnosticBuffer *diagnostics);
+void initStreamingParser(Parser *parser, Lexer *lexer, DiagnosticBuffer *diagnostics);
+void initPipelinedParser(Parser *parser, TokenRing *ring, DiagnosticBuffer *diagnostics);
 bool parse(Parser *parser);
-void freeParser(const Parser *parser);
+// Análise incremental (workspace.c): cada item do fonte (cabeçalho, um procedimento ou o
+// bloco principal) é analisado sozinho. O item fica num NODE_PROGRAM sem nome, em
+// procedures ou em body; o cabeçalho só declara os símbolos globais. Como no programa
+// inteiro, o que vem depois de "end." é ignorado
+bool parseHeaderItem(Parser *parser);
+bool parseProcedureItem(Parser *parser);
+bool parseMainItem(Parser *parser);
+void freeParser(Parser *parser);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,205 @@
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "perf_counters.h"
+
+static double monotonicNow(void) {
+    struct timespec ts;
+#ifdef __linux__
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define GROUP_SIZE 3
+
+// Grupos agendados juntos pelo kernel; três eventos cabem nos contadores de qualquer PMU
+static const PerfEvent groups[][GROUP_SIZE] = {
+    {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_BRANCH_MISSES},
+    {PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_DTLB_MISSES},
+};
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static void eventAttributes(PerfEvent event, bool inherit, struct perf_event_attr *attr) {
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->inherit = inherit;
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr->type = PERF_TYPE_HARDWARE;
+    switch (event) {
+        case PERF_CYCLES: attr->config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PERF_INSTRUCTIONS: attr->config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PERF_BRANCH_MISSES: attr->config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case PERF_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D);
+            break;
+        case PERF_LLC_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL);
+            break;
+        default:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB);
+            break;
+    }
+}
+
+static int openEvent(PerfEvent event, bool inherit, int group_fd) {
+    struct perf_event_attr attr;
+    eventAttributes(event, inherit, &attr);
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+// Valores acumulados de um grupo, na ordem em que os eventos abriram. Quando o
+// kernel multiplexa os grupos, a contagem é estimada pela fração de tempo medida
+static void readGroup(const PerfCounters *perf, int g, uint64_t *totals) {
+    int leader = -1;
+    for (int i = 0; i < GROUP_SIZE && leader < 0; i++) leader = perf->fds[groups[g][i]];
+    if (leader < 0) return;
+    uint64_t buffer[3 + GROUP_SIZE];
+    if (read(leader, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+    uint64_t enabled = buffer[1], running = buffer[2];
+    double scale = running > 0 && running < enabled ? (double)enabled / (double)running : 1.0;
+    int n = 0;
+    for (int i = 0; i < GROUP_SIZE; i++) {
+        PerfEvent event = groups[g][i];
+        if (perf->fds[event] < 0 || n >= (int)buffer[0]) continue;
+        totals[event] = (uint64_t)((double)buffer[3 + n++] * scale);
+    }
+}
+
+static void readCounters(const PerfCounters *perf, uint64_t *totals) {
+    memset(totals, 0, sizeof(uint64_t) * PERF_EVENT_COUNT);
+    if (!perf->hardware) return;
+    for (int g = 0; g < (int)(sizeof(groups) / sizeof(groups[0])); g++) readGroup(perf, g, totals);
+}
+
+bool perfOpen(PerfCounters *perf) {
+    memset(perf, 0, sizeof(*perf));
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) perf->fds[e] = -1;
+    perf->inherited = true;
+    for (int g = 0; g < (int)(sizeof(groups) / sizeof(groups[0])); g++) {
+        int leader = -1;
+        for (int i = 0; i < GROUP_SIZE; i++) {
+            PerfEvent event = groups[g][i];
+            // O primeiro evento que abrir lidera o grupo; um membro recusado fica de fora
+            int fd = openEvent(event, perf->inherited, leader);
+            // Kernels antigos não aceitam inherit com PERF_FORMAT_GROUP: todos os eventos
+            // passam a contar só a thread principal, antes que algum abra com herança
+            if (fd < 0 && errno == EINVAL && perf->inherited && !perf->hardware) {
+                perf->inherited = false;
+                fd = openEvent(event, false, leader);
+            }
+            if (fd < 0) {
+                if (!perf->error) perf->error = errno;
+                continue;
+            }
+            perf->fds[event] = fd;
+            if (leader < 0) leader = fd;
+            perf->hardware = true;
+        }
+        if (leader >= 0) ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    perf->last_time = monotonicNow();
+    readCounters(perf, perf->last);
+    return perf->hardware;
+}
+
+void perfClose(PerfCounters *perf) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (perf->fds[e] >= 0) close(perf->fds[e]);
+        perf->fds[e] = -1;
+    }
+    perf->hardware = false;
+}
+
+#else
+
+// Sem perf_event_open: apenas os tempos de cada fase
+static void readCounters(const PerfCounters *perf, uint64_t *totals) {
+    (void)perf;
+    memset(totals, 0, sizeof(uint64_t) * PERF_EVENT_COUNT);
+}
+
+bool perfOpen(PerfCounters *perf) {
+    memset(perf, 0, sizeof(*perf));
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) perf->fds[e] = -1;
+    perf->error = ENOSYS;
+    perf->last_time = monotonicNow();
+    return false;
+}
+
+void perfClose(PerfCounters *perf) {
+    (void)perf;
+}
+
+#endif
+
+void perfPhase(PerfCounters *perf, const char *name) {
+    if (!perf) return;
+    // Fases além do limite somam na última
+    PerfPhase *phase = perf->phase_count < PERF_MAX_PHASES ? &perf->phases[perf->phase_count++]
+                                                           : &perf->phases[PERF_MAX_PHASES - 1];
+    uint64_t totals[PERF_EVENT_COUNT];
+    readCounters(perf, totals);
+    double time = monotonicNow();
+    phase->name = name;
+    phase->seconds += time - perf->last_time;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        phase->values[e] += totals[e] >= perf->last[e] ? totals[e] - perf->last[e] : 0;
+        perf->last[e] = totals[e];
+    }
+    perf->last_time = time;
+}
+
+// Faltas por mil instruções, ou "-" quando o evento não está disponível
+static void printRate(const PerfCounters *perf, const PerfPhase *phase, PerfEvent event, FILE *out) {
+    uint64_t instructions = phase->values[PERF_INSTRUCTIONS];
+    if (perf->fds[event] < 0 || perf->fds[PERF_INSTRUCTIONS] < 0 || instructions == 0) {
+        fprintf(out, "  %9s", "-");
+    } else {
+        fprintf(out, "  %9.2f", 1000.0 * (double)phase->values[event] / (double)instructions);
+    }
+}
+
+void perfReport(const PerfCounters *perf, FILE *out) {
+    if (!perf->hardware) {
+        fprintf(out, "perf: hardware counters unavailable (%s); timers only\n",
+                perf->error ? strerror(perf->error) : "no events");
+        fprintf(out, "  %-16s %10s\n", "phase", "ms");
+        for (int i = 0; i < perf->phase_count; i++) {
+            fprintf(out, "  %-16s %10.3f\n", perf->phases[i].name, perf->phases[i].seconds * 1e3);
+        }
+        return;
+    }
+    fprintf(out, "perf: hardware counters per phase, %s (misses per 1000 instructions)\n",
+            perf->inherited ? "worker threads included" : "main thread only");
+    fprintf(out, "  %-16s %10s %14s %14s %6s  %9s  %9s  %9s  %9s\n", "phase", "ms", "cycles", "instructions",
+            "IPC", "br-miss", "L1D", "LLC", "dTLB");
+    for (int i = 0; i < perf->phase_count; i++) {
+        const PerfPhase *phase = &perf->phases[i];
+        uint64_t cycles = phase->values[PERF_CYCLES], instructions = phase->values[PERF_INSTRUCTIONS];
+        fprintf(out, "  %-16s %10.3f %14llu %14llu", phase->name, phase->seconds * 1e3,
+                (unsigned long long)cycles, (unsigned long long)instructions);
+        if (cycles > 0 && perf->fds[PERF_INSTRUCTIONS] >= 0) fprintf(out, " %6.2f", (double)instructions / (double)cycles);
+        else fprintf(out, " %6s", "-");
+        printRate(perf, phase, PERF_BRANCH_MISSES, out);
+        printRate(perf, phase, PERF_L1D_MISSES, out);
+        printRate(perf, phase, PERF_LLC_MISSES, out);
+        printRate(perf, phase, PERF_DTLB_MISSES, out);
+        fputc('\n', out);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Contadores de hardware por fase do compilador (--perf). Dois grupos de
+// perf_event_open: ciclos, instruções e desvios mal previstos; faltas na L1D, na
+// LLC e na dTLB. Cada fase guarda a diferença dos contadores entre duas fronteiras.
+// Os contadores são herdados pelas threads criadas depois de perfOpen (-j, --build,
+// --pipeline); o kernel soma a contagem de uma thread quando ela termina, então ela
+// entra na fase em que foi esperada. Kernels que recusam herança em grupo contam só
+// a thread principal, e o relatório avisa.
+// Sem permissão do kernel (ou fora do Linux), só os tempos são registrados.
+#define PERF_MAX_PHASES 32
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+} PerfEvent;
+
+typedef struct {
+    const char *name;
+    double seconds;
+    uint64_t values[PERF_EVENT_COUNT];
+} PerfPhase;
+
+typedef struct {
+    int fds[PERF_EVENT_COUNT];        // -1 quando o evento não abriu
+    bool hardware;                    // Algum contador abriu; false = apenas tempos
+    bool inherited;                   // Os contadores incluem as threads de trabalho
+    int error;                        // errno da primeira falha, para o relatório
+    double last_time;
+    uint64_t last[PERF_EVENT_COUNT];
+    PerfPhase phases[PERF_MAX_PHASES];
+    int phase_count;
+} PerfCounters;
+
+// Abre os grupos e começa a contar; retorna se há contadores de hardware
+bool perfOpen(PerfCounters *perf);
+// Fecha a fase em curso com o nome dado; perf NULL não faz nada
+void perfPhase(PerfCounters *perf, const char *name);
+// Tabela por fase: tempo, IPC e faltas por mil instruções
+void perfReport(const PerfCounters *perf, FILE *out);
+void perfClose(PerfCounters *perf);
+
+#endif
@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+#ifdef HAVE_PROFILER
+#include <sys/time.h>
+#endif
+
+#define PROFILE_TOP 20        // Linhas listadas no relatório
+
+volatile sig_atomic_t profile_pending;
+
+static void *checkedCalloc(size_t count, size_t size) {
+    void *memory = calloc(count ? count : 1, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória no perfil de execução\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+void initProfile(Profile *profile, const BytecodeProgram *program, int interval) {
+    memset(profile, 0, sizeof(*profile));
+    profile->program = program;
+    profile->interval = interval > 0 ? interval : PROFILE_DEFAULT_INTERVAL;
+    profile->hits = checkedCalloc(program->function_count, sizeof(uint64_t *));
+    for (int i = 0; i < program->function_count; i++) {
+        profile->hits[i] = checkedCalloc(program->functions[i].count + 1, sizeof(uint64_t));
+    }
+    profile->calls = checkedCalloc(program->function_count, sizeof(uint64_t));
+    // Tudo que o tratador de sinal usa já existe antes da primeira amostra
+    profile->stacks = checkedCalloc((size_t)PROFILE_MAX_STACKS * PROFILE_MAX_DEPTH, sizeof(int));
+    profile->leaf_pcs = checkedCalloc(PROFILE_MAX_STACKS, sizeof(int));
+    profile->depths = checkedCalloc(PROFILE_MAX_STACKS, sizeof(uint8_t));
+}
+
+void freeProfile(Profile *profile) {
+    for (int i = 0; profile->hits && i < profile->program->function_count; i++) {
+        free(profile->hits[i]);
+    }
+    free(profile->hits);
+    free(profile->calls);
+    free(profile->stacks);
+    free(profile->leaf_pcs);
+    free(profile->depths);
+    memset(profile, 0, sizeof(*profile));
+}
+
+#ifdef HAVE_PROFILER
+static void markPending(int signal, siginfo_t *info, void *context) {
+    (void)signal;
+    (void)info;
+    (void)context;
+    profile_pending = 1;
+}
+
+bool startProfile(Profile *profile, void (*handler)(int, siginfo_t *, void *)) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handler ? handler : markPending;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    profile_pending = 0;
+    if (sigaction(SIGPROF, &action, NULL) != 0) {
+        perror("sigaction");
+        return false;
+    }
+    struct itimerval timer;
+    timer.it_interval.tv_sec = profile->interval / 1000000;
+    timer.it_interval.tv_usec = profile->interval % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        perror("setitimer");
+        return false;
+    }
+    return true;
+}
+
+void stopProfile(void) {
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    signal(SIGPROF, SIG_IGN);
+    profile_pending = 0;
+}
+#else
+bool startProfile(Profile *profile, void (*handler)(int, ProfileSignalInfo *, void *)) {
+    (void)profile;
+    (void)handler;
+    fprintf(stderr, "profile: sampling profiler unavailable on this platform\n");
+    return false;
+}
+
+void stopProfile(void) {
+    profile_pending = 0;
+}
+#endif
+
+void recordSample(Profile *profile, const int *stack, int depth, int function, int pc) {
+    profile->samples++;
+    if (function < 0) {
+        profile->outside++;
+        return;
+    }
+    const Function *f = &profile->program->functions[function];
+    profile->hits[function][pc >= 0 && pc < f->count ? pc : f->count]++;
+    if (profile->stack_count == PROFILE_MAX_STACKS) {
+        profile->dropped++;
+        return;
+    }
+    // Pilhas mais fundas que o limite perdem os chamadores mais externos
+    int skip = depth + 1 > PROFILE_MAX_DEPTH ? depth + 1 - PROFILE_MAX_DEPTH : 0;
+    int *slot = &profile->stacks[(size_t)profile->stack_count * PROFILE_MAX_DEPTH];
+    int n = 0;
+    for (int i = skip; i < depth; i++) slot[n++] = stack[i];
+    slot[n++] = function;
+    profile->leaf_pcs[profile->stack_count] = pc;
+    profile->depths[profile->stack_count++] = (uint8_t)n;
+}
+
+// Uma linha do relatório: statement de origem dentro de um procedimento
+typedef struct {
+    int function;
+    int line;
+    int column;
+    uint64_t samples;
+} HotLine;
+
+static int compareHotLines(const void *a, const void *b) {
+    const HotLine *x = a, *y = b;
+    if (x->samples != y->samples) return x->samples < y->samples ? 1 : -1;
+    if (x->line != y->line) return x->line - y->line;
+    return x->column - y->column;
+}
+
+static int compareCalls(const void *a, const void *b) {
+    const uint64_t *x = *(const uint64_t *const *)a, *y = *(const uint64_t *const *)b;
+    return *x < *y ? 1 : *x > *y ? -1 : 0;
+}
+
+void printProfile(const Profile *profile, FILE *out) {
+    const BytecodeProgram *program = profile->program;
+    size_t capacity = 0;
+    for (int i = 0; i < program->function_count; i++) capacity += (size_t)program->functions[i].count + 1;
+    HotLine *lines = checkedCalloc(capacity, sizeof(HotLine));
+    size_t count = 0;
+
+    // As instruções de um mesmo statement somam as amostras na mesma linha do relatório
+    for (int i = 0; i < program->function_count; i++) {
+        const Function *f = &program->functions[i];
+        size_t first = count;
+        for (int pc = 0; pc <= f->count; pc++) {
+            uint64_t n = profile->hits[i][pc];
+            if (n == 0) continue;
+            int line = pc < f->count ? f->lines[pc] : 0;
+            int column = pc < f->count ? f->columns[pc] : 0;
+            size_t j = first;
+            while (j < count && (lines[j].line != line || lines[j].column != column)) j++;
+            if (j == count) lines[count++] = (HotLine){i, line, column, 0};
+            lines[j].samples += n;
+        }
+    }
+    qsort(lines, count, sizeof(HotLine), compareHotLines);
+
+    double total = profile->samples ? (double)profile->samples : 1.0;
+    fprintf(out, "profile: %llu samples every %d us, %llu outside compiled code\n",
+            (unsigned long long)profile->samples, profile->interval, (unsigned long long)profile->outside);
+    fprintf(out, "  %10s  %6s  %-12s  %s\n", "samples", "%", "line:col", "procedure");
+    for (size_t i = 0; i < count && i < PROFILE_TOP; i++) {
+        char position[32];
+        if (lines[i].line <= 0) snprintf(position, sizeof(position), "(entry/exit)");
+        else if (lines[i].column <= 0) snprintf(position, sizeof(position), "%d", lines[i].line);
+        else snprintf(position, sizeof(position), "%d:%d", lines[i].line, lines[i].column);
+        fprintf(out, "  %10llu  %5.1f%%  %-12s  %s\n", (unsigned long long)lines[i].samples,
+                100.0 * (double)lines[i].samples / total, position, program->functions[lines[i].function].name);
+    }
+    free(lines);
+
+    const uint64_t **calls = checkedCalloc(program->function_count, sizeof(uint64_t *));
+    int called = 0;
+    for (int i = 0; i < program->function_count; i++) {
+        if (profile->calls[i] > 0) calls[called++] = &profile->calls[i];
+    }
+    qsort(calls, called, sizeof(uint64_t *), compareCalls);
+    if (called > 0) fprintf(out, "profile: calls per procedure\n");
+    for (int i = 0; i < called; i++) {
+        fprintf(out, "  %12llu  %s\n", (unsigned long long)*calls[i],
+                program->functions[calls[i] - profile->calls].name);
+    }
+    free(calls);
+    if (profile->dropped > 0) {
+        fprintf(out, "profile: %llu stack(s) beyond the first %d not kept for the folded output\n",
+                (unsigned long long)profile->dropped, PROFILE_MAX_STACKS);
+    }
+}
+
+static int compareStrings(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Formato folded: "main;externo;atual:linha contagem", uma pilha distinta por linha
+bool writeFoldedStacks(const Profile *profile, const char *path) {
+    const BytecodeProgram *program = profile->program;
+    char **stacks = checkedCalloc(profile->stack_count, sizeof(char *));
+    for (int s = 0; s < profile->stack_count; s++) {
+        const int *frames = &profile->stacks[(size_t)s * PROFILE_MAX_DEPTH];
+        int depth = profile->depths[s];
+        const Function *leaf = &program->functions[frames[depth - 1]];
+        int pc = profile->leaf_pcs[s];
+        size_t length = 16;
+        for (int d = 0; d < depth; d++) length += strlen(program->functions[frames[d]].name) + 1;
+        char *text = checkedCalloc(length, 1);
+        size_t used = 0;
+        for (int d = 0; d < depth; d++) {
+            used += (size_t)snprintf(text + used, length - used, "%s%s", d > 0 ? ";" : "",
+                                     program->functions[frames[d]].name);
+        }
+        if (pc >= 0 && pc < leaf->count && leaf->lines[pc] > 0) {
+            snprintf(text + used, length - used, ":%d", leaf->lines[pc]);
+        }
+        stacks[s] = text;
+    }
+    qsort(stacks, profile->stack_count, sizeof(char *), compareStrings);
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror("Error opening profile output file");
+    } else {
+        for (int s = 0; s < profile->stack_count;) {
+            int next = s + 1;
+            while (next < profile->stack_count && strcmp(stacks[next], stacks[s]) == 0) next++;
+            fprintf(file, "%s %d\n", stacks[s], next - s);
+            s = next;
+        }
+        if (profile->outside > 0) fprintf(file, "[runtime] %llu\n", (unsigned long long)profile->outside);
+    }
+    for (int s = 0; s < profile->stack_count; s++) free(stacks[s]);
+    free(stacks);
+    return file && fclose(file) == 0;
+}
@@ -0,0 +1,58 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include "bytecode.h"
+
+// Perfil por amostragem (--profile): um temporizador SIGPROF interrompe a execução
+// a cada intervalo de tempo de CPU, e cada amostra é atribuída à instrução de bytecode
+// em execução, que leva à linha e à coluna do statement de origem
+#define PROFILE_DEFAULT_INTERVAL 1000   // Microssegundos
+#define PROFILE_MAX_DEPTH 32            // Procedimentos guardados por pilha amostrada
+#define PROFILE_MAX_STACKS (1 << 16)    // Pilhas guardadas para o arquivo de flame graph
+
+// SIGPROF, setitimer e siginfo_t são POSIX; sem eles startProfile só informa que não há perfil
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_PROFILER 1
+typedef siginfo_t ProfileSignalInfo;
+#else
+typedef void ProfileSignalInfo;
+#endif
+
+typedef struct {
+    const BytecodeProgram *program;
+    int interval;
+    uint64_t **hits;          // hits[função][pc]; a posição count recebe prólogo e epílogo nativos
+    uint64_t *calls;          // Chamadas executadas de cada procedimento
+    uint64_t samples;
+    uint64_t outside;         // Amostras fora do código do programa (runtime, biblioteca C)
+    int *stacks;              // PROFILE_MAX_DEPTH funções por pilha, da mais externa para a atual
+    int *leaf_pcs;            // Instrução da função atual em cada pilha
+    uint8_t *depths;
+    int stack_count;
+    uint64_t dropped;         // Pilhas que não couberam; continuam contadas em hits
+} Profile;
+
+// Sinalizada pelo tratador padrão; a máquina virtual a consulta entre despachos
+extern volatile sig_atomic_t profile_pending;
+
+void initProfile(Profile *profile, const BytecodeProgram *program, int interval);
+void freeProfile(Profile *profile);
+
+// handler NULL apenas marca profile_pending; outro tratador registra a amostra ele mesmo
+bool startProfile(Profile *profile, void (*handler)(int, ProfileSignalInfo *, void *));
+void stopProfile(void);
+
+// Registra uma amostra; seguro dentro de um tratador de sinal (não aloca nada).
+// stack traz as funções chamadoras, da mais externa para a mais interna; pc negativo
+// indica um ponto fora de qualquer instrução (prólogo ou epílogo do código nativo)
+void recordSample(Profile *profile, const int *stack, int depth, int function, int pc);
+
+// Linhas mais quentes e chamadas por procedimento; pilhas no formato folded do flamegraph.pl
+void printProfile(const Profile *profile, FILE *out);
+bool writeFoldedStacks(const Profile *profile, const char *path);
+
+#endif
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "query.h"
+#include "trace.h"
+
+static void *checkedRealloc(void *memory, size_t size) {
+    void *result = realloc(memory, size);
+    if (!result) {
+        fprintf(stderr, "Erro de alocação de memória nas consultas\n");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+void initQueryDb(QueryDb *db) {
+    db->revision = 1;
+    db->stack = NULL;
+    db->depth = 0;
+    db->stack_capacity = 0;
+    db->stats = (QueryStats){0, 0, 0};
+}
+
+void freeQueryDb(QueryDb *db) {
+    free(db->stack);
+    db->stack = NULL;
+    db->stack_capacity = 0;
+}
+
+void initQuery(Query *query, const QueryKind *kind, void *key) {
+    *query = (Query){.kind = kind, .key = key};
+}
+
+void freeQuery(Query *query) {
+    if (query->computed && query->kind && query->kind->discard) query->kind->discard(query);
+    free(query->deps);
+    query->deps = NULL;
+    query->dep_count = query->dep_capacity = 0;
+    query->computed = false;
+}
+
+void querySet(QueryDb *db, Query *input, uint64_t hash) {
+    if (input->computed && input->hash == hash) return;
+    db->revision++;
+    input->hash = hash;
+    input->computed = true;
+    input->verified_at = input->changed_at = db->revision;
+}
+
+static void addDependency(Query *query, Query *dep) {
+    // Consultas lidas várias vezes seguidas entram uma vez
+    if (query->dep_count > 0 && query->deps[query->dep_count - 1] == dep) return;
+    if (query->dep_count == query->dep_capacity) {
+        query->dep_capacity = query->dep_capacity ? query->dep_capacity * 2 : 4;
+        query->deps = checkedRealloc(query->deps, sizeof(Query *) * query->dep_capacity);
+    }
+    query->deps[query->dep_count++] = dep;
+}
+
+static void execute(QueryDb *db, Query *query) {
+    if (query->computed && query->kind->discard) query->kind->discard(query);
+    if (db->depth == db->stack_capacity) {
+        db->stack_capacity = db->stack_capacity ? db->stack_capacity * 2 : 8;
+        db->stack = checkedRealloc(db->stack, sizeof(Query *) * db->stack_capacity);
+    }
+    db->stack[db->depth++] = query;
+    query->active = true;
+    query->dep_count = 0;
+    uint64_t start = traceBegin();
+    uint64_t hash = query->kind->compute(db, query);
+    traceSpan(start, "query", query->kind->name, NULL, -1);
+    query->active = false;
+    db->depth--;
+
+    db->stats.executed++;
+    if (query->computed && hash == query->hash) {
+        db->stats.unchanged++;      // Quem depende do valor continua válido
+    } else {
+        query->changed_at = db->revision;
+    }
+    query->hash = hash;
+    query->computed = true;
+    query->verified_at = db->revision;
+}
+
+static void refresh(QueryDb *db, Query *query);
+
+// As dependências são conferidas na ordem em que foram lidas: a primeira que mudou
+// encerra a conferência, e as seguintes (que o novo cálculo talvez nem leia) ficam
+// sem ser tocadas
+static bool dependenciesUnchanged(QueryDb *db, const Query *query) {
+    for (int i = 0; i < query->dep_count; i++) {
+        Query *dep = query->deps[i];
+        refresh(db, dep);
+        if (dep->changed_at > query->verified_at) return false;
+    }
+    return true;
+}
+
+static void refresh(QueryDb *db, Query *query) {
+    if (!query->kind || (query->computed && query->verified_at == db->revision)) return;
+    if (query->active) {
+        fprintf(stderr, "Erro: ciclo entre consultas (%s)\n", query->kind->name);
+        exit(EXIT_FAILURE);
+    }
+    if (query->computed && dependenciesUnchanged(db, query)) {
+        query->verified_at = db->revision;
+        db->stats.reused++;
+        return;
+    }
+    execute(db, query);
+}
+
+void *queryGet(QueryDb *db, Query *query) {
+    refresh(db, query);
+    if (db->depth > 0) addDependency(db->stack[db->depth - 1], query);
+    return query->value;
+}
@@ -0,0 +1,63 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Consultas memorizadas da análise incremental. Cada consulta guarda o valor calculado,
+// as consultas que leu para calculá-lo e duas revisões: a última em que o valor foi
+// conferido e a última em que ele mudou. Alterar uma entrada avança a revisão do banco;
+// pedida de novo, uma consulta confere as dependências na ordem em que as leu e só é
+// recalculada se alguma mudou depois da última conferência. Um valor recalculado com o
+// mesmo hash do anterior mantém a revisão antiga, e quem depende dele não é recalculado.
+
+typedef struct Query Query;
+typedef struct QueryDb QueryDb;
+
+typedef struct {
+    const char *name;
+    // Calcula query->value e devolve o hash dele; as consultas lidas com queryGet
+    // viram dependências
+    uint64_t (*compute)(QueryDb *db, Query *query);
+    void (*discard)(Query *query);   // Libera query->value
+} QueryKind;
+
+struct Query {
+    const QueryKind *kind;    // NULL: entrada, alterada só por querySet
+    void *key;                // O que a consulta analisa (um item do fonte, o workspace)
+    void *value;
+    uint64_t hash;
+    uint64_t verified_at;     // Revisão da última conferência
+    uint64_t changed_at;      // Revisão da última mudança do valor
+    Query **deps;
+    int dep_count;
+    int dep_capacity;
+    bool computed;
+    bool active;              // Em cálculo: pedir a consulta de novo seria um ciclo
+};
+
+typedef struct {
+    int executed;             // Consultas calculadas
+    int unchanged;            // Calculadas de novo com o mesmo valor
+    int reused;               // Conferidas sem recálculo
+} QueryStats;
+
+struct QueryDb {
+    uint64_t revision;
+    Query **stack;            // Consultas em cálculo; a do topo recebe as dependências
+    int depth;
+    int stack_capacity;
+    QueryStats stats;
+};
+
+void initQueryDb(QueryDb *db);
+void freeQueryDb(QueryDb *db);
+void initQuery(Query *query, const QueryKind *kind, void *key);
+void freeQuery(Query *query);
+
+// Entrada com valor novo; um hash igual ao atual não muda nada
+void querySet(QueryDb *db, Query *input, uint64_t hash);
+// Valor atualizado da consulta, registrada como dependência da consulta em cálculo
+void *queryGet(QueryDb *db, Query *query);
+
+#endif
@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "runtime.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define HAVE_POSIX_IO 1
+#endif
+
+// Entrada e saída com buffers próprios: writeln e read não passam por printf/scanf.
+// A saída acumula em out_buffer e só é gravada quando enche, no fim do programa ou,
+// com stdout num terminal, a cada fim de linha. A entrada é lida em blocos e os
+// números são convertidos direto do buffer.
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+#define INPUT_BUFFER_SIZE (1 << 16)
+#define REAL_TEXT_SIZE 512            // Texto de um real lido, na pilha; mais longo vai para o heap
+
+static char out_buffer[OUTPUT_BUFFER_SIZE];
+static size_t out_length;
+static bool out_ready;
+static bool out_line_buffered;
+
+static char in_buffer[INPUT_BUFFER_SIZE];
+static size_t in_position, in_length;
+static bool in_eof;
+
+static void writeAll(const char *data, size_t size) {
+#ifdef HAVE_POSIX_IO
+    while (size > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        // O perfilador (--profile) interrompe a execução com SIGPROF
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+        data += written;
+        size -= (size_t)written;
+    }
+#else
+    fwrite(data, 1, size, stdout);
+    fflush(stdout);
+#endif
+}
+
+void pas_flush(void) {
+    if (out_length == 0) return;
+    writeAll(out_buffer, out_length);
+    out_length = 0;
+}
+
+// Primeira escrita: o que o próprio compilador deixou no stdio sai antes, e o buffer
+// é esvaziado na saída do programa
+static void initOutput(void) {
+    out_ready = true;
+    fflush(stdout);
+#ifdef HAVE_POSIX_IO
+    out_line_buffered = isatty(STDOUT_FILENO);
+#endif
+    atexit(pas_flush);
+}
+
+static void writeBytes(const char *data, size_t size) {
+    if (!out_ready) initOutput();
+    if (out_length + size > OUTPUT_BUFFER_SIZE) {
+        pas_flush();
+        if (size > OUTPUT_BUFFER_SIZE) {
+            writeAll(data, size);
+            return;
+        }
+    }
+    memcpy(out_buffer + out_length, data, size);
+    out_length += size;
+}
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Dígitos decimais de value, gravados do fim de end para trás; retorna o início
+static char *formatUnsigned(uint64_t value, char *end) {
+    char *p = end;
+    while (value >= 100) {
+        p -= 2;
+        memcpy(p, digit_pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return p;
+}
+
+void pas_write_integer(int64_t value) {
+    char text[24];
+    char *end = text + sizeof(text);
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    char *p = formatUnsigned(magnitude, end);
+    if (value < 0) *--p = '-';
+    writeBytes(p, (size_t)(end - p));
+}
+
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static bool nearTie(double value) {
+    return value > 0.5 - 1e-6 && value < 0.5 + 1e-6;
+}
+
+// Seis algarismos significativos de value > 0 (como %g): scaled = value * 10^(5 - exponent)
+// com um único arredondamento. Retorna false quando o caso exige o printf: número
+// subnormal, potência de dez inexata ou resultado perto demais de um empate entre
+// dois arredondamentos. A biblioteca não depende de libm
+static bool sixDigits(double value, uint32_t *digits, int *exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int binary_exponent = (int)((bits >> 52) & 0x7ff);
+    if (binary_exponent == 0 || binary_exponent == 0x7ff) return false;
+    // log10(2) ~ 78913 / 2^18; a estimativa erra por no máximo um
+    int e = ((binary_exponent - 1023) * 78913) >> 18;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        int p = 5 - e;
+        if (p < -22 || p > 22) return false;
+        double scaled = p >= 0 ? value * powers_of_ten[p] : value / powers_of_ten[-p];
+        if (nearTie(scaled - 99999.0)) return false;
+        if (scaled < 99999.5) {
+            e--;
+            continue;
+        }
+        if (scaled >= 1000000.0) {
+            e++;
+            continue;
+        }
+        uint32_t n = (uint32_t)scaled;
+        double fraction = scaled - n;
+        if (nearTie(fraction)) return false;
+        n += fraction > 0.5;
+        if (n >= 1000000) {
+            n = 100000;
+            e++;
+        }
+        *digits = n;
+        *exponent = e;
+        return true;
+    }
+    return false;
+}
+
+void pas_write_real(double value) {
+    uint32_t digits;
+    int exponent;
+    if (value == 0 || value != value || !sixDigits(value < 0 ? -value : value, &digits, &exponent)) {
+        char text[32];
+        int length = snprintf(text, sizeof(text), "%g", value);
+        writeBytes(text, (size_t)length);
+        return;
+    }
+    char significant[8];
+    formatUnsigned(digits, significant + 6);
+    int count = 6;
+    while (count > 1 && significant[count - 1] == '0') count--;
+
+    char text[32];
+    char *p = text;
+    if (value < 0) *p++ = '-';
+    if (exponent < -4 || exponent >= 6) {
+        *p++ = significant[0];
+        if (count > 1) {
+            *p++ = '.';
+            memcpy(p, significant + 1, (size_t)count - 1);
+            p += count - 1;
+        }
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        int magnitude = exponent < 0 ? -exponent : exponent;
+        char exponent_text[8];
+        char *exponent_end = exponent_text + sizeof(exponent_text);
+        char *start = formatUnsigned((uint64_t)magnitude, exponent_end);
+        if (magnitude < 10) *p++ = '0';
+        memcpy(p, start, (size_t)(exponent_end - start));
+        p += exponent_end - start;
+    } else if (exponent >= 0) {
+        // Parte inteira com exponent + 1 algarismos, completada com zeros
+        for (int i = 0; i <= exponent; i++) *p++ = i < count ? significant[i] : '0';
+        if (count > exponent + 1) {
+            *p++ = '.';
+            memcpy(p, significant + exponent + 1, (size_t)(count - exponent - 1));
+            p += count - exponent - 1;
+        }
+    } else {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > exponent; i--) *p++ = '0';
+        memcpy(p, significant, (size_t)count);
+        p += count;
+    }
+    writeBytes(text, (size_t)(p - text));
+}
+
+void pas_write_boolean(int64_t value) {
+    if (value) writeBytes("TRUE", 4);
+    else writeBytes("FALSE", 5);
+}
+
+void pas_write_string(const char *text) {
+    writeBytes(text, strlen(text));
+}
+
+void pas_writeln(void) {
+    writeBytes("\n", 1);
+    if (out_line_buffered) pas_flush();
+}
+
+// Próximo caractere da entrada sem consumi-lo; EOF no fim. Antes de bloquear na
+// leitura a saída pendente é gravada, para que perguntas apareçam antes da resposta
+static int peekInput(void) {
+    if (in_position < in_length) return (unsigned char)in_buffer[in_position];
+    if (in_eof) return EOF;
+    pas_flush();
+    fflush(stdout);
+#ifdef HAVE_POSIX_IO
+    ssize_t count;
+    do {
+        count = read(STDIN_FILENO, in_buffer, sizeof(in_buffer));
+    } while (count < 0 && errno == EINTR);
+#else
+    size_t count = fread(in_buffer, 1, sizeof(in_buffer), stdin);
+#endif
+    if (count <= 0) {
+        in_eof = true;
+        return EOF;
+    }
+    in_position = 0;
+    in_length = (size_t)count;
+    return (unsigned char)in_buffer[0];
+}
+
+static void skipInputSpaces(void) {
+    for (int c = peekInput(); c == ' ' || (c >= '\t' && c <= '\r'); c = peekInput()) in_position++;
+}
+
+static bool isDigit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+// Como scanf("%" SCNd64): espaços, sinal opcional e dígitos; o valor satura nos
+// limites de int64_t, como strtoll
+int64_t pas_read_integer(void) {
+    skipInputSpaces();
+    bool negative = false;
+    int c = peekInput();
+    if (c == '+' || c == '-') {
+        negative = c == '-';
+        in_position++;
+        c = peekInput();
+    }
+    if (!isDigit(c)) pas_runtime_error("invalid integer input");
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t value = 0;
+    for (; isDigit(c); c = peekInput()) {
+        unsigned digit = (unsigned)(c - '0');
+        value = value > (limit - digit) / 10 ? limit : value * 10 + digit;
+        in_position++;
+    }
+    return negative ? (int64_t)(0 - value) : (int64_t)value;
+}
+
+// Texto de um real como lido da entrada, para fastReal ou strtod; começa no vetor
+// small e passa para o heap quando a entrada tem mais dígitos que ele
+typedef struct {
+    char *text;
+    size_t length;
+    size_t capacity;
+    char small[REAL_TEXT_SIZE];
+} RealText;
+
+static void appendReal(RealText *real, char c) {
+    if (real->length + 1 == real->capacity) {
+        size_t capacity = real->capacity * 2;
+        char *text = real->text == real->small ? malloc(capacity) : realloc(real->text, capacity);
+        if (!text) pas_runtime_error("out of memory reading a real");
+        if (real->text == real->small) memcpy(text, real->small, real->length);
+        real->text = text;
+        real->capacity = capacity;
+    }
+    real->text[real->length++] = c;
+}
+
+// Consome a sequência de dígitos e devolve quantos havia; com skip_zeros os zeros à
+// esquerda não são guardados (não mudam o valor e podem ser milhares)
+static size_t appendDigits(RealText *real, bool skip_zeros) {
+    size_t count = 0;
+    for (int c = peekInput(); isDigit(c); c = peekInput(), count++) {
+        if (!skip_zeros || c != '0') {
+            appendReal(real, (char)c);
+            skip_zeros = false;
+        }
+        in_position++;
+    }
+    return count;
+}
+
+// m * 10^e exato quando m e 10^|e| são representáveis (caminho rápido de Clinger)
+static bool fastReal(const char *text, double *value) {
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    const char *p = text;
+    bool negative = *p == '-';
+    if (*p == '+' || *p == '-') p++;
+    for (; isDigit(*p) || *p == '.'; p++) {
+        if (*p == '.') {
+            exponent = -(int)strspn(p + 1, "0123456789");
+            continue;
+        }
+        if (mantissa || *p != '0') digits++;
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    }
+    if (*p == 'e' || *p == 'E') {
+        long written = strtol(p + 1, NULL, 10);
+        // Muito além de ±22 o caminho rápido não serve; o limite evita estourar o int
+        if (written < -100000 || written > 100000) return false;
+        exponent += (int)written;
+    }
+    if (digits > 15 || exponent < -22 || exponent > 22) return false;
+    double magnitude = exponent >= 0 ? (double)mantissa * powers_of_ten[exponent]
+                                     : (double)mantissa / powers_of_ten[-exponent];
+    *value = negative ? -magnitude : magnitude;
+    return true;
+}
+
+// Como scanf("%lf") para a notação decimal: sinal, dígitos, fração e expoente
+double pas_read_real(void) {
+    RealText real;
+    real.text = real.small;
+    real.length = 0;
+    real.capacity = sizeof(real.small);
+    skipInputSpaces();
+    int c = peekInput();
+    if (c == '+' || c == '-') {
+        appendReal(&real, (char)c);
+        in_position++;
+    }
+    size_t sign = real.length;
+    size_t digits = appendDigits(&real, true);
+    if (digits > 0 && real.length == sign) appendReal(&real, '0');
+    if (peekInput() == '.') {
+        appendReal(&real, '.');
+        in_position++;
+        digits += appendDigits(&real, false);
+    }
+    if (digits == 0) pas_runtime_error("invalid real input");
+    c = peekInput();
+    if (c == 'e' || c == 'E') {
+        appendReal(&real, (char)c);
+        in_position++;
+        c = peekInput();
+        if (c == '+' || c == '-') {
+            appendReal(&real, (char)c);
+            in_position++;
+        }
+        // Um expoente só de zeros fica vazio no texto: "0" o mantém válido para strtod
+        if (appendDigits(&real, true) == 0) pas_runtime_error("invalid real input");
+        if (!isDigit(real.text[real.length - 1])) appendReal(&real, '0');
+    }
+    appendReal(&real, '\0');
+    double value;
+    if (!fastReal(real.text, &value)) value = strtod(real.text, NULL);
+    if (real.text != real.small) free(real.text);
+    return value;
+}
+
+void pas_runtime_error(const char *message) {
+    pas_flush();
+    fflush(stdout);
+    fprintf(stderr, "Runtime Error: %s\n", message);
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,18 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <stdint.h>
+
+// Biblioteca de execução usada pelos programas compilados (writeln/read)
+void pas_write_integer(int64_t value);
+void pas_write_real(double value);
+void pas_write_boolean(int64_t value);
+void pas_write_string(const char *text);
+void pas_writeln(void);
+int64_t pas_read_integer(void);
+double pas_read_real(void);
+void pas_runtime_error(const char *message);
+// Grava a saída pendente; também é chamada na saída do programa
+void pas_flush(void);
+
+#endif
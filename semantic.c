@@ -0,0 +1,518 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "semantic.h"
+#include "parallel.h"
+#include "trace.h"
+
+static void analyzeStatement(SemanticContext *ctx, AstNode *node);
+
+static void semanticError(SemanticContext *ctx, const AstNode *node, DiagnosticCode code, const char *detail) {
+    reportDiagnostic(ctx->diagnostics, code, node->line, node->column, detail);
+    ctx->error_count++;
+}
+
+// Procura primeiro no escopo local e depois no global
+static Symbol *lookup(const SemanticContext *ctx, const char *name) {
+    Symbol *symbol = ctx->locals ? findSymbol(ctx->locals, name) : NULL;
+    return symbol ? symbol : findSymbol(ctx->globals, name);
+}
+
+static bool isNumeric(DataType type) {
+    return type == TYPE_INTEGER || type == TYPE_REAL;
+}
+
+static bool isLiteral(const AstNode *node) {
+    return node->kind == NODE_INT_LITERAL || node->kind == NODE_REAL_LITERAL ||
+           node->kind == NODE_BOOL_LITERAL;
+}
+
+static double realValue(const AstNode *node) {
+    return node->kind == NODE_INT_LITERAL ? (double)node->as.int_value : node->as.real_value;
+}
+
+// Envolve um operando inteiro numa conversão para real; literais são convertidos na hora
+static AstNode *widen(SemanticContext *ctx, AstNode *node) {
+    if (node->type != TYPE_INTEGER) return node;
+    if (node->kind == NODE_INT_LITERAL) {
+        node->kind = NODE_REAL_LITERAL;
+        node->as.real_value = (double)node->as.int_value;
+        node->type = TYPE_REAL;
+        return node;
+    }
+    AstNode *conversion = createNode(ctx->arena, NODE_WIDEN, node->line, node->column);
+    conversion->type = TYPE_REAL;
+    conversion->next = node->next;
+    conversion->as.unary.op = TOKEN_REAL;
+    conversion->as.unary.operand = node;
+    node->next = NULL;
+    return conversion;
+}
+
+static void makeInteger(AstNode *node, long long value) {
+    node->kind = NODE_INT_LITERAL;
+    node->type = TYPE_INTEGER;
+    node->as.int_value = value;
+}
+
+static void makeReal(AstNode *node, double value) {
+    node->kind = NODE_REAL_LITERAL;
+    node->type = TYPE_REAL;
+    node->as.real_value = value;
+}
+
+static void makeBoolean(AstNode *node, bool value) {
+    node->kind = NODE_BOOL_LITERAL;
+    node->type = TYPE_BOOLEAN;
+    node->as.bool_value = value;
+}
+
+// Substitui um nó binário com operandos literais pelo resultado
+static void foldBinary(AstNode *node) {
+    AstNode *left = node->as.binary.left;
+    AstNode *right = node->as.binary.right;
+    TokenType op = node->as.binary.op;
+
+    if (left->type == TYPE_BOOLEAN) {
+        bool a = left->as.bool_value, b = right->as.bool_value;
+        switch (op) {
+            case TOKEN_AND: makeBoolean(node, a && b); break;
+            case TOKEN_OR: makeBoolean(node, a || b); break;
+            case TOKEN_EQ: makeBoolean(node, a == b); break;
+            case TOKEN_NEQ: makeBoolean(node, a != b); break;
+            default: break;
+        }
+        return;
+    }
+
+    if (left->type == TYPE_INTEGER && right->type == TYPE_INTEGER) {
+        // Aritmética sem sinal para que o estouro dê a volta em vez de ser indefinido
+        unsigned long long a = (unsigned long long)left->as.int_value;
+        unsigned long long b = (unsigned long long)right->as.int_value;
+        long long sa = left->as.int_value, sb = right->as.int_value;
+        switch (op) {
+            case TOKEN_PLUS: makeInteger(node, (long long)(a + b)); break;
+            case TOKEN_MINUS: makeInteger(node, (long long)(a - b)); break;
+            case TOKEN_MULTIPLY: makeInteger(node, (long long)(a * b)); break;
+            case TOKEN_DIV: if (sb != 0 && !(sb == -1 && sa == LLONG_MIN)) makeInteger(node, sa / sb); break;
+            case TOKEN_MOD: if (sb != 0 && !(sb == -1 && sa == LLONG_MIN)) makeInteger(node, sa % sb); break;
+            case TOKEN_EQ: makeBoolean(node, sa == sb); break;
+            case TOKEN_NEQ: makeBoolean(node, sa != sb); break;
+            case TOKEN_LT: makeBoolean(node, sa < sb); break;
+            case TOKEN_GT: makeBoolean(node, sa > sb); break;
+            case TOKEN_LTE: makeBoolean(node, sa <= sb); break;
+            case TOKEN_GTE: makeBoolean(node, sa >= sb); break;
+            default: break;
+        }
+        return;
+    }
+
+    double a = realValue(left), b = realValue(right);
+    switch (op) {
+        case TOKEN_PLUS: makeReal(node, a + b); break;
+        case TOKEN_MINUS: makeReal(node, a - b); break;
+        case TOKEN_MULTIPLY: makeReal(node, a * b); break;
+        case TOKEN_DIVIDE: if (b != 0.0) makeReal(node, a / b); break;
+        case TOKEN_EQ: makeBoolean(node, a == b); break;
+        case TOKEN_NEQ: makeBoolean(node, a != b); break;
+        case TOKEN_LT: makeBoolean(node, a < b); break;
+        case TOKEN_GT: makeBoolean(node, a > b); break;
+        case TOKEN_LTE: makeBoolean(node, a <= b); break;
+        case TOKEN_GTE: makeBoolean(node, a >= b); break;
+        default: break;
+    }
+}
+
+static void analyzeExpression(SemanticContext *ctx, AstNode *node);
+
+static void analyzeBinary(SemanticContext *ctx, AstNode *node) {
+    AstNode **left = &node->as.binary.left;
+    AstNode **right = &node->as.binary.right;
+    analyzeExpression(ctx, *left);
+    analyzeExpression(ctx, *right);
+    DataType lt = (*left)->type, rt = (*right)->type;
+
+    if (lt == TYPE_UNKNOWN || rt == TYPE_UNKNOWN) {
+        return; // Erro já reportado no operando
+    }
+
+    switch (node->as.binary.op) {
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_MULTIPLY:
+            if (!isNumeric(lt) || !isNumeric(rt)) {
+                semanticError(ctx, node, DIAG_ARITHMETIC_OPERANDS, NULL);
+                return;
+            }
+            if (lt == TYPE_REAL || rt == TYPE_REAL) {
+                *left = widen(ctx, *left);
+                *right = widen(ctx, *right);
+                node->type = TYPE_REAL;
+            } else {
+                node->type = TYPE_INTEGER;
+            }
+            break;
+        case TOKEN_DIVIDE:
+            if (!isNumeric(lt) || !isNumeric(rt)) {
+                semanticError(ctx, node, DIAG_DIVIDE_OPERANDS, NULL);
+                return;
+            }
+            *left = widen(ctx, *left);
+            *right = widen(ctx, *right);
+            node->type = TYPE_REAL;
+            break;
+        case TOKEN_DIV:
+        case TOKEN_MOD:
+            if (lt != TYPE_INTEGER || rt != TYPE_INTEGER) {
+                semanticError(ctx, node, DIAG_INTEGER_OPERANDS, NULL);
+                return;
+            }
+            if ((*right)->kind == NODE_INT_LITERAL && (*right)->as.int_value == 0) {
+                semanticError(ctx, node, DIAG_DIVISION_BY_ZERO, NULL);
+                return;
+            }
+            node->type = TYPE_INTEGER;
+            break;
+        case TOKEN_AND:
+        case TOKEN_OR:
+            if (lt != TYPE_BOOLEAN || rt != TYPE_BOOLEAN) {
+                semanticError(ctx, node, DIAG_LOGICAL_OPERANDS, NULL);
+                return;
+            }
+            node->type = TYPE_BOOLEAN;
+            break;
+        default:
+            // Operadores relacionais
+            if (isNumeric(lt) && isNumeric(rt)) {
+                if (lt != rt) {
+                    *left = widen(ctx, *left);
+                    *right = widen(ctx, *right);
+                }
+            } else if (lt != rt || (node->as.binary.op != TOKEN_EQ && node->as.binary.op != TOKEN_NEQ)) {
+                semanticError(ctx, node, DIAG_COMPARISON_OPERANDS, NULL);
+                return;
+            }
+            node->type = TYPE_BOOLEAN;
+            break;
+    }
+
+    if (isLiteral(*left) && isLiteral(*right)) {
+        foldBinary(node);
+    }
+}
+
+// Elemento de array: o nó recebe o tipo dos elementos
+static void analyzeIndex(SemanticContext *ctx, AstNode *node) {
+    AstNode *array = node->as.element.array;
+    AstNode *index = node->as.element.index;
+    analyzeExpression(ctx, index);
+    if (index->type != TYPE_INTEGER && index->type != TYPE_UNKNOWN) {
+        semanticError(ctx, index, DIAG_INDEX_TYPE, typeName(index->type));
+    }
+    Symbol *symbol = lookup(ctx, array->as.variable.name);
+    if (!symbol) {
+        semanticError(ctx, array, DIAG_UNDECLARED_IDENTIFIER, array->as.variable.name);
+    } else if (symbol->type != TYPE_ARRAY) {
+        semanticError(ctx, array, DIAG_NOT_ARRAY, array->as.variable.name);
+    } else {
+        array->as.variable.symbol = symbol;
+        array->type = TYPE_ARRAY;
+        node->type = symbol->element_type;
+    }
+}
+
+static void analyzeExpression(SemanticContext *ctx, AstNode *node) {
+    switch (node->kind) {
+        case NODE_INT_LITERAL:
+            node->type = TYPE_INTEGER;
+            break;
+        case NODE_REAL_LITERAL:
+            node->type = TYPE_REAL;
+            break;
+        case NODE_BOOL_LITERAL:
+            node->type = TYPE_BOOLEAN;
+            break;
+        case NODE_STRING_LITERAL:
+            node->type = TYPE_UNKNOWN; // Só aceito como argumento de write/writeln
+            break;
+        case NODE_VARIABLE: {
+            Symbol *symbol = lookup(ctx, node->as.variable.name);
+            if (!symbol) {
+                semanticError(ctx, node, DIAG_UNDECLARED_IDENTIFIER, node->as.variable.name);
+            } else if (symbol->type == TYPE_PROCEDURE) {
+                semanticError(ctx, node, DIAG_PROCEDURE_AS_VALUE, node->as.variable.name);
+            } else if (symbol->type == TYPE_ARRAY) {
+                semanticError(ctx, node, DIAG_ARRAY_AS_VALUE, node->as.variable.name);
+            } else {
+                node->as.variable.symbol = symbol;
+                node->type = symbol->type;
+            }
+            break;
+        }
+        case NODE_INDEX:
+            analyzeIndex(ctx, node);
+            break;
+        case NODE_UNARY: {
+            AstNode *operand = node->as.unary.operand;
+            analyzeExpression(ctx, operand);
+            if (operand->type == TYPE_UNKNOWN) break;
+            if (node->as.unary.op == TOKEN_NOT) {
+                if (operand->type != TYPE_BOOLEAN) {
+                    semanticError(ctx, node, DIAG_NOT_OPERAND, NULL);
+                    break;
+                }
+                node->type = TYPE_BOOLEAN;
+                if (operand->kind == NODE_BOOL_LITERAL) makeBoolean(node, !operand->as.bool_value);
+            } else {
+                if (!isNumeric(operand->type)) {
+                    semanticError(ctx, node, DIAG_SIGN_OPERAND, NULL);
+                    break;
+                }
+                node->type = operand->type;
+                bool negate = node->as.unary.op == TOKEN_MINUS;
+                if (operand->kind == NODE_INT_LITERAL) {
+                    makeInteger(node, negate ? (long long)(0ULL - (unsigned long long)operand->as.int_value)
+                                             : operand->as.int_value);
+                } else if (operand->kind == NODE_REAL_LITERAL) {
+                    makeReal(node, negate ? -operand->as.real_value : operand->as.real_value);
+                }
+            }
+            break;
+        }
+        case NODE_BINARY:
+            analyzeBinary(ctx, node);
+            break;
+        case NODE_WIDEN:
+            break;
+        default:
+            semanticError(ctx, node, DIAG_UNSUPPORTED_EXPRESSION, NULL);
+            break;
+    }
+}
+
+static void analyzeCondition(SemanticContext *ctx, AstNode *cond) {
+    analyzeExpression(ctx, cond);
+    if (cond->type != TYPE_BOOLEAN && cond->type != TYPE_UNKNOWN) {
+        semanticError(ctx, cond, DIAG_CONDITION_TYPE, typeName(cond->type));
+    }
+}
+
+// Verifica a atribuição de value a uma variável do tipo target; devolve o
+// valor possivelmente convertido. A conversão em atribuições gera aviso
+static AstNode *checkAssignable(SemanticContext *ctx, DataType target, AstNode *value, const char *name, bool warn) {
+    if (target == TYPE_UNKNOWN || value->type == TYPE_UNKNOWN || target == value->type) {
+        return value;
+    }
+    if (target == TYPE_REAL && value->type == TYPE_INTEGER) {
+        if (!warn) return widen(ctx, value);
+        reportDiagnostic(ctx->diagnostics, DIAG_IMPLICIT_CONVERSION, value->line, value->column, name);
+        ctx->warning_count++;
+        return widen(ctx, value);
+    }
+    reportDiagnostic(ctx->diagnostics, DIAG_ASSIGN_TYPE, value->line, value->column,
+                     typeName(value->type), typeName(target), name);
+    ctx->error_count++;
+    return value;
+}
+
+// Nome de um alvo, para as mensagens
+static const char *targetName(const AstNode *target) {
+    return target->kind == NODE_INDEX ? target->as.element.array->as.variable.name : target->as.variable.name;
+}
+
+// Resolve o alvo de uma atribuição ou de read; o tipo do que é escrito fica em target->type
+static Symbol *resolveTarget(SemanticContext *ctx, AstNode *target) {
+    if (target->kind == NODE_INDEX) {
+        analyzeIndex(ctx, target);
+        return target->as.element.array->as.variable.symbol;
+    }
+    Symbol *symbol = lookup(ctx, target->as.variable.name);
+    if (!symbol) {
+        semanticError(ctx, target, DIAG_UNDECLARED_IDENTIFIER, target->as.variable.name);
+        return NULL;
+    }
+    if (symbol->type == TYPE_PROCEDURE) {
+        semanticError(ctx, target, DIAG_ASSIGN_PROCEDURE, target->as.variable.name);
+        return NULL;
+    }
+    if (symbol->type == TYPE_ARRAY) {
+        semanticError(ctx, target, DIAG_ARRAY_AS_VALUE, target->as.variable.name);
+        return NULL;
+    }
+    target->as.variable.symbol = symbol;
+    target->type = symbol->type;
+    return symbol;
+}
+
+static void analyzeCall(SemanticContext *ctx, AstNode *node) {
+    Symbol *symbol = lookup(ctx, node->as.call.name);
+    if (!symbol) {
+        semanticError(ctx, node, DIAG_UNDECLARED_PROCEDURE, node->as.call.name);
+        return;
+    }
+    if (symbol->type != TYPE_PROCEDURE) {
+        semanticError(ctx, node, DIAG_NOT_PROCEDURE, node->as.call.name);
+        return;
+    }
+    node->as.call.symbol = symbol;
+
+    int index = 0;
+    for (AstNode **arg = &node->as.call.args; *arg; arg = &(*arg)->next, index++) {
+        analyzeExpression(ctx, *arg);
+        if (index < symbol->param_count) {
+            *arg = checkAssignable(ctx, symbol->param_types[index], *arg, node->as.call.name, false);
+        }
+    }
+    if (index != symbol->param_count) {
+        reportDiagnostic(ctx->diagnostics, DIAG_ARGUMENT_COUNT, node->line, node->column,
+                         node->as.call.name, symbol->param_count, index);
+        ctx->error_count++;
+    }
+}
+
+static void analyzeStatement(SemanticContext *ctx, AstNode *node) {
+    switch (node->kind) {
+        case NODE_BLOCK:
+            for (AstNode *stmt = node->as.block.statements; stmt; stmt = stmt->next) {
+                analyzeStatement(ctx, stmt);
+            }
+            break;
+        case NODE_ASSIGN: {
+            AstNode *target = node->as.assign.target;
+            Symbol *symbol = resolveTarget(ctx, target);
+            analyzeExpression(ctx, node->as.assign.value);
+            if (symbol) {
+                node->as.assign.value = checkAssignable(ctx, target->type, node->as.assign.value,
+                                                        targetName(target), true);
+            }
+            break;
+        }
+        case NODE_IF:
+            analyzeCondition(ctx, node->as.if_stmt.cond);
+            analyzeStatement(ctx, node->as.if_stmt.then_branch);
+            if (node->as.if_stmt.else_branch) analyzeStatement(ctx, node->as.if_stmt.else_branch);
+            break;
+        case NODE_WHILE:
+            analyzeCondition(ctx, node->as.while_stmt.cond);
+            analyzeStatement(ctx, node->as.while_stmt.body);
+            break;
+        case NODE_FOR: {
+            AstNode *var = node->as.for_stmt.var;
+            Symbol *symbol = resolveTarget(ctx, var);
+            if (symbol && symbol->type != TYPE_INTEGER) {
+                semanticError(ctx, var, DIAG_FOR_VARIABLE_TYPE, var->as.variable.name);
+            }
+            analyzeExpression(ctx, node->as.for_stmt.start);
+            analyzeExpression(ctx, node->as.for_stmt.end);
+            if (node->as.for_stmt.start->type != TYPE_INTEGER && node->as.for_stmt.start->type != TYPE_UNKNOWN) {
+                semanticError(ctx, node->as.for_stmt.start, DIAG_FOR_BOUNDS_TYPE,
+                              typeName(node->as.for_stmt.start->type));
+            }
+            if (node->as.for_stmt.end->type != TYPE_INTEGER && node->as.for_stmt.end->type != TYPE_UNKNOWN) {
+                semanticError(ctx, node->as.for_stmt.end, DIAG_FOR_BOUNDS_TYPE,
+                              typeName(node->as.for_stmt.end->type));
+            }
+            analyzeStatement(ctx, node->as.for_stmt.body);
+            break;
+        }
+        case NODE_CALL:
+            analyzeCall(ctx, node);
+            break;
+        case NODE_WRITE:
+            for (AstNode *arg = node->as.write.args; arg; arg = arg->next) {
+                if (arg->kind != NODE_STRING_LITERAL) analyzeExpression(ctx, arg);
+            }
+            break;
+        case NODE_READ:
+            for (AstNode *target = node->as.read.targets; target; target = target->next) {
+                Symbol *symbol = resolveTarget(ctx, target);
+                if (symbol && target->type == TYPE_BOOLEAN) {
+                    semanticError(ctx, target, DIAG_READ_BOOLEAN, targetName(target));
+                }
+            }
+            break;
+        default:
+            semanticError(ctx, node, DIAG_INVALID_STATEMENT, NULL);
+            break;
+    }
+}
+
+static void analyzeProcedure(SemanticContext *ctx, AstNode *proc) {
+    ctx->locals = proc->as.procedure.locals;
+    ctx->arena = proc->as.procedure.arena;
+    proc->as.procedure.symbol = findSymbol(ctx->globals, proc->as.procedure.name);
+    if (proc->as.procedure.body) analyzeStatement(ctx, proc->as.procedure.body);
+}
+
+// Procedimento verificado por uma thread de trabalho, com seu próprio buffer de diagnósticos
+typedef struct {
+    AstNode *proc;
+    DiagnosticBuffer diagnostics;
+    int error_count;
+    int warning_count;
+} ProcedureCheck;
+
+typedef struct {
+    SymbolTable *globals;
+    ProcedureCheck *checks;
+} CheckBatch;
+
+static void analyzeProcedureJob(void *context, int index) {
+    uint64_t span = traceBegin();
+    CheckBatch *batch = (CheckBatch *)context;
+    ProcedureCheck *check = &batch->checks[index];
+    SemanticContext ctx = {batch->globals, NULL, NULL, &check->diagnostics, 0, 0};
+    analyzeProcedure(&ctx, check->proc);
+    check->error_count = ctx.error_count;
+    check->warning_count = ctx.warning_count;
+    // Contagem de tokens só quando o corpo também foi analisado em paralelo
+    int tokens = check->proc->as.procedure.token_count;
+    traceSpanArgs(span, "semantic", check->proc->as.procedure.name, "line", check->proc->line,
+                  tokens ? "tokens" : NULL, tokens);
+}
+
+// Os corpos só leem o escopo global, que não muda mais: cada um é verificado numa thread e
+// os diagnósticos entram na ordem do fonte. Com uses, o escopo não está congelado (as units
+// criam os símbolos na primeira consulta) e a verificação é feita em sequência
+static bool analyzeProceduresInParallel(SemanticContext *ctx, AstNode *program, int jobs) {
+    int count = 0;
+    for (AstNode *proc = program->as.program.procedures; proc; proc = proc->next) count++;
+    if (jobs <= 1 || count < PARALLEL_MIN_ITEMS || ctx->globals->unit_count > 0) return false;
+
+    ProcedureCheck *checks = (ProcedureCheck *)calloc(count, sizeof(ProcedureCheck));
+    if (!checks) {
+        fprintf(stderr, "Erro de alocação de memória na análise semântica\n");
+        exit(EXIT_FAILURE);
+    }
+    int index = 0;
+    for (AstNode *proc = program->as.program.procedures; proc; proc = proc->next, index++) {
+        checks[index].proc = proc;
+        initDiagnostics(&checks[index].diagnostics);
+    }
+    CheckBatch batch = {ctx->globals, checks};
+    parallelFor(count, jobs, analyzeProcedureJob, &batch);
+    for (int i = 0; i < count; i++) {
+        appendDiagnostics(ctx->diagnostics, &checks[i].diagnostics, 0);
+        ctx->error_count += checks[i].error_count;
+        ctx->warning_count += checks[i].warning_count;
+        freeDiagnostics(&checks[i].diagnostics);
+    }
+    free(checks);
+    return true;
+}
+
+int analyzeProgram(AstNode *program, SymbolTable *globals, Arena *arena, DiagnosticBuffer *diagnostics, int jobs) {
+    SemanticContext ctx = {globals, NULL, arena, diagnostics, 0, 0};
+
+    if (!analyzeProceduresInParallel(&ctx, program, jobs)) {
+        for (AstNode *proc = program->as.program.procedures; proc; proc = proc->next) {
+            analyzeProcedure(&ctx, proc);
+        }
+    }
+
+    ctx.locals = NULL;
+    ctx.arena = arena;
+    if (program->as.program.body) analyzeStatement(&ctx, program->as.program.body);
+    return ctx.error_count;
+}
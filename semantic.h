@@ -0,0 +1,23 @@
+#ifndef SEMANTIC_H
+#define SEMANTIC_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "symbol_table.h"
+#include "diagnostics.h"
+
+// Estado da análise semântica de um programa
+typedef struct {
+    SymbolTable *globals;
+    SymbolTable *locals;      // Escopo do procedimento atual (NULL no bloco principal)
+    Arena *arena;             // Arena onde conversões implícitas são alocadas
+    DiagnosticBuffer *diagnostics;
+    int error_count;
+    int warning_count;
+} SemanticContext;
+
+// Resolve identificadores, verifica tipos e dobra constantes; com jobs > 1, os corpos
+// dos procedimentos são verificados em paralelo. Retorna o número de erros encontrados
+int analyzeProgram(AstNode *program, SymbolTable *globals, Arena *arena, DiagnosticBuffer *diagnostics, int jobs);
+
+#endif
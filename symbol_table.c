@@ -6,26 +6,110 @@
 #include <stdlib.h>
 #include <string.h>
 #include "symbol_table.h"
+#include "unit.h"
+
+// Escopos com mais símbolos que isto ganham um índice por hash: o escopo global de um
+// fonte grande tem milhares de nomes, e cada identificador do corpo é procurado nele
+#define INDEX_THRESHOLD 16
 
 void initSymbolTable(SymbolTable *table) {
     table->head = NULL;
+    table->index = NULL;
+    table->index_size = 0;
+    table->symbol_count = 0;
     table->current_scope = 0;
+    table->variable_count = 0;
+    table->procedure_count = 0;
+    table->array_count = 0;
+    table->array_slots = 0;
+    table->units = NULL;
+    table->unit_count = 0;
+    table->imports = NULL;
+    table->import_count = 0;
+}
+
+static void indexSymbol(SymbolTable *table, Symbol *symbol) {
+    uint32_t mask = (uint32_t)table->index_size - 1;
+    uint32_t slot = unitSymbolHash(symbol->name) & mask;
+    while (table->index[slot]) slot = (slot + 1) & mask;
+    table->index[slot] = symbol;
+}
+
+// Dobra o índice, mantendo a ocupação abaixo da metade
+static void growIndex(SymbolTable *table) {
+    int size = table->index_size ? table->index_size * 2 : 4 * INDEX_THRESHOLD;
+    Symbol **index = (Symbol **)calloc(size, sizeof(Symbol *));
+    if (!index) {
+        fprintf(stderr, "Erro de alocação de memória ao indexar símbolos\n");
+        exit(EXIT_FAILURE);
+    }
+    free(table->index);
+    table->index = index;
+    table->index_size = size;
+    for (Symbol *s = table->head; s; s = s->next) indexSymbol(table, s);
 }
 
 bool addSymbol(SymbolTable *table, const char *name, DataType type) {
+    if (findOwnSymbol(table, name)) {
+        return false; // Já declarado neste escopo (nomes das units podem ser redeclarados)
+    }
     Symbol *new_symbol = (Symbol *)malloc(sizeof(Symbol));
     if (!new_symbol) {
         return false; // Erro de alocação
     }
     new_symbol->name = strdup(name);
     new_symbol->type = type;
+    new_symbol->scope = table->current_scope;
+    if (type == TYPE_PROCEDURE) {
+        new_symbol->index = table->procedure_count++;
+    } else if (type == TYPE_ARRAY) {
+        new_symbol->index = table->array_count++;
+    } else {
+        new_symbol->index = table->variable_count++;
+    }
+    new_symbol->param_count = 0;
+    new_symbol->param_types = NULL;
+    new_symbol->exported = false;
+    new_symbol->forward = false;
+    new_symbol->element_type = TYPE_UNKNOWN;
+    new_symbol->low = 0;
+    new_symbol->high = -1;
     new_symbol->next = table->head;
     table->head = new_symbol;
+    table->symbol_count++;
+    if (table->symbol_count * 2 > table->index_size && table->symbol_count > INDEX_THRESHOLD) {
+        growIndex(table);
+    } else if (table->index) {
+        indexSymbol(table, new_symbol);
+    }
     return true;
 }
 
+bool addProcedureSymbol(SymbolTable *table, const char *name, int param_count, const DataType *param_types) {
+    if (!addSymbol(table, name, TYPE_PROCEDURE)) {
+        return false;
+    }
+    Symbol *symbol = table->head;
+    if (param_count > 0) {
+        symbol->param_types = (DataType *)malloc(sizeof(DataType) * param_count);
+        if (!symbol->param_types) {
+            return false;
+        }
+        memcpy(symbol->param_types, param_types, sizeof(DataType) * param_count);
+    }
+    symbol->param_count = param_count;
+    return true;
+}
 
-Symbol* findSymbol(SymbolTable *table, const char *name) {
+
+Symbol* findOwnSymbol(SymbolTable *table, const char *name) {
+    if (table->index) {
+        uint32_t mask = (uint32_t)table->index_size - 1;
+        for (uint32_t slot = unitSymbolHash(name) & mask; table->index[slot]; slot = (slot + 1) & mask) {
+            if (strcmp(table->index[slot]->name, name) == 0) return table->index[slot];
+        }
+        return NULL;
+    }
     Symbol *current = table->head;
     while (current) {
         if (strcmp(current->name, name) == 0) {
@@ -36,13 +120,53 @@ Symbol* findSymbol(SymbolTable *table, const char *name) {
     return NULL;
 }
 
+Symbol* findSymbol(SymbolTable *table, const char *name) {
+    Symbol *symbol = findOwnSymbol(table, name);
+    if (symbol || table->unit_count == 0) return symbol;
+    uint32_t hash = unitSymbolHash(name);
+    for (int i = table->unit_count - 1; i >= 0 && !symbol; i--) {
+        symbol = findUnitSymbol(table, i, name, hash);
+    }
+    return symbol;
+}
+
+void globalTypes(const SymbolTable *table, uint8_t *types) {
+    for (Symbol *s = table->head; s; s = s->next) {
+        if (s->type != TYPE_PROCEDURE && s->type != TYPE_ARRAY) types[s->index] = (uint8_t)s->type;
+    }
+    for (int i = 0; i < table->unit_count; i++) unitGlobalTypes(table->units[i], types);
+}
+
 void freeSymbolTable(SymbolTable *table) {
     Symbol *current = table->head;
     while (current) {
         Symbol *next = current->next;
         free(current->name);
+        free(current->param_types);
         free(current);
         current = next;
     }
     table->head = NULL;
-}
\ No newline at end of file
+    free(table->index);
+    table->index = NULL;
+    table->index_size = 0;
+    table->symbol_count = 0;
+    for (int i = 0; i < table->unit_count; i++) closeUnit(table->units[i]);
+    free(table->units);
+    free(table->imports);
+    table->units = NULL;
+    table->unit_count = 0;
+    table->imports = NULL;
+    table->import_count = 0;
+}
+
+const char *typeName(DataType type) {
+    switch (type) {
+        case TYPE_INTEGER: return "integer";
+        case TYPE_REAL: return "real";
+        case TYPE_BOOLEAN: return "boolean";
+        case TYPE_PROCEDURE: return "procedure";
+        case TYPE_ARRAY: return "array";
+        default: return "unknown";
+    }
+}
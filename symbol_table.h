@@ -6,13 +6,22 @@
 #define SYMBOL_TABLE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "tokens.h"
 
+// Limites dos arrays: a numeração cabe no operando c das instruções e todos os
+// elementos, juntos, em deslocamentos de 32 bits no código nativo
+#define MAX_ARRAYS 65535
+#define MAX_ARRAY_SLOTS (1 << 26)
+// Parâmetros de um procedimento: os argumentos de uma chamada vão num vetor fixo da VM
+#define MAX_PARAMS 64
+
 typedef enum {
     TYPE_INTEGER,
     TYPE_REAL,
     TYPE_BOOLEAN,
     TYPE_PROCEDURE,
+    TYPE_ARRAY,
     TYPE_UNKNOWN
 } DataType;
 
@@ -20,17 +29,48 @@ typedef struct Symbol {
     char *name;
     DataType type;
     int scope;
+    int index;               // Posição da variável no escopo, número do procedimento ou do array
+    int param_count;         // Procedimentos: número de parâmetros
+    DataType *param_types;   // Procedimentos: tipos dos parâmetros
+    bool exported;           // Declarado na interface de uma unit
+    bool forward;            // Cabeçalho da interface cujo corpo ainda não apareceu
+    DataType element_type;   // Arrays: tipo dos elementos, indexados de low a high
+    int32_t low;
+    int32_t high;
     struct Symbol *next;
 } Symbol;
 
+typedef struct Unit Unit;
+
+// Escopo com os símbolos declarados no próprio fonte. O escopo global também vê as
+// units de uses: as variáveis delas ocupam segmentos reservados no início das globais
+// e os procedimentos importados recebem índices negativos (CALL -1 - i), resolvidos
+// pela ligação (unit.c) depois da geração do bytecode
 typedef struct {
     Symbol *head;
+    Symbol **index;          // Nomes por hash (endereçamento aberto) quando o escopo cresce
+    int index_size;          // Potência de dois; 0 enquanto o escopo é percorrido em lista
+    int symbol_count;
     int current_scope;
+    int variable_count;
+    int procedure_count;
+    int array_count;         // Arrays têm numeração própria: não ocupam registradores nem globais
+    int64_t array_slots;     // Soma dos comprimentos dos arrays
+    Unit **units;            // Na ordem de uses; a última tem prioridade
+    int unit_count;
+    int *imports;            // Procedimento importado i: unidade imports[2i], registro imports[2i + 1]
+    int import_count;
 } SymbolTable;
 
 void initSymbolTable(SymbolTable *table);
 bool addSymbol(SymbolTable *table, const char *name, DataType type);
+bool addProcedureSymbol(SymbolTable *table, const char *name, int param_count, const DataType *param_types);
+// Procura nos símbolos próprios e depois nas units; findOwnSymbol ignora as units
 Symbol* findSymbol(SymbolTable *table, const char *name);
+Symbol* findOwnSymbol(SymbolTable *table, const char *name);
+// Tipos de todas as globais, inclusive as dos segmentos das units (sem os arrays)
+void globalTypes(const SymbolTable *table, uint8_t *types);
 void freeSymbolTable(SymbolTable *table);
+const char *typeName(DataType type);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "token_ring.h"
+#include "lexer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#define RING_SIZE 4096        // Potência de dois: a posição na fila sai de uma máscara
+#define RING_BATCH 256        // Tokens lidos pelo lexer entre duas publicações
+
+struct TokenRing {
+    Token slots[RING_SIZE];
+    // Contadores que só crescem; cada lado grava o seu e lê o do outro. Ficam em linhas
+    // de cache separadas para que o avanço de um não invalide a linha do outro
+    _Alignas(64) atomic_size_t tail;   // Próxima posição a publicar (lexer)
+    _Alignas(64) atomic_size_t head;   // Próxima posição a consumir (parser)
+    _Alignas(64) atomic_bool done;     // TOKEN_EOF publicado
+    const char *source;
+    pthread_t thread;
+};
+
+static void *lexerThread(void *argument) {
+    TokenRing *ring = argument;
+    Lexer lexer;
+    initLexer(&lexer, ring->source);
+    TokenList batch;
+    initTokenList(&batch);
+    size_t tail = 0;
+    while (lexBatch(&lexer, &batch, RING_BATCH) > 0) {
+        for (TokenNode *node = batch.head; node; node = node->next) {
+            // Fila cheia: publica o que já foi escrito e cede a vez ao parser
+            while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == RING_SIZE) {
+                atomic_store_explicit(&ring->tail, tail, memory_order_release);
+                sched_yield();
+            }
+            ring->slots[tail & (RING_SIZE - 1)] = node->token;
+            node->token.lexeme = NULL;   // O lexema agora é do slot
+            tail++;
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+        releaseTokens(&batch, NULL);
+    }
+    atomic_store_explicit(&ring->done, true, memory_order_release);
+    freeTokenList(&batch);
+    return NULL;
+}
+
+TokenRing *startTokenRing(const char *source) {
+    TokenRing *ring = aligned_alloc(64, sizeof(TokenRing));
+    if (!ring) {
+        fprintf(stderr, "Erro de alocação de memória ao criar a fila de tokens\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->done, false);
+    ring->source = source;
+    if (pthread_create(&ring->thread, NULL, lexerThread, ring) != 0) {
+        free(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+int receiveTokens(TokenRing *ring, TokenList *list, int max_tokens) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    while (tail == head) {
+        // done é gravado depois do último tail: relido depois dele, tail já está completo
+        if (atomic_load_explicit(&ring->done, memory_order_acquire)) {
+            tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+            if (tail == head) return 0;
+            break;
+        }
+        sched_yield();
+        tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    }
+    int count = tail - head < (size_t)max_tokens ? (int)(tail - head) : max_tokens;
+    for (int i = 0; i < count; i++) appendToken(list, &ring->slots[(head + i) & (RING_SIZE - 1)]);
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+    return count;
+}
+
+void stopTokenRing(TokenRing *ring) {
+    if (!ring) return;
+    // O parser pode parar antes do fim do fonte: esvazia a fila para o lexer terminar
+    TokenList rest;
+    initTokenList(&rest);
+    while (receiveTokens(ring, &rest, RING_SIZE) > 0) releaseTokens(&rest, NULL);
+    freeTokenList(&rest);
+    pthread_join(ring->thread, NULL);
+    free(ring);
+}
+
+#else
+
+TokenRing *startTokenRing(const char *source) {
+    (void)source;
+    return NULL;
+}
+
+int receiveTokens(TokenRing *ring, TokenList *list, int max_tokens) {
+    (void)ring;
+    (void)list;
+    (void)max_tokens;
+    return 0;
+}
+
+void stopTokenRing(TokenRing *ring) {
+    (void)ring;
+}
+
+#endif
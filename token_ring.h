@@ -0,0 +1,20 @@
+#ifndef TOKEN_RING_H
+#define TOKEN_RING_H
+
+#include "tokens.h"
+
+// Lexer numa thread própria (--pipeline): os tokens são publicados em lotes numa fila
+// circular de um produtor e um consumidor, sem travas, e o parser os retira no ritmo em
+// que avança. A lista completa de tokens nunca é montada
+typedef struct TokenRing TokenRing;
+
+// Inicia a thread do lexer sobre o fonte, que precisa viver até stopTokenRing;
+// NULL quando a plataforma não tem threads
+TokenRing *startTokenRing(const char *source);
+// Move até max_tokens tokens para o fim da lista, esperando o lexer se a fila estiver
+// vazia; os lexemas passam a ser da lista. Retorna 0 depois do TOKEN_EOF
+int receiveTokens(TokenRing *ring, TokenList *list, int max_tokens);
+// Espera a thread do lexer e libera a fila com os tokens não consumidos
+void stopTokenRing(TokenRing *ring);
+
+#endif
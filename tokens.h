@@ -1,6 +1,8 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <stdint.h>
+
 // Definição de tipos de tokens
 typedef enum {
     // Palavras-chave
@@ -17,9 +19,23 @@ typedef enum {
     TOKEN_ELSE,            // "else"
     TOKEN_WHILE,           // "while"
     TOKEN_DO,              // "do"
+    TOKEN_FOR,             // "for"
+    TOKEN_TO,              // "to"
+    TOKEN_DOWNTO,          // "downto"
     TOKEN_READ,            // "read"
     TOKEN_WRITE,           // "write"
     TOKEN_WRITELN,         // "writeln"
+    TOKEN_DIV,             // "div"
+    TOKEN_MOD,             // "mod"
+    TOKEN_AND,             // "and"
+    TOKEN_OR,              // "or"
+    TOKEN_NOT,             // "not"
+    TOKEN_UNIT,            // "unit"
+    TOKEN_INTERFACE,       // "interface"
+    TOKEN_IMPLEMENTATION,  // "implementation"
+    TOKEN_USES,            // "uses"
+    TOKEN_ARRAY,           // "array"
+    TOKEN_OF,              // "of"
 
     // Operadores
     TOKEN_ASSIGN,          // ":="
@@ -41,6 +57,9 @@ typedef enum {
     TOKEN_DOT,             // "."
     TOKEN_LPAREN,          // "("
     TOKEN_RPAREN,          // ")"
+    TOKEN_LBRACKET,        // "["
+    TOKEN_RBRACKET,        // "]"
+    TOKEN_DOTDOT,          // ".."
 
     // Literais
     TOKEN_IDENTIFIER,      // Identificador (ex.: nomes de variáveis)
@@ -60,6 +79,10 @@ typedef struct {
     char *lexeme;      // Lexema associado ao token
     int line;          // Linha onde o token foi encontrado
     int column;        // Coluna onde o token foi encontrado
+    union {
+        int64_t integer;   // TOKEN_INTEGER_LITERAL
+        double real;       // TOKEN_REAL_LITERAL
+    } value;           // Valor decodificado pelo lexer
 } Token;
 
 // Protótipos de funções
@@ -75,12 +98,11 @@ typedef struct tokenNode {
 typedef struct {
     tokenNode *head;          // Cabeça da lista
     tokenNode *tail;          // Cauda da lista
+    tokenNode *free_nodes;    // Nós já consumidos, reaproveitados por addToken
+    int count;                // Tokens adicionados desde initTokenList
 } TokenList;
 
-// Linked list node for tokens
-typedef struct TokenNode {
-    Token token;
-    struct TokenNode *next;
-} TokenNode;
+// Nome usado pelo parser para o nó da lista
+typedef tokenNode TokenNode;
 
 #endif // TOKEN_H
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "trace.h"
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    const char *category;
+    char name[TRACE_NAME_MAX];
+    const char *keys[2];
+    long long values[2];
+} TraceEvent;
+
+// Buffer de uma thread; só ela escreve nele até traceClose
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;
+    int tid;
+    uint64_t last_phase;  // Fim da última fase registrada pela thread
+    TraceEvent *events;
+    int count;
+    int capacity;
+} TraceBuffer;
+
+static bool enabled;
+static FILE *trace_file;     // Aberto já em traceOpen: um caminho inválido falha antes da compilação
+static uint64_t origin;
+static _Atomic(TraceBuffer *) buffers;
+static atomic_int next_tid = 1;
+static _Thread_local TraceBuffer *local;
+
+static uint64_t nanoseconds(void) {
+    struct timespec ts;
+#ifdef __linux__
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *memory = realloc(array, size);
+    if (!memory) {
+        fprintf(stderr, "Erro de alocação de memória no rastreamento\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+// Primeiro evento da thread: cria o buffer e o publica na lista com compare-and-swap
+static TraceBuffer *threadBuffer(void) {
+    if (local) return local;
+    TraceBuffer *buffer = checkedRealloc(NULL, sizeof(TraceBuffer));
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->tid = atomic_fetch_add(&next_tid, 1);
+    buffer->last_phase = origin;
+    buffer->next = atomic_load(&buffers);
+    while (!atomic_compare_exchange_weak(&buffers, &buffer->next, buffer)) {
+    }
+    local = buffer;
+    return buffer;
+}
+
+static TraceEvent *addEvent(uint64_t start, uint64_t end, const char *category, const char *name) {
+    TraceBuffer *buffer = threadBuffer();
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+        buffer->events = checkedRealloc(buffer->events, buffer->capacity * sizeof(TraceEvent));
+    }
+    TraceEvent *event = &buffer->events[buffer->count++];
+    memset(event, 0, sizeof(*event));
+    event->start = start;
+    event->end = end;
+    event->category = category;
+    snprintf(event->name, sizeof(event->name), "%s", name);
+    return event;
+}
+
+bool traceOpen(const char *path) {
+    trace_file = fopen(path, "w");
+    if (!trace_file) {
+        perror("Error opening trace file");
+        return false;
+    }
+    origin = nanoseconds();
+    enabled = true;
+    // A thread principal é a primeira da lista de threads do visualizador
+    threadBuffer();
+    return true;
+}
+
+uint64_t traceBegin(void) {
+    return enabled ? nanoseconds() : 0;
+}
+
+void traceSpan(uint64_t start, const char *category, const char *name, const char *key, long long value) {
+    if (!enabled) return;
+    TraceEvent *event = addEvent(start, nanoseconds(), category, name);
+    event->keys[0] = key;
+    event->values[0] = value;
+}
+
+void traceSpanArgs(uint64_t start, const char *category, const char *name,
+                   const char *key0, long long value0, const char *key1, long long value1) {
+    if (!enabled) return;
+    TraceEvent *event = addEvent(start, nanoseconds(), category, name);
+    event->keys[0] = key0;
+    event->values[0] = value0;
+    event->keys[1] = key1;
+    event->values[1] = value1;
+}
+
+void tracePhase(const char *name, long long bytes, long long tokens) {
+    if (!enabled) return;
+    TraceBuffer *buffer = threadBuffer();
+    uint64_t end = nanoseconds();
+    TraceEvent *event = addEvent(buffer->last_phase, end, "phase", name);
+    if (bytes >= 0) {
+        event->keys[0] = "bytes";
+        event->values[0] = bytes;
+    }
+    if (tokens >= 0) {
+        event->keys[1] = "tokens";
+        event->values[1] = tokens;
+    }
+    buffer->last_phase = end;
+}
+
+uint64_t traceStartPhases(void) {
+    if (!enabled) return 0;
+    TraceBuffer *buffer = threadBuffer();
+    uint64_t mark = buffer->last_phase;
+    buffer->last_phase = nanoseconds();
+    return mark;
+}
+
+void traceRestorePhases(uint64_t mark) {
+    if (enabled) threadBuffer()->last_phase = mark;
+}
+
+static void writeString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(file, "\\%c", *c);
+        else if (*c < 0x20) fprintf(file, "\\u%04x", *c);
+        else fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void writeEvent(FILE *file, const TraceEvent *event, int tid) {
+    fprintf(file, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"cat\":", tid);
+    writeString(file, event->category);
+    fprintf(file, ",\"name\":");
+    writeString(file, event->name);
+    fprintf(file, ",\"ts\":%.3f,\"dur\":%.3f,\"args\":{", (double)(event->start - origin) / 1e3,
+            (double)(event->end - event->start) / 1e3);
+    bool first = true;
+    for (int k = 0; k < 2; k++) {
+        if (!event->keys[k]) continue;
+        fprintf(file, "%s\"%s\":%lld", first ? "" : ",", event->keys[k], event->values[k]);
+        first = false;
+    }
+    fprintf(file, "}}");
+}
+
+bool traceClose(void) {
+    if (!enabled) return true;
+    enabled = false;
+    FILE *file = trace_file;
+    trace_file = NULL;
+    if (file) {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"compilador\"}}");
+    }
+    TraceBuffer *buffer = atomic_exchange(&buffers, NULL);
+    while (buffer) {
+        if (file) {
+            fprintf(file, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", buffer->tid);
+            char name[32] = "main";
+            if (buffer->tid > 1) snprintf(name, sizeof(name), "worker %d", buffer->tid - 1);
+            writeString(file, name);
+            fprintf(file, "}}");
+            for (int i = 0; i < buffer->count; i++) writeEvent(file, &buffer->events[i], buffer->tid);
+        }
+        TraceBuffer *next = buffer->next;
+        free(buffer->events);
+        free(buffer);
+        buffer = next;
+    }
+    local = NULL;
+    if (!file) return false;
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
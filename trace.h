@@ -0,0 +1,32 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Linha do tempo no formato trace-event (--trace), aberta direto no Perfetto ou em
+// chrome://tracing. Cada thread grava seus intervalos num buffer próprio, sem travas;
+// os buffers entram numa lista atômica e só são lidos por traceClose, depois que as
+// threads terminaram. Desligado, cada chamada custa um teste.
+#define TRACE_NAME_MAX 64
+
+// Cria o arquivo de saída; false (com a mensagem) se ele não pode ser aberto
+bool traceOpen(const char *path);
+// Instante inicial de um intervalo (0 com o rastreamento desligado)
+uint64_t traceBegin(void);
+// Intervalo [start, agora) com um argumento inteiro opcional (key NULL omite)
+void traceSpan(uint64_t start, const char *category, const char *name, const char *key, long long value);
+// Como traceSpan, com dois argumentos inteiros
+void traceSpanArgs(uint64_t start, const char *category, const char *name,
+                   const char *key0, long long value0, const char *key1, long long value1);
+// Fase do compilador: do fim da fase anterior nesta thread até agora; contagens
+// negativas são omitidas
+void tracePhase(const char *name, long long bytes, long long tokens);
+// Fases de uma tarefa aninhada (uma unit do --build) contam a partir de agora; devolve o
+// marco anterior da thread, que traceRestorePhases recoloca no fim da tarefa
+uint64_t traceStartPhases(void);
+void traceRestorePhases(uint64_t mark);
+// Grava o JSON e libera os buffers
+bool traceClose(void);
+
+#endif
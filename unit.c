@@ -0,0 +1,783 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "unit.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HAVE_MMAP 1
+#endif
+
+#define UNIT_MAGIC "PPU1"
+#define UNIT_VERSION 2
+
+// Layout do arquivo: cabeçalho, nomes e seções alinhadas em 8 bytes. Todos os
+// deslocamentos contam do início do arquivo, que termina com um byte zero: um nome
+// corrompido nunca leva strcmp para fora do mapeamento
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t interface_hash;
+    uint64_t build_key;                   // unitBuildKey do fonte compilado
+    uint32_t name;
+    uint32_t symbols, symbol_count;       // UnitSymbol[]: variáveis exportadas e depois procedimentos
+    uint32_t variable_count;
+    uint32_t buckets, bucket_count;       // uint32_t[]: 1 + primeiro registro do balde, 0 se vazio
+    uint32_t dependencies, dependency_count;
+    uint32_t imports, import_count;
+    uint32_t global_types, global_count;  // Globais da unit: segmentos das dependências e depois as próprias
+    uint32_t functions, function_count;
+    uint32_t constants, constant_count;
+    uint32_t strings, string_count;       // uint32_t[]: deslocamento de cada string
+} UnitHeader;
+
+typedef struct {
+    uint32_t name;
+    uint32_t hash;
+    uint32_t next;            // 1 + próximo registro do balde, 0 no fim
+    uint32_t index;           // Variável: global da unit; procedimento: função da unit
+    uint32_t params;          // Tipos dos parâmetros, um byte cada
+    uint16_t param_count;
+    uint8_t type;
+    uint8_t padding;
+} UnitSymbol;
+
+typedef struct {
+    uint64_t interface_hash;  // Interface da dependência quando a unit foi compilada
+    uint32_t name;
+    uint32_t global_start;
+} UnitDependency;
+
+// Procedimento importado i (CALL -1 - i): registro symbol da dependência
+typedef struct {
+    uint32_t dependency;
+    uint32_t symbol;
+} UnitImport;
+
+typedef struct {
+    uint32_t name;
+    uint32_t code;            // Instruction[count]
+    uint32_t lines;           // int[count]
+    uint32_t columns;         // int[count]
+    uint32_t register_types;  // uint8_t[register_count]
+    uint32_t count;
+    uint32_t register_count;
+    uint32_t param_count;
+} UnitFunction;
+
+static void *checkedRealloc(void *memory, size_t size) {
+    void *grown = realloc(memory, size ? size : 1);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória nas units\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static char *checkedStrdup(const char *text) {
+    char *copy = checkedRealloc(NULL, strlen(text) + 1);
+    strcpy(copy, text);
+    return copy;
+}
+
+static const UnitHeader *header(const Unit *unit) {
+    return (const UnitHeader *)unit->data;
+}
+
+static const UnitSymbol *records(const Unit *unit) {
+    return (const UnitSymbol *)(unit->data + header(unit)->symbols);
+}
+
+static const char *text(const Unit *unit, uint32_t offset) {
+    return offset < unit->size ? (const char *)unit->data + offset : "";
+}
+
+// FNV-1a
+uint32_t unitSymbolHash(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t mixHash(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+void unitPath(char *path, size_t size, const char *directory, const char *name) {
+    snprintf(path, size, "%s/%s%s", directory && *directory ? directory : ".", name, UNIT_EXTENSION);
+}
+
+// Seção de count elementos de size bytes dentro do arquivo e alinhada
+static bool validSection(const Unit *unit, uint32_t offset, uint32_t count, size_t size, size_t align) {
+    return offset % align == 0 && offset <= unit->size && (uint64_t)count * size <= unit->size - offset;
+}
+
+static bool validHeader(const Unit *unit) {
+    const UnitHeader *h = header(unit);
+    return h->bucket_count > 0 && (h->bucket_count & (h->bucket_count - 1)) == 0 &&
+           h->variable_count <= h->symbol_count &&
+           validSection(unit, h->symbols, h->symbol_count, sizeof(UnitSymbol), 4) &&
+           validSection(unit, h->buckets, h->bucket_count, sizeof(uint32_t), 4) &&
+           validSection(unit, h->dependencies, h->dependency_count, sizeof(UnitDependency), 8) &&
+           validSection(unit, h->imports, h->import_count, sizeof(UnitImport), 4) &&
+           validSection(unit, h->global_types, h->global_count, 1, 1) &&
+           validSection(unit, h->functions, h->function_count, sizeof(UnitFunction), 4) &&
+           validSection(unit, h->constants, h->constant_count, sizeof(Value), 8) &&
+           validSection(unit, h->strings, h->string_count, sizeof(uint32_t), 4);
+}
+
+static bool mapFile(Unit *unit, const char *path) {
+#ifdef HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    unit->data = data;
+    unit->size = (size_t)st.st_size;
+    unit->mapped = true;
+    return true;
+#else
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    // Num diretório o ftell devolve LONG_MAX; num pipe o fseek falha
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length < 0 || length == LONG_MAX || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return false;
+    }
+    uint8_t *data = length > 0 ? checkedRealloc(NULL, (size_t)length) : NULL;
+    bool ok = data && fread(data, 1, (size_t)length, file) == (size_t)length;
+    fclose(file);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+    unit->data = data;
+    unit->size = (size_t)length;
+    return true;
+#endif
+}
+
+Unit *openUnit(const char *directory, const char *name, const char **reason) {
+    char path[1024];
+    unitPath(path, sizeof(path), directory, name);
+    Unit *unit = checkedRealloc(NULL, sizeof(Unit));
+    memset(unit, 0, sizeof(*unit));
+    if (!mapFile(unit, path)) {
+        free(unit);
+        *reason = "file not found";
+        return NULL;
+    }
+    unit->name = checkedStrdup(name);
+    unit->directory = checkedStrdup(directory && *directory ? directory : ".");
+
+    const UnitHeader *h = header(unit);
+    if (unit->size < sizeof(UnitHeader) || memcmp(h->magic, UNIT_MAGIC, 4) != 0) {
+        *reason = "not a unit file";
+    } else if (h->version != UNIT_VERSION) {
+        *reason = "compiled by another version";
+    } else if (unit->data[unit->size - 1] != '\0' || !validHeader(unit)) {
+        *reason = "corrupt file";
+    } else if (strcmp(text(unit, h->name), name) != 0) {
+        *reason = "file contains another unit";
+    } else {
+        return unit;
+    }
+    closeUnit(unit);
+    return NULL;
+}
+
+void closeUnit(Unit *unit) {
+    if (!unit) return;
+    for (uint32_t i = 0; unit->symbols && i < header(unit)->symbol_count; i++) {
+        if (!unit->symbols[i]) continue;
+        free(unit->symbols[i]->name);
+        free(unit->symbols[i]->param_types);
+        free(unit->symbols[i]);
+    }
+    free(unit->symbols);
+#ifdef HAVE_MMAP
+    if (unit->mapped) munmap((void *)unit->data, unit->size);
+#else
+    free((void *)unit->data);
+#endif
+    free(unit->name);
+    free(unit->directory);
+    free(unit);
+}
+
+uint64_t unitInterfaceHash(const Unit *unit) {
+    return header(unit)->interface_hash;
+}
+
+uint64_t unitBuildKey(const char *source, int opt_level) {
+    uint64_t hash = mixHash(1469598103934665603ULL, source, strlen(source));
+    return mixHash(hash, &opt_level, sizeof(opt_level));
+}
+
+uint64_t unitRecordedKey(const Unit *unit) {
+    return header(unit)->build_key;
+}
+
+int unitDependencyCount(const Unit *unit) {
+    return (int)header(unit)->dependency_count;
+}
+
+const char *unitDependency(const Unit *unit, int i, uint64_t *interface_hash) {
+    const UnitDependency *dependency = &((const UnitDependency *)(unit->data + header(unit)->dependencies))[i];
+    *interface_hash = dependency->interface_hash;
+    return text(unit, dependency->name);
+}
+
+bool useUnit(SymbolTable *table, Unit *unit) {
+    for (int i = 0; i < table->unit_count; i++) {
+        if (strcmp(table->units[i]->name, unit->name) == 0) return false;
+    }
+    unit->global_start = table->variable_count;
+    table->variable_count += (int)header(unit)->variable_count;
+    table->units = checkedRealloc(table->units, sizeof(Unit *) * (table->unit_count + 1));
+    table->units[table->unit_count++] = unit;
+    return true;
+}
+
+// Busca no índice mapeado; devolve o número do registro ou -1
+static int lookupRecord(const Unit *unit, const char *name, uint32_t hash) {
+    const UnitHeader *h = header(unit);
+    const UnitSymbol *symbols = records(unit);
+    const uint32_t *buckets = (const uint32_t *)(unit->data + h->buckets);
+    for (uint32_t i = buckets[hash & (h->bucket_count - 1)]; i > 0 && i <= h->symbol_count; i = symbols[i - 1].next) {
+        const UnitSymbol *s = &symbols[i - 1];
+        if (s->hash == hash && strcmp(text(unit, s->name), name) == 0) return (int)i - 1;
+    }
+    return -1;
+}
+
+Symbol *findUnitSymbol(SymbolTable *table, int index, const char *name, uint32_t hash) {
+    Unit *unit = table->units[index];
+    int record = lookupRecord(unit, name, hash);
+    if (record < 0) return NULL;
+    if (!unit->symbols) {
+        unit->symbols = checkedRealloc(NULL, sizeof(Symbol *) * header(unit)->symbol_count);
+        memset(unit->symbols, 0, sizeof(Symbol *) * header(unit)->symbol_count);
+    }
+    if (unit->symbols[record]) return unit->symbols[record];
+
+    // Primeira consulta ao registro: o Symbol aponta para o segmento ou para a importação
+    const UnitSymbol *s = &records(unit)[record];
+    bool variable = (uint32_t)record < header(unit)->variable_count;
+    if (variable != (s->type != TYPE_PROCEDURE)) return NULL;
+    Symbol *symbol = checkedRealloc(NULL, sizeof(Symbol));
+    memset(symbol, 0, sizeof(*symbol));
+    symbol->name = checkedStrdup(name);
+    symbol->type = s->type <= TYPE_PROCEDURE ? (DataType)s->type : TYPE_UNKNOWN;
+    if (symbol->type == TYPE_PROCEDURE) {
+        table->imports = checkedRealloc(table->imports, sizeof(int) * 2 * (table->import_count + 1));
+        table->imports[2 * table->import_count] = index;
+        table->imports[2 * table->import_count + 1] = record;
+        symbol->index = -1 - table->import_count++;
+        if (validSection(unit, s->params, s->param_count, 1, 1)) {
+            symbol->param_count = s->param_count;
+            symbol->param_types = checkedRealloc(NULL, sizeof(DataType) * s->param_count);
+            for (int p = 0; p < s->param_count; p++) symbol->param_types[p] = (DataType)unit->data[s->params + p];
+        }
+    } else {
+        symbol->index = unit->global_start + record;
+    }
+    unit->symbols[record] = symbol;
+    return symbol;
+}
+
+void unitGlobalTypes(const Unit *unit, uint8_t *types) {
+    const UnitSymbol *symbols = records(unit);
+    for (uint32_t r = 0; r < header(unit)->variable_count; r++) {
+        types[unit->global_start + r] = symbols[r].type < TYPE_PROCEDURE ? symbols[r].type : TYPE_INTEGER;
+    }
+}
+
+// Arquivo montado na memória antes de ser gravado
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+static uint32_t append(Buffer *b, const void *data, size_t size, size_t align) {
+    size_t offset = (b->size + align - 1) & ~(align - 1);
+    if (offset + size > b->capacity) {
+        while (offset + size > b->capacity) b->capacity = b->capacity ? b->capacity * 2 : 4096;
+        b->data = checkedRealloc(b->data, b->capacity);
+    }
+    memset(b->data + b->size, 0, offset - b->size);
+    if (size) memcpy(b->data + offset, data, size);
+    b->size = offset + size;
+    return (uint32_t)offset;
+}
+
+static uint32_t appendString(Buffer *b, const char *text) {
+    return append(b, text, strlen(text) + 1, 1);
+}
+
+// Variáveis exportadas na ordem das globais e depois os procedimentos na ordem de declaração
+static int compareExports(const void *a, const void *b) {
+    const Symbol *x = *(const Symbol *const *)a, *y = *(const Symbol *const *)b;
+    bool px = x->type == TYPE_PROCEDURE, py = y->type == TYPE_PROCEDURE;
+    if (px != py) return px ? 1 : -1;
+    return x->index - y->index;
+}
+
+static bool writeFile(const char *path, const Buffer *b) {
+    // Grava ao lado e renomeia: quem lê o .ppu nunca vê um arquivo pela metade
+    char temp[1100];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    FILE *file = fopen(temp, "wb");
+    if (!file) {
+        perror("Error opening unit file");
+        return false;
+    }
+    bool ok = fwrite(b->data, 1, b->size, file) == b->size;
+    if (fclose(file) != 0) ok = false;
+    if (ok && rename(temp, path) != 0) {
+        perror("Error writing unit file");
+        ok = false;
+    }
+    if (!ok) remove(temp);
+    return ok;
+}
+
+bool writeUnit(const char *path, const AstNode *unit, const SymbolTable *globals, const BytecodeProgram *code,
+               uint64_t build_key) {
+    if (code->main_function != code->function_count - 1) {
+        fprintf(stderr, "Erro: bytecode da unit %s sem o bloco principal no fim\n", unit->as.program.name);
+        return false;
+    }
+    int export_count = 0;
+    for (Symbol *s = globals->head; s; s = s->next) export_count += s->exported;
+    Symbol **exports = checkedRealloc(NULL, sizeof(Symbol *) * export_count);
+    export_count = 0;
+    for (Symbol *s = globals->head; s; s = s->next) {
+        if (s->exported) exports[export_count++] = s;
+    }
+    qsort(exports, export_count, sizeof(Symbol *), compareExports);
+
+    Buffer b = {0};
+    UnitHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, UNIT_MAGIC, 4);
+    h.version = UNIT_VERSION;
+    h.build_key = build_key;
+    append(&b, &h, sizeof(h), 8);
+    h.name = appendString(&b, unit->as.program.name);
+
+    // Registros e índice: baldes em potência de dois, com no máximo meio registro por balde
+    uint64_t hash = mixHash(1469598103934665603ULL, unit->as.program.name, strlen(unit->as.program.name) + 1);
+    UnitSymbol *symbols = checkedRealloc(NULL, sizeof(UnitSymbol) * export_count);
+    h.bucket_count = 1;
+    while (h.bucket_count < 2 * (uint32_t)export_count) h.bucket_count *= 2;
+    uint32_t *buckets = checkedRealloc(NULL, sizeof(uint32_t) * h.bucket_count);
+    memset(buckets, 0, sizeof(uint32_t) * h.bucket_count);
+    for (int i = export_count - 1; i >= 0; i--) {
+        const Symbol *s = exports[i];
+        UnitSymbol *record = &symbols[i];
+        memset(record, 0, sizeof(*record));
+        record->name = appendString(&b, s->name);
+        record->hash = unitSymbolHash(s->name);
+        record->index = (uint32_t)s->index;
+        record->type = (uint8_t)s->type;
+        record->param_count = (uint16_t)s->param_count;
+        uint8_t params[256];
+        for (int p = 0; p < s->param_count && p < 256; p++) params[p] = (uint8_t)s->param_types[p];
+        record->params = append(&b, params, (size_t)s->param_count, 1);
+        uint32_t *bucket = &buckets[record->hash & (h.bucket_count - 1)];
+        record->next = *bucket;
+        *bucket = (uint32_t)i + 1;
+        if (s->type != TYPE_PROCEDURE) h.variable_count++;
+    }
+    for (int i = 0; i < export_count; i++) {
+        const Symbol *s = exports[i];
+        hash = mixHash(hash, s->name, strlen(s->name) + 1);
+        hash = mixHash(hash, &symbols[i].type, 1);
+        hash = mixHash(hash, b.data + symbols[i].params, symbols[i].param_count);
+        hash = mixHash(hash, "", 1);
+    }
+    h.interface_hash = hash;
+    h.symbol_count = (uint32_t)export_count;
+
+    UnitDependency *dependencies = checkedRealloc(NULL, sizeof(UnitDependency) * globals->unit_count);
+    for (int i = 0; i < globals->unit_count; i++) {
+        const Unit *used = globals->units[i];
+        dependencies[i].interface_hash = unitInterfaceHash(used);
+        dependencies[i].name = appendString(&b, used->name);
+        dependencies[i].global_start = (uint32_t)used->global_start;
+    }
+    UnitFunction *functions = checkedRealloc(NULL, sizeof(UnitFunction) * code->function_count);
+    h.function_count = (uint32_t)code->function_count - 1;
+    for (uint32_t i = 0; i < h.function_count; i++) {
+        const Function *f = &code->functions[i];
+        UnitFunction *out = &functions[i];
+        out->name = appendString(&b, f->name);
+        out->count = (uint32_t)f->count;
+        out->register_count = (uint32_t)f->register_count;
+        out->param_count = (uint32_t)f->param_count;
+        out->register_types = append(&b, f->register_types, (size_t)f->register_count, 1);
+        out->code = append(&b, f->code, sizeof(Instruction) * f->count, 8);
+        out->lines = append(&b, f->lines, sizeof(int) * f->count, 4);
+        out->columns = append(&b, f->columns, sizeof(int) * f->count, 4);
+    }
+    uint32_t *strings = checkedRealloc(NULL, sizeof(uint32_t) * code->string_count);
+    for (int i = 0; i < code->string_count; i++) strings[i] = appendString(&b, code->strings[i]);
+    h.string_count = (uint32_t)code->string_count;
+
+    h.symbols = append(&b, symbols, sizeof(UnitSymbol) * export_count, 8);
+    h.buckets = append(&b, buckets, sizeof(uint32_t) * h.bucket_count, 8);
+    h.dependencies = append(&b, dependencies, sizeof(UnitDependency) * globals->unit_count, 8);
+    h.dependency_count = (uint32_t)globals->unit_count;
+    UnitImport *imports = checkedRealloc(NULL, sizeof(UnitImport) * globals->import_count);
+    for (int i = 0; i < globals->import_count; i++) {
+        imports[i].dependency = (uint32_t)globals->imports[2 * i];
+        imports[i].symbol = (uint32_t)globals->imports[2 * i + 1];
+    }
+    h.imports = append(&b, imports, sizeof(UnitImport) * globals->import_count, 8);
+    h.import_count = (uint32_t)globals->import_count;
+    h.global_types = append(&b, code->global_types, (size_t)code->global_count, 8);
+    h.global_count = (uint32_t)code->global_count;
+    h.functions = append(&b, functions, sizeof(UnitFunction) * h.function_count, 8);
+    h.constants = append(&b, code->constants, sizeof(Value) * code->constant_count, 8);
+    h.constant_count = (uint32_t)code->constant_count;
+    h.strings = append(&b, strings, sizeof(uint32_t) * h.string_count, 8);
+    append(&b, "", 1, 1);
+    memcpy(b.data, &h, sizeof(h));
+
+    bool ok = b.size <= UINT32_MAX && writeFile(path, &b);
+    free(exports);
+    free(symbols);
+    free(buckets);
+    free(dependencies);
+    free(functions);
+    free(strings);
+    free(imports);
+    free(b.data);
+    return ok;
+}
+
+// Programa ou unit na ligação; as globais e funções próprias de cada módulo viram um
+// bloco contíguo do programa ligado
+typedef struct {
+    Unit *unit;               // NULL: o próprio programa
+    bool owned;               // Aberta pela ligação (dependência indireta)
+    int own_start;            // Primeira global própria no escopo do módulo
+    int own_count;
+    int global_base;          // Primeira global própria no programa ligado
+    int function_base;
+    int constant_base;
+    int string_base;
+    int *dependencies;        // Módulo de cada dependência
+} LinkModule;
+
+typedef struct {
+    LinkModule *modules;
+    int count;
+    int capacity;
+} Linker;
+
+static int addModule(Linker *l, Unit *unit, bool owned) {
+    if (l->count == l->capacity) {
+        l->capacity = l->capacity ? l->capacity * 2 : 16;
+        l->modules = checkedRealloc(l->modules, sizeof(LinkModule) * l->capacity);
+    }
+    LinkModule *m = &l->modules[l->count];
+    memset(m, 0, sizeof(*m));
+    m->unit = unit;
+    m->owned = owned;
+    return l->count++;
+}
+
+static int findModule(const Linker *l, const char *name) {
+    for (int i = 1; i < l->count; i++) {
+        if (strcmp(l->modules[i].unit->name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Abre as dependências indiretas e confere se cada unit foi compilada com a interface
+// atual das que ela usa
+static bool resolveDependencies(Linker *l, const SymbolTable *globals) {
+    l->modules[0].dependencies = checkedRealloc(NULL, sizeof(int) * (globals->unit_count + 1));
+    for (int i = 0; i < globals->unit_count; i++) {
+        l->modules[0].dependencies[i] = addModule(l, globals->units[i], false);
+    }
+    for (int m = 1; m < l->count; m++) {
+        const Unit *unit = l->modules[m].unit;
+        const UnitHeader *h = header(unit);
+        const UnitDependency *deps = (const UnitDependency *)(unit->data + h->dependencies);
+        int *resolved = checkedRealloc(NULL, sizeof(int) * (h->dependency_count + 1));
+        l->modules[m].dependencies = resolved;
+        for (uint32_t d = 0; d < h->dependency_count; d++) {
+            const char *name = text(unit, deps[d].name);
+            int found = findModule(l, name);
+            if (found < 0) {
+                const char *reason;
+                Unit *opened = openUnit(unit->directory, name, &reason);
+                if (!opened) {
+                    fprintf(stderr, "Erro: unit %s, usada por %s: %s\n", name, unit->name, reason);
+                    return false;
+                }
+                found = addModule(l, opened, true);
+                unit = l->modules[m].unit;
+            }
+            if (unitInterfaceHash(l->modules[found].unit) != deps[d].interface_hash) {
+                fprintf(stderr, "Erro: a interface de %s mudou depois que %s foi compilada; recompile %s\n",
+                        name, unit->name, unit->name);
+                return false;
+            }
+            resolved[d] = found;
+        }
+    }
+    return true;
+}
+
+// Global do programa ligado para cada global do escopo do módulo
+static int *globalMap(const Linker *l, int module, int local_count, const SymbolTable *globals) {
+    const LinkModule *m = &l->modules[module];
+    int *map = checkedRealloc(NULL, sizeof(int) * (local_count + 1));
+    for (int g = 0; g < local_count; g++) map[g] = -1;
+    for (int g = m->own_start; g < local_count; g++) map[g] = m->global_base + g - m->own_start;
+    int dependency_count = m->unit ? (int)header(m->unit)->dependency_count : globals->unit_count;
+    const UnitDependency *deps = m->unit ? (const UnitDependency *)(m->unit->data + header(m->unit)->dependencies) : NULL;
+    for (int d = 0; d < dependency_count; d++) {
+        const LinkModule *target = &l->modules[m->dependencies[d]];
+        int start = deps ? (int)deps[d].global_start : globals->units[d]->global_start;
+        const UnitSymbol *symbols = records(target->unit);
+        for (uint32_t r = 0; r < header(target->unit)->variable_count && start + (int)r < local_count; r++) {
+            // Índice fora das globais próprias da dependência: map fica -1 e relocate recusa o acesso
+            int own = (int)symbols[r].index - target->own_start;
+            if (symbols[r].index < (uint32_t)target->own_start || own >= target->own_count) continue;
+            map[start + r] = target->global_base + own;
+        }
+    }
+    return map;
+}
+
+// Função do programa ligado chamada por CALL k no módulo
+static int callTarget(const Linker *l, int module, int k, const SymbolTable *globals) {
+    const LinkModule *m = &l->modules[module];
+    if (k >= 0) return m->function_base + k;
+    int slot = -1 - k;
+    int dependency, record;
+    if (!m->unit) {
+        if (slot >= globals->import_count) return -1;
+        dependency = globals->imports[2 * slot];
+        record = globals->imports[2 * slot + 1];
+    } else {
+        const UnitHeader *h = header(m->unit);
+        if ((uint32_t)slot >= h->import_count) return -1;
+        const UnitImport *import = &((const UnitImport *)(m->unit->data + h->imports))[slot];
+        if (import->dependency >= h->dependency_count) return -1;
+        dependency = (int)import->dependency;
+        record = (int)import->symbol;
+    }
+    const LinkModule *target = &l->modules[m->dependencies[dependency]];
+    const UnitHeader *th = header(target->unit);
+    if ((uint32_t)record >= th->symbol_count) return -1;
+    const UnitSymbol *s = &records(target->unit)[record];
+    if (s->type != TYPE_PROCEDURE || s->index >= th->function_count) return -1;
+    // Quem chama empilha os argumentos da assinatura exportada
+    const UnitFunction *f = &((const UnitFunction *)(target->unit->data + th->functions))[s->index];
+    if (f->param_count != s->param_count) return -1;
+    return target->function_base + (int)s->index;
+}
+
+// Renumera as referências de uma função já copiada para o programa ligado
+static bool relocate(const Linker *l, int module, Function *f, const int *map, int local_globals,
+                     int local_constants, int local_strings, int function_limit, const SymbolTable *globals) {
+    const LinkModule *m = &l->modules[module];
+    for (int i = 0; i < f->count; i++) {
+        Instruction *ins = &f->code[i];
+        if (ins->op >= OP_COUNT) return false;
+        // A VM e os back-ends confiam nos operandos: um .ppu corrompido não pode escapar do quadro
+        int operands = opcodeOperands((OpCode)ins->op);
+        if (((operands & (OPERAND_DEF_A | OPERAND_USE_A)) && ins->a >= f->register_count) ||
+            ((operands & OPERAND_USE_B) && ins->b >= f->register_count) ||
+            ((operands & OPERAND_USE_C) && ins->c >= f->register_count)) {
+            return false;
+        }
+        switch (ins->op) {
+            case OP_LOADG: case OP_STOREG:
+                if (ins->k < 0 || ins->k >= local_globals || map[ins->k] < 0) return false;
+                ins->k = map[ins->k];
+                break;
+            case OP_CALL: {
+                int target = callTarget(l, module, ins->k, globals);
+                if (target < 0 || target >= function_limit) return false;
+                ins->k = target;
+                break;
+            }
+            case OP_LOADK:
+                if (ins->k < 0 || ins->k >= local_constants) return false;
+                ins->k += m->constant_base;
+                break;
+            case OP_WRITE_S:
+                if (ins->k < 0 || ins->k >= local_strings) return false;
+                ins->k += m->string_base;
+                break;
+            case OP_JMP: case OP_JMPF: case OP_JMPT:
+                if (ins->k < 0 || ins->k >= f->count) return false;
+                break;
+            case OP_PROFILE: case OP_HALT:
+            case OP_LOADX: case OP_STOREX: case OP_VLOOP:   // Units não declaram arrays
+                if (m->unit) return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// Copia a função i da unit, que ainda referencia o escopo da própria unit
+static bool copyFunction(const Unit *unit, uint32_t i, Function *out) {
+    const UnitFunction *f = &((const UnitFunction *)(unit->data + header(unit)->functions))[i];
+    if (!validSection(unit, f->code, f->count, sizeof(Instruction), 8) ||
+        !validSection(unit, f->lines, f->count, sizeof(int), 4) ||
+        !validSection(unit, f->columns, f->count, sizeof(int), 4) ||
+        !validSection(unit, f->register_types, f->register_count, 1, 1) ||
+        f->register_count > MAX_REGISTERS || f->param_count > f->register_count || f->param_count > MAX_ARGS) {
+        return false;
+    }
+    const char *name = text(unit, f->name);
+    out->name = checkedRealloc(NULL, strlen(unit->name) + strlen(name) + 2);
+    sprintf(out->name, "%s.%s", unit->name, name);
+    out->count = out->capacity = (int)f->count;
+    out->register_count = (int)f->register_count;
+    out->param_count = (int)f->param_count;
+    out->code = checkedRealloc(NULL, sizeof(Instruction) * f->count);
+    out->lines = checkedRealloc(NULL, sizeof(int) * f->count);
+    out->columns = checkedRealloc(NULL, sizeof(int) * f->count);
+    out->register_types = checkedRealloc(NULL, f->register_count + 1);
+    memcpy(out->code, unit->data + f->code, sizeof(Instruction) * f->count);
+    memcpy(out->lines, unit->data + f->lines, sizeof(int) * f->count);
+    memcpy(out->columns, unit->data + f->columns, sizeof(int) * f->count);
+    memcpy(out->register_types, unit->data + f->register_types, f->register_count);
+    return true;
+}
+
+// Sem unit: o problema está nos registros que o programa importou
+static void reportCorrupt(const Unit *unit) {
+    if (unit) fprintf(stderr, "Erro: %s" UNIT_EXTENSION " está corrompido\n", unit->name);
+    else fprintf(stderr, "Erro: uma das units usadas está corrompida\n");
+}
+
+static void freeLinker(Linker *l) {
+    for (int i = 0; i < l->count; i++) {
+        if (l->modules[i].owned) closeUnit(l->modules[i].unit);
+        free(l->modules[i].dependencies);
+    }
+    free(l->modules);
+}
+
+bool linkUnits(BytecodeProgram *program, const SymbolTable *globals) {
+    if (globals->unit_count == 0) return true;
+    Linker l = {0};
+    addModule(&l, NULL, false);
+    bool ok = resolveDependencies(&l, globals);
+
+    // Layout: o programa primeiro, com as mesmas funções, e as units na ordem em que apareceram
+    int global_count = 0, function_count = program->function_count;
+    int constant_count = program->constant_count, string_count = program->string_count;
+    for (int i = 0; ok && i < l.count; i++) {
+        LinkModule *m = &l.modules[i];
+        int dependency_count = m->unit ? (int)header(m->unit)->dependency_count : globals->unit_count;
+        int local_count = m->unit ? (int)header(m->unit)->global_count : program->global_count;
+        for (int d = 0; d < dependency_count; d++) {
+            const Unit *target = l.modules[m->dependencies[d]].unit;
+            int start = m->unit ? (int)((const UnitDependency *)(m->unit->data + header(m->unit)->dependencies))[d].global_start
+                                : target->global_start;
+            int end = start + (int)header(target)->variable_count;
+            if (end > m->own_start) m->own_start = end;
+        }
+        if (m->own_start > local_count) {
+            reportCorrupt(m->unit);
+            ok = false;
+            break;
+        }
+        m->own_count = local_count - m->own_start;
+        m->global_base = global_count;
+        global_count += m->own_count;
+        if (!m->unit) continue;
+        m->function_base = function_count;
+        m->constant_base = constant_count;
+        m->string_base = string_count;
+        function_count += (int)header(m->unit)->function_count;
+        constant_count += (int)header(m->unit)->constant_count;
+        string_count += (int)header(m->unit)->string_count;
+    }
+    if (!ok) {
+        freeLinker(&l);
+        return false;
+    }
+
+    uint8_t *global_types = checkedRealloc(NULL, (size_t)global_count + 1);
+    memset(global_types, 0, (size_t)global_count + 1);
+    program->functions = checkedRealloc(program->functions, sizeof(Function) * function_count);
+    memset(program->functions + program->function_count, 0,
+           sizeof(Function) * (function_count - program->function_count));
+    program->constants = checkedRealloc(program->constants, sizeof(Value) * (constant_count + 1));
+    program->strings = checkedRealloc(program->strings, sizeof(char *) * (string_count + 1));
+    memset(program->strings + program->string_count, 0, sizeof(char *) * (string_count - program->string_count));
+
+    for (int i = 0; ok && i < l.count; i++) {
+        const LinkModule *m = &l.modules[i];
+        const Unit *unit = m->unit;
+        int local_globals = unit ? (int)header(unit)->global_count : program->global_count;
+        const uint8_t *local_types = unit ? unit->data + header(unit)->global_types : program->global_types;
+        memcpy(global_types + m->global_base, local_types + m->own_start, (size_t)m->own_count);
+        int *map = globalMap(&l, i, local_globals, globals);
+        if (!unit) {
+            for (int f = 0; ok && f < program->function_count; f++) {
+                ok = relocate(&l, i, &program->functions[f], map, local_globals, program->constant_count,
+                              program->string_count, function_count, globals);
+            }
+        } else {
+            const UnitHeader *h = header(unit);
+            memcpy(program->constants + m->constant_base, unit->data + h->constants, sizeof(Value) * h->constant_count);
+            const uint32_t *strings = (const uint32_t *)(unit->data + h->strings);
+            for (uint32_t s = 0; s < h->string_count; s++) {
+                program->strings[m->string_base + s] = checkedStrdup(text(unit, strings[s]));
+            }
+            for (uint32_t f = 0; ok && f < h->function_count; f++) {
+                Function *out = &program->functions[m->function_base + f];
+                ok = copyFunction(unit, f, out) &&
+                     relocate(&l, i, out, map, local_globals, (int)h->constant_count, (int)h->string_count,
+                              function_count, globals);
+            }
+        }
+        free(map);
+        if (!ok) reportCorrupt(unit);
+    }
+
+    // Mesmo com erro o programa fica consistente para freeBytecode
+    program->function_count = function_count;
+    program->constant_count = constant_count;
+    for (int s = program->string_count; s < string_count; s++) {
+        if (!program->strings[s]) program->strings[s] = checkedStrdup("");
+    }
+    program->string_count = string_count;
+    free(program->global_types);
+    program->global_types = global_types;
+    program->global_count = global_count;
+    freeLinker(&l);
+    return ok;
+}
@@ -0,0 +1,57 @@
+#ifndef UNIT_H
+#define UNIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ast.h"
+#include "symbol_table.h"
+#include "bytecode.h"
+
+// Units pré-compiladas. Compilar "unit X" grava X.ppu com os símbolos exportados (tipos e
+// assinaturas) e um índice de hash, as dependências e o bytecode da unit. Quem usa a unit
+// mapeia o arquivo com mmap e findSymbol procura os nomes direto no índice mapeado: só os
+// símbolos encontrados viram um Symbol. O bytecode das units entra no programa na ligação,
+// depois da geração de código, em qualquer nível de otimização.
+#define UNIT_EXTENSION ".ppu"
+
+struct Unit {
+    char *name;
+    char *directory;          // Onde as dependências da unit são procuradas
+    const uint8_t *data;      // Arquivo mapeado (ou lido, sem mmap)
+    size_t size;
+    bool mapped;
+    int global_start;         // Segmento das variáveis exportadas no escopo de quem a usa
+    Symbol **symbols;         // Symbol de cada registro já consultado
+};
+
+// <directory>/<name>.ppu
+void unitPath(char *path, size_t size, const char *directory, const char *name);
+// Abre e valida o arquivo; em caso de erro devolve NULL e a causa em reason
+Unit *openUnit(const char *directory, const char *name, const char **reason);
+void closeUnit(Unit *unit);
+// Hash dos registros exportados: só muda quando quem usa a unit precisa ser recompilado
+uint64_t unitInterfaceHash(const Unit *unit);
+// Chave de compilação: fonte e nível de otimização com que o .ppu foi gerado
+uint64_t unitBuildKey(const char *source, int opt_level);
+uint64_t unitRecordedKey(const Unit *unit);
+// Dependência i da unit e o hash da interface dela quando a unit foi compilada
+int unitDependencyCount(const Unit *unit);
+const char *unitDependency(const Unit *unit, int i, uint64_t *interface_hash);
+
+// uses: reserva o segmento de globais da unit no escopo e a torna visível a findSymbol;
+// false se a unit já está em uso
+bool useUnit(SymbolTable *table, Unit *unit);
+// hash = unitSymbolHash(name), calculado uma vez para todas as units consultadas
+uint32_t unitSymbolHash(const char *name);
+Symbol *findUnitSymbol(SymbolTable *table, int unit, const char *name, uint32_t hash);
+void unitGlobalTypes(const Unit *unit, uint8_t *types);
+
+// Grava a unit analisada; code é o bytecode dela, com o bloco principal (vazio) por último
+bool writeUnit(const char *path, const AstNode *unit, const SymbolTable *globals, const BytecodeProgram *code,
+               uint64_t build_key);
+// Acrescenta ao programa o código de todas as units alcançáveis por uses e renumera
+// globais, chamadas, constantes e strings
+bool linkUnits(BytecodeProgram *program, const SymbolTable *globals);
+
+#endif
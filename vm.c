@@ -0,0 +1,391 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vm.h"
+#include "runtime.h"
+
+#define STACK_SIZE (1 << 20)
+#define MAX_FRAMES 65536
+
+// Quadro de ativação: função em execução, ponto de retorno e base dos registradores
+typedef struct {
+    const Function *function;
+    const Instruction *return_ip;
+    Value *base;
+} Frame;
+
+// Despacho direto por goto computado quando o compilador suporta
+#if defined(__GNUC__)
+#define USE_COMPUTED_GOTO 1
+#endif
+
+static const char *super_names[] = {
+#define X(a, b) #a "_" #b,
+    SUPERINSTRUCTIONS(X)
+#undef X
+#define X(a, b, c) #a "_" #b "_" #c,
+    SUPERINSTRUCTIONS3(X)
+#undef X
+};
+
+const char *vmOpcodeName(int op) {
+    return op < OP_COUNT ? opcodeName((OpCode)op) : op < VM_OPCODE_COUNT ? super_names[op - OP_COUNT] : "?";
+}
+
+// Sequências reconhecidas pela fusão; as de três vêm antes para terem prioridade
+typedef struct {
+    uint8_t fused;
+    uint8_t ops[3];
+    int length;
+} Sequence;
+
+static const Sequence sequences[] = {
+#define X(a, b, c) {OP_##a##_##b##_##c, {OP_##a, OP_##b, OP_##c}, 3},
+    SUPERINSTRUCTIONS3(X)
+#undef X
+#define X(a, b) {OP_##a##_##b, {OP_##a, OP_##b, 0}, 2},
+    SUPERINSTRUCTIONS(X)
+#undef X
+};
+
+// Troca o opcode do início de cada sequência pela superinstrução; uma sequência
+// não pode conter o destino de um desvio, exceto na primeira posição
+static void fuseSuperinstructions(Instruction *code, int count) {
+    bool *target = calloc(count + 1, sizeof(bool));
+    if (!target) {
+        fprintf(stderr, "Erro de alocação de memória na máquina virtual\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; i++) {
+        if (opcodeOperands((OpCode)code[i].op) & OPERAND_JUMP) target[code[i].k] = true;
+    }
+    for (int i = 0; i < count;) {
+        const Sequence *match = NULL;
+        for (size_t s = 0; s < sizeof(sequences) / sizeof(sequences[0]) && !match; s++) {
+            const Sequence *seq = &sequences[s];
+            if (i + seq->length > count) continue;
+            bool ok = true;
+            for (int j = 0; j < seq->length && ok; j++) {
+                ok = code[i + j].op == seq->ops[j] && (j == 0 || !target[i + j]);
+            }
+            if (ok) match = seq;
+        }
+        if (match) {
+            code[i].op = match->fused;
+            i += match->length;
+        } else {
+            i++;
+        }
+    }
+    free(target);
+}
+
+// Distância de cada opcode até a instrução seguinte ao desvio que ele executa por
+// último (0 se não desvia); uma superinstrução termina no desvio da sequência
+static void branchLengths(uint8_t *length) {
+    memset(length, 0, VM_OPCODE_COUNT);
+    length[OP_JMP] = length[OP_JMPF] = length[OP_JMPT] = 1;
+    for (size_t s = 0; s < sizeof(sequences) / sizeof(sequences[0]); s++) {
+        const Sequence *seq = &sequences[s];
+        if (opcodeOperands((OpCode)seq->ops[seq->length - 1]) & OPERAND_JUMP) length[seq->fused] = (uint8_t)seq->length;
+    }
+}
+
+// Amostra pendente: a instrução prestes a executar e os procedimentos ativos
+static void sampleExecution(Profile *profile, const Function *functions, const Frame *frames, int frame_count,
+                            const Function *function, const Instruction *ins) {
+    int stack[PROFILE_MAX_DEPTH];
+    int depth = 0;
+    for (int i = frame_count > PROFILE_MAX_DEPTH - 1 ? frame_count - (PROFILE_MAX_DEPTH - 1) : 0; i < frame_count; i++) {
+        stack[depth++] = (int)(frames[i].function - functions);
+    }
+    profile_pending = 0;
+    recordSample(profile, stack, depth, (int)(function - functions), (int)(ins - function->code));
+}
+
+// Corpo de cada instrução simples, compartilhado pelo despacho normal e pelas superinstruções
+#define DO_NOP
+#define DO_MOV R(ins->a) = R(ins->b);
+#define DO_LOADI R(ins->a).i = ins->k;
+#define DO_LOADK R(ins->a) = constants[ins->k];
+#define DO_LOADG R(ins->a) = globals[ins->k];
+#define DO_STOREG globals[ins->k] = R(ins->a);
+
+// Elementos de array: com o índice deslocado e sem sinal, uma comparação cobre os dois limites
+#define ELEMENT(array) \
+    const ArrayInfo *array = &program->arrays[ins->c]; \
+    uint64_t element = (uint64_t)R(ins->b).i - (uint64_t)(int64_t)array->low; \
+    if (element >= (uint64_t)array->length) pas_runtime_error("index out of range");
+#define DO_LOADX { ELEMENT(array) R(ins->a) = arrays[array->offset + element]; }
+#define DO_STOREX { ELEMENT(array) arrays[array->offset + element] = R(ins->a); }
+
+// Aritmética inteira com volta em caso de estouro
+#define DO_ADD_I R(ins->a).i = (int64_t)((uint64_t)R(ins->b).i + (uint64_t)R(ins->c).i);
+#define DO_SUB_I R(ins->a).i = (int64_t)((uint64_t)R(ins->b).i - (uint64_t)R(ins->c).i);
+#define DO_MUL_I R(ins->a).i = (int64_t)((uint64_t)R(ins->b).i * (uint64_t)R(ins->c).i);
+#define DO_DIV_I \
+    if (R(ins->c).i == 0) pas_runtime_error("division by zero"); \
+    R(ins->a).i = R(ins->c).i == -1 ? (int64_t)(0 - (uint64_t)R(ins->b).i) : R(ins->b).i / R(ins->c).i;
+#define DO_MOD_I \
+    if (R(ins->c).i == 0) pas_runtime_error("division by zero"); \
+    R(ins->a).i = R(ins->c).i == -1 ? 0 : R(ins->b).i % R(ins->c).i;
+#define DO_NEG_I R(ins->a).i = (int64_t)(0 - (uint64_t)R(ins->b).i);
+
+#define DO_ADD_R R(ins->a).r = R(ins->b).r + R(ins->c).r;
+#define DO_SUB_R R(ins->a).r = R(ins->b).r - R(ins->c).r;
+#define DO_MUL_R R(ins->a).r = R(ins->b).r * R(ins->c).r;
+#define DO_DIV_R R(ins->a).r = R(ins->b).r / R(ins->c).r;
+#define DO_NEG_R R(ins->a).r = -R(ins->b).r;
+#define DO_I2R R(ins->a).r = (double)R(ins->b).i;
+
+#define DO_EQ_I R(ins->a).i = R(ins->b).i == R(ins->c).i;
+#define DO_NE_I R(ins->a).i = R(ins->b).i != R(ins->c).i;
+#define DO_LT_I R(ins->a).i = R(ins->b).i < R(ins->c).i;
+#define DO_LE_I R(ins->a).i = R(ins->b).i <= R(ins->c).i;
+#define DO_GT_I R(ins->a).i = R(ins->b).i > R(ins->c).i;
+#define DO_GE_I R(ins->a).i = R(ins->b).i >= R(ins->c).i;
+#define DO_EQ_R R(ins->a).i = R(ins->b).r == R(ins->c).r;
+#define DO_NE_R R(ins->a).i = R(ins->b).r != R(ins->c).r;
+#define DO_LT_R R(ins->a).i = R(ins->b).r < R(ins->c).r;
+#define DO_LE_R R(ins->a).i = R(ins->b).r <= R(ins->c).r;
+#define DO_GT_R R(ins->a).i = R(ins->b).r > R(ins->c).r;
+#define DO_GE_R R(ins->a).i = R(ins->b).r >= R(ins->c).r;
+
+#define DO_AND R(ins->a).i = R(ins->b).i & R(ins->c).i;
+#define DO_OR R(ins->a).i = R(ins->b).i | R(ins->c).i;
+#define DO_NOT R(ins->a).i = !R(ins->b).i;
+
+#define DO_JMP ip = function->code + ins->k;
+#define DO_JMPF if (!R(ins->a).i) ip = function->code + ins->k;
+#define DO_JMPT if (R(ins->a).i) ip = function->code + ins->k;
+
+#define DO_WRITE_I pas_write_integer(R(ins->a).i);
+#define DO_WRITE_R pas_write_real(R(ins->a).r);
+#define DO_WRITE_B pas_write_boolean(R(ins->a).i);
+#define DO_WRITE_S pas_write_string(program->strings[ins->k]);
+#define DO_WRITELN pas_writeln();
+#define DO_READ_I R(ins->a).i = pas_read_integer();
+#define DO_READ_R R(ins->a).r = pas_read_real();
+#define DO_PROFILE counters[ins->k]++;
+
+#define SIMPLE_OPCODES(X) \
+    X(NOP) X(MOV) X(LOADI) X(LOADK) X(LOADG) X(STOREG) X(LOADX) X(STOREX) \
+    X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(MOD_I) X(NEG_I) \
+    X(ADD_R) X(SUB_R) X(MUL_R) X(DIV_R) X(NEG_R) X(I2R) \
+    X(EQ_I) X(NE_I) X(LT_I) X(LE_I) X(GT_I) X(GE_I) \
+    X(EQ_R) X(NE_R) X(LT_R) X(LE_R) X(GT_R) X(GE_R) \
+    X(AND) X(OR) X(NOT) X(JMP) X(JMPF) X(JMPT) \
+    X(WRITE_I) X(WRITE_R) X(WRITE_B) X(WRITE_S) X(WRITELN) X(READ_I) X(READ_R) X(PROFILE)
+
+// Laço vetorizado (VLOOP): a máquina virtual avalia o kernel elemento a elemento, na
+// ordem do laço original, com um despacho por operação em vez de um por instrução
+static Value runKernel(const Kernel *kernel, Value *arrays, const Value *args) {
+    int64_t start = args[0].i, count = args[1].i;
+    bool reduces = kernel->reduction >= 0;
+    Value acc = reduces ? args[2] : (Value){.i = 0};
+    const Value *inputs = args + 2 + reduces;
+    Value v[KERNEL_MAX_OPS] = {0};
+    for (int n = 0; n < kernel->op_count; n++) {
+        if (kernel->ops[n].op == OP_ARG) v[n] = inputs[kernel->ops[n].k];
+    }
+    for (int64_t j = 0; j < count; j++) {
+        for (int n = 0; n < kernel->op_count; n++) {
+            const KernelOp *op = &kernel->ops[n];
+            Value a = v[op->a], b = v[op->b];
+            switch (op->op) {
+                case OP_LOADX: v[n] = arrays[start + op->k + j]; break;
+                case OP_STOREX: arrays[start + op->k + j] = a; break;
+                case OP_ADD_I: v[n].i = (int64_t)((uint64_t)a.i + (uint64_t)b.i); break;
+                case OP_SUB_I: v[n].i = (int64_t)((uint64_t)a.i - (uint64_t)b.i); break;
+                case OP_MUL_I: v[n].i = (int64_t)((uint64_t)a.i * (uint64_t)b.i); break;
+                case OP_NEG_I: v[n].i = (int64_t)(0 - (uint64_t)a.i); break;
+                case OP_ADD_R: v[n].r = a.r + b.r; break;
+                case OP_SUB_R: v[n].r = a.r - b.r; break;
+                case OP_MUL_R: v[n].r = a.r * b.r; break;
+                case OP_DIV_R: v[n].r = a.r / b.r; break;
+                default: break;
+            }
+        }
+        if (!reduces) continue;
+        Value x = v[kernel->reduction];
+        switch (kernel->reduction_op) {
+            case OP_ADD_I: acc.i = (int64_t)((uint64_t)acc.i + (uint64_t)x.i); break;
+            case OP_SUB_I: acc.i = (int64_t)((uint64_t)acc.i - (uint64_t)x.i); break;
+            case OP_ADD_R: acc.r += x.r; break;
+            default: acc.r -= x.r; break;
+        }
+    }
+    return acc;
+}
+
+int runProgram(const BytecodeProgram *program, const VMOptions *options, VMStats *stats) {
+    Value *stack = calloc(STACK_SIZE, sizeof(Value));
+    Value *globals = calloc(program->global_count + 1, sizeof(Value));
+    Value *arrays = calloc((size_t)program->array_slots + 1, sizeof(Value));
+    Frame *frames = malloc(sizeof(Frame) * MAX_FRAMES);
+    uint64_t *own_counters = options->counters ? NULL : calloc(program->counter_count + 1, sizeof(uint64_t));
+    uint64_t *counters = options->counters ? options->counters : own_counters;
+    // Cópia das funções: a fusão troca opcodes sem alterar o programa,
+    // que ainda pode seguir para o back-end nativo
+    Function *functions = malloc(sizeof(Function) * (program->function_count + 1));
+    if (!stack || !globals || !arrays || !frames || !counters || !functions) {
+        fprintf(stderr, "Erro de alocação de memória na máquina virtual\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < program->function_count; i++) {
+        functions[i] = program->functions[i];
+        if (!options->superinstructions) continue;
+        Instruction *code = malloc(sizeof(Instruction) * (functions[i].count + 1));
+        if (!code) {
+            fprintf(stderr, "Erro de alocação de memória na máquina virtual\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(code, program->functions[i].code, sizeof(Instruction) * functions[i].count);
+        fuseSuperinstructions(code, functions[i].count);
+        functions[i].code = code;
+    }
+
+    Value args[MAX_ARGS];
+    int arg_count = 0;
+    int frame_count = 0;
+    uint64_t executed = 0;
+    // Perfil de pares e amostragem: no despacho por goto computado, uma tabela que passa por instrument
+    bool count_pairs = options->count_pairs && stats;
+    int previous = OP_NOP;
+    if (stats) memset(stats->pairs, 0, sizeof(stats->pairs));
+    // Desvios: o seguinte despacho mostra se o último desvio saltou
+    bool count_branches = options->count_branches && stats;
+    uint8_t branch_length[VM_OPCODE_COUNT];
+    const Instruction *branch_end = NULL;
+    if (count_branches) branchLengths(branch_length);
+    if (stats) stats->branches = stats->taken = 0;
+    Profile *profile = options->profile;
+    if (profile && !startProfile(profile, NULL)) profile = NULL;
+
+    const Value *constants = program->constants;
+    const Function *function = &functions[program->main_function];
+    const Instruction *ip = function->code;
+    const Instruction *ins;
+    Value *base = stack;
+
+#define R(x) base[(x)]
+
+#ifdef USE_COMPUTED_GOTO
+    static const void *dispatch_table[] = {
+#define X(name) &&op_##name,
+        OPCODES(X)
+#undef X
+#define X(a, b) &&op_##a##_##b,
+        SUPERINSTRUCTIONS(X)
+#undef X
+#define X(a, b, c) &&op_##a##_##b##_##c,
+        SUPERINSTRUCTIONS3(X)
+#undef X
+    };
+    static const void *profile_table[VM_OPCODE_COUNT];
+    for (int op = 0; op < VM_OPCODE_COUNT; op++) profile_table[op] = &&instrument;
+    const void *const *table = count_pairs || count_branches || profile ? profile_table : dispatch_table;
+#define NEXT() do { ins = ip++; executed++; goto *table[ins->op]; } while (0)
+#define CASE(name) op_##name:
+    NEXT();
+instrument:
+    if (count_pairs) {
+        stats->pairs[previous][ins->op]++;
+        previous = ins->op;
+    }
+    if (count_branches) {
+        if (branch_end) stats->taken += ins != branch_end;
+        branch_end = branch_length[ins->op] ? ins + branch_length[ins->op] : NULL;
+        stats->branches += branch_end != NULL;
+    }
+    if (profile_pending) sampleExecution(profile, functions, frames, frame_count, function, ins);
+    goto *dispatch_table[ins->op];
+#else
+#define NEXT() continue
+#define CASE(name) case OP_##name:
+    for (;;) {
+        ins = ip++;
+        executed++;
+        if (count_pairs) {
+            stats->pairs[previous][ins->op]++;
+            previous = ins->op;
+        }
+        if (count_branches) {
+            if (branch_end) stats->taken += ins != branch_end;
+            branch_end = branch_length[ins->op] ? ins + branch_length[ins->op] : NULL;
+            stats->branches += branch_end != NULL;
+        }
+        if (profile_pending) sampleExecution(profile, functions, frames, frame_count, function, ins);
+        switch (ins->op) {
+#endif
+
+#define X(name) CASE(name) DO_##name NEXT();
+    SIMPLE_OPCODES(X)
+#undef X
+
+    CASE(ARG)
+        // O compilador rejeita chamadas acima de MAX_ARGS; só um .ppu adulterado chega aqui
+        if (arg_count == MAX_ARGS) pas_runtime_error("too many arguments");
+        args[arg_count++] = R(ins->a);
+        NEXT();
+    CASE(CALL) {
+        const Function *callee = &functions[ins->k];
+        Value *callee_base = base + function->register_count;
+        if (frame_count == MAX_FRAMES || callee_base + callee->register_count > stack + STACK_SIZE) {
+            pas_runtime_error("stack overflow");
+        }
+        frames[frame_count++] = (Frame){function, ip, base};
+        memcpy(callee_base, args, sizeof(Value) * arg_count);
+        memset(callee_base + arg_count, 0, sizeof(Value) * (callee->register_count - arg_count));
+        arg_count = 0;
+        if (profile) profile->calls[ins->k]++;
+        function = callee;
+        base = callee_base;
+        ip = callee->code;
+        NEXT();
+    }
+    CASE(VLOOP)
+        R(ins->a) = runKernel(&program->kernels[ins->k], arrays, args);
+        arg_count = 0;
+        NEXT();
+    CASE(RET) {
+        Frame *frame = &frames[--frame_count];
+        function = frame->function;
+        ip = frame->return_ip;
+        base = frame->base;
+        NEXT();
+    }
+
+    CASE(HALT) goto done;
+
+    // Superinstruções: os corpos em sequência, cada um com os operandos da sua posição
+#define X(a, b) CASE(a##_##b) DO_##a ins = ip++; DO_##b NEXT();
+    SUPERINSTRUCTIONS(X)
+#undef X
+#define X(a, b, c) CASE(a##_##b##_##c) DO_##a ins = ip++; DO_##b ins = ip++; DO_##c NEXT();
+    SUPERINSTRUCTIONS3(X)
+#undef X
+
+#ifndef USE_COMPUTED_GOTO
+        }
+    }
+#endif
+
+done:
+#undef R
+#undef NEXT
+#undef CASE
+    if (profile) stopProfile();
+    pas_flush();
+    if (stats) stats->instructions = executed;
+    for (int i = 0; i < program->function_count && options->superinstructions; i++) {
+        free(functions[i].code);
+    }
+    free(functions);
+    free(stack);
+    free(globals);
+    free(arrays);
+    free(frames);
+    free(own_counters);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bytecode.h"
+#include "profile.h"
+
+// Superinstruções: sequências frequentes executadas com um único despacho,
+// escolhidas pelo perfil de pares de opcodes (--opcode-pairs) sobre os programas
+// de teste, com e sem -O2. A instrução fundida ocupa a posição da primeira da
+// sequência; as demais continuam no código e fornecem os próprios operandos
+#define SUPERINSTRUCTIONS(X) \
+    X(EQ_I, JMPT) X(EQ_I, JMPF) X(NE_I, JMPT) X(NE_I, JMPF) \
+    X(LT_I, JMPT) X(LT_I, JMPF) X(LE_I, JMPT) X(LE_I, JMPF) \
+    X(GT_I, JMPT) X(GT_I, JMPF) X(GE_I, JMPT) X(GE_I, JMPF) \
+    X(LOADI, ADD_I) X(LOADI, SUB_I) X(LOADI, MUL_I) X(LOADI, DIV_I) X(LOADI, MOD_I) \
+    X(STOREG, LOADG) X(LOADG, LOADG) X(LOADG, LOADI) X(ADD_I, STOREG) X(MUL_I, STOREG) X(STOREG, JMP) \
+    X(ADD_I, ADD_I) X(ADD_I, MUL_I) X(MUL_I, ADD_I) X(MOD_I, ADD_I) X(ADD_I, EQ_I) \
+    X(I2R, DIV_R) X(DIV_R, ADD_R)
+
+// Sequências de três: soma sobre uma global (carrega, soma, grava)
+#define SUPERINSTRUCTIONS3(X) \
+    X(LOADG, ADD_I, STOREG) X(LOADI, ADD_I, STOREG)
+
+enum {
+    VM_SUPER_BEFORE = OP_COUNT - 1,
+#define X(a, b) OP_##a##_##b,
+    SUPERINSTRUCTIONS(X)
+#undef X
+#define X(a, b, c) OP_##a##_##b##_##c,
+    SUPERINSTRUCTIONS3(X)
+#undef X
+    VM_OPCODE_COUNT
+};
+
+// Opções de execução
+typedef struct {
+    bool superinstructions;   // Funde as sequências acima antes de executar
+    bool count_pairs;         // Conta os pares de opcodes despachados em sequência
+    bool count_branches;      // Conta os desvios executados e os que saltaram
+    Profile *profile;         // Amostragem por SIGPROF e chamadas por procedimento (--profile)
+    uint64_t *counters;       // counter_count posições somadas por PROFILE; NULL descarta as contagens
+} VMOptions;
+
+// Contadores coletados durante a execução
+typedef struct {
+    uint64_t instructions;    // Despachos; uma superinstrução conta uma vez
+    uint64_t pairs[VM_OPCODE_COUNT][VM_OPCODE_COUNT];   // [anterior][atual], com count_pairs
+    uint64_t branches;        // Desvios executados, com count_branches
+    uint64_t taken;           // Desvios que não seguiram para a instrução seguinte
+} VMStats;
+
+// Executa o programa a partir do bloco principal; retorna o código de saída
+int runProgram(const BytecodeProgram *program, const VMOptions *options, VMStats *stats);
+const char *vmOpcodeName(int op);
+
+#endif
@@ -0,0 +1,515 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "workspace.h"
+#include "lexer.h"
+#include "parser.h"
+#include "semantic.h"
+#include "unit.h"
+
+typedef enum {
+    ITEM_HEADER,
+    ITEM_PROCEDURE,
+    ITEM_MAIN
+} ItemKind;
+
+struct WorkspaceItem {
+    ItemKind kind;
+    int id;
+    char *text;               // Do token que abre o item até o início do próximo
+    size_t length;
+    int lines;                // Quebras de linha em text
+    int column;               // Coluna do primeiro caractere no arquivo
+    int first_line;           // Linha do primeiro caractere, atualizada antes de cada verificação
+    Workspace *workspace;
+    Query text_input;         // Entrada: texto e coluna
+    Query tokens;             // Tokens com as linhas relativas ao item
+    Query outline;            // Procedimentos: nome e tipos dos parâmetros
+    Query check;              // Sintaxe, símbolos locais, tipos e diagnósticos do item
+};
+
+// O que o escopo global precisa de um procedimento
+typedef struct {
+    char *name;
+    int param_count;
+    DataType *param_types;
+    int line;                 // Do cabeçalho, relativa ao item
+} Outline;
+
+typedef struct {
+    DiagnosticBuffer diagnostics;   // Linhas relativas ao item
+} CheckResult;
+
+typedef struct {
+    SymbolTable *table;
+    DiagnosticBuffer diagnostics;   // Do cabeçalho, que começa na linha 1
+    int *duplicates;          // Itens cujo procedimento repete um nome já declarado
+    int duplicate_count;
+} Scope;
+
+// Início de um item encontrado ao dividir o fonte
+typedef struct {
+    size_t offset;
+    ItemKind kind;
+    int column;
+} Boundary;
+
+static void *checkedRealloc(void *memory, size_t size) {
+    void *result = realloc(memory, size);
+    if (!result) {
+        fprintf(stderr, "Erro de alocação de memória na análise incremental\n");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+// FNV-1a
+static uint64_t mixHash(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+#define HASH_SEED 1469598103934665603ULL
+
+// Os registros decidem se a verificação de um item mudou
+static uint64_t hashDiagnostics(const DiagnosticBuffer *diagnostics) {
+    uint64_t hash = HASH_SEED;
+    for (int i = 0; i < diagnostics->count; i++) {
+        const Diagnostic *record = &diagnostics->records[i];
+        hash = mixHash(hash, &record->code, sizeof(record->code));
+        hash = mixHash(hash, &record->line, sizeof(record->line));
+        hash = mixHash(hash, &record->column, sizeof(record->column));
+        hash = mixHash(hash, record->numbers, sizeof(record->numbers));
+        for (int k = 0; k < DIAGNOSTIC_TEXTS && record->texts[k]; k++) {
+            hash = mixHash(hash, record->texts[k], strlen(record->texts[k]) + 1);
+        }
+    }
+    return hash;
+}
+
+static uint64_t computeTokens(QueryDb *db, Query *query) {
+    WorkspaceItem *item = query->key;
+    queryGet(db, &item->text_input);
+    TokenList *tokens = checkedRealloc(NULL, sizeof(TokenList));
+    initTokenList(tokens);
+    // Os erros do lexer saem na hora, com a linha do arquivo; os tokens guardam a linha
+    // relativa ao item e não mudam quando o item é deslocado
+    Lexer lexer;
+    initLexer(&lexer, item->text);
+    lexer.line = item->first_line;
+    lexer.column = item->column;
+    lexBatch(&lexer, tokens, INT_MAX);
+    for (TokenNode *node = tokens->head; node; node = node->next) {
+        node->token.line -= item->first_line - 1;
+    }
+    query->value = tokens;
+    return item->text_input.hash;
+}
+
+static void discardTokens(Query *query) {
+    freeTokenList(query->value);
+    free(query->value);
+}
+
+static uint64_t computeOutline(QueryDb *db, Query *query) {
+    WorkspaceItem *item = query->key;
+    TokenList *tokens = queryGet(db, &item->tokens);
+    DiagnosticBuffer discarded;   // Os erros saem na verificação do item
+    initDiagnostics(&discarded);
+    Parser parser;
+    initParser(&parser, tokens, &discarded);
+    parseProcedureItem(&parser);
+
+    // O procedimento é o único símbolo global do item
+    Symbol *symbol = parser.symbol_table->head;
+    Outline *outline = checkedRealloc(NULL, sizeof(Outline));
+    outline->name = strdup(symbol ? symbol->name : "?");
+    outline->param_count = symbol ? symbol->param_count : 0;
+    outline->param_types = NULL;
+    if (outline->param_count > 0) {
+        size_t size = sizeof(DataType) * outline->param_count;
+        outline->param_types = checkedRealloc(NULL, size);
+        memcpy(outline->param_types, symbol->param_types, size);
+    }
+    outline->line = parser.program->as.program.procedures->line;
+    freeParser(&parser);
+    freeDiagnostics(&discarded);
+
+    query->value = outline;
+    uint64_t hash = mixHash(HASH_SEED, outline->name, strlen(outline->name) + 1);
+    return mixHash(hash, outline->param_types, sizeof(DataType) * outline->param_count);
+}
+
+static void discardOutline(Query *query) {
+    Outline *outline = query->value;
+    free(outline->name);
+    free(outline->param_types);
+    free(outline);
+}
+
+static uint64_t computeScope(QueryDb *db, Query *query) {
+    Workspace *workspace = query->key;
+    // A lista de itens é a primeira dependência: quando ela muda, as seguintes (talvez
+    // de itens já liberados) nem chegam a ser conferidas
+    queryGet(db, &workspace->layout);
+    WorkspaceItem *header = workspace->items[0];
+    TokenList *tokens = queryGet(db, &header->tokens);
+
+    Scope *scope = checkedRealloc(NULL, sizeof(Scope));
+    initDiagnostics(&scope->diagnostics);
+    Parser parser;
+    initParser(&parser, tokens, &scope->diagnostics);
+    parser.unit_dir = workspace->unit_dir;
+    parseHeaderItem(&parser);
+    scope->table = parser.symbol_table;
+    scope->duplicates = NULL;
+    scope->duplicate_count = 0;
+    // freeParser libera a tabela do parser: ele fica com uma vazia
+    parser.symbol_table = checkedRealloc(NULL, sizeof(SymbolTable));
+    initSymbolTable(parser.symbol_table);
+    freeParser(&parser);
+
+    uint64_t hash = mixHash(HASH_SEED, &header->text_input.hash, sizeof(uint64_t));
+    for (int i = 0; i < scope->table->unit_count; i++) {
+        uint64_t interface = unitInterfaceHash(scope->table->units[i]);
+        hash = mixHash(hash, &interface, sizeof(interface));
+    }
+    // Procedimentos depois do bloco principal não entram no programa
+    for (int i = 1; i < workspace->item_count && workspace->items[i]->kind == ITEM_PROCEDURE; i++) {
+        WorkspaceItem *item = workspace->items[i];
+        Outline *outline = queryGet(db, &item->outline);
+        if (!addProcedureSymbol(scope->table, outline->name, outline->param_count, outline->param_types)) {
+            scope->duplicates = checkedRealloc(scope->duplicates, sizeof(int) * (scope->duplicate_count + 1));
+            scope->duplicates[scope->duplicate_count++] = item->id;
+            hash = mixHash(hash, &item->id, sizeof(item->id));
+        }
+        hash = mixHash(hash, &item->outline.hash, sizeof(uint64_t));
+    }
+    query->value = scope;
+    return hash;
+}
+
+static void discardScope(Query *query) {
+    Scope *scope = query->value;
+    freeSymbolTable(scope->table);
+    free(scope->table);
+    freeDiagnostics(&scope->diagnostics);
+    free(scope->duplicates);
+    free(scope);
+}
+
+static uint64_t computeCheck(QueryDb *db, Query *query) {
+    WorkspaceItem *item = query->key;
+    Workspace *workspace = item->workspace;
+    TokenList *tokens = queryGet(db, &item->tokens);
+    Scope *scope = queryGet(db, &workspace->scope);
+
+    CheckResult *result = checkedRealloc(NULL, sizeof(CheckResult));
+    initDiagnostics(&result->diagnostics);
+    Parser parser;
+    initParser(&parser, tokens, &result->diagnostics);
+    bool parsed = item->kind == ITEM_MAIN ? parseMainItem(&parser) : parseProcedureItem(&parser);
+    // Como na análise do programa inteiro, a semântica só roda sobre um item sem erros
+    if (parsed && parser.error_count == 0) {
+        analyzeProgram(parser.program, scope->table, &parser.global_arena, &result->diagnostics, 1);
+    }
+    freeParser(&parser);
+
+    query->value = result;
+    return hashDiagnostics(&result->diagnostics);
+}
+
+static void discardCheck(Query *query) {
+    CheckResult *result = query->value;
+    freeDiagnostics(&result->diagnostics);
+    free(result);
+}
+
+static const QueryKind TOKENS_QUERY = {"tokens", computeTokens, discardTokens};
+static const QueryKind OUTLINE_QUERY = {"outline", computeOutline, discardOutline};
+static const QueryKind SCOPE_QUERY = {"scope", computeScope, discardScope};
+static const QueryKind CHECK_QUERY = {"check", computeCheck, discardCheck};
+
+static WorkspaceItem *createItem(Workspace *workspace, ItemKind kind) {
+    WorkspaceItem *item = checkedRealloc(NULL, sizeof(WorkspaceItem));
+    item->kind = kind;
+    item->id = workspace->next_id++;
+    item->text = NULL;
+    item->length = 0;
+    item->lines = 0;
+    item->column = 0;
+    item->first_line = 1;
+    item->workspace = workspace;
+    initQuery(&item->text_input, NULL, item);
+    initQuery(&item->tokens, &TOKENS_QUERY, item);
+    initQuery(&item->outline, &OUTLINE_QUERY, item);
+    initQuery(&item->check, &CHECK_QUERY, item);
+    return item;
+}
+
+static void freeItem(WorkspaceItem *item) {
+    freeQuery(&item->check);
+    freeQuery(&item->outline);
+    freeQuery(&item->tokens);
+    freeQuery(&item->text_input);
+    free(item->text);
+    free(item);
+}
+
+static void setItemInput(Workspace *workspace, WorkspaceItem *item) {
+    uint64_t hash = mixHash(HASH_SEED, item->text, item->length);
+    querySet(&workspace->db, &item->text_input, mixHash(hash, &item->column, sizeof(item->column)));
+}
+
+// Troca o texto do item; a entrada só avança a revisão se texto ou coluna mudaram
+static void setItemText(Workspace *workspace, WorkspaceItem *item, const char *text, size_t length, int column) {
+    if (item->text && item->length == length && item->column == column && memcmp(item->text, text, length) == 0) {
+        return;
+    }
+    free(item->text);
+    item->text = checkedRealloc(NULL, length + 1);
+    memcpy(item->text, text, length);
+    item->text[length] = '\0';
+    item->length = length;
+    item->column = column;
+    item->lines = 0;
+    for (size_t i = 0; i < length; i++) item->lines += text[i] == '\n';
+    setItemInput(workspace, item);
+}
+
+// Mesmo texto, outra coluna: o item começa na linha onde a mudança terminou
+static void moveItem(Workspace *workspace, WorkspaceItem *item, int column) {
+    if (item->column == column) return;
+    item->column = column;
+    setItemInput(workspace, item);
+}
+
+void initWorkspace(Workspace *workspace, const char *unit_dir) {
+    initQueryDb(&workspace->db);
+    workspace->unit_dir = unit_dir;
+    workspace->source = NULL;
+    workspace->length = 0;
+    workspace->items = NULL;
+    workspace->item_count = 0;
+    workspace->item_capacity = 0;
+    workspace->next_id = 0;
+    workspace->layout_version = 0;
+    initQuery(&workspace->layout, NULL, workspace);
+    initQuery(&workspace->scope, &SCOPE_QUERY, workspace);
+    initDiagnostics(&workspace->diagnostics);
+}
+
+void freeWorkspace(Workspace *workspace) {
+    freeQuery(&workspace->scope);
+    freeQuery(&workspace->layout);
+    for (int i = 0; i < workspace->item_count; i++) freeItem(workspace->items[i]);
+    free(workspace->items);
+    free(workspace->source);
+    freeQueryDb(&workspace->db);
+    freeDiagnostics(&workspace->diagnostics);
+}
+
+// Último item antigo que começa em offset ou antes
+static int itemAt(const size_t *starts, int count, size_t offset) {
+    int low = 0, high = count - 1;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (starts[middle] <= offset) low = middle; else high = middle - 1;
+    }
+    return low;
+}
+
+// Divide o fonte em itens. Um item começa em cada 'procedure' e no 'begin' do bloco
+// principal, o primeiro 'begin' fora de um procedimento; o cabeçalho é o que vem antes.
+// A divisão recomeça no início de um item antigo anterior à mudança e para no primeiro
+// início, depois do trecho alterado, que coincide com o de um item antigo do mesmo tipo:
+// dali em diante o texto e o estado da divisão são os mesmos de antes
+void updateWorkspace(Workspace *workspace, const char *source) {
+    size_t length = strlen(source);
+    size_t old_length = workspace->length;
+    const char *old = workspace->source ? workspace->source : "";
+    size_t limit = length < old_length ? length : old_length;
+    size_t prefix = 0;
+    while (prefix < limit && source[prefix] == old[prefix]) prefix++;
+    if (workspace->item_count > 0 && prefix == length && length == old_length) return;
+    size_t suffix = 0;
+    while (suffix < limit - prefix && source[length - 1 - suffix] == old[old_length - 1 - suffix]) suffix++;
+    size_t changed_end = length - suffix;
+
+    int count = workspace->item_count;
+    size_t *starts = checkedRealloc(NULL, sizeof(size_t) * (count + 1));
+    starts[0] = 0;
+    for (int i = 0; i < count; i++) starts[i + 1] = starts[i] + workspace->items[i]->length;
+
+    // Um token do item que contém o caractere antes da mudança pode ter crescido, e a
+    // mudança pode ter desfeito a palavra que abre esse item: a divisão recomeça no
+    // item anterior a ele, cujo início ficou intacto
+    int first = 0;
+    if (count > 0 && prefix > 0) {
+        first = itemAt(starts, count, prefix - 1);
+        if (first > 0) first--;
+    }
+    size_t start = count > 0 ? starts[first] : 0;
+    ItemKind first_kind = count > 0 ? workspace->items[first]->kind : ITEM_HEADER;
+
+    Boundary *bounds = checkedRealloc(NULL, sizeof(Boundary) * 4);
+    int bound_count = 0, bound_capacity = 4;
+    bounds[bound_count++] = (Boundary){start, first_kind, count > 0 ? workspace->items[first]->column : 1};
+    int resume = count;       // Primeiro item antigo que continua igual
+    size_t region_end = length;
+
+    Lexer lexer;
+    initLexer(&lexer, source + start);
+    lexer.column = bounds[0].column;
+    lexer.quiet = true;       // Os erros saem quando cada item é tokenizado (computeTokens)
+    TokenList scan;
+    initTokenList(&scan);
+    ItemKind mode = ITEM_HEADER;
+    int depth = 0;
+    bool body = false;        // O procedimento atual já abriu o corpo
+    while (!lexer.finished) {
+        releaseTokens(&scan, NULL);
+        lexBatch(&lexer, &scan, 1);
+        Token *token = &scan.tail->token;
+        bool opens = false;
+        if (token->type == TOKEN_PROCEDURE) {
+            opens = true;
+            mode = ITEM_PROCEDURE;
+            depth = 0;
+            body = false;
+        } else if (token->type == TOKEN_BEGIN) {
+            if (mode == ITEM_HEADER || (mode == ITEM_PROCEDURE && body && depth == 0)) {
+                opens = true;
+                mode = ITEM_MAIN;
+            } else if (mode == ITEM_PROCEDURE && depth == 0) {
+                body = true;
+            }
+            depth++;
+        } else if (token->type == TOKEN_END && depth > 0) {
+            depth--;
+        }
+        if (!opens) continue;
+
+        size_t offset = (size_t)(lexer.current - source) - strlen(token->lexeme);
+        if (offset == start && first_kind != ITEM_HEADER) continue;   // A palavra do próprio item
+        if (offset >= changed_end && count > 0) {
+            size_t old_offset = offset - length + old_length;
+            int match = itemAt(starts, count, old_offset);
+            if (match > first && starts[match] == old_offset && workspace->items[match]->kind == mode) {
+                resume = match;
+                region_end = offset;
+                break;
+            }
+        }
+        if (bound_count == bound_capacity) {
+            bound_capacity *= 2;
+            bounds = checkedRealloc(bounds, sizeof(Boundary) * bound_capacity);
+        }
+        bounds[bound_count++] = (Boundary){offset, mode, token->column};
+    }
+    freeTokenList(&scan);
+
+    // Os itens antigos [first, resume) dão lugar aos novos; os do mesmo tipo, na mesma
+    // posição, são reaproveitados e só mudam se o texto mudou
+    int replaced = resume - first;
+    bool layout_changed = replaced != bound_count;
+    WorkspaceItem **fresh = checkedRealloc(NULL, sizeof(WorkspaceItem *) * bound_count);
+    for (int i = 0; i < bound_count; i++) {
+        WorkspaceItem *item = NULL;
+        if (i < replaced && workspace->items[first + i]->kind == bounds[i].kind) {
+            item = workspace->items[first + i];
+            workspace->items[first + i] = NULL;
+        } else {
+            item = createItem(workspace, bounds[i].kind);
+            layout_changed = true;
+        }
+        size_t end = i + 1 < bound_count ? bounds[i + 1].offset : region_end;
+        setItemText(workspace, item, source + bounds[i].offset, end - bounds[i].offset, bounds[i].column);
+        fresh[i] = item;
+    }
+    for (int i = first; i < resume; i++) {
+        if (workspace->items[i]) {
+            freeItem(workspace->items[i]);
+            layout_changed = true;
+        }
+    }
+
+    int new_count = first + bound_count + (count - resume);
+    if (new_count > workspace->item_capacity) {
+        workspace->item_capacity = new_count * 2;
+        workspace->items = checkedRealloc(workspace->items, sizeof(WorkspaceItem *) * workspace->item_capacity);
+    }
+    memmove(workspace->items + first + bound_count, workspace->items + resume,
+            sizeof(WorkspaceItem *) * (count - resume));
+    memcpy(workspace->items + first, fresh, sizeof(WorkspaceItem *) * bound_count);
+    workspace->item_count = new_count;
+
+    // Itens seguintes na mesma linha do fim da mudança têm a coluna deslocada
+    size_t offset = region_end;
+    for (int i = first + bound_count; i < new_count; i++) {
+        WorkspaceItem *item = workspace->items[i];
+        size_t line_start = offset;
+        while (line_start > 0 && source[line_start - 1] != '\n') line_start--;
+        if (line_start > changed_end) break;
+        moveItem(workspace, item, (int)(offset - line_start) + 1);
+        offset += item->length;
+    }
+
+    if (layout_changed) querySet(&workspace->db, &workspace->layout, ++workspace->layout_version);
+    free(workspace->source);
+    workspace->source = checkedRealloc(NULL, length + 1);
+    memcpy(workspace->source, source, length + 1);
+    workspace->length = length;
+    free(fresh);
+    free(bounds);
+    free(starts);
+}
+
+static bool isDuplicate(const Scope *scope, int id) {
+    for (int i = 0; i < scope->duplicate_count; i++) {
+        if (scope->duplicates[i] == id) return true;
+    }
+    return false;
+}
+
+// Os diagnósticos de cada item contam as linhas do início dele e recebem aqui o
+// deslocamento do item
+DiagnosticBuffer *checkWorkspace(Workspace *workspace) {
+    int line = 1;
+    for (int i = 0; i < workspace->item_count; i++) {
+        workspace->items[i]->first_line = line;
+        line += workspace->items[i]->lines;
+    }
+
+    QueryDb *db = &workspace->db;
+    DiagnosticBuffer *diagnostics = &workspace->diagnostics;
+    clearDiagnostics(diagnostics);
+    Scope *scope = queryGet(db, &workspace->scope);
+    appendDiagnostics(diagnostics, &scope->diagnostics, 0);
+    bool has_main = false;
+    for (int i = 1; i < workspace->item_count && !has_main; i++) {
+        WorkspaceItem *item = workspace->items[i];
+        has_main = item->kind == ITEM_MAIN;
+        if (isDuplicate(scope, item->id)) {
+            Outline *outline = queryGet(db, &item->outline);
+            reportDiagnostic(diagnostics, DIAG_PROCEDURE_REDECLARED, outline->line + item->first_line - 1, 0,
+                             outline->name);
+        }
+        CheckResult *result = queryGet(db, &item->check);
+        appendDiagnostics(diagnostics, &result->diagnostics, item->first_line - 1);
+    }
+    if (!has_main) {
+        // O bloco principal falta: o erro aponta o fim do fonte, como na análise do programa inteiro
+        WorkspaceItem *last = workspace->items[workspace->item_count - 1];
+        TokenList *tokens = queryGet(db, &last->tokens);
+        reportDiagnostic(diagnostics, DIAG_EXPECTED_TOKEN, tokens->tail->token.line + last->first_line - 1,
+                         tokens->tail->token.column, TOKEN_BEGIN);
+    }
+    finishDiagnostics(diagnostics);
+    return diagnostics;
+}
@@ -0,0 +1,41 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "query.h"
+#include "diagnostics.h"
+
+// Análise incremental do fonte (--check e --watch). O fonte é dividido em itens — o
+// cabeçalho (program, uses e var), cada procedimento e o bloco principal — e a análise
+// vira consultas memorizadas (query.h) por item:
+//   texto → tokens → resumo (nome e parâmetros) → escopo global → verificação do corpo
+// Os tokens e os diagnósticos de um item contam as linhas a partir do início dele: inserir
+// linhas num procedimento não muda os itens seguintes. Só o escopo global lê todos os
+// itens, e pelo resumo: editar um corpo sem mudar a assinatura refaz só aquele corpo.
+
+typedef struct WorkspaceItem WorkspaceItem;
+
+typedef struct {
+    QueryDb db;
+    const char *unit_dir;     // Onde o cabeçalho procura os .ppu de uses
+    char *source;             // Texto da última atualização
+    size_t length;
+    WorkspaceItem **items;    // Na ordem do fonte; o primeiro é o cabeçalho
+    int item_count;
+    int item_capacity;
+    int next_id;
+    uint64_t layout_version;
+    Query layout;             // Entrada: muda quando itens entram ou saem
+    Query scope;              // Símbolos do cabeçalho e assinaturas dos procedimentos
+    DiagnosticBuffer diagnostics; // Do fonte inteiro, montados por checkWorkspace
+} Workspace;
+
+void initWorkspace(Workspace *workspace, const char *unit_dir);
+// Texto novo do fonte: só os itens tocados pela diferença para o texto anterior mudam
+void updateWorkspace(Workspace *workspace, const char *source);
+// Diagnósticos do fonte, ordenados e com as linhas do arquivo; valem até a próxima verificação
+DiagnosticBuffer *checkWorkspace(Workspace *workspace);
+void freeWorkspace(Workspace *workspace);
+
+#endif
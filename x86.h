@@ -0,0 +1,178 @@
+#ifndef X86_H
+#define X86_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bytecode.h"
+
+// Registradores de uso geral na numeração da codificação x86-64
+typedef enum {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+} X86Reg;
+
+typedef enum {
+    CC_E, CC_NE, CC_L, CC_LE, CC_G, CC_GE,
+    CC_B, CC_BE, CC_A, CC_AE, CC_P, CC_NP
+} X86Cond;
+
+typedef enum {
+    X86_LABEL,      // Pseudo-instrução: define o rótulo label
+    X86_MOV, X86_MOVABS, X86_LEA,
+    X86_ADD, X86_SUB, X86_IMUL, X86_AND, X86_OR, X86_XOR,
+    X86_CMP, X86_TEST, X86_NEG, X86_CQO, X86_IDIV,
+    X86_SETCC, X86_MOVZXB,
+    X86_MOVSD, X86_ADDSD, X86_SUBSD, X86_MULSD, X86_DIVSD,
+    X86_UCOMISD, X86_CVTSI2SD, X86_XORPD,
+    // Vetoriais (VLOOP): dois operandos; em VEX o destino também é o primeiro operando
+    X86_MOVUPD, X86_ADDPD, X86_SUBPD, X86_MULPD, X86_DIVPD,
+    X86_PADDQ, X86_PSUBQ, X86_PMULUDQ, X86_PXOR, X86_PSLLQ, X86_PSRLQ,
+    X86_UNPCKLPD, X86_UNPCKHPD, X86_MOVQ,
+    X86_VBROADCASTSD, X86_VEXTRACTF128, X86_VZEROUPPER,
+    X86_JMP, X86_JCC, X86_CALL, X86_RET, X86_PUSH, X86_POP
+} X86Op;
+
+typedef enum {
+    OPER_NONE,
+    OPER_REG,       // Registrador de uso geral (64 bits)
+    OPER_XMM,       // Registrador SSE
+    OPER_IMM,       // Imediato
+    OPER_MEM,       // [base + index * scale + disp]
+    OPER_RIP        // [rip + símbolo + disp]
+} X86OperandKind;
+
+// Símbolos referenciados pelo código gerado
+typedef enum {
+    SYM_GLOBALS,    // Área das variáveis globais (.bss)
+    SYM_CONSTANTS,  // Tabela de constantes de 64 bits (.rodata)
+    SYM_SIGN_MASK,  // Máscara de sinal para negar reais
+    SYM_STRING,     // String index
+    SYM_FUNCTION,   // Procedimento index
+    SYM_RUNTIME     // Função da biblioteca de execução index
+} X86SymbolKind;
+
+typedef enum {
+    RT_WRITE_INTEGER, RT_WRITE_REAL, RT_WRITE_BOOLEAN, RT_WRITE_STRING, RT_WRITELN,
+    RT_READ_INTEGER, RT_READ_REAL, RT_RUNTIME_ERROR,
+    RT_COUNT
+} X86Runtime;
+
+typedef struct {
+    X86OperandKind kind;
+    int reg;                 // REG, XMM, base de MEM
+    int64_t imm;             // IMM
+    int32_t disp;            // MEM, RIP
+    int index;               // MEM: registrador de índice quando scale > 0
+    int scale;               // MEM: 1, 2, 4 ou 8; 0 sem índice
+    X86SymbolKind symbol;    // RIP
+    int symbol_index;        // RIP: índice da string
+} X86Operand;
+
+typedef struct {
+    X86Op op;
+    X86Cond cond;            // JCC, SETCC
+    X86Operand dst;
+    X86Operand src;
+    int target;              // LABEL/JMP/JCC: rótulo; CALL: índice da função ou do runtime
+    X86SymbolKind call_kind; // CALL: SYM_FUNCTION ou SYM_RUNTIME
+    bool vex;                // Codificação VEX das instruções SSE (-mavx2)
+    bool wide;               // VEX.256: registradores ymm
+    int pc;                  // Instrução de bytecode de origem; -1 no prólogo e no epílogo
+} X86Inst;
+
+// push rbp, mov rbp, rsp e ret: rbp ainda (ou já) é o quadro do chamador
+#define X86_PC_NO_FRAME (-2)
+
+typedef struct {
+    char *symbol;            // Nome do símbolo na saída
+    X86Inst *code;
+    int count;
+    int capacity;
+    int label_count;
+} X86Function;
+
+typedef struct {
+    X86Function *functions;
+    int function_count;
+    int main_function;
+    int global_count;
+    uint64_t *constants;
+    int constant_count;
+    char **strings;
+    int string_count;
+    int division_error;      // Índice da mensagem de divisão por zero
+    int index_error;         // Índice da mensagem de índice fora dos limites
+    bool call_counters;      // Cada prólogo soma 1 ao contador da função, logo após as globais
+    int counter_count;       // Contadores de PROFILE, depois dos contadores de chamadas
+    int array_slots;         // Elementos dos arrays, depois dos contadores
+} X86Program;
+
+// Posição de 8 bytes do primeiro contador de PROFILE na área das globais
+#define X86_PROFILE_SLOT(program) \
+    ((program)->global_count + 1 + ((program)->call_counters ? (program)->function_count : 0))
+// Posição do primeiro elemento da área dos arrays e tamanho total da área, em bytes
+#define X86_ARRAY_SLOT(program) (X86_PROFILE_SLOT(program) + (program)->counter_count)
+#define X86_DATA_SIZE(program) (8 * (X86_ARRAY_SLOT(program) + (program)->array_slots))
+
+// Estatísticas da alocação de registradores
+typedef struct {
+    int intervals;
+    int spilled;
+} X86AllocStats;
+
+// Código de máquina codificado, ainda com referências a dados e ao runtime por resolver
+typedef enum {
+    TARGET_RODATA,           // Deslocamento dentro de .rodata
+    TARGET_BSS,              // Deslocamento dentro da área de globais
+    TARGET_RUNTIME           // Função da biblioteca de execução index
+} X86RelocTarget;
+
+// Campo de 32 bits em text + offset que recebe S + addend - P
+typedef struct {
+    int offset;
+    X86RelocTarget target;
+    int index;
+    int64_t addend;
+} X86Reloc;
+
+// Trecho de text a partir de offset gerado pela instrução pc da função
+typedef struct {
+    int offset;
+    int function;
+    int pc;
+} X86SourceRange;
+
+typedef struct {
+    uint8_t *text;
+    int text_size;
+    int text_capacity;
+    int *function_offsets;
+    uint8_t *rodata;         // Máscara de sinal, constantes e strings
+    int rodata_size;
+    int bss_size;
+    X86Reloc *relocs;
+    int reloc_count;
+    int reloc_capacity;
+    X86SourceRange *ranges;  // Em ordem crescente de offset; usado pelo perfil do --run
+    int range_count;
+    int range_capacity;
+} X86Image;
+
+extern const char *const x86RuntimeNames[RT_COUNT];
+
+// naive: todos os registradores virtuais ficam na pilha (base de comparação);
+// count_calls: prólogos com contadores de chamadas (call_counters);
+// avx2: VLOOP em registradores ymm, quatro elementos por vez (senão SSE2, dois)
+bool generateX86(const BytecodeProgram *program, bool naive, bool count_calls, bool avx2,
+                 X86Program *out, X86AllocStats *stats);
+void freeX86(X86Program *program);
+void writeX86Assembly(const X86Program *program, FILE *out);
+
+// Codificação direta para bytes e escrita de objetos ELF64 relocáveis
+void encodeX86(const X86Program *program, X86Image *image);
+const X86SourceRange *findSourceRange(const X86Image *image, int offset);
+void freeX86Image(X86Image *image);
+bool writeElfObject(const X86Program *program, const X86Image *image, FILE *out);
+
+#endif
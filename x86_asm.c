@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include "x86.h"
+
+// Impressão do código gerado como assembly GNU em sintaxe Intel
+
+static const char *const reg64[] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+static const char *const reg32[] = {
+    "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+    "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"
+};
+static const char *const reg8[] = {
+    "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+    "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"
+};
+static const char *const conditions[] = {
+    "e", "ne", "l", "le", "g", "ge", "b", "be", "a", "ae", "p", "np"
+};
+static const char *const mnemonics[] = {
+    [X86_MOV] = "mov", [X86_MOVABS] = "movabs", [X86_LEA] = "lea",
+    [X86_ADD] = "add", [X86_SUB] = "sub", [X86_IMUL] = "imul", [X86_AND] = "and",
+    [X86_OR] = "or", [X86_XOR] = "xor", [X86_CMP] = "cmp", [X86_TEST] = "test",
+    [X86_NEG] = "neg", [X86_CQO] = "cqo", [X86_IDIV] = "idiv",
+    [X86_MOVSD] = "movsd", [X86_ADDSD] = "addsd", [X86_SUBSD] = "subsd",
+    [X86_MULSD] = "mulsd", [X86_DIVSD] = "divsd", [X86_UCOMISD] = "ucomisd",
+    [X86_CVTSI2SD] = "cvtsi2sd", [X86_XORPD] = "xorpd",
+    [X86_MOVUPD] = "movupd", [X86_ADDPD] = "addpd", [X86_SUBPD] = "subpd", [X86_MULPD] = "mulpd",
+    [X86_DIVPD] = "divpd", [X86_PADDQ] = "paddq", [X86_PSUBQ] = "psubq", [X86_PMULUDQ] = "pmuludq",
+    [X86_PXOR] = "pxor", [X86_PSLLQ] = "psllq", [X86_PSRLQ] = "psrlq", [X86_UNPCKLPD] = "unpcklpd",
+    [X86_UNPCKHPD] = "unpckhpd", [X86_MOVQ] = "movq", [X86_VBROADCASTSD] = "vbroadcastsd",
+    [X86_VEXTRACTF128] = "vextractf128", [X86_VZEROUPPER] = "vzeroupper",
+    [X86_RET] = "ret", [X86_PUSH] = "push", [X86_POP] = "pop"
+};
+
+static void printSymbol(FILE *out, const X86Operand *o) {
+    switch (o->symbol) {
+        case SYM_GLOBALS: fprintf(out, "pas_globals"); break;
+        case SYM_CONSTANTS: fprintf(out, ".Lconstants"); break;
+        case SYM_SIGN_MASK: fprintf(out, ".Lsign_mask"); break;
+        case SYM_STRING: fprintf(out, ".Lstr%d", o->symbol_index); break;
+        default: break;
+    }
+}
+
+static void printOperand(FILE *out, const X86Inst *ins, const X86Operand *o) {
+    // xorpd e movupd leem 16 bytes da memória (32 em VEX.256); lea não usa tamanho
+    const char *size = ins->op == X86_MOVUPD && ins->wide ? "ymmword ptr "
+                     : ins->op == X86_XORPD || ins->op == X86_MOVUPD ? "xmmword ptr "
+                     : ins->op == X86_LEA ? "" : "qword ptr ";
+    switch (o->kind) {
+        case OPER_REG: fprintf(out, "%s", reg64[o->reg]); break;
+        case OPER_XMM: fprintf(out, "%s%d", ins->wide ? "ymm" : "xmm", o->reg); break;
+        case OPER_IMM: fprintf(out, "%lld", (long long)o->imm); break;
+        case OPER_MEM:
+            if (o->scale) {
+                fprintf(out, "%s[%s + %s*%d", size, reg64[o->reg], reg64[o->index], o->scale);
+                if (o->disp) fprintf(out, " %c %d", o->disp < 0 ? '-' : '+', o->disp < 0 ? -o->disp : o->disp);
+                fprintf(out, "]");
+            } else if (o->disp < 0) fprintf(out, "%s[%s - %d]", size, reg64[o->reg], -o->disp);
+            else if (o->disp > 0) fprintf(out, "%s[%s + %d]", size, reg64[o->reg], o->disp);
+            else fprintf(out, "%s[%s]", size, reg64[o->reg]);
+            break;
+        case OPER_RIP:
+            fprintf(out, "%s[rip + ", size);
+            printSymbol(out, o);
+            if (o->disp) fprintf(out, " + %d", o->disp);
+            fprintf(out, "]");
+            break;
+        case OPER_NONE:
+            break;
+    }
+}
+
+static void printInstruction(FILE *out, const X86Program *program, int function, const X86Inst *ins) {
+    switch (ins->op) {
+        case X86_LABEL:
+            fprintf(out, ".L%d_%d:\n", function, ins->target);
+            return;
+        case X86_JMP:
+            fprintf(out, "\tjmp .L%d_%d\n", function, ins->target);
+            return;
+        case X86_JCC:
+            fprintf(out, "\tj%s .L%d_%d\n", conditions[ins->cond], function, ins->target);
+            return;
+        case X86_CALL:
+            if (ins->call_kind == SYM_RUNTIME) fprintf(out, "\tcall %s\n", x86RuntimeNames[ins->target]);
+            else fprintf(out, "\tcall %s\n", program->functions[ins->target].symbol);
+            return;
+        case X86_SETCC:
+            fprintf(out, "\tset%s %s\n", conditions[ins->cond], reg8[ins->dst.reg]);
+            return;
+        case X86_MOVZXB:
+            fprintf(out, "\tmovzx %s, %s\n", reg32[ins->dst.reg], reg8[ins->src.reg]);
+            return;
+        case X86_VEXTRACTF128:
+            fprintf(out, "\tvextractf128 xmm%d, ymm%d, 1\n", ins->dst.reg, ins->src.reg);
+            return;
+        default:
+            break;
+    }
+
+    // Em VEX as operações de dois operandos repetem o destino como primeira fonte
+    bool vex_prefix = ins->vex && mnemonics[ins->op][0] != 'v';
+    bool repeat = ins->vex && ins->op != X86_MOVUPD && ins->op != X86_MOVQ && ins->op != X86_VBROADCASTSD;
+    fprintf(out, "\t%s%s", vex_prefix ? "v" : "", mnemonics[ins->op]);
+    if (ins->dst.kind != OPER_NONE) {
+        fprintf(out, " ");
+        printOperand(out, ins, &ins->dst);
+    }
+    if (repeat && ins->dst.kind != OPER_NONE) {
+        fprintf(out, ", ");
+        printOperand(out, ins, &ins->dst);
+    }
+    if (ins->src.kind != OPER_NONE) {
+        fprintf(out, ", ");
+        printOperand(out, ins, &ins->src);
+    }
+    fprintf(out, "\n");
+}
+
+static void printString(FILE *out, const char *text) {
+    fprintf(out, "\t.asciz \"");
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(out, "\\%c", *p);
+        else if (*p < 32 || *p >= 127) fprintf(out, "\\%03o", *p);
+        else fputc(*p, out);
+    }
+    fprintf(out, "\"\n");
+}
+
+void writeX86Assembly(const X86Program *program, FILE *out) {
+    fprintf(out, "\t.intel_syntax noprefix\n");
+    fprintf(out, "\t.text\n");
+    for (int i = 0; i < program->function_count; i++) {
+        const X86Function *f = &program->functions[i];
+        if (i == program->main_function) fprintf(out, "\t.globl %s\n", f->symbol);
+        fprintf(out, "\t.type %s, @function\n", f->symbol);
+        fprintf(out, "%s:\n", f->symbol);
+        for (int j = 0; j < f->count; j++) {
+            printInstruction(out, program, i, &f->code[j]);
+        }
+        fprintf(out, "\t.size %s, .-%s\n\n", f->symbol, f->symbol);
+    }
+
+    fprintf(out, "\t.section .rodata\n");
+    fprintf(out, "\t.p2align 4\n");
+    fprintf(out, ".Lsign_mask:\n\t.quad 0x8000000000000000, 0\n");
+    fprintf(out, ".Lconstants:\n");
+    for (int i = 0; i < program->constant_count; i++) {
+        fprintf(out, "\t.quad 0x%016llx\n", (unsigned long long)program->constants[i]);
+    }
+    for (int i = 0; i < program->string_count; i++) {
+        fprintf(out, ".Lstr%d:\n", i);
+        printString(out, program->strings[i]);
+    }
+
+    fprintf(out, "\n\t.bss\n\t.p2align 3\n");
+    fprintf(out, "pas_globals:\n\t.zero %d\n", X86_DATA_SIZE(program));
+    fprintf(out, "\t.section .note.GNU-stack,\"\",@progbits\n");
+}
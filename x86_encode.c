@@ -0,0 +1,472 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "x86.h"
+
+// Codificador das instruções x86-64 usadas pelo gerador de código
+
+#define SIGN_MASK_OFFSET 0
+#define CONSTANTS_OFFSET 16
+
+// Desvio ainda sem destino: rótulo local ou função do programa
+typedef struct {
+    int offset;
+    int target;
+} Fixup;
+
+typedef struct {
+    X86Image *image;
+    const X86Program *program;
+    int *string_offsets;
+    int *label_offsets;
+    Fixup *labels;            // Desvios para rótulos da função atual
+    int label_count;
+    int label_capacity;
+    Fixup *calls;             // Chamadas entre procedimentos
+    int call_count;
+    int call_capacity;
+} Encoder;
+
+static void *checkedRealloc(void *array, size_t size) {
+    void *grown = realloc(array, size);
+    if (!grown) {
+        fprintf(stderr, "Erro de alocação de memória ao codificar x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static void put8(Encoder *e, uint8_t byte) {
+    X86Image *image = e->image;
+    if (image->text_size == image->text_capacity) {
+        image->text_capacity = image->text_capacity ? image->text_capacity * 2 : 4096;
+        image->text = checkedRealloc(image->text, image->text_capacity);
+    }
+    image->text[image->text_size++] = byte;
+}
+
+static void put32(Encoder *e, uint32_t value) {
+    for (int i = 0; i < 4; i++) put8(e, (uint8_t)(value >> (8 * i)));
+}
+
+static void put64(Encoder *e, uint64_t value) {
+    for (int i = 0; i < 8; i++) put8(e, (uint8_t)(value >> (8 * i)));
+}
+
+static void patch32(Encoder *e, int offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) e->image->text[offset + i] = (uint8_t)(value >> (8 * i));
+}
+
+static void addFixup(Fixup **list, int *count, int *capacity, int offset, int target) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *list = checkedRealloc(*list, sizeof(Fixup) * *capacity);
+    }
+    (*list)[(*count)++] = (Fixup){offset, target};
+}
+
+static void addReloc(Encoder *e, X86RelocTarget target, int index, int64_t addend) {
+    X86Image *image = e->image;
+    if (image->reloc_count == image->reloc_capacity) {
+        image->reloc_capacity = image->reloc_capacity ? image->reloc_capacity * 2 : 64;
+        image->relocs = checkedRealloc(image->relocs, sizeof(X86Reloc) * image->reloc_capacity);
+    }
+    image->relocs[image->reloc_count++] = (X86Reloc){image->text_size, target, index, addend};
+}
+
+static bool fitsInt8(int64_t value) {
+    return value >= -128 && value <= 127;
+}
+
+static bool isByteRegister(int r) {
+    return r >= RSP && r <= RDI;   // spl, bpl, sil e dil exigem REX
+}
+
+// Prefixo REX para o campo reg e o operando r/m
+static void emitRex(Encoder *e, bool w, int reg_field, const X86Operand *rm, bool byte_operands) {
+    int rex = 0x40 | (w ? 8 : 0) | ((reg_field & 8) ? 4 : 0);
+    if (rm->kind == OPER_REG || rm->kind == OPER_XMM || rm->kind == OPER_MEM) {
+        if (rm->reg & 8) rex |= 1;
+    }
+    if (rm->kind == OPER_MEM && rm->scale && (rm->index & 8)) rex |= 2;
+    bool force = byte_operands && (isByteRegister(reg_field) || (rm->kind == OPER_REG && isByteRegister(rm->reg)));
+    if (rex != 0x40 || force) put8(e, (uint8_t)rex);
+}
+
+// Byte ModRM (e SIB/deslocamento); trailing é o tamanho do imediato que segue,
+// necessário para o endereçamento relativo a rip
+static void emitModRM(Encoder *e, int reg_field, const X86Operand *rm, int trailing) {
+    int reg_bits = (reg_field & 7) << 3;
+    switch (rm->kind) {
+        case OPER_REG:
+        case OPER_XMM:
+            put8(e, (uint8_t)(0xC0 | reg_bits | (rm->reg & 7)));
+            break;
+        case OPER_MEM: {
+            int base = rm->reg & 7;
+            int mod = rm->disp == 0 && base != RBP ? 0 : fitsInt8(rm->disp) ? 1 : 2;
+            if (rm->scale) {
+                int ss = rm->scale == 8 ? 3 : rm->scale == 4 ? 2 : rm->scale == 2 ? 1 : 0;
+                put8(e, (uint8_t)((mod << 6) | reg_bits | 4));
+                put8(e, (uint8_t)((ss << 6) | ((rm->index & 7) << 3) | base));
+            } else {
+                put8(e, (uint8_t)((mod << 6) | reg_bits | base));
+                if (base == RSP) put8(e, 0x24);
+            }
+            if (mod == 1) put8(e, (uint8_t)(int8_t)rm->disp);
+            else if (mod == 2) put32(e, (uint32_t)rm->disp);
+            break;
+        }
+        case OPER_RIP: {
+            put8(e, (uint8_t)(0x05 | reg_bits));
+            if (rm->symbol == SYM_GLOBALS) {
+                addReloc(e, TARGET_BSS, 0, (int64_t)rm->disp - 4 - trailing);
+            } else {
+                int base = rm->symbol == SYM_SIGN_MASK ? SIGN_MASK_OFFSET
+                         : rm->symbol == SYM_CONSTANTS ? CONSTANTS_OFFSET
+                         : e->string_offsets[rm->symbol_index];
+                addReloc(e, TARGET_RODATA, 0, (int64_t)base + rm->disp - 4 - trailing);
+            }
+            put32(e, 0);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Instrução genérica: [prefixo] [REX] opcode ModRM
+static void encodeRM(Encoder *e, uint8_t prefix, bool w, const char *opcode, int opcode_length,
+                     int reg_field, const X86Operand *rm, int trailing, bool byte_operands) {
+    if (prefix) put8(e, prefix);
+    emitRex(e, w, reg_field, rm, byte_operands);
+    for (int i = 0; i < opcode_length; i++) put8(e, (uint8_t)opcode[i]);
+    emitModRM(e, reg_field, rm, trailing);
+}
+
+// Operações aritméticas e lógicas de dois operandos: opcodes r/m,r e r,r/m e a extensão /n
+typedef struct {
+    uint8_t rm_reg;
+    uint8_t reg_rm;
+    int extension;
+} AluEncoding;
+
+static AluEncoding aluEncoding(X86Op op) {
+    switch (op) {
+        case X86_ADD: return (AluEncoding){0x01, 0x03, 0};
+        case X86_OR: return (AluEncoding){0x09, 0x0B, 1};
+        case X86_AND: return (AluEncoding){0x21, 0x23, 4};
+        case X86_SUB: return (AluEncoding){0x29, 0x2B, 5};
+        case X86_XOR: return (AluEncoding){0x31, 0x33, 6};
+        default: return (AluEncoding){0x39, 0x3B, 7};
+    }
+}
+
+static const uint8_t condition_codes[] = {
+    [CC_E] = 0x4, [CC_NE] = 0x5, [CC_L] = 0xC, [CC_LE] = 0xE, [CC_G] = 0xF, [CC_GE] = 0xD,
+    [CC_B] = 0x2, [CC_BE] = 0x6, [CC_A] = 0x7, [CC_AE] = 0x3, [CC_P] = 0xA, [CC_NP] = 0xB
+};
+
+static void encodeAlu(Encoder *e, const X86Inst *ins) {
+    AluEncoding enc = aluEncoding(ins->op);
+    if (ins->src.kind == OPER_IMM) {
+        bool small = fitsInt8(ins->src.imm);
+        encodeRM(e, 0, true, small ? "\x83" : "\x81", 1, enc.extension, &ins->dst, small ? 1 : 4, false);
+        if (small) put8(e, (uint8_t)(int8_t)ins->src.imm);
+        else put32(e, (uint32_t)ins->src.imm);
+    } else if (ins->dst.kind == OPER_REG) {
+        char opcode = (char)enc.reg_rm;
+        encodeRM(e, 0, true, &opcode, 1, ins->dst.reg, &ins->src, 0, false);
+    } else {
+        char opcode = (char)enc.rm_reg;
+        encodeRM(e, 0, true, &opcode, 1, ins->src.reg, &ins->dst, 0, false);
+    }
+}
+
+static void encodeMov(Encoder *e, const X86Inst *ins) {
+    if (ins->src.kind == OPER_IMM) {
+        encodeRM(e, 0, true, "\xC7", 1, 0, &ins->dst, 4, false);
+        put32(e, (uint32_t)ins->src.imm);
+    } else if (ins->dst.kind == OPER_REG) {
+        encodeRM(e, 0, true, "\x8B", 1, ins->dst.reg, &ins->src, 0, false);
+    } else {
+        encodeRM(e, 0, true, "\x89", 1, ins->src.reg, &ins->dst, 0, false);
+    }
+}
+
+// Instrução SSE escalar: prefixo, 0F op, destino no campo reg
+static void encodeSse(Encoder *e, uint8_t prefix, uint8_t op, bool w, const X86Operand *reg, const X86Operand *rm) {
+    char opcode[2] = {0x0F, (char)op};
+    encodeRM(e, prefix, w, opcode, 2, reg->reg, rm, 0, false);
+}
+
+// Prefixo de 3 bytes C4: R, X e B invertidos, mapa (1 = 0F, 2 = 0F38, 3 = 0F3A),
+// W, o registrador vvvv invertido (0, ou seja 1111, se não usado), L e o prefixo implícito pp
+static void emitVex(Encoder *e, int map, bool w, int vvvv, bool wide, int pp, int reg_field, const X86Operand *rm) {
+    int b = (rm->kind == OPER_REG || rm->kind == OPER_XMM || rm->kind == OPER_MEM) && (rm->reg & 8);
+    int x = rm->kind == OPER_MEM && rm->scale && (rm->index & 8);
+    put8(e, 0xC4);
+    put8(e, (uint8_t)(((reg_field & 8) ? 0 : 0x80) | (x ? 0 : 0x40) | (b ? 0 : 0x20) | map));
+    put8(e, (uint8_t)((w ? 0x80 : 0) | ((~vvvv & 15) << 3) | (wide ? 4 : 0) | pp));
+}
+
+// Instrução SSE com prefixo 66 (pp = 1) ou F2 (pp = 3), legada ou VEX. Em VEX,
+// source (o vvvv) é o destino das operações de dois operandos, ou -1 se não há
+static void encodeVector(Encoder *e, const X86Inst *ins, int pp, int map, uint8_t op, bool w,
+                         int reg_field, int source, const X86Operand *rm, int trailing) {
+    if (ins->vex) {
+        emitVex(e, map, w, source < 0 ? 0 : source, ins->wide, pp, reg_field, rm);
+        put8(e, op);
+    } else {
+        put8(e, pp == 1 ? 0x66 : 0xF2);
+        emitRex(e, w, reg_field, rm, false);
+        put8(e, 0x0F);
+        if (map == 2) put8(e, 0x38);
+        else if (map == 3) put8(e, 0x3A);
+        put8(e, op);
+    }
+    emitModRM(e, reg_field, rm, trailing);
+}
+
+// Operações de dois operandos xmm, xmm/m com prefixo 66
+static void encodePacked(Encoder *e, const X86Inst *ins, uint8_t op) {
+    encodeVector(e, ins, 1, 1, op, false, ins->dst.reg, ins->dst.reg, &ins->src, 0);
+}
+
+static void encodeJump(Encoder *e, const X86Inst *ins) {
+    if (ins->op == X86_JMP) {
+        put8(e, 0xE9);
+    } else {
+        put8(e, 0x0F);
+        put8(e, (uint8_t)(0x80 | condition_codes[ins->cond]));
+    }
+    addFixup(&e->labels, &e->label_count, &e->label_capacity, e->image->text_size, ins->target);
+    put32(e, 0);
+}
+
+// Um novo trecho começa quando muda a instrução de bytecode de origem
+static void addSourceRange(Encoder *e, int function, int pc) {
+    X86Image *image = e->image;
+    if (image->range_count > 0) {
+        X86SourceRange *last = &image->ranges[image->range_count - 1];
+        if (last->function == function && last->pc == pc) return;
+        if (last->offset == image->text_size) image->range_count--;
+    }
+    if (image->range_count == image->range_capacity) {
+        image->range_capacity = image->range_capacity ? image->range_capacity * 2 : 256;
+        image->ranges = checkedRealloc(image->ranges, sizeof(X86SourceRange) * image->range_capacity);
+    }
+    image->ranges[image->range_count++] = (X86SourceRange){image->text_size, function, pc};
+}
+
+static void encodeInstruction(Encoder *e, const X86Inst *ins) {
+    switch (ins->op) {
+        case X86_LABEL:
+            e->label_offsets[ins->target] = e->image->text_size;
+            break;
+        case X86_MOV:
+            encodeMov(e, ins);
+            break;
+        case X86_MOVABS:
+            put8(e, (uint8_t)(0x48 | ((ins->dst.reg & 8) ? 1 : 0)));
+            put8(e, (uint8_t)(0xB8 | (ins->dst.reg & 7)));
+            put64(e, (uint64_t)ins->src.imm);
+            break;
+        case X86_LEA:
+            encodeRM(e, 0, true, "\x8D", 1, ins->dst.reg, &ins->src, 0, false);
+            break;
+        case X86_ADD: case X86_SUB: case X86_AND: case X86_OR: case X86_XOR: case X86_CMP:
+            encodeAlu(e, ins);
+            break;
+        case X86_IMUL:
+            encodeRM(e, 0, true, "\x0F\xAF", 2, ins->dst.reg, &ins->src, 0, false);
+            break;
+        case X86_TEST:
+            encodeRM(e, 0, true, "\x85", 1, ins->src.reg, &ins->dst, 0, false);
+            break;
+        case X86_NEG:
+            encodeRM(e, 0, true, "\xF7", 1, 3, &ins->dst, 0, false);
+            break;
+        case X86_IDIV:
+            encodeRM(e, 0, true, "\xF7", 1, 7, &ins->dst, 0, false);
+            break;
+        case X86_CQO:
+            put8(e, 0x48);
+            put8(e, 0x99);
+            break;
+        case X86_SETCC: {
+            char opcode[2] = {0x0F, (char)(0x90 | condition_codes[ins->cond])};
+            encodeRM(e, 0, false, opcode, 2, 0, &ins->dst, 0, true);
+            break;
+        }
+        case X86_MOVZXB:
+            encodeRM(e, 0, false, "\x0F\xB6", 2, ins->dst.reg, &ins->src, 0, true);
+            break;
+        case X86_MOVSD:
+            if (ins->dst.kind == OPER_XMM) encodeSse(e, 0xF2, 0x10, false, &ins->dst, &ins->src);
+            else encodeSse(e, 0xF2, 0x11, false, &ins->src, &ins->dst);
+            break;
+        case X86_ADDSD:
+        case X86_SUBSD: {
+            uint8_t op = ins->op == X86_ADDSD ? 0x58 : 0x5C;
+            if (ins->vex) encodeVector(e, ins, 3, 1, op, false, ins->dst.reg, ins->dst.reg, &ins->src, 0);
+            else encodeSse(e, 0xF2, op, false, &ins->dst, &ins->src);
+            break;
+        }
+        case X86_MULSD: encodeSse(e, 0xF2, 0x59, false, &ins->dst, &ins->src); break;
+        case X86_DIVSD: encodeSse(e, 0xF2, 0x5E, false, &ins->dst, &ins->src); break;
+        case X86_UCOMISD: encodeSse(e, 0x66, 0x2E, false, &ins->dst, &ins->src); break;
+        case X86_XORPD: encodeSse(e, 0x66, 0x57, false, &ins->dst, &ins->src); break;
+        case X86_CVTSI2SD: encodeSse(e, 0xF2, 0x2A, true, &ins->dst, &ins->src); break;
+        case X86_MOVUPD:
+            if (ins->dst.kind == OPER_XMM) encodeVector(e, ins, 1, 1, 0x10, false, ins->dst.reg, -1, &ins->src, 0);
+            else encodeVector(e, ins, 1, 1, 0x11, false, ins->src.reg, -1, &ins->dst, 0);
+            break;
+        case X86_ADDPD: encodePacked(e, ins, 0x58); break;
+        case X86_MULPD: encodePacked(e, ins, 0x59); break;
+        case X86_SUBPD: encodePacked(e, ins, 0x5C); break;
+        case X86_DIVPD: encodePacked(e, ins, 0x5E); break;
+        case X86_PADDQ: encodePacked(e, ins, 0xD4); break;
+        case X86_PSUBQ: encodePacked(e, ins, 0xFB); break;
+        case X86_PMULUDQ: encodePacked(e, ins, 0xF4); break;
+        case X86_PXOR: encodePacked(e, ins, 0xEF); break;
+        case X86_UNPCKLPD: encodePacked(e, ins, 0x14); break;
+        case X86_UNPCKHPD: encodePacked(e, ins, 0x15); break;
+        case X86_PSLLQ:
+        case X86_PSRLQ:
+            // 66 0F 73 /6 (psllq) ou /2 (psrlq) com imediato de 8 bits
+            encodeVector(e, ins, 1, 1, 0x73, false, ins->op == X86_PSLLQ ? 6 : 2, ins->dst.reg, &ins->dst, 1);
+            put8(e, (uint8_t)ins->src.imm);
+            break;
+        case X86_MOVQ:
+            encodeVector(e, ins, 1, 1, 0x7E, true, ins->src.reg, -1, &ins->dst, 0);
+            break;
+        case X86_VBROADCASTSD:
+            encodeVector(e, ins, 1, 2, 0x19, false, ins->dst.reg, -1, &ins->src, 0);
+            break;
+        case X86_VEXTRACTF128:
+            encodeVector(e, ins, 1, 3, 0x19, false, ins->src.reg, -1, &ins->dst, 1);
+            put8(e, 1);
+            break;
+        case X86_VZEROUPPER:
+            put8(e, 0xC5);
+            put8(e, 0xF8);
+            put8(e, 0x77);
+            break;
+        case X86_JMP:
+        case X86_JCC:
+            encodeJump(e, ins);
+            break;
+        case X86_CALL:
+            put8(e, 0xE8);
+            if (ins->call_kind == SYM_RUNTIME) {
+                addReloc(e, TARGET_RUNTIME, ins->target, -4);
+            } else {
+                addFixup(&e->calls, &e->call_count, &e->call_capacity, e->image->text_size, ins->target);
+            }
+            put32(e, 0);
+            break;
+        case X86_RET:
+            put8(e, 0xC3);
+            break;
+        case X86_PUSH:
+        case X86_POP:
+            if (ins->dst.reg & 8) put8(e, 0x41);
+            put8(e, (uint8_t)((ins->op == X86_PUSH ? 0x50 : 0x58) | (ins->dst.reg & 7)));
+            break;
+    }
+}
+
+// .rodata: máscara de sinal (16 bytes alinhados), constantes de 64 bits e strings
+static void layoutRodata(Encoder *e) {
+    const X86Program *program = e->program;
+    X86Image *image = e->image;
+    int size = CONSTANTS_OFFSET + 8 * program->constant_count;
+    e->string_offsets = malloc(sizeof(int) * (program->string_count + 1));
+    if (!e->string_offsets) {
+        fprintf(stderr, "Erro de alocação de memória ao codificar x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < program->string_count; i++) {
+        e->string_offsets[i] = size;
+        size += (int)strlen(program->strings[i]) + 1;
+    }
+    image->rodata = calloc(size, 1);
+    if (!image->rodata) {
+        fprintf(stderr, "Erro de alocação de memória ao codificar x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+    image->rodata_size = size;
+    uint64_t sign = 0x8000000000000000ULL;
+    memcpy(image->rodata + SIGN_MASK_OFFSET, &sign, sizeof(sign));
+    memcpy(image->rodata + CONSTANTS_OFFSET, program->constants, 8 * (size_t)program->constant_count);
+    for (int i = 0; i < program->string_count; i++) {
+        strcpy((char *)image->rodata + e->string_offsets[i], program->strings[i]);
+    }
+}
+
+void encodeX86(const X86Program *program, X86Image *image) {
+    memset(image, 0, sizeof(*image));
+    Encoder e;
+    memset(&e, 0, sizeof(e));
+    e.image = image;
+    e.program = program;
+    layoutRodata(&e);
+    image->bss_size = X86_DATA_SIZE(program);
+    image->function_offsets = malloc(sizeof(int) * (program->function_count + 1));
+    if (!image->function_offsets) {
+        fprintf(stderr, "Erro de alocação de memória ao codificar x86-64\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < program->function_count; i++) {
+        const X86Function *f = &program->functions[i];
+        while (image->text_size % 16 != 0) put8(&e, 0xCC);
+        image->function_offsets[i] = image->text_size;
+
+        e.label_offsets = checkedRealloc(e.label_offsets, sizeof(int) * (f->label_count + 1));
+        e.label_count = 0;
+        for (int j = 0; j < f->count; j++) {
+            if (f->code[j].op != X86_LABEL) addSourceRange(&e, i, f->code[j].pc);
+            encodeInstruction(&e, &f->code[j]);
+        }
+        for (int j = 0; j < e.label_count; j++) {
+            Fixup *fixup = &e.labels[j];
+            patch32(&e, fixup->offset, (uint32_t)(e.label_offsets[fixup->target] - (fixup->offset + 4)));
+        }
+    }
+    for (int j = 0; j < e.call_count; j++) {
+        Fixup *fixup = &e.calls[j];
+        patch32(&e, fixup->offset, (uint32_t)(image->function_offsets[fixup->target] - (fixup->offset + 4)));
+    }
+
+    free(e.string_offsets);
+    free(e.label_offsets);
+    free(e.labels);
+    free(e.calls);
+}
+
+// Busca binária pelo último trecho que começa em offset ou antes
+const X86SourceRange *findSourceRange(const X86Image *image, int offset) {
+    int low = 0, high = image->range_count - 1;
+    const X86SourceRange *found = NULL;
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        if (image->ranges[middle].offset <= offset) {
+            found = &image->ranges[middle];
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return found;
+}
+
+void freeX86Image(X86Image *image) {
+    free(image->text);
+    free(image->ranges);
+    free(image->function_offsets);
+    free(image->rodata);
+    free(image->relocs);
+    memset(image, 0, sizeof(*image));
+}